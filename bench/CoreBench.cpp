@@ -0,0 +1,306 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Benchmark that measures hot paths in the application's core data types and the sound mixer
+#include "Config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "SDL2/SDL.h"
+#include "StdString.h"
+#include "StringList.h"
+#include "HashMap.h"
+#include "Json.h"
+#include "Buffer.h"
+#include "SoundMixer.h"
+#include "BenchUtil.h"
+#include "BenchHook.h"
+
+static const char *benchName = "core";
+static const int stringCount = 200000;
+static const int hashMapKeyCount = 20000;
+static const int hashMapFindCount = 500000;
+static const int jsonFieldCount = 24;
+static const int jsonParseCount = 20000;
+static const int jsonFindCount = 500000;
+static const int bufferWriteCount = 1000000;
+static const int bufferWriteSize = 24;
+static const int mixSampleCount = 48000 * 2;
+static const int mixPassCount = 200;
+
+// Return a JSON object string with jsonFieldCount fields of mixed types, resembling a MediaItem record
+static StdString getSampleJson () {
+	StdString s;
+	int i;
+
+	s.assign ("{");
+	for (i = 0; i < jsonFieldCount; ++i) {
+		if (i > 0) {
+			s.append (",");
+		}
+		switch (i % 4) {
+			case 0: {
+				s.appendSprintf ("\"stringField%i\":\"value %i with some text\"", i, i);
+				break;
+			}
+			case 1: {
+				s.appendSprintf ("\"numberField%i\":%i", i, i * 1000);
+				break;
+			}
+			case 2: {
+				s.appendSprintf ("\"boolField%i\":%s", i, ((i / 4) % 2) ? "true" : "false");
+				break;
+			}
+			default: {
+				s.appendSprintf ("\"arrayField%i\":[1,2,3,4,5,6,7,8]", i);
+				break;
+			}
+		}
+	}
+	s.append ("}");
+	return (s);
+}
+
+static void benchStdString () {
+	StdString s, text;
+	uint64_t start;
+	int i, count;
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < stringCount; ++i) {
+		s.sprintf ("%s/%i/%lli.jpg", "/media/path/subdirectory", i, (long long int) i * 1000);
+	}
+	BenchUtil::printResult (benchName, "stdstring_sprintf", stringCount, BenchUtil::getElapsedSeconds (start));
+
+	text.assign ("The quick brown fox jumps over the lazy dog; the dog sleeps while the fox runs");
+	count = 0;
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < stringCount; ++i) {
+		s.assign (text);
+		s.replace (StdString ("the"), StdString ("a"));
+		count += (int) s.length ();
+	}
+	BenchUtil::printResult (benchName, "stdstring_replace", stringCount, BenchUtil::getElapsedSeconds (start));
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < stringCount; ++i) {
+		s = text.filtered (StdString ("abcdefghijklmnopqrstuvwxyz "));
+		count += (int) s.length ();
+	}
+	BenchUtil::printResult (benchName, "stdstring_filtered", stringCount, BenchUtil::getElapsedSeconds (start));
+	if (count <= 0) {
+		fprintf (stderr, "Unexpected string length\n");
+	}
+}
+
+static void benchHashMap () {
+	HashMap map;
+	StringList keys;
+	StringList::const_iterator i1, i2;
+	uint64_t start;
+	int i, count;
+
+	for (i = 0; i < hashMapKeyCount; ++i) {
+		keys.push_back (StdString::createSprintf ("key_%08x", (unsigned int) (i * 2654435761u)));
+	}
+
+	start = BenchUtil::getCounter ();
+	i = 0;
+	i1 = keys.cbegin ();
+	i2 = keys.cend ();
+	while (i1 != i2) {
+		map.insert (*i1, i);
+		++i;
+		++i1;
+	}
+	BenchUtil::printResult (benchName, "hashmap_insert", hashMapKeyCount, BenchUtil::getElapsedSeconds (start));
+
+	count = 0;
+	start = BenchUtil::getCounter ();
+	i = 0;
+	while (i < hashMapFindCount) {
+		i1 = keys.cbegin ();
+		i2 = keys.cend ();
+		while ((i1 != i2) && (i < hashMapFindCount)) {
+			count += map.find (*i1, 0);
+			++i;
+			++i1;
+		}
+	}
+	BenchUtil::printResult (benchName, "hashmap_find", hashMapFindCount, BenchUtil::getElapsedSeconds (start));
+	if (count < 0) {
+		fprintf (stderr, "Unexpected hashmap sum\n");
+	}
+}
+
+static void benchJson () {
+	Json *json, *copy;
+	StdString data, s;
+	uint64_t start;
+	int i, count;
+
+	data = getSampleJson ();
+	json = new Json ();
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < jsonParseCount; ++i) {
+		if (! json->parse (data)) {
+			fprintf (stderr, "Failed to parse sample JSON\n");
+			break;
+		}
+	}
+	BenchUtil::printResult (benchName, "json_parse", jsonParseCount, BenchUtil::getElapsedSeconds (start));
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < jsonParseCount; ++i) {
+		copy = json->copy ();
+		delete (copy);
+	}
+	BenchUtil::printResult (benchName, "json_copy", jsonParseCount, BenchUtil::getElapsedSeconds (start));
+
+	// Json getter methods locate fields through findJsonObjectEntry; read fields at the start, middle, and end of the object
+	count = 0;
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < jsonFindCount; ++i) {
+		switch (i % 3) {
+			case 0: {
+				s = json->getString ("stringField0", "");
+				count += (int) s.length ();
+				break;
+			}
+			case 1: {
+				count += json->getNumber ("numberField13", (int) 0);
+				break;
+			}
+			default: {
+				count += json->getBoolean ("boolField22", false) ? 1 : 0;
+				break;
+			}
+		}
+	}
+	BenchUtil::printResult (benchName, "json_find", jsonFindCount, BenchUtil::getElapsedSeconds (start));
+	if (count < 0) {
+		fprintf (stderr, "Unexpected json sum\n");
+	}
+	delete (json);
+}
+
+static void benchBuffer () {
+	Buffer *buffer;
+	uint8_t data[bufferWriteSize];
+	uint64_t start;
+	int i;
+
+	memset (data, 0x5A, sizeof (data));
+	buffer = new Buffer ();
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < bufferWriteCount; ++i) {
+		buffer->add (data, bufferWriteSize);
+	}
+	BenchUtil::printResult (benchName, "buffer_add_grow", bufferWriteCount, BenchUtil::getElapsedSeconds (start));
+	BenchUtil::printValue (benchName, "buffer_add_grow_capacity", "bytes", (double) buffer->getCapacity ());
+	delete (buffer);
+
+	buffer = new Buffer ();
+	start = BenchUtil::getCounter ();
+	buffer->reserve (bufferWriteCount * bufferWriteSize);
+	for (i = 0; i < bufferWriteCount; ++i) {
+		buffer->add (data, bufferWriteSize);
+	}
+	BenchUtil::printResult (benchName, "buffer_add_reserved", bufferWriteCount, BenchUtil::getElapsedSeconds (start));
+	delete (buffer);
+}
+
+static void benchMixFunction (const char *name, int mixType, int sampleSize) {
+	BenchHook::MixFunction fn;
+	uint8_t *dest, *src;
+	uint64_t start;
+	int64_t datasize;
+	int i;
+
+	fn = BenchHook::getMixFunction (mixType);
+	if (! fn) {
+		return;
+	}
+	datasize = (int64_t) mixSampleCount * sampleSize;
+	dest = (uint8_t *) malloc (datasize);
+	src = (uint8_t *) malloc (datasize);
+	if ((! dest) || (! src)) {
+		fprintf (stderr, "Failed to allocate mix buffers\n");
+		free (dest);
+		free (src);
+		return;
+	}
+	memset (dest, 0, datasize);
+	if (mixType == BenchHook::MixFloat32) {
+		for (i = 0; i < mixSampleCount; ++i) {
+			((float *) src)[i] = (float) sin ((double) i * 0.01f) * 0.5f;
+		}
+	}
+	else {
+		for (i = 0; i < datasize; ++i) {
+			src[i] = (uint8_t) ((i * 31) & 0xFF);
+		}
+	}
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < mixPassCount; ++i) {
+		fn (dest, SoundMixer::maxMixVolume / 2, src, datasize);
+	}
+	BenchUtil::printResult (benchName, name, (int64_t) mixPassCount * mixSampleCount, BenchUtil::getElapsedSeconds (start));
+	free (dest);
+	free (src);
+}
+
+static void benchSoundMixer () {
+	benchMixFunction ("mix_sint8", BenchHook::MixSint8, 1);
+	benchMixFunction ("mix_uint8", BenchHook::MixUint8, 1);
+	benchMixFunction ("mix_sint16", BenchHook::MixSint16, 2);
+	benchMixFunction ("mix_uint16", BenchHook::MixUint16, 2);
+	benchMixFunction ("mix_sint32", BenchHook::MixSint32, 4);
+	benchMixFunction ("mix_float32", BenchHook::MixFloat32, 4);
+}
+
+int main (int argc, char **argv) {
+	if (SDL_Init (0) != 0) {
+		fprintf (stderr, "SDL_Init failed: %s\n", SDL_GetError ());
+		return (1);
+	}
+	benchStdString ();
+	benchHashMap ();
+	benchJson ();
+	benchBuffer ();
+	benchSoundMixer ();
+	SDL_Quit ();
+	return (0);
+}
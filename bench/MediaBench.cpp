@@ -0,0 +1,446 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Benchmark that measures media library and playback throughput: database upsert and select through MediaItem, thumbnail extraction with MediaReader, and Video decode-to-texture frame rate on the SDL software renderer. Test clips are generated with MediaWriter on each run, so no media files are required.
+#include "Config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <list>
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_image.h"
+#include "App.h"
+#include "StdString.h"
+#include "StringList.h"
+#include "OsUtil.h"
+#include "TaskGroup.h"
+#include "Database.h"
+#include "MediaItem.h"
+#include "MediaReader.h"
+#include "MediaWriter.h"
+#include "SharedBuffer.h"
+#include "SoundMixer.h"
+#include "Histogram.h"
+#include "Video.h"
+#include "BenchUtil.h"
+#include "BenchHook.h"
+
+static const char *benchName = "media";
+static const char *defaultWorkDirectoryName = "media-bench-data";
+static const int databaseItemCount = 5000;
+static const int databaseTransactionSize = 500;
+static const int databaseSelectCount = 2000;
+static const int databasePageSize = 100;
+static const int clipFrameRate = 30;
+static const int clipFrameCount = 150;
+static const int clipEncodeThreadCount = 4;
+static const int maxQueuedClipFrames = 48;
+static const int thumbnailCount = 12;
+static const int updateDelay = 5; // milliseconds
+static const int videoPlayTimeout = 30000; // milliseconds
+
+struct ClipSize {
+	int width;
+	int height;
+};
+static const ClipSize clipSizes[] = {
+	{ 640, 360 },
+	{ 1280, 720 }
+};
+static const int clipSizeCount = (int) (sizeof (clipSizes) / sizeof (clipSizes[0]));
+
+// Return a MediaItem populated with field values resembling a scanned video file
+static MediaItem getSampleMediaItem (int index) {
+	MediaItem item;
+
+	item.mediaId.sprintf ("bench%08x", (unsigned int) index);
+	item.name.sprintf ("Sample Clip %i.mp4", index);
+	item.mediaDirname.sprintf ("/media/library/directory%i", index % 50);
+	item.mediaPath = OsUtil::getJoinedPath (item.mediaDirname, item.name);
+	item.mtime = 1600000000000LL + ((int64_t) index * 1000);
+	item.duration = 60000 + ((index % 600) * 1000);
+	item.mediaFileSize = 10000000 + ((int64_t) index * 4096);
+	item.totalBitrate = 4000000;
+	item.isVideo = true;
+	item.isAudio = true;
+	item.frameRate = 30.0f;
+	item.videoBitrate = 3800000;
+	item.width = 1920;
+	item.height = 1080;
+	item.audioSampleRate = 48000;
+	item.audioChannels = 2;
+	item.audioBitrate = 192000;
+	item.thumbnailTimestamps.push_back (0);
+	item.thumbnailTimestamps.push_back (item.duration / 2);
+	item.sortKey = item.name.lowercased ().filtered (MediaItem::sortKeyCharacters);
+	return (item);
+}
+
+static void benchDatabase (const StdString &workPath) {
+	StdString dbpath, errmsg;
+	MediaItem item;
+	std::list<MediaItem> items;
+	uint64_t start;
+	int i, count;
+	OpResult result;
+
+	dbpath = OsUtil::getJoinedPath (workPath, "bench.db");
+	OsUtil::removeFile (dbpath);
+	result = Database::instance->open (dbpath);
+	if (result != OpResult::Success) {
+		fprintf (stderr, "Failed to open database; path=\"%s\" err=%i\n", dbpath.c_str (), result);
+		return;
+	}
+	result = Database::instance->exec (dbpath, MediaItem::createTableSql, &errmsg);
+	if (result != OpResult::Success) {
+		fprintf (stderr, "Failed to create MediaItem table; err=\"%s\"\n", errmsg.c_str ());
+		Database::instance->close (dbpath);
+		return;
+	}
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < databaseItemCount; ++i) {
+		item = getSampleMediaItem (i);
+		Database::instance->exec (dbpath, item.getUpsertSql ());
+	}
+	BenchUtil::printResult (benchName, "database_upsert", databaseItemCount, BenchUtil::getElapsedSeconds (start));
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < databaseItemCount; ++i) {
+		if ((i % databaseTransactionSize) == 0) {
+			Database::instance->exec (dbpath, StdString ("BEGIN TRANSACTION;"));
+		}
+		item = getSampleMediaItem (i);
+		item.mtime += 1;
+		Database::instance->exec (dbpath, item.getUpsertSql ());
+		if (((i + 1) % databaseTransactionSize) == 0) {
+			Database::instance->exec (dbpath, StdString ("COMMIT;"));
+		}
+	}
+	if ((databaseItemCount % databaseTransactionSize) != 0) {
+		Database::instance->exec (dbpath, StdString ("COMMIT;"));
+	}
+	BenchUtil::printResult (benchName, "database_upsert_transaction", databaseItemCount, BenchUtil::getElapsedSeconds (start));
+
+	count = 0;
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < databaseSelectCount; ++i) {
+		item = getSampleMediaItem ((i * 7919) % databaseItemCount);
+		if (item.readDatabaseMediaPathRow (dbpath, &errmsg, item.mediaPath)) {
+			++count;
+		}
+	}
+	BenchUtil::printResult (benchName, "database_select_path", databaseSelectCount, BenchUtil::getElapsedSeconds (start));
+	if (count != databaseSelectCount) {
+		fprintf (stderr, "database_select_path found %i of %i records\n", count, databaseSelectCount);
+	}
+
+	count = 0;
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < (databaseItemCount / databasePageSize); ++i) {
+		items.clear ();
+		if (MediaItem::readDatabaseRows (dbpath, &errmsg, &items, StdString (), i * databasePageSize, databasePageSize)) {
+			count += (int) items.size ();
+		}
+	}
+	BenchUtil::printResult (benchName, "database_select_page", count, BenchUtil::getElapsedSeconds (start));
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < databasePageSize; ++i) {
+		MediaItem::countDatabaseRecords (dbpath, &errmsg, StdString ("clip 1"));
+	}
+	BenchUtil::printResult (benchName, "database_count_search", databasePageSize, BenchUtil::getElapsedSeconds (start));
+
+	Database::instance->close (dbpath);
+	OsUtil::removeFile (dbpath);
+}
+
+// Update TaskGroup state until writer has ended its run
+static void waitMediaWriter (MediaWriter *writer) {
+	while (writer->isRunning) {
+		TaskGroup::instance->update (updateDelay);
+		SDL_Delay (updateDelay);
+	}
+	TaskGroup::instance->update (updateDelay);
+}
+
+// Fill a frame buffer with a moving gradient pattern in MediaUtil::swsRenderPixelFormat, so that encoded frames differ from each other
+static void fillClipFrame (uint8_t *data, int width, int height, int frameIndex) {
+	uint8_t *row, *pixel;
+	int x, y;
+
+	for (y = 0; y < height; ++y) {
+		row = data + ((int64_t) y * width * 4);
+		for (x = 0; x < width; ++x) {
+			pixel = row + (x * 4);
+			pixel[0] = (uint8_t) ((x + (frameIndex * 4)) & 0xFF);
+			pixel[1] = (uint8_t) ((y + (frameIndex * 2)) & 0xFF);
+			pixel[2] = (uint8_t) (((x ^ y) + frameIndex) & 0xFF);
+			pixel[3] = 0xFF;
+		}
+	}
+}
+
+// Write a test clip of the specified size to path and return a boolean value indicating if the operation succeeded
+static bool writeClip (const StdString &path, int width, int height) {
+	MediaWriter *writer;
+	SharedBuffer *frame;
+	uint64_t start;
+	int i;
+	bool result;
+
+	OsUtil::removeFile (path);
+	writer = new MediaWriter ();
+	writer->retain ();
+	writer->videoWidth = width;
+	writer->videoHeight = height;
+	writer->videoExpectedFrameRate = (double) clipFrameRate;
+	writer->videoFrameDropLag = 0;
+	writer->videoEncodePreset.assign ("veryfast");
+	writer->videoEncodeThreadCount = clipEncodeThreadCount;
+	writer->isDuplicateFrameElisionEnabled = false;
+
+	start = BenchUtil::getCounter ();
+	writer->start (path);
+	for (i = 0; i < clipFrameCount; ++i) {
+		if (writer->isWriteFailed) {
+			break;
+		}
+		frame = new SharedBuffer ();
+		frame->retain ();
+		if (frame->expand (width * height * 4) != OpResult::Success) {
+			frame->release ();
+			break;
+		}
+		fillClipFrame (frame->data, width, height, i);
+		writer->writeVideoFrame (frame, 1000 + (((int64_t) i * 1000) / clipFrameRate), width * 4, width, height);
+		frame->release ();
+		TaskGroup::instance->update (0);
+
+		// Bound the number of raw frames held in the writer queue; encoder lookahead with clipEncodeThreadCount threads stays well below this limit
+		while ((writer->frameReceiveCount - writer->packetWriteCount) > maxQueuedClipFrames) {
+			if (writer->isWriteFailed || (! writer->isRunning)) {
+				break;
+			}
+			TaskGroup::instance->update (updateDelay);
+			SDL_Delay (updateDelay);
+		}
+	}
+	writer->stop ();
+	waitMediaWriter (writer);
+	result = (! writer->isWriteFailed) && OsUtil::fileExists (path);
+	if (result) {
+		BenchUtil::printResult (benchName, StdString::createSprintf ("clip_encode_%ix%i", width, height).c_str (), clipFrameCount, BenchUtil::getElapsedSeconds (start));
+	}
+	else {
+		fprintf (stderr, "Failed to write test clip; path=\"%s\" err=\"%s\"\n", path.c_str (), writer->lastErrorMessage.c_str ());
+	}
+	writer->release ();
+	return (result);
+}
+
+static void benchThumbnails (const StdString &clipPath, const StdString &workPath, int width, int height) {
+	MediaReader reader;
+	StdString path;
+	uint64_t start;
+	int64_t seektimestamp;
+	int i, count;
+
+	start = BenchUtil::getCounter ();
+	reader.setMediaPath (clipPath);
+	if (reader.readMetadata () != OpResult::Success) {
+		fprintf (stderr, "Failed to read clip metadata; path=\"%s\" err=\"%s\"\n", clipPath.c_str (), reader.lastErrorMessage.c_str ());
+		return;
+	}
+	count = 0;
+	for (i = 0; i < thumbnailCount; ++i) {
+		seektimestamp = (int64_t) (((double) reader.duration) * 0.99f * (double) i / (double) thumbnailCount);
+		reader.setVideoFrameSeekTimestamp (seektimestamp);
+		reader.readVideoFrame ();
+		if (! reader.videoFrameData) {
+			fprintf (stderr, "Failed to read clip frame; path=\"%s\" err=\"%s\"\n", clipPath.c_str (), reader.lastErrorMessage.c_str ());
+			break;
+		}
+		path = OsUtil::getJoinedPath (workPath, StdString::createSprintf ("thumbnail_%ix%i_%i.jpg", width, height, i));
+		reader.writeVideoFrameJpeg (path);
+		if (! reader.lastErrorMessage.empty ()) {
+			fprintf (stderr, "Failed to write thumbnail; path=\"%s\" err=\"%s\"\n", path.c_str (), reader.lastErrorMessage.c_str ());
+			break;
+		}
+		OsUtil::removeFile (path);
+		++count;
+	}
+	BenchUtil::printResult (benchName, StdString::createSprintf ("thumbnail_%ix%i", width, height).c_str (), count, BenchUtil::getElapsedSeconds (start));
+}
+
+static void benchVideo (const StdString &clipPath, int width, int height) {
+	Video *video;
+	Video::PlaybackStats stats;
+	StdString name;
+	uint64_t start, t;
+	int elapsed;
+	double seconds;
+
+	if (! App::instance->render) {
+		return;
+	}
+	video = new Video ((double) width, (double) height, SoundMixer::maxMixVolume, true);
+	video->retain ();
+	video->setPlayPath (clipPath);
+	start = BenchUtil::getCounter ();
+	t = start;
+	video->play ();
+	while (video->isPlaying) {
+		elapsed = (int) (BenchUtil::getElapsedSeconds (t) * 1000.0f);
+		t = BenchUtil::getCounter ();
+		TaskGroup::instance->update (elapsed);
+		video->update (elapsed, 0.0f, 0.0f);
+		BenchHook::executePredrawTasks ();
+		SDL_RenderClear (App::instance->render);
+		video->draw ();
+		SDL_RenderPresent (App::instance->render);
+		if ((BenchUtil::getElapsedSeconds (start) * 1000.0f) > (double) videoPlayTimeout) {
+			fprintf (stderr, "Video playback timed out; path=\"%s\"\n", clipPath.c_str ());
+			video->stop ();
+			break;
+		}
+		SDL_Delay (1);
+	}
+	seconds = BenchUtil::getElapsedSeconds (start);
+	video->getPlaybackStats (&stats);
+	video->stop ();
+	while (video->isPlaying) {
+		TaskGroup::instance->update (updateDelay);
+		BenchHook::executePredrawTasks ();
+		SDL_Delay (updateDelay);
+	}
+	TaskGroup::instance->update (updateDelay);
+	if (video->isPlayFailed) {
+		fprintf (stderr, "Video playback failed; path=\"%s\" err=\"%s\"\n", clipPath.c_str (), video->lastErrorMessage.c_str ());
+	}
+
+	name.sprintf ("video_render_%ix%i", width, height);
+	BenchUtil::printResult (benchName, name.c_str (), stats.videoFrameRenderCount, seconds);
+	BenchUtil::printValue (benchName, StdString::createSprintf ("%s_dropped", name.c_str ()).c_str (), "frames", (double) (stats.videoPacketDropCount + stats.videoFrameSkipCount));
+	BenchUtil::printValue (benchName, StdString::createSprintf ("%s_decode_mean", name.c_str ()).c_str (), "us", stats.decodeTime.getMean ());
+	BenchUtil::printValue (benchName, StdString::createSprintf ("%s_scale_mean", name.c_str ()).c_str (), "us", stats.scaleTime.getMean ());
+	BenchUtil::printValue (benchName, StdString::createSprintf ("%s_upload_mean", name.c_str ()).c_str (), "us", stats.textureUploadTime.getMean ());
+	BenchUtil::printValue (benchName, StdString::createSprintf ("%s_upload_p99", name.c_str ()).c_str (), "us", (double) stats.textureUploadTime.getPercentile (99.0f));
+	video->release ();
+}
+
+// Create a hidden window with a software renderer for use by Video, and return a boolean value indicating if the operation succeeded. Set SDL_VIDEODRIVER=offscreen or SDL_VIDEODRIVER=dummy to run without a display.
+static bool createRenderer () {
+	SDL_SetHint (SDL_HINT_RENDER_DRIVER, "software");
+	if (SDL_InitSubSystem (SDL_INIT_VIDEO) != 0) {
+		fprintf (stderr, "Failed to start SDL video, SDL_InitSubSystem: %s\n", SDL_GetError ());
+		return (false);
+	}
+	App::instance->window = SDL_CreateWindow ("media-bench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, clipSizes[clipSizeCount - 1].width, clipSizes[clipSizeCount - 1].height, SDL_WINDOW_HIDDEN);
+	if (! App::instance->window) {
+		fprintf (stderr, "Failed to create window, SDL_CreateWindow: %s\n", SDL_GetError ());
+		return (false);
+	}
+	App::instance->render = SDL_CreateRenderer (App::instance->window, -1, SDL_RENDERER_SOFTWARE);
+	if (! App::instance->render) {
+		fprintf (stderr, "Failed to create renderer, SDL_CreateRenderer: %s\n", SDL_GetError ());
+		SDL_DestroyWindow (App::instance->window);
+		App::instance->window = NULL;
+		return (false);
+	}
+	return (true);
+}
+
+static void destroyRenderer () {
+	if (App::instance->render) {
+		SDL_DestroyRenderer (App::instance->render);
+		App::instance->render = NULL;
+	}
+	if (App::instance->window) {
+		SDL_DestroyWindow (App::instance->window);
+		App::instance->window = NULL;
+	}
+}
+
+int main (int argc, char **argv) {
+	StdString workpath, clippath;
+	OpResult result;
+	int i;
+
+	App::createInstance (true);
+	if (SDL_Init (0) != 0) {
+		fprintf (stderr, "SDL_Init failed: %s\n", SDL_GetError ());
+		App::freeInstance ();
+		return (1);
+	}
+	if (IMG_Init (IMG_INIT_JPG | IMG_INIT_PNG) != (IMG_INIT_JPG | IMG_INIT_PNG)) {
+		fprintf (stderr, "IMG_Init failed: %s\n", IMG_GetError ());
+		App::freeInstance ();
+		return (1);
+	}
+	if (argc >= 2) {
+		workpath.assign (argv[1]);
+	}
+	else {
+		workpath = OsUtil::getJoinedPath (OsUtil::getWorkingPath (), defaultWorkDirectoryName);
+	}
+	result = OsUtil::createDirectory (workpath);
+	if (result != OpResult::Success) {
+		fprintf (stderr, "Failed to create work directory; path=\"%s\" err=%i\n", workpath.c_str (), result);
+		App::freeInstance ();
+		return (1);
+	}
+
+	benchDatabase (workpath);
+	createRenderer ();
+	for (i = 0; i < clipSizeCount; ++i) {
+		clippath = OsUtil::getJoinedPath (workpath, StdString::createSprintf ("clip_%ix%i.mp4", clipSizes[i].width, clipSizes[i].height));
+		if (! writeClip (clippath, clipSizes[i].width, clipSizes[i].height)) {
+			continue;
+		}
+		benchThumbnails (clippath, workpath, clipSizes[i].width, clipSizes[i].height);
+		benchVideo (clippath, clipSizes[i].width, clipSizes[i].height);
+		OsUtil::removeFile (clippath);
+	}
+	destroyRenderer ();
+
+	TaskGroup::instance->stop ();
+	while (! TaskGroup::instance->isStopComplete ()) {
+		TaskGroup::instance->update (updateDelay);
+		SDL_Delay (updateDelay);
+	}
+	TaskGroup::instance->waitThreads ();
+	OsUtil::removeDirectory (workpath);
+	App::freeInstance ();
+	return (0);
+}
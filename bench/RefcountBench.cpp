@@ -0,0 +1,196 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Benchmark that compares SDL_mutex refcounting with the atomic Refcounted base class
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "SDL2/SDL.h"
+#include "Refcounted.h"
+#include "BenchUtil.h"
+
+// Refcount implementation used by shared types before the Refcounted base class, kept here as a baseline
+class MutexRefcounted {
+public:
+	MutexRefcounted ()
+	: refcount (0)
+	, refcountMutex (NULL) {
+		refcountMutex = SDL_CreateMutex ();
+	}
+	virtual ~MutexRefcounted () {
+		if (refcountMutex) {
+			SDL_DestroyMutex (refcountMutex);
+			refcountMutex = NULL;
+		}
+	}
+
+	void retain () {
+		SDL_LockMutex (refcountMutex);
+		++refcount;
+		if (refcount < 1) {
+			refcount = 1;
+		}
+		SDL_UnlockMutex (refcountMutex);
+	}
+
+	void release () {
+		bool isdestroyed;
+
+		isdestroyed = false;
+		SDL_LockMutex (refcountMutex);
+		--refcount;
+		if (refcount <= 0) {
+			refcount = 0;
+			isdestroyed = true;
+		}
+		SDL_UnlockMutex (refcountMutex);
+		if (isdestroyed) {
+			delete (this);
+		}
+	}
+
+private:
+	int refcount;
+	SDL_mutex *refcountMutex;
+};
+
+class AtomicItem : public Refcounted {
+public:
+	AtomicItem () { }
+	~AtomicItem () { }
+};
+
+static const int allocateCount = 200000;
+static const int retainCount = 2000000;
+static const int threadCount = 4;
+
+struct RetainThreadContext {
+	MutexRefcounted *mutexItem;
+	AtomicItem *atomicItem;
+	int count;
+};
+
+static const char *benchName = "refcount";
+
+static int retainMutexThread (void *contextPtr) {
+	RetainThreadContext *ctx;
+	int i;
+
+	ctx = (RetainThreadContext *) contextPtr;
+	for (i = 0; i < ctx->count; ++i) {
+		ctx->mutexItem->retain ();
+		ctx->mutexItem->release ();
+	}
+	return (0);
+}
+
+static int retainAtomicThread (void *contextPtr) {
+	RetainThreadContext *ctx;
+	int i;
+
+	ctx = (RetainThreadContext *) contextPtr;
+	for (i = 0; i < ctx->count; ++i) {
+		ctx->atomicItem->retain ();
+		ctx->atomicItem->release ();
+	}
+	return (0);
+}
+
+static void runThreads (const char *name, SDL_ThreadFunction fn, RetainThreadContext *ctx) {
+	SDL_Thread *threads[threadCount];
+	uint64_t start;
+	int i;
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < threadCount; ++i) {
+		threads[i] = SDL_CreateThread (fn, name, ctx);
+	}
+	for (i = 0; i < threadCount; ++i) {
+		if (threads[i]) {
+			SDL_WaitThread (threads[i], NULL);
+		}
+	}
+	BenchUtil::printResult (benchName, name, ctx->count * threadCount * 2, BenchUtil::getElapsedSeconds (start));
+}
+
+int main (int argc, char **argv) {
+	MutexRefcounted *mutexitem;
+	AtomicItem *atomicitem;
+	RetainThreadContext ctx;
+	uint64_t start;
+	int i;
+
+	if (SDL_Init (0) != 0) {
+		fprintf (stderr, "SDL_Init failed: %s\n", SDL_GetError ());
+		return (1);
+	}
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < allocateCount; ++i) {
+		mutexitem = new MutexRefcounted ();
+		mutexitem->retain ();
+		mutexitem->release ();
+	}
+	BenchUtil::printResult (benchName, "allocate_mutex", allocateCount, BenchUtil::getElapsedSeconds (start));
+
+	start = BenchUtil::getCounter ();
+	for (i = 0; i < allocateCount; ++i) {
+		atomicitem = new AtomicItem ();
+		atomicitem->retain ();
+		atomicitem->release ();
+	}
+	BenchUtil::printResult (benchName, "allocate_atomic", allocateCount, BenchUtil::getElapsedSeconds (start));
+
+	mutexitem = new MutexRefcounted ();
+	mutexitem->retain ();
+	atomicitem = new AtomicItem ();
+	atomicitem->retain ();
+
+	ctx.mutexItem = mutexitem;
+	ctx.atomicItem = atomicitem;
+	ctx.count = retainCount;
+	start = BenchUtil::getCounter ();
+	retainMutexThread (&ctx);
+	BenchUtil::printResult (benchName, "retain_release_mutex", retainCount * 2, BenchUtil::getElapsedSeconds (start));
+	start = BenchUtil::getCounter ();
+	retainAtomicThread (&ctx);
+	BenchUtil::printResult (benchName, "retain_release_atomic", retainCount * 2, BenchUtil::getElapsedSeconds (start));
+
+	ctx.count = retainCount / threadCount;
+	runThreads ("retain_release_mutex_threads", retainMutexThread, &ctx);
+	runThreads ("retain_release_atomic_threads", retainAtomicThread, &ctx);
+
+	mutexitem->release ();
+	atomicitem->release ();
+	SDL_Quit ();
+	return (0);
+}
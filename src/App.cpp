@@ -46,6 +46,8 @@
 #include "LuaScript.h"
 #include "OsUtil.h"
 #include "SdlUtil.h"
+#include "BufferPool.h"
+#include "Profiler.h"
 #include "Ui.h"
 #include "UiConfiguration.h"
 #include "UiText.h"
@@ -79,6 +81,7 @@ constexpr const SDL_Keycode settingsKeycode = SDLK_s;
 constexpr const SDL_Keycode helpKeycode = SDLK_h;
 constexpr const SDL_Keycode logKeycode = SDLK_l;
 constexpr const SDL_Keycode consoleKeycode = SDLK_o;
+constexpr const SDL_Keycode profilerKeycode = SDLK_p;
 constexpr const int defaultMinFrameDelay = 10;
 constexpr const double pointerOffsetScaleX = 0.5f;
 constexpr const double pointerOffsetScaleY = 0.25f;
@@ -90,6 +93,8 @@ void App::createInstance (bool shouldSkipInit) {
 		return;
 	}
 	App::instance = new App ();
+	BufferPool::createInstance ();
+	Profiler::createInstance ();
 	MediaUtil::createInstance ();
 	Prng::createInstance ();
 	TaskGroup::createInstance ();
@@ -133,6 +138,7 @@ void App::freeInstance () {
 	SystemInterface::freeInstance ();
 	SoundMixer::freeInstance ();
 	SpriteGroup::freeInstance ();
+	Resource::instance->logTextureStats ();
 	Resource::freeInstance ();
 	RenderResource::freeInstance ();
 	Network::freeInstance ();
@@ -141,7 +147,12 @@ void App::freeInstance () {
 	TaskGroup::freeInstance ();
 	Prng::freeInstance ();
 	MediaUtil::freeInstance ();
+	Profiler::freeInstance ();
+	BufferPool::instance->logStats ();
+	BufferPool::freeInstance ();
 
+	// Write queued log messages and end the writer thread while SDL is still initialized
+	App::instance->log.stop ();
 	delete (App::instance);
 	App::instance = NULL;
 
@@ -157,6 +168,7 @@ App::App ()
 , render (NULL)
 , isShuttingDown (false)
 , isShutdown (false)
+, isScriptFailed (false)
 , startTime (0)
 , isTextureRenderEnabled (false)
 , rootPanel (NULL)
@@ -170,6 +182,7 @@ App::App ()
 , drawableHeight (0.0f)
 , minDrawFrameDelay (0)
 , minUpdateFrameDelay (0)
+, prefsWriteDelay (App::defaultPrefsWriteDelay)
 , fontScale (1.0f)
 , drawCount (0)
 , updateCount (0)
@@ -177,10 +190,15 @@ App::App ()
 , networkActivityCount (0)
 , isPrefsWriteDisabled (false)
 , nextUniqueId (1)
+, prefsDirtyTime (0)
+, prefsWriteData (NULL)
+, prefsWriteThread (NULL)
+, isPrefsWriteComplete (false)
 , mouseCursor (NULL)
 , isUpdateThreadEnded (false)
 , isSuspendingUpdate (false)
 , consoleWindowHandle (&consoleWindow)
+, isBatchIndex (false)
 {
 	SdlUtil::createMutex (&uniqueIdMutex);
 	SdlUtil::createMutex (&prefsMapMutex);
@@ -281,6 +299,7 @@ void App::init () {
 	}
 	else {
 		prefsPath.assign (OsUtil::getJoinedPath (path, StdString::createSprintf ("%s.conf", APPLICATION_PACKAGE_NAME)));
+		Network::instance->httpCachePath.assign (OsUtil::getJoinedPath (path, App::httpCacheDirectoryName));
 		if (! log.isFileWriteEnabled) {
 			log.openLogFile (OsUtil::getJoinedPath (path, StdString::createSprintf ("%s.log", APPLICATION_PACKAGE_NAME)));
 		}
@@ -288,6 +307,16 @@ void App::init () {
 
 	minDrawFrameDelay = OsUtil::getEnvValue (OsUtil::minDrawFrameDelayEnvKey, 0);
 	minUpdateFrameDelay = OsUtil::getEnvValue (OsUtil::minUpdateFrameDelayEnvKey, 0);
+	prefsWriteDelay = OsUtil::getEnvValue (OsUtil::prefsWriteDelayEnvKey, App::defaultPrefsWriteDelay);
+	CaptureWriter::instance->videoEncodePreset.assign (OsUtil::getEnvValue (OsUtil::captureVideoPresetEnvKey, ""));
+	CaptureWriter::instance->videoEncodeThreadCount = OsUtil::getEnvValue (OsUtil::captureVideoThreadsEnvKey, 0);
+	CaptureWriter::instance->videoScaleThreadCount = OsUtil::getEnvValue (OsUtil::captureVideoScaleThreadsEnvKey, 0);
+	CaptureWriter::instance->isDuplicateFrameElisionEnabled = OsUtil::getEnvValue (OsUtil::captureSkipDuplicateFramesEnvKey, false);
+
+	result = log.start ();
+	if (result != OpResult::Success) {
+		Log::warning ("Failed to start log writer thread, writing log messages synchronously; err=%i", result);
+	}
 }
 
 int App::run (int argCount, char **argValues) {
@@ -307,6 +336,19 @@ int App::run (int argCount, char **argValues) {
 			argv.push_back (StdString (argValues[i]));
 		}
 	}
+	if ((argv.size () >= 2) && argv.at (1).equals (App::batchIndexOption)) {
+		if (argv.size () < 4) {
+			printf ("Usage: %s %s data-path media-source-path [media-source-path...]\n", argv.at (0).c_str (), App::batchIndexOption);
+			return (OpResult::InvalidParamError);
+		}
+		isBatchIndex = true;
+		isPrefsWriteDisabled = true;
+		batchIndexDataPath = App::getBatchIndexPath (argv.at (2));
+		batchIndexSourcePath.clear ();
+		for (i = 3; i < (int) argv.size (); ++i) {
+			batchIndexSourcePath.push_back (App::getBatchIndexPath (argv.at (i)));
+		}
+	}
 
 	Prng::instance->seed ((uint32_t) (OsUtil::getTime () & 0xFFFFFFFF));
 	prefsMap.clear ();
@@ -334,7 +376,11 @@ int App::run (int argCount, char **argValues) {
 		Log::err ("Failed to load text resources; language=\"%s\" err=%i", language.c_str (), result);
 		return (result);
 	}
-	Network::instance->maxRequestThreads = prefsMap.find (App::networkThreadsKey, Network::defaultMaxRequestThreads);
+	if (isBatchIndex) {
+		return (runBatchIndex ());
+	}
+	Network::instance->maxHttpTransfers = prefsMap.find (App::networkThreadsKey, Network::defaultMaxHttpTransfers);
+	Network::instance->maxHostHttpTransfers = prefsMap.find (App::networkHostTransfersKey, Network::defaultMaxHostHttpTransfers);
 	Network::instance->allowUnverifiedHttps = prefsMap.find (App::allowUnverifiedHttpsKey, false);
 	Network::instance->httpUserAgent.sprintf ("Membrane Media Player/%s_%s", BUILD_ID, PLATFORM_ID);
 	result = Network::instance->start ();
@@ -350,7 +396,7 @@ int App::run (int argCount, char **argValues) {
 	}
 
 	result = runWindow ();
-	writePrefs ();
+	flushPrefs ();
 	return (result);
 }
 
@@ -363,6 +409,8 @@ int App::runWindow () {
 	RenderResource::DisplayMode *mode;
 	int result, delay, i, w, h;
 	int64_t endtime, elapsed, t1, t2;
+	uint64_t framecounter, lastframecounter;
+	StdString tracepath;
 	double fps;
 
 	if (SDL_Init (appUtil.getSdlInitFlags ()) != 0) {
@@ -475,16 +523,32 @@ int App::runWindow () {
 	Log::debug ("* sdlBuildVersion=%i.%i.%i sdlLinkVersion=%i.%i.%i isTextureRenderEnabled=%s diagonalDpi=%.2f horizontalDpi=%.2f verticalDpi=%.2f imagePrefix=%s minDrawFrameDelay=%i minUpdateFrameDelay=%i", version1.major, version1.minor, version1.patch, version2.major, version2.minor, version2.patch, BOOL_STRING (isTextureRenderEnabled), displayDdpi, displayHdpi, displayVdpi, imagePrefix.c_str (), minDrawFrameDelay, minUpdateFrameDelay);
 	Log::debug ("* renderName=%s renderMaxTextureSize=%ix%i renderFlags=%s windowFlags=%s", renderinfo.name, renderinfo.max_texture_width, renderinfo.max_texture_height, UiText::instance->getSdlRendererFlagsText (renderinfo.flags).c_str (), UiText::instance->getSdlWindowFlagsText (flags).c_str ());
 
+	tracepath = OsUtil::getEnvValue (OsUtil::profileTraceFilenameEnvKey, "");
+	if (! tracepath.empty ()) {
+		Profiler::instance->startTrace ();
+	}
+	lastframecounter = 0;
 	while (true) {
 		if (isShutdown) {
 			break;
 		}
+		if (Profiler::isEnabled.load (std::memory_order_relaxed)) {
+			framecounter = SDL_GetPerformanceCounter ();
+			if (lastframecounter > 0) {
+				Profiler::instance->addFrame (Profiler::getCounterDuration (lastframecounter, framecounter));
+			}
+			lastframecounter = framecounter;
+		}
+		else {
+			lastframecounter = 0;
+		}
 		t1 = OsUtil::getTime ();
 		Input::instance->pollEvents ();
 
 		draw ();
 		UiStack::instance->executeStackCommands ();
 		Resource::instance->compact ();
+		BufferPool::instance->trim ();
 
 		t2 = OsUtil::getTime ();
 		delay = minDrawFrameDelay - ((int) (t2 - t1));
@@ -494,6 +558,9 @@ int App::runWindow () {
 		SDL_Delay (delay);
 	}
 	SDL_WaitThread (thread, &result);
+	if ((! tracepath.empty ()) && Profiler::instance->isTracing) {
+		Profiler::instance->writeTrace (tracepath);
+	}
 
 	executePredrawTasks ();
 	executePostdrawTasks ();
@@ -538,6 +605,100 @@ int App::runWindow () {
 	return (OpResult::Success);
 }
 
+int App::runBatchIndex () {
+	MediaControl::TaskStats stats;
+	int64_t t1, scantime, cleantime;
+	double seconds;
+	int result;
+
+	if (IMG_Init (IMG_INIT_JPG | IMG_INIT_PNG) != (IMG_INIT_JPG | IMG_INIT_PNG)) {
+		Log::err ("Failed to start SDL_image, IMG_Init: %s", IMG_GetError ());
+		return (OpResult::SdlOperationFailedError);
+	}
+	result = OsUtil::createDirectory (batchIndexDataPath);
+	if (result != OpResult::Success) {
+		Log::err ("Failed to create data directory; path=\"%s\" err=%i", batchIndexDataPath.c_str (), result);
+		return (result);
+	}
+
+	result = OpResult::Success;
+	scantime = 0;
+	cleantime = 0;
+	MediaControl::instance->isWatchEnabled = false;
+	MediaControl::instance->configureBatch (batchIndexSourcePath, batchIndexDataPath, prefsMap.find (MediaControl::mediaThumbnailCountKey, MediaControl::defaultMediaThumbnailCount));
+	if (! waitBatchIndexTasks ()) {
+		result = OpResult::OperationCancelledError;
+	}
+	else if (! MediaControl::instance->isReady) {
+		Log::err ("Failed to open media database; dataPath=\"%s\"", batchIndexDataPath.c_str ());
+		result = OpResult::FileOperationFailedError;
+	}
+
+	if (result == OpResult::Success) {
+		t1 = OsUtil::getTime ();
+		MediaControl::instance->scan ();
+		if (! waitBatchIndexTasks ()) {
+			result = OpResult::OperationCancelledError;
+		}
+		scantime = OsUtil::getTime () - t1;
+	}
+	if (result == OpResult::Success) {
+		t1 = OsUtil::getTime ();
+		MediaControl::instance->clean ();
+		if (! waitBatchIndexTasks ()) {
+			result = OpResult::OperationCancelledError;
+		}
+		cleantime = OsUtil::getTime () - t1;
+	}
+
+	MediaControl::instance->getTaskStats (&stats);
+	seconds = ((double) (scantime > 0 ? scantime : 1)) / 1000.0f;
+	printf ("Scan: %i files (%.2f/s), %i thumbnails (%.2f/s), %.2fMB read (%.2fMB/s), %i errors, %.3fs\n", stats.scanFileCount, ((double) stats.scanFileCount) / seconds, stats.thumbnailCount, ((double) stats.thumbnailCount) / seconds, ((double) stats.scanReadBytes) / (1024.0f * 1024.0f), (((double) stats.scanReadBytes) / (1024.0f * 1024.0f)) / seconds, stats.scanErrorCount, ((double) scantime) / 1000.0f);
+	printf ("Clean: %i records removed, %.2fMB removed, %.3fs\n", stats.removedRecordCount, ((double) stats.removedFileBytes) / (1024.0f * 1024.0f), ((double) cleantime) / 1000.0f);
+
+	MediaControl::instance->stop ();
+	TaskGroup::instance->stop ();
+	while (! TaskGroup::instance->isStopComplete ()) {
+		TaskGroup::instance->update (App::batchIndexUpdateDelay);
+		SDL_Delay (App::batchIndexUpdateDelay);
+	}
+	TaskGroup::instance->waitThreads ();
+
+	if ((result == OpResult::Success) && (stats.failedTaskCount > 0)) {
+		result = OpResult::FileOperationFailedError;
+	}
+	Log::info ("Batch index ended; result=%i runtime=%.3fs pid=%i", result, ((double) (OsUtil::getTime () - startTime)) / 1000.0f, OsUtil::getProcessId ());
+	return (result);
+}
+
+bool App::waitBatchIndexTasks () {
+	while (MediaControl::instance->isRunningTask (MediaControl::ReadyTask) || MediaControl::instance->isRunningTask (MediaControl::ScanTask) || MediaControl::instance->isRunningTask (MediaControl::CleanTask)) {
+		if (isShuttingDown) {
+			return (false);
+		}
+		TaskGroup::instance->update (App::batchIndexUpdateDelay);
+		MediaControl::instance->update (App::batchIndexUpdateDelay);
+		SDL_Delay (App::batchIndexUpdateDelay);
+	}
+	return (true);
+}
+
+StdString App::getBatchIndexPath (const StdString &path) {
+#if PLATFORM_WINDOWS
+	if ((path.length () >= 2) && (path.at (1) == ':')) {
+		return (path);
+	}
+	if (path.startsWith ("\\")) {
+		return (path);
+	}
+#else
+	if (path.startsWith ("/")) {
+		return (path);
+	}
+#endif
+	return (OsUtil::getJoinedPath (OsUtil::getWorkingPath (), path));
+}
+
 void App::populateWidgets () {
 	if (! rootPanel) {
 		rootPanel = new Panel ();
@@ -578,6 +739,7 @@ void App::unlockPrefs () {
 
 void App::executePredrawTasks () {
 	std::list<App::RenderTaskContext>::const_iterator i1, i2;
+	ProfilerZone zone ("App::executePredrawTasks");
 
 	predrawTaskList.clear ();
 	SDL_LockMutex (predrawTaskMutex);
@@ -598,6 +760,7 @@ void App::executePredrawTasks () {
 
 void App::executePostdrawTasks () {
 	std::list<App::RenderTaskContext>::const_iterator i1, i2;
+	ProfilerZone zone ("App::executePostdrawTasks");
 
 	postdrawTaskList.clear ();
 	SDL_LockMutex (postdrawTaskMutex);
@@ -618,8 +781,10 @@ void App::executePostdrawTasks () {
 
 void App::draw () {
 	Ui *ui;
+	ProfilerZone zone ("App::draw");
 
 	executePredrawTasks ();
+	CaptureWriter::instance->beginDrawFrame ();
 	SDL_RenderClear (render);
 	UiStack::instance->drawBackground ();
 	ui = UiStack::instance->getActiveUi ();
@@ -629,9 +794,13 @@ void App::draw () {
 		ui->release ();
 	}
 	UiStack::instance->drawForeground ();
+	CaptureWriter::instance->endDrawFrame ();
 	executePostdrawTasks ();
 
-	SDL_RenderPresent (render);
+	{
+		ProfilerZone presentzone ("SDL_RenderPresent");
+		SDL_RenderPresent (render);
+	}
 	++drawCount;
 }
 
@@ -641,6 +810,7 @@ int App::runUpdates (void *itPtr) {
 	int64_t t1, t2, last;
 	int delay;
 
+	Profiler::instance->setThreadName ("App::runUpdates");
 	line = OsUtil::getEnvValue (OsUtil::runScriptEnvKey, "");
 	if (! line.empty ()) {
 		TaskGroup::instance->run (TaskGroup::RunContext (LuaScript::run, new LuaScript (line, true)));
@@ -678,6 +848,7 @@ int App::runUpdates (void *itPtr) {
 
 void App::update (int msElapsed) {
 	Ui *ui;
+	ProfilerZone zone ("App::update");
 
 	TaskGroup::instance->update (msElapsed);
 	UiLog::instance->update (msElapsed);
@@ -733,6 +904,7 @@ void App::update (int msElapsed) {
 
 void App::executeUpdateTasks () {
 	std::list<App::UpdateTaskContext>::const_iterator i1, i2;
+	ProfilerZone zone ("App::executeUpdateTasks");
 
 	updateTaskList.clear ();
 	SDL_LockMutex (updateTaskMutex);
@@ -773,6 +945,15 @@ bool App::keyEvent (void *ptr, SDL_Keycode keycode, bool isShiftDown, bool isCon
 			UiStack::instance->toggleConsoleWindow ();
 			return (true);
 		}
+		if (keycode == profilerKeycode) {
+			if (isShiftDown) {
+				App::instance->toggleProfilerTrace ();
+			}
+			else {
+				UiStack::instance->toggleProfilerWindow ();
+			}
+			return (true);
+		}
 	}
 	if (UiStack::instance->processKeyEvent (keycode, isShiftDown, isControlDown)) {
 		return (true);
@@ -1105,22 +1286,115 @@ void App::toggleMousePointer () {
 }
 
 void App::writePrefs () {
-	int result;
+	int64_t now;
 
 	if (isPrefsWriteDisabled) {
 		return;
 	}
+	if (prefsWriteThread) {
+		SDL_LockMutex (prefsMapMutex);
+		if (! isPrefsWriteComplete) {
+			SDL_UnlockMutex (prefsMapMutex);
+			return;
+		}
+		SDL_UnlockMutex (prefsMapMutex);
+		SDL_WaitThread (prefsWriteThread, NULL);
+		prefsWriteThread = NULL;
+	}
+
+	now = OsUtil::getTime ();
 	SDL_LockMutex (prefsMapMutex);
 	if (prefsMap.isWriteDirty) {
-		result = prefsMap.write (prefsPath);
-		if (result != OpResult::Success) {
-			Log::err ("Failed to write prefs file; prefsPath=\"%s\" err=%i", prefsPath.c_str (), result);
-			isPrefsWriteDisabled = true;
+		if (prefsDirtyTime <= 0) {
+			prefsDirtyTime = now;
+		}
+		if ((now - prefsDirtyTime) >= prefsWriteDelay) {
+			prefsWriteData = prefsMap.createWriteBuffer ();
+			prefsDirtyTime = 0;
+			isPrefsWriteComplete = false;
 		}
 	}
 	SDL_UnlockMutex (prefsMapMutex);
+	if (! prefsWriteData) {
+		return;
+	}
+
+	prefsWriteThread = SDL_CreateThread (App::runPrefsWrite, "App::runPrefsWrite", (void *) this);
+	if (! prefsWriteThread) {
+		executePrefsWrite ();
+	}
+}
+
+void App::flushPrefs () {
+	if (prefsWriteThread) {
+		SDL_WaitThread (prefsWriteThread, NULL);
+		prefsWriteThread = NULL;
+	}
+	if (isPrefsWriteDisabled) {
+		return;
+	}
+	SDL_LockMutex (prefsMapMutex);
+	if (prefsMap.isWriteDirty) {
+		prefsWriteData = prefsMap.createWriteBuffer ();
+	}
+	prefsDirtyTime = 0;
+	SDL_UnlockMutex (prefsMapMutex);
+	if (prefsWriteData) {
+		executePrefsWrite ();
+	}
+}
+
+int App::runPrefsWrite (void *itPtr) {
+	((App *) itPtr)->executePrefsWrite ();
+	return (0);
+}
+void App::executePrefsWrite () {
+	OpResult result;
+
+	result = OsUtil::writeFileReplace (prefsPath, prefsWriteData);
+	prefsWriteData = NULL;
+	if (result != OpResult::Success) {
+		Log::err ("Failed to write prefs file; prefsPath=\"%s\" err=%i", prefsPath.c_str (), result);
+		isPrefsWriteDisabled = true;
+	}
+	SDL_LockMutex (prefsMapMutex);
+	isPrefsWriteComplete = true;
+	SDL_UnlockMutex (prefsMapMutex);
 }
 
 void App::showNotification (const StdString &messageText) {
 	UiStack::instance->showSnackbar (messageText);
 }
+
+void App::toggleProfilerTrace () {
+	Profiler::Trace *trace;
+
+	if (! Profiler::instance->isTracing) {
+		Profiler::instance->startTrace ();
+		showNotification (UiText::instance->getText (UiTextId::ProfilerTraceStarted).capitalized ());
+		return;
+	}
+	trace = new Profiler::Trace ();
+	Profiler::instance->endTrace (OsUtil::getJoinedPath (prefsPath.empty () ? OsUtil::getWorkingPath () : OsUtil::getPathDirname (prefsPath), StdString::createSprintf ("trace-%lli.json", (long long int) OsUtil::getTime ())), trace);
+	if ((! UiStack::instance->isProfilerWindowOpen ()) && (! Profiler::instance->isMeasuring)) {
+		Profiler::instance->setEnabled (false);
+	}
+	if (! TaskGroup::instance->run (TaskGroup::RunContext (App::writeProfilerTrace, trace))) {
+		App::writeProfilerTrace (trace);
+	}
+}
+
+void App::writeProfilerTrace (void *tracePtr) {
+	Profiler::Trace *trace;
+	OpResult result;
+
+	trace = (Profiler::Trace *) tracePtr;
+	result = Profiler::writeTraceFile (*trace);
+	if (result != OpResult::Success) {
+		App::instance->showNotification (StdString::createSprintf ("%s (%i)", UiText::instance->getText (UiTextId::ProfilerTraceWriteFailed).capitalized ().c_str (), result));
+	}
+	else {
+		App::instance->showNotification (StdString::createSprintf ("%s - %s", UiText::instance->getText (UiTextId::ProfilerTraceWritten).capitalized ().c_str (), trace->path.c_str ()));
+	}
+	delete (trace);
+}
@@ -34,12 +34,14 @@
 #ifndef APP_H
 #define APP_H
 
+#include <atomic>
 #include "AppUtil.h"
 #include "Log.h"
 #include "HashMap.h"
 #include "StringList.h"
 #include "WidgetHandle.h"
 
+class Buffer;
 class Widget;
 class Panel;
 class ConsoleWindow;
@@ -59,6 +61,10 @@ public:
 	static constexpr const char *defaultImagePrefix = "1600x900";
 	static constexpr const int prefsVersion = 1;
 	static constexpr const char *databaseWriteQueueId = "databaseWrite";
+	static constexpr const int defaultPrefsWriteDelay = 2000;
+	static constexpr const char *httpCacheDirectoryName = "httpcache";
+	static constexpr const char *batchIndexOption = "--index";
+	static constexpr const int batchIndexUpdateDelay = 50; // milliseconds
 
 	// Key values for the prefs map
 	static constexpr const char *networkThreadsKey = "AppA";
@@ -69,6 +75,7 @@ public:
 	static constexpr const char *soundVolumeKey = "AppF";
 	static constexpr const char *fsBrowserPathKey = "AppG";
 	static constexpr const char *languageKey = "AppH";
+	static constexpr const char *networkHostTransfersKey = "AppI";
 
 	// Read-write data members
 	Log log;
@@ -85,6 +92,7 @@ public:
 	SDL_Renderer *render; // The renderer must be accessed only from the application's main thread
 	bool isShuttingDown;
 	bool isShutdown;
+	bool isScriptFailed; // True if a script started from the environment ended with an error, causing the application to exit with a failure status
 	int64_t startTime;
 	bool isTextureRenderEnabled;
 	Panel *rootPanel;
@@ -98,6 +106,7 @@ public:
 	double drawableHeight;
 	int minDrawFrameDelay; // milliseconds
 	int minUpdateFrameDelay; // milliseconds
+	int prefsWriteDelay; // milliseconds
 	double fontScale;
 	StdString imagePrefix;
 	int64_t drawCount;
@@ -105,7 +114,7 @@ public:
 	SDL_Rect clipRect;
 	int uiActivityCount;
 	int networkActivityCount;
-	bool isPrefsWriteDisabled;
+	std::atomic<bool> isPrefsWriteDisabled;
 
 	// Run the application, returning only after the application exits
 	int run (int argCount, char **argValues);
@@ -202,23 +211,38 @@ public:
 	// Show the provided message as a notification in the application interface
 	void showNotification (const StdString &messageText);
 
+	// Start a Profiler trace, or write the trace in progress to a file in the preferences directory
+	void toggleProfilerTrace ();
+
 	// Task functions
 	static void shutdownApplication (void *ptr);
 	static void resizeWindow (void *modePtr);
 	void executeResizeWindow (void *modePtr);
 	static void resizeFonts (void *doublePtr);
 	void executeResizeFonts (void *doublePtr);
+	static void writeProfilerTrace (void *tracePtr);
 
 	// Callback functions
 	static bool keyEvent (void *ptr, SDL_Keycode keycode, bool isShiftDown, bool isControlDown);
 
 private:
+	friend class BenchHook;
+
 	// Read environment settings and configure the app
 	void init ();
 
 	// Run the application window
 	int runWindow ();
 
+	// Run media scan and clean tasks for the paths in batchIndexDataPath and batchIndexSourcePath without opening the application window, print throughput stats, and return a Result value
+	int runBatchIndex ();
+
+	// Update media control state until no ready, scan, or clean task remains. Returns false if the application began shutting down before tasks completed.
+	bool waitBatchIndexTasks ();
+
+	// Return path as an absolute path, resolving relative paths against the working directory
+	static StdString getBatchIndexPath (const StdString &path);
+
 	// Create the root panel and other top-level widgets
 	void populateWidgets ();
 
@@ -240,9 +264,16 @@ private:
 	// Run the application's state update thread
 	static int runUpdates (void *itPtr);
 
-	// Write the prefs file if any prefsMap keys have changed since the last write
+	// Start a prefs file write if any prefsMap keys have changed and prefsWriteDelay has elapsed since the first change
 	void writePrefs ();
 
+	// Wait for any prefs file write in progress, then write any remaining prefsMap changes before returning
+	void flushPrefs ();
+
+	// Write prefsWriteData to the prefs file and free it
+	static int runPrefsWrite (void *itPtr);
+	void executePrefsWrite ();
+
 	std::list<App::UpdateTaskContext> updateTaskList;
 	std::list<App::UpdateTaskContext> updateTaskAddList;
 	SDL_mutex *updateTaskMutex;
@@ -260,6 +291,10 @@ private:
 	SDL_mutex *networkActivityMutex;
 	HashMap prefsMap;
 	SDL_mutex *prefsMapMutex;
+	int64_t prefsDirtyTime;
+	Buffer *prefsWriteData;
+	SDL_Thread *prefsWriteThread;
+	bool isPrefsWriteComplete;
 	SDL_Cursor *mouseCursor;
 	std::stack<SDL_Rect> clipRectStack;
 	bool isUpdateThreadEnded;
@@ -269,5 +304,8 @@ private:
 	WidgetHandle<ConsoleWindow> consoleWindowHandle;
 	ConsoleWindow *consoleWindow;
 	SDL_mutex *consoleWindowMutex;
+	bool isBatchIndex;
+	StdString batchIndexDataPath;
+	StringList batchIndexSourcePath;
 };
 #endif
@@ -31,6 +31,7 @@
 * If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
 */
 #include "Config.h"
+#include "BufferPool.h"
 #include "Buffer.h"
 
 Buffer::Buffer ()
@@ -40,13 +41,11 @@ Buffer::Buffer ()
 , readLength (0)
 , size (0)
 , sizeIncrement (Buffer::defaultSizeIncrement)
+, isPooled (false)
 {
 }
 Buffer::~Buffer () {
-	if (data) {
-		free (data);
-		data = NULL;
-	}
+	freeData ();
 }
 
 Buffer *Buffer::copy () const {
@@ -60,16 +59,87 @@ Buffer *Buffer::copy () const {
 }
 
 void Buffer::reset () {
-	if (data) {
-		free (data);
-		data = NULL;
-	}
+	freeData ();
 	length = 0;
 	readPosition = 0;
 	readLength = 0;
 	size = 0;
 }
 
+OpResult Buffer::reserve (int capacity) {
+	if (capacity <= size) {
+		return (OpResult::Success);
+	}
+	return (resize (capacity));
+}
+
+int Buffer::getCapacity () const {
+	return (size);
+}
+
+int Buffer::getGrowSize (int requiredSize) const {
+	int64_t sz;
+	int blocks;
+
+	// Grow by at least half the current size so that repeated appends copy data an amortized constant number of times
+	sz = (int64_t) size + (size / 2);
+	if (sz < requiredSize) {
+		sz = requiredSize;
+	}
+	blocks = (int) (sz / sizeIncrement);
+	if (sz % sizeIncrement) {
+		++blocks;
+	}
+	sz = (int64_t) blocks * sizeIncrement;
+	if (sz > INT32_MAX) {
+		sz = requiredSize;
+	}
+	return ((int) sz);
+}
+
+OpResult Buffer::resize (int allocateSize) {
+	uint8_t *block;
+	int blocksize;
+
+	if (isPooled && BufferPool::instance) {
+		block = BufferPool::instance->allocate (allocateSize, &blocksize);
+		if (! block) {
+			return (OpResult::OutOfMemoryError);
+		}
+		if (data) {
+			if (length > 0) {
+				memcpy (block, data, length);
+			}
+			BufferPool::instance->recycle (data, size);
+		}
+		data = block;
+		size = blocksize;
+		return (OpResult::Success);
+	}
+
+	block = (uint8_t *) realloc (data, allocateSize);
+	if (! block) {
+		return (OpResult::OutOfMemoryError);
+	}
+	data = block;
+	size = allocateSize;
+	return (OpResult::Success);
+}
+
+void Buffer::freeData () {
+	if (! data) {
+		return;
+	}
+	if (isPooled && BufferPool::instance) {
+		BufferPool::instance->recycle (data, size);
+	}
+	else {
+		free (data);
+	}
+	data = NULL;
+	size = 0;
+}
+
 bool Buffer::empty () const {
 	if ((! data) || (length <= 0) || (readPosition >= length)) {
 		return (true);
@@ -78,25 +148,16 @@ bool Buffer::empty () const {
 }
 
 OpResult Buffer::add (uint8_t *dataPtr, int dataLength) {
-	int sz, diff, blocks, sz2;
+	int sz;
 
 	if (dataLength <= 0) {
 		return (OpResult::Success);
 	}
 	sz = length + dataLength;
-	diff = sz - size;
-	if (diff > 0) {
-		blocks = (diff / sizeIncrement);
-		if (diff % sizeIncrement) {
-			++blocks;
-		}
-
-		sz2 = size + (blocks * sizeIncrement);
-		data = (uint8_t *) realloc (data, sz2);
-		if (! data) {
+	if (sz > size) {
+		if (resize (getGrowSize (sz)) != OpResult::Success) {
 			return (OpResult::OutOfMemoryError);
 		}
-		size = sz2;
 	}
 
 	memcpy (data + length, dataPtr, dataLength);
@@ -110,25 +171,16 @@ OpResult Buffer::add (const char *str) {
 }
 
 OpResult Buffer::expand (int expandSize) {
-	int sz, diff, blocks, sz2;
+	int sz;
 
 	if (expandSize <= 0) {
 		return (OpResult::Success);
 	}
 	sz = length + expandSize;
-	diff = sz - size;
-	if (diff > 0) {
-		blocks = (diff / sizeIncrement);
-		if (diff % sizeIncrement) {
-			++blocks;
-		}
-
-		sz2 = size + (blocks * sizeIncrement);
-		data = (uint8_t *) realloc (data, sz2);
-		if (! data) {
+	if (sz > size) {
+		if (resize (getGrowSize (sz)) != OpResult::Success) {
 			return (OpResult::OutOfMemoryError);
 		}
-		size = sz2;
 	}
 
 	memset (data + length, 0, expandSize);
@@ -185,11 +237,13 @@ OpResult Buffer::compact () {
 	if (readPosition > 0) {
 		memmove (data, data + readPosition, endlen);
 	}
-	data = (uint8_t *) realloc (data, sz);
-	if (! data) {
-		return (OpResult::OutOfMemoryError);
+	if (! isPooled) {
+		data = (uint8_t *) realloc (data, sz);
+		if (! data) {
+			return (OpResult::OutOfMemoryError);
+		}
+		size = sz;
 	}
-	size = sz;
 	readPosition = 0;
 	length = endlen;
 	readLength = endlen;
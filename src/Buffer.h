@@ -66,6 +66,12 @@ public:
 	// Increase the buffer's allocated length by expandSize bytes and return a Result value
 	OpResult expand (int expandSize);
 
+	// Allocate storage for at least capacity bytes of data without changing the buffer's length, and return a Result value
+	OpResult reserve (int capacity);
+
+	// Return the number of bytes the buffer can hold without allocating more storage
+	int getCapacity () const;
+
 	// Truncate the buffer's data length to the provided value, which must be less than the buffer's current length
 	void truncate (int dataLength);
 
@@ -95,7 +101,19 @@ public:
 	bool read (StdString *value);
 
 protected:
+	// Return the allocation size that should be used when growing the buffer to hold requiredSize bytes
+	int getGrowSize (int requiredSize) const;
+
+	// Change the buffer's allocated size to hold at least allocateSize bytes, preserving existing data, and return a Result value
+	OpResult resize (int allocateSize);
+
+	// Free the buffer's data block
+	void freeData ();
+
 	int size;
 	int sizeIncrement;
+
+	// True if data blocks should be obtained from and returned to BufferPool
+	bool isPooled;
 };
 #endif
@@ -0,0 +1,316 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#include "Log.h"
+#include "SdlUtil.h"
+#include "OsUtil.h"
+#include "BufferPool.h"
+
+BufferPool *BufferPool::instance = NULL;
+
+BufferPool::BufferPool ()
+: freeBytes (0)
+, lastTrimTime (0)
+{
+	std::vector<BufferPool::SizeClass>::iterator i1, i2;
+	BufferPool::SizeClass *sizeclass;
+	int64_t sz;
+	int count;
+
+	// Size classes step through each power of two and the midpoint above it: 64, 96, 128, 192, 256...
+	sz = BufferPool::minBlockSize;
+	while (sz <= BufferPool::maxBlockSize) {
+		sizeClasses.push_back (BufferPool::SizeClass ());
+		sizeClasses.back ().blockSize = (int) sz;
+		if (sz < BufferPool::maxBlockSize) {
+			sizeClasses.push_back (BufferPool::SizeClass ());
+			sizeClasses.back ().blockSize = (int) (sz + (sz / 2));
+		}
+		sz *= 2;
+	}
+	i1 = sizeClasses.begin ();
+	i2 = sizeClasses.end ();
+	while (i1 != i2) {
+		sizeclass = &(*i1);
+		count = (int) (BufferPool::maxFreeBytesPerSizeClass / sizeclass->blockSize);
+		if (count < 2) {
+			count = 2;
+		}
+		if (count > BufferPool::maxFreeBlockCount) {
+			count = BufferPool::maxFreeBlockCount;
+		}
+		sizeclass->maxFreeCount = count;
+		sizeclass->freeBlocks.reserve (count);
+		sizeclass->stats.blockSize = sizeclass->blockSize;
+		SdlUtil::createMutex (&(sizeclass->mutex));
+		++i1;
+	}
+}
+BufferPool::~BufferPool () {
+	std::vector<BufferPool::SizeClass>::iterator i1, i2;
+
+	clear ();
+	i1 = sizeClasses.begin ();
+	i2 = sizeClasses.end ();
+	while (i1 != i2) {
+		SdlUtil::destroyMutex (&(i1->mutex));
+		++i1;
+	}
+	sizeClasses.clear ();
+}
+
+void BufferPool::createInstance () {
+	if (! BufferPool::instance) {
+		BufferPool::instance = new BufferPool ();
+	}
+}
+void BufferPool::freeInstance () {
+	if (BufferPool::instance) {
+		delete (BufferPool::instance);
+		BufferPool::instance = NULL;
+	}
+}
+
+int BufferPool::getSizeClassIndex (int requestSize) const {
+	int i1, i2, mid;
+
+	if (requestSize > BufferPool::maxBlockSize) {
+		return (-1);
+	}
+	i1 = 0;
+	i2 = ((int) sizeClasses.size ()) - 1;
+	while (i1 < i2) {
+		mid = (i1 + i2) / 2;
+		if (sizeClasses.at (mid).blockSize < requestSize) {
+			i1 = mid + 1;
+		}
+		else {
+			i2 = mid;
+		}
+	}
+	return (i1);
+}
+
+int BufferPool::getBlockSize (int requestSize) const {
+	int index;
+
+	index = getSizeClassIndex (requestSize);
+	if (index < 0) {
+		return (requestSize);
+	}
+	return (sizeClasses.at (index).blockSize);
+}
+
+uint8_t *BufferPool::allocate (int requestSize, int *blockSize) {
+	BufferPool::SizeClass *sizeclass;
+	uint8_t *block;
+	int index;
+
+	if (requestSize <= 0) {
+		requestSize = 1;
+	}
+	index = getSizeClassIndex (requestSize);
+	if (index < 0) {
+		block = (uint8_t *) malloc (requestSize);
+		if (block && blockSize) {
+			*blockSize = requestSize;
+		}
+		return (block);
+	}
+
+	sizeclass = &(sizeClasses.at (index));
+	block = NULL;
+	SDL_LockMutex (sizeclass->mutex);
+	if (! sizeclass->freeBlocks.empty ()) {
+		block = sizeclass->freeBlocks.back ();
+		sizeclass->freeBlocks.pop_back ();
+		sizeclass->stats.freeCount = (int) sizeclass->freeBlocks.size ();
+		if (sizeclass->stats.freeCount < sizeclass->minFreeCount) {
+			sizeclass->minFreeCount = sizeclass->stats.freeCount;
+		}
+		freeBytes -= sizeclass->blockSize;
+	}
+	else {
+		++(sizeclass->stats.heapAllocateCount);
+	}
+	++(sizeclass->stats.allocateCount);
+	++(sizeclass->stats.inUseCount);
+	if (sizeclass->stats.inUseCount > sizeclass->stats.highWaterCount) {
+		sizeclass->stats.highWaterCount = sizeclass->stats.inUseCount;
+	}
+	SDL_UnlockMutex (sizeclass->mutex);
+
+	if (! block) {
+		block = (uint8_t *) malloc (sizeclass->blockSize);
+		if (! block) {
+			SDL_LockMutex (sizeclass->mutex);
+			--(sizeclass->stats.inUseCount);
+			SDL_UnlockMutex (sizeclass->mutex);
+			return (NULL);
+		}
+	}
+	if (blockSize) {
+		*blockSize = sizeclass->blockSize;
+	}
+	return (block);
+}
+
+void BufferPool::recycle (uint8_t *block, int blockSize) {
+	BufferPool::SizeClass *sizeclass;
+	int index;
+	bool isrecycled;
+
+	if (! block) {
+		return;
+	}
+	index = getSizeClassIndex (blockSize);
+	if ((index < 0) || (sizeClasses.at (index).blockSize != blockSize)) {
+		free (block);
+		return;
+	}
+
+	sizeclass = &(sizeClasses.at (index));
+	isrecycled = false;
+	SDL_LockMutex (sizeclass->mutex);
+	if (sizeclass->stats.inUseCount > 0) {
+		--(sizeclass->stats.inUseCount);
+	}
+	if ((((int) sizeclass->freeBlocks.size ()) < sizeclass->maxFreeCount) && ((freeBytes.load () + blockSize) <= BufferPool::maxFreeBytes)) {
+		sizeclass->freeBlocks.push_back (block);
+		sizeclass->stats.freeCount = (int) sizeclass->freeBlocks.size ();
+		freeBytes += blockSize;
+		isrecycled = true;
+	}
+	SDL_UnlockMutex (sizeclass->mutex);
+	if (! isrecycled) {
+		free (block);
+	}
+}
+
+void BufferPool::clear () {
+	std::vector<BufferPool::SizeClass>::iterator i1, i2;
+	std::vector<uint8_t *>::iterator j1, j2;
+
+	i1 = sizeClasses.begin ();
+	i2 = sizeClasses.end ();
+	while (i1 != i2) {
+		SDL_LockMutex (i1->mutex);
+		j1 = i1->freeBlocks.begin ();
+		j2 = i1->freeBlocks.end ();
+		while (j1 != j2) {
+			free (*j1);
+			++j1;
+		}
+		freeBytes -= ((int64_t) i1->blockSize) * ((int64_t) i1->freeBlocks.size ());
+		i1->freeBlocks.clear ();
+		i1->stats.freeCount = 0;
+		i1->minFreeCount = 0;
+		SDL_UnlockMutex (i1->mutex);
+		++i1;
+	}
+}
+
+void BufferPool::trim () {
+	std::vector<BufferPool::SizeClass>::iterator i1, i2;
+	std::vector<uint8_t *> blocks;
+	std::vector<uint8_t *>::iterator j1, j2;
+	int64_t now;
+	int count;
+
+	now = OsUtil::getTime ();
+	if (lastTrimTime <= 0) {
+		lastTrimTime = now;
+		return;
+	}
+	if ((now - lastTrimTime) < BufferPool::trimPeriod) {
+		return;
+	}
+	lastTrimTime = now;
+	i1 = sizeClasses.begin ();
+	i2 = sizeClasses.end ();
+	while (i1 != i2) {
+		SDL_LockMutex (i1->mutex);
+		// minFreeCount blocks sat in the free list for the whole period without being allocated
+		count = i1->minFreeCount;
+		if (count > (int) i1->freeBlocks.size ()) {
+			count = (int) i1->freeBlocks.size ();
+		}
+		if (count > 0) {
+			blocks.assign (i1->freeBlocks.begin (), i1->freeBlocks.begin () + count);
+			i1->freeBlocks.erase (i1->freeBlocks.begin (), i1->freeBlocks.begin () + count);
+			i1->stats.freeCount = (int) i1->freeBlocks.size ();
+			freeBytes -= ((int64_t) i1->blockSize) * ((int64_t) count);
+		}
+		i1->minFreeCount = (int) i1->freeBlocks.size ();
+		SDL_UnlockMutex (i1->mutex);
+
+		j1 = blocks.begin ();
+		j2 = blocks.end ();
+		while (j1 != j2) {
+			free (*j1);
+			++j1;
+		}
+		blocks.clear ();
+		++i1;
+	}
+}
+
+void BufferPool::getStats (std::vector<BufferPool::PoolStats> *destList) {
+	std::vector<BufferPool::SizeClass>::iterator i1, i2;
+
+	destList->clear ();
+	i1 = sizeClasses.begin ();
+	i2 = sizeClasses.end ();
+	while (i1 != i2) {
+		SDL_LockMutex (i1->mutex);
+		if (i1->stats.allocateCount > 0) {
+			destList->push_back (i1->stats);
+		}
+		SDL_UnlockMutex (i1->mutex);
+		++i1;
+	}
+}
+
+void BufferPool::logStats () {
+	std::vector<BufferPool::PoolStats> stats;
+	std::vector<BufferPool::PoolStats>::const_iterator i1, i2;
+
+	getStats (&stats);
+	i1 = stats.cbegin ();
+	i2 = stats.cend ();
+	while (i1 != i2) {
+		Log::debug ("Buffer pool stats; blockSize=%i highWater=%i inUse=%i free=%i allocateCount=%lli heapAllocateCount=%lli", i1->blockSize, i1->highWaterCount, i1->inUseCount, i1->freeCount, (long long int) i1->allocateCount, (long long int) i1->heapAllocateCount);
+		++i1;
+	}
+	Log::debug ("Buffer pool free bytes; freeBytes=%lli maxFreeBytes=%lli", (long long int) freeBytes.load (), (long long int) BufferPool::maxFreeBytes);
+}
@@ -0,0 +1,119 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Object that recycles memory blocks for Buffer data and other frequently allocated objects, using size classes with thread-safe free lists
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+
+class BufferPool {
+public:
+	BufferPool ();
+	~BufferPool ();
+	static BufferPool *instance;
+
+	// Initialize static instance data
+	static void createInstance ();
+
+	// Clear static instance data
+	static void freeInstance ();
+
+	static constexpr const int minBlockSize = 64;
+	static constexpr const int maxBlockSize = (32 * 1024 * 1024);
+	static constexpr const int maxFreeBlockCount = 256;
+	static constexpr const int64_t maxFreeBytesPerSizeClass = (48 * 1024 * 1024);
+	static constexpr const int64_t maxFreeBytes = (192 * 1024 * 1024);
+	static constexpr const int trimPeriod = 10000;
+
+	struct PoolStats {
+		int blockSize;
+		int inUseCount;
+		int freeCount;
+		int highWaterCount;
+		int64_t allocateCount;
+		int64_t heapAllocateCount;
+		PoolStats ():
+			blockSize (0),
+			inUseCount (0),
+			freeCount (0),
+			highWaterCount (0),
+			allocateCount (0),
+			heapAllocateCount (0) { }
+	};
+
+	// Return the size of the block that would be provided for an allocation of requestSize bytes
+	int getBlockSize (int requestSize) const;
+
+	// Return a memory block able to hold at least requestSize bytes, or NULL if the block could not be allocated. If blockSize is provided, store the block's usable size in that pointer. Blocks larger than maxBlockSize are allocated from the heap and not pooled.
+	uint8_t *allocate (int requestSize, int *blockSize = NULL);
+
+	// Return a memory block previously provided by allocate, using the blockSize value received from that call
+	void recycle (uint8_t *block, int blockSize);
+
+	// Release all free blocks held by the pool
+	void clear ();
+
+	// If trimPeriod milliseconds have elapsed since the last trim, release free blocks that stayed unused for that entire period. This method is intended to be invoked on each pass of an update loop.
+	void trim ();
+
+	// Store stats for each size class that has received allocations into the provided list
+	void getStats (std::vector<BufferPool::PoolStats> *destList);
+
+	// Write pool stats to the log
+	void logStats ();
+
+private:
+	struct SizeClass {
+		int blockSize;
+		int maxFreeCount;
+		int minFreeCount;
+		std::vector<uint8_t *> freeBlocks;
+		BufferPool::PoolStats stats;
+		SDL_mutex *mutex;
+		SizeClass ():
+			blockSize (0),
+			maxFreeCount (0),
+			minFreeCount (0),
+			mutex (NULL) { }
+	};
+
+	// Return the index of the size class that provides blocks for requestSize bytes, or -1 if no size class is large enough
+	int getSizeClassIndex (int requestSize) const;
+
+	std::vector<BufferPool::SizeClass> sizeClasses;
+	std::atomic<int64_t> freeBytes;
+	int64_t lastTrimTime;
+};
+#endif
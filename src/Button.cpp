@@ -67,6 +67,7 @@ Button::Button ()
 , promptLabel (NULL)
 , iconImage (NULL)
 , pressClock (0)
+, layerBodyType (-1)
 {
 	classId = ClassId::Button;
 	mouseEnterCallback = Widget::EventCallbackContext (Button::mouseEntered, this);
@@ -326,6 +327,11 @@ void Button::mouseReleased (void *itPtr, Widget *widgetPtr) {
 
 void Button::doUpdate (int msElapsed) {
 	Panel::doUpdate (msElapsed);
+	if ((bodyType != layerBodyType) || ((bodyType == GradientBody) && (! gradientColor.equals (layerGradientColor)))) {
+		layerBodyType = bodyType;
+		layerGradientColor.assign (gradientColor);
+		invalidateLayerContent ();
+	}
 	if (pressClock > 0) {
 		pressClock -= msElapsed;
 		if (pressClock <= 0) {
@@ -352,7 +358,7 @@ void Button::doUpdate (int msElapsed) {
 
 void Button::doDraw (double originX, double originY) {
 	SDL_Renderer *render;
-	SDL_Rect rect;
+	SDL_Rect rect, endrect, middlerect;
 	SDL_Texture *endtexture, *middletexture;
 	int x0, y0, endtexturew, endtextureh, middletexturew, middletextureh;
 
@@ -362,9 +368,9 @@ void Button::doDraw (double originX, double originY) {
 		y0 = (int) (originY + position.y);
 
 		middletexture = NULL;
-		endtexture = UiConfiguration::instance->buttonGradientEndSprite->getScaleTexture (height, &endtexturew, &endtextureh);
+		endtexture = UiConfiguration::instance->buttonGradientEndSprite->getScaleTexture (height, &endtexturew, &endtextureh, NULL, &endrect);
 		if (endtexture) {
-			middletexture = UiConfiguration::instance->buttonGradientMiddleSprite->getScaleTexture (height, &middletexturew, &middletextureh);
+			middletexture = UiConfiguration::instance->buttonGradientMiddleSprite->getScaleTexture (height, &middletexturew, &middletextureh, NULL, &middlerect);
 		}
 		if (endtexture && middletexture) {
 			rect.x = x0;
@@ -377,19 +383,19 @@ void Button::doDraw (double originX, double originY) {
 			rect.h = endtextureh;
 			SDL_SetTextureColorMod (endtexture, gradientColor.rByte, gradientColor.gByte, gradientColor.bByte);
 			SDL_SetTextureBlendMode (endtexture, SDL_BLENDMODE_BLEND);
-			SDL_RenderCopy (render, endtexture, NULL, &rect);
+			SDL_RenderCopy (render, endtexture, &endrect, &rect);
 
 			rect.x += endtexturew;
 			rect.w = middletexturew - endtexturew;
 			rect.h = middletextureh;
 			SDL_SetTextureColorMod (middletexture, gradientColor.rByte, gradientColor.gByte, gradientColor.bByte);
 			SDL_SetTextureBlendMode (middletexture, SDL_BLENDMODE_BLEND);
-			SDL_RenderCopy (render, middletexture, NULL, &rect);
+			SDL_RenderCopy (render, middletexture, &middlerect, &rect);
 
 			rect.x = x0 + (int) width - endtexturew;
 			rect.w = endtexturew;
 			rect.h = endtextureh;
-			SDL_RenderCopyEx (render, endtexture, NULL, &rect, 0.0f, NULL, SDL_FLIP_HORIZONTAL);
+			SDL_RenderCopyEx (render, endtexture, &endrect, &rect, 0.0f, NULL, SDL_FLIP_HORIZONTAL);
 
 			App::instance->popClipRect ();
 		}
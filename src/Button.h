@@ -139,5 +139,7 @@ protected:
 	Label *promptLabel;
 	Image *iconImage;
 	int pressClock;
+	int layerBodyType;
+	Color layerGradientColor;
 };
 #endif
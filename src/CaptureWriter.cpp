@@ -38,6 +38,7 @@
 #include "SharedBuffer.h"
 #include "TaskGroup.h"
 #include "RenderResource.h"
+#include "Resource.h"
 #include "UiText.h"
 #include "MediaWriter.h"
 #include "CaptureWriter.h"
@@ -45,17 +46,37 @@
 CaptureWriter *CaptureWriter::instance = NULL;
 
 CaptureWriter::CaptureWriter ()
-: imageWriteCount (0)
+: videoEncodeThreadCount (0)
+, videoScaleThreadCount (0)
+, isDuplicateFrameElisionEnabled (false)
+, imageWriteCount (0)
 , mediaWriter (NULL)
 , imageWriteData (NULL)
 , imageWriteWidth (0)
 , imageWriteHeight (0)
 , imageWritePitch (0)
-, isCapturingFrame (false)
+, isCaptureRequested (false)
 , isWritingImage (false)
+, captureTextureWidth (0)
+, captureTextureHeight (0)
+, captureDrawIndex (0)
+, captureReadIndex (-1)
+, isDrawingCapture (false)
+, captureBufferIndex (0)
+, totalLatency (0)
+, totalReadTime (0)
 {
+	int i;
+
 	SdlUtil::createMutex (&baseWritePathMutex);
 	SdlUtil::createMutex (&captureMutex);
+	for (i = 0; i < CaptureWriter::captureTextureCount; ++i) {
+		captureTextures[i] = NULL;
+		captureFrameTimes[i] = 0;
+	}
+	for (i = 0; i < CaptureWriter::captureBufferCount; ++i) {
+		captureBuffers[i] = NULL;
+	}
 }
 CaptureWriter::~CaptureWriter () {
 	SdlUtil::destroyMutex (&baseWritePathMutex);
@@ -69,6 +90,7 @@ CaptureWriter::~CaptureWriter () {
 		imageWriteData = NULL;
 	}
 	SDL_UnlockMutex (captureMutex);
+	clearCapture ();
 	SdlUtil::destroyMutex (&captureMutex);
 }
 
@@ -136,6 +158,7 @@ void CaptureWriter::startMediaWriter (const StdString &writePath) {
 void CaptureWriter::stopMediaWriter () {
 	SDL_LockMutex (captureMutex);
 	if (mediaWriter) {
+		Log::debug ("Stop media capture; path=\"%s\" frames=%lli drops=%lli averageLatency=%llims maxLatency=%llims averageReadTime=%llius maxReadTime=%llius", mediaWriter->writePath.c_str (), (long long int) stats.frameCount, (long long int) stats.dropCount, (long long int) stats.averageLatency, (long long int) stats.maxLatency, (long long int) stats.averageReadTime, (long long int) stats.maxReadTime);
 		mediaWriter->stop ();
 		mediaWriter->release ();
 		mediaWriter = NULL;
@@ -148,9 +171,9 @@ void CaptureWriter::toggleMediaWriter (const StdString &writePath) {
 
 	SDL_LockMutex (captureMutex);
 	if (mediaWriter) {
-		mediaWriter->stop ();
-		mediaWriter->release ();
-		mediaWriter = NULL;
+		SDL_UnlockMutex (captureMutex);
+		stopMediaWriter ();
+		return;
 	}
 	else {
 		if (writePath.empty ()) {
@@ -201,17 +224,22 @@ void CaptureWriter::update (int msElapsed) {
 			}
 		}
 	}
-	if (! isCapturingFrame) {
+	if (! isCaptureRequested) {
 		if (! nextMediaWriterPath.empty ()) {
 			if (mediaWriter) {
 				mediaWriter->stop ();
 				mediaWriter->release ();
 			}
+			resetStats ();
 			mediaWriter = new MediaWriter ();
 			mediaWriter->retain ();
 			mediaWriter->videoWidth = App::instance->windowWidth;
 			mediaWriter->videoHeight = App::instance->windowHeight;
 			mediaWriter->videoExpectedFrameRate = 1000.0f / (double) (App::instance->minUpdateFrameDelay * 2);
+			mediaWriter->videoEncodePreset.assign (videoEncodePreset);
+			mediaWriter->videoEncodeThreadCount = videoEncodeThreadCount;
+			mediaWriter->videoScaleThreadCount = videoScaleThreadCount;
+			mediaWriter->isDuplicateFrameElisionEnabled = isDuplicateFrameElisionEnabled;
 			mediaWriter->start (nextMediaWriterPath);
 			if (mediaWriter->isWriteFailed) {
 				Log::debug ("Failed to start stream publish; err=%s", mediaWriter->lastErrorMessage.c_str ());
@@ -224,6 +252,9 @@ void CaptureWriter::update (int msElapsed) {
 		else if ((! imageWritePaths.empty ()) && (! imageWriteData)) {
 			shouldcapture = true;
 		}
+		if (shouldcapture) {
+			isCaptureRequested = true;
+		}
 	}
 	SDL_UnlockMutex (captureMutex);
 
@@ -231,67 +262,214 @@ void CaptureWriter::update (int msElapsed) {
 		isWritingImage = true;
 		TaskGroup::instance->run (TaskGroup::RunContext (CaptureWriter::writeImage, this));
 	}
-	if (shouldcapture) {
-		isCapturingFrame = true;
-		App::instance->addPostdrawTask (CaptureWriter::captureRenderFrame, this);
+}
+
+void CaptureWriter::beginDrawFrame () {
+	bool isactive, shouldcapture;
+
+	isDrawingCapture = false;
+	SDL_LockMutex (captureMutex);
+	isactive = (mediaWriter && mediaWriter->isWriting) || (! imageWritePaths.empty ());
+	shouldcapture = isCaptureRequested && isactive;
+	isCaptureRequested = false;
+	SDL_UnlockMutex (captureMutex);
+	if (! shouldcapture) {
+		if ((! isactive) && (captureReadIndex < 0) && captureTextures[0]) {
+			clearCapture ();
+		}
+		return;
+	}
+	if (! resetCaptureTextures ()) {
+		return;
 	}
+	if (captureDrawIndex == captureReadIndex) {
+		captureDrawIndex = (captureDrawIndex + 1) % CaptureWriter::captureTextureCount;
+	}
+	if (SDL_SetRenderTarget (App::instance->render, captureTextures[captureDrawIndex]) != 0) {
+		Log::debug ("Failed to set capture render target; err=%s", SDL_GetError ());
+		return;
+	}
+	captureFrameTimes[captureDrawIndex] = OsUtil::getTime ();
+	isDrawingCapture = true;
 }
 
-void CaptureWriter::captureRenderFrame (void *itPtr) {
-	CaptureWriter *it = (CaptureWriter *) itPtr;
+void CaptureWriter::endDrawFrame () {
+	if (captureReadIndex >= 0) {
+		readCaptureTexture ();
+	}
+	if (! isDrawingCapture) {
+		return;
+	}
+	isDrawingCapture = false;
+	SDL_SetRenderTarget (App::instance->render, NULL);
+	SDL_RenderCopy (App::instance->render, captureTextures[captureDrawIndex], NULL, NULL);
+	captureReadIndex = captureDrawIndex;
+	captureDrawIndex = (captureDrawIndex + 1) % CaptureWriter::captureTextureCount;
+}
+
+bool CaptureWriter::resetCaptureTextures () {
+	int i, w, h;
+
+	w = App::instance->windowWidth;
+	h = App::instance->windowHeight;
+	if (captureTextures[0] && ((captureTextureWidth != w) || (captureTextureHeight != h))) {
+		clearCapture ();
+	}
+	if (captureTextures[0]) {
+		return (true);
+	}
+	for (i = 0; i < CaptureWriter::captureTextureCount; ++i) {
+		captureTexturePaths[i].sprintf ("*_CaptureWriter_%i_%llx", i, (long long int) App::instance->getUniqueId ());
+		captureTextures[i] = Resource::instance->createTexture (captureTexturePaths[i], w, h, false, Resource::CaptureTextureCategory);
+		if (! captureTextures[i]) {
+			Log::debug ("Failed to create capture texture; width=%i height=%i", w, h);
+			clearCapture ();
+			return (false);
+		}
+		SDL_SetTextureBlendMode (captureTextures[i], SDL_BLENDMODE_NONE);
+	}
+	captureTextureWidth = w;
+	captureTextureHeight = h;
+	captureDrawIndex = 0;
+	captureReadIndex = -1;
+	return (true);
+}
 
-	it->executeCaptureRenderFrame ();
-	it->isCapturingFrame = false;
+void CaptureWriter::clearCapture () {
+	int i;
+
+	for (i = 0; i < CaptureWriter::captureTextureCount; ++i) {
+		if (captureTextures[i]) {
+			Resource::instance->unloadTexture (captureTexturePaths[i]);
+			captureTextures[i] = NULL;
+			captureTexturePaths[i].assign ("");
+		}
+	}
+	for (i = 0; i < CaptureWriter::captureBufferCount; ++i) {
+		if (captureBuffers[i]) {
+			captureBuffers[i]->release ();
+			captureBuffers[i] = NULL;
+		}
+	}
+	captureTextureWidth = 0;
+	captureTextureHeight = 0;
+	captureDrawIndex = 0;
+	captureReadIndex = -1;
+	captureBufferIndex = 0;
 }
-void CaptureWriter::executeCaptureRenderFrame () {
-	bool shouldcapture;
-	int result, w, h, pitch, datasize;
-	int64_t t;
+
+SharedBuffer *CaptureWriter::getCaptureBuffer (int dataSize) {
 	SharedBuffer *b;
+	int i, index;
 
-	shouldcapture = false;
-	SDL_LockMutex (captureMutex);
-	if ((mediaWriter && mediaWriter->isWriting) || (! imageWritePaths.empty ())) {
-		shouldcapture = true;
+	for (i = 0; i < CaptureWriter::captureBufferCount; ++i) {
+		index = (captureBufferIndex + i) % CaptureWriter::captureBufferCount;
+		b = captureBuffers[index];
+		if (! b) {
+			b = new SharedBuffer ();
+			b->retain ();
+			if (b->expand (dataSize) != OpResult::Success) {
+				b->release ();
+				return (NULL);
+			}
+			captureBuffers[index] = b;
+		}
+		else if (b->getRefcount () > 1) {
+			// The media writer or image write operation still holds this buffer
+			continue;
+		}
+		captureBufferIndex = (index + 1) % CaptureWriter::captureBufferCount;
+		b->retain ();
+		return (b);
 	}
+	return (NULL);
+}
+
+void CaptureWriter::readCaptureTexture () {
+	SharedBuffer *b;
+	SDL_Texture *target;
+	int result, w, h, pitch;
+	int64_t t, frametime, latency, readtime;
+	bool isactive;
+
+	SDL_LockMutex (captureMutex);
+	isactive = (mediaWriter && mediaWriter->isWriting) || (! imageWritePaths.empty ());
 	SDL_UnlockMutex (captureMutex);
-	if (! shouldcapture) {
+	if (! isactive) {
+		captureReadIndex = -1;
 		return;
 	}
-	w = App::instance->windowWidth;
-	h = App::instance->windowHeight;
+	frametime = captureFrameTimes[captureReadIndex];
+	w = captureTextureWidth;
+	h = captureTextureHeight;
 	pitch = w * sizeof (Uint32);
-	datasize = w * h * sizeof (Uint32);
-	b = new SharedBuffer ();
-	b->retain ();
-	if (b->expand (datasize) != OpResult::Success) {
-		Log::debug ("Failed to capture render frame, out of memory");
-		b->release ();
+	b = getCaptureBuffer (w * h * sizeof (Uint32));
+	if (! b) {
+		SDL_LockMutex (captureMutex);
+		++(stats.dropCount);
+		SDL_UnlockMutex (captureMutex);
+		captureReadIndex = -1;
 		return;
 	}
 
-	t = OsUtil::getTime ();
+	t = OsUtil::getHrtime ();
+	target = SDL_GetRenderTarget (App::instance->render);
+	SDL_SetRenderTarget (App::instance->render, captureTextures[captureReadIndex]);
 	result = SDL_RenderReadPixels (App::instance->render, NULL, SDL_PIXELFORMAT_RGBA32, b->data, pitch);
-	if (result == 0) {
-		SDL_LockMutex (captureMutex);
-		if (mediaWriter && mediaWriter->isWriting) {
-			mediaWriter->writeVideoFrame (b, t, pitch, w, h);
-		}
-		if (! imageWritePaths.empty ()) {
-			if (imageWriteData) {
-				imageWriteData->release ();
-			}
-			imageWriteData = b;
-			imageWriteData->retain ();
-			imageWriteWidth = w;
-			imageWriteHeight = h;
-			imageWritePitch = pitch;
+	SDL_SetRenderTarget (App::instance->render, target);
+	readtime = (OsUtil::getHrtime () - t) / 10;
+	captureReadIndex = -1;
+	if (result != 0) {
+		Log::debug ("Failed to capture render frame, SDL_RenderReadPixels; err=%s", SDL_GetError ());
+		b->release ();
+		return;
+	}
+
+	SDL_LockMutex (captureMutex);
+	if (mediaWriter && mediaWriter->isWriting) {
+		mediaWriter->writeVideoFrame (b, frametime, pitch, w, h);
+	}
+	if (! imageWritePaths.empty ()) {
+		if (imageWriteData) {
+			imageWriteData->release ();
 		}
-		SDL_UnlockMutex (captureMutex);
+		imageWriteData = b;
+		imageWriteData->retain ();
+		imageWriteWidth = w;
+		imageWriteHeight = h;
+		imageWritePitch = pitch;
 	}
+	latency = OsUtil::getTime () - frametime;
+	++(stats.frameCount);
+	totalLatency += latency;
+	totalReadTime += readtime;
+	stats.averageLatency = totalLatency / stats.frameCount;
+	stats.averageReadTime = totalReadTime / stats.frameCount;
+	if (latency > stats.maxLatency) {
+		stats.maxLatency = latency;
+	}
+	if (readtime > stats.maxReadTime) {
+		stats.maxReadTime = readtime;
+	}
+	SDL_UnlockMutex (captureMutex);
 	b->release ();
 }
 
+CaptureWriter::CaptureStats CaptureWriter::getStats () {
+	CaptureWriter::CaptureStats result;
+
+	SDL_LockMutex (captureMutex);
+	result = stats;
+	SDL_UnlockMutex (captureMutex);
+	return (result);
+}
+
+void CaptureWriter::resetStats () {
+	stats = CaptureWriter::CaptureStats ();
+	totalLatency = 0;
+	totalReadTime = 0;
+}
+
 void CaptureWriter::writeImage (void *itPtr) {
 	CaptureWriter *it = (CaptureWriter *) itPtr;
 
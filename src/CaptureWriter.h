@@ -51,6 +51,30 @@ public:
 
 	static constexpr const char *imageWriteFormat = "png";
 	static constexpr const char *mediaWriteFormat = "mp4";
+	static constexpr const int captureBufferCount = 5; // One buffer may be held by the media writer as its duplicate frame reference
+	static constexpr const int captureTextureCount = 2;
+
+	struct CaptureStats {
+		int64_t frameCount;
+		int64_t dropCount;
+		int64_t averageLatency; // milliseconds
+		int64_t maxLatency; // milliseconds
+		int64_t averageReadTime; // microseconds
+		int64_t maxReadTime; // microseconds
+		CaptureStats ():
+			frameCount (0),
+			dropCount (0),
+			averageLatency (0),
+			maxLatency (0),
+			averageReadTime (0),
+			maxReadTime (0) { }
+	};
+
+	// Read-write data members
+	StdString videoEncodePreset;
+	int videoEncodeThreadCount; // Zero to select a thread count automatically
+	int videoScaleThreadCount; // Zero to select a thread count automatically
+	bool isDuplicateFrameElisionEnabled;
 
 	// Read-only data members
 	int imageWriteCount;
@@ -79,13 +103,35 @@ public:
 	// Execute operations to update state as appropriate for an elapsed millisecond time period
 	void update (int msElapsed);
 
+	// Execute operations appropriate before drawing a render frame. If a capture is pending, this method redirects drawing to a capture texture. Must be invoked from the render thread.
+	void beginDrawFrame ();
+
+	// Execute operations appropriate after drawing a render frame, copying any capture texture to the window and reading back pixels from the previously drawn capture texture. Must be invoked from the render thread.
+	void endDrawFrame ();
+
+	// Return a CaptureStats struct with frame, drop, and latency values for the current capture session
+	CaptureWriter::CaptureStats getStats ();
+
 private:
 	// Task functions
-	static void captureRenderFrame (void *itPtr);
-	void executeCaptureRenderFrame ();
 	static void writeImage (void *itPtr);
 	void executeWriteImage ();
 
+	// Create capture textures sized for the window if needed, replacing any textures of a different size. Returns a boolean value indicating if the textures are available.
+	bool resetCaptureTextures ();
+
+	// Release capture textures and buffers
+	void clearCapture ();
+
+	// Return a retained buffer from the capture ring that is not held by a consumer, or NULL if all buffers are in use
+	SharedBuffer *getCaptureBuffer (int dataSize);
+
+	// Read pixels from the capture texture drawn in a previous frame and pass them to the media writer and image write operation
+	void readCaptureTexture ();
+
+	// Reset capture stats values to begin a new capture session
+	void resetStats ();
+
 	StdString baseWritePath;
 	SDL_mutex *baseWritePathMutex;
 	SDL_mutex *captureMutex;
@@ -96,7 +142,20 @@ private:
 	int imageWriteWidth;
 	int imageWriteHeight;
 	int imageWritePitch;
-	bool isCapturingFrame;
+	bool isCaptureRequested;
 	bool isWritingImage;
+	SDL_Texture *captureTextures[CaptureWriter::captureTextureCount];
+	StdString captureTexturePaths[CaptureWriter::captureTextureCount];
+	int captureTextureWidth;
+	int captureTextureHeight;
+	int captureDrawIndex;
+	int captureReadIndex;
+	int64_t captureFrameTimes[CaptureWriter::captureTextureCount];
+	bool isDrawingCapture;
+	SharedBuffer *captureBuffers[CaptureWriter::captureBufferCount];
+	int captureBufferIndex;
+	CaptureWriter::CaptureStats stats;
+	int64_t totalLatency;
+	int64_t totalReadTime;
 };
 #endif
@@ -90,6 +90,7 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <set>
 #include <queue>
 #include <stack>
 #include "SDL2/SDL.h"
@@ -0,0 +1,323 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#if PLATFORM_LINUX || PLATFORM_MACOS
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#endif
+#if PLATFORM_WINDOWS
+#include <windows.h>
+#endif
+#include <sys/stat.h>
+#include <errno.h>
+#include "SdlUtil.h"
+#include "OsUtil.h"
+#include "StringList.h"
+#include "FileWalker.h"
+
+static bool compareEntryPaths (const FileWalker::Entry &a, const FileWalker::Entry &b) {
+	return (a.path < b.path);
+}
+
+FileWalker::FileWalker ()
+: maxThreadCount (FileWalker::defaultMaxThreadCount)
+, fileMatchFn (NULL)
+, fileMatchData (NULL)
+, cancelFlag (NULL)
+, directoryCount (0)
+, fileCount (0)
+, errorCount (0)
+, activeWorkerCount (0)
+{
+	SdlUtil::createMutex (&walkMutex);
+	SdlUtil::createCond (&walkCond);
+}
+FileWalker::~FileWalker () {
+	SdlUtil::destroyCond (&walkCond);
+	SdlUtil::destroyMutex (&walkMutex);
+}
+
+bool FileWalker::isCancelled () const {
+	return (cancelFlag && *cancelFlag);
+}
+
+OpResult FileWalker::walk (const StringList &rootPaths, std::list<FileWalker::Entry> *destList) {
+	std::list<SDL_Thread *> threads;
+	std::list<SDL_Thread *>::const_iterator i1, i2;
+	SDL_Thread *thread;
+	int i, count, result;
+
+	destList->clear ();
+	SDL_LockMutex (walkMutex);
+	directoryQueue.assign (rootPaths);
+	entryList.clear ();
+	visitedDirectories.clear ();
+	activeWorkerCount = 0;
+	directoryCount = 0;
+	fileCount = 0;
+	errorCount = 0;
+	errorPaths.clear ();
+	SDL_UnlockMutex (walkMutex);
+
+	count = maxThreadCount;
+	if (count < 1) {
+		count = 1;
+	}
+	for (i = 0; i < count; ++i) {
+		thread = SDL_CreateThread (FileWalker::runWorker, StdString::createSprintf ("FileWalker::runWorker %i", i).c_str (), (void *) this);
+		if (! thread) {
+			break;
+		}
+		threads.push_back (thread);
+	}
+	if (threads.empty ()) {
+		executeWorker ();
+	}
+	i1 = threads.cbegin ();
+	i2 = threads.cend ();
+	while (i1 != i2) {
+		SDL_WaitThread (*i1, &result);
+		++i1;
+	}
+
+	SDL_LockMutex (walkMutex);
+	destList->swap (entryList);
+	directoryQueue.clear ();
+	visitedDirectories.clear ();
+	SDL_UnlockMutex (walkMutex);
+	destList->sort (compareEntryPaths);
+	return (OpResult::Success);
+}
+
+bool FileWalker::readEntry (const StdString &path, FileWalker::Entry *destEntry) {
+	int64_t mtime, size;
+
+	mtime = OsUtil::getFileMtime (path);
+	if (mtime < 0) {
+		return (false);
+	}
+	size = OsUtil::getFileSize (path);
+	if (size < 0) {
+		return (false);
+	}
+	destEntry->path.assign (path);
+	destEntry->mtime = mtime;
+	destEntry->size = size;
+	destEntry->fingerprint.assign ("");
+	return (true);
+}
+
+int FileWalker::runWorker (void *itPtr) {
+	((FileWalker *) itPtr)->executeWorker ();
+	return (0);
+}
+void FileWalker::executeWorker () {
+	std::list<FileWalker::Entry> entries;
+	StringList subdirs, errorpaths;
+	StdString path;
+
+	SDL_LockMutex (walkMutex);
+	while (true) {
+		while (directoryQueue.empty () && (activeWorkerCount > 0) && (! isCancelled ())) {
+			SDL_CondWait (walkCond, walkMutex);
+		}
+		if (directoryQueue.empty () || isCancelled ()) {
+			break;
+		}
+		path = directoryQueue.front ();
+		directoryQueue.pop_front ();
+		++activeWorkerCount;
+		SDL_UnlockMutex (walkMutex);
+
+		readDirectory (path, &entries, &subdirs, &errorpaths);
+
+		SDL_LockMutex (walkMutex);
+		entryList.splice (entryList.end (), entries);
+		directoryQueue.splice (directoryQueue.end (), subdirs);
+		errorPaths.splice (errorPaths.end (), errorpaths);
+		--activeWorkerCount;
+		SDL_CondBroadcast (walkCond);
+	}
+	SDL_CondBroadcast (walkCond);
+	SDL_UnlockMutex (walkMutex);
+}
+
+void FileWalker::readDirectory (const StdString &path, std::list<FileWalker::Entry> *destList, StringList *subdirList, StringList *errorPathList) {
+#if PLATFORM_LINUX || PLATFORM_MACOS
+	DIR *dir;
+	struct dirent *ent;
+	struct stat st;
+	StdString name;
+	int fd, files, errors;
+	bool isdir, isfile, visited;
+
+	fd = open (path.c_str (), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0) {
+		SDL_LockMutex (walkMutex);
+		++errorCount;
+		SDL_UnlockMutex (walkMutex);
+		return;
+	}
+	if (fstat (fd, &st) != 0) {
+		close (fd);
+		SDL_LockMutex (walkMutex);
+		++errorCount;
+		SDL_UnlockMutex (walkMutex);
+		return;
+	}
+	SDL_LockMutex (walkMutex);
+	visited = ! visitedDirectories.insert (std::pair<int64_t, int64_t> ((int64_t) st.st_dev, (int64_t) st.st_ino)).second;
+	if (! visited) {
+		++directoryCount;
+	}
+	SDL_UnlockMutex (walkMutex);
+	if (visited) {
+		close (fd);
+		return;
+	}
+	dir = fdopendir (fd);
+	if (! dir) {
+		close (fd);
+		SDL_LockMutex (walkMutex);
+		++errorCount;
+		SDL_UnlockMutex (walkMutex);
+		return;
+	}
+
+	files = 0;
+	errors = 0;
+	while (! isCancelled ()) {
+		ent = readdir (dir);
+		if (! ent) {
+			break;
+		}
+		if ((ent->d_name[0] == '.') && ((ent->d_name[1] == '\0') || ((ent->d_name[1] == '.') && (ent->d_name[2] == '\0')))) {
+			continue;
+		}
+		name.assign (ent->d_name);
+		isdir = false;
+		isfile = false;
+		if (ent->d_type == DT_DIR) {
+			isdir = true;
+		}
+		else if ((ent->d_type == DT_REG) || (ent->d_type == DT_LNK) || (ent->d_type == DT_UNKNOWN)) {
+			if ((ent->d_type == DT_REG) && fileMatchFn && (! fileMatchFn (fileMatchData, name))) {
+				continue;
+			}
+			if (fstatat (fd, ent->d_name, &st, 0) != 0) {
+				if ((errno == ENOENT) || (errno == ELOOP)) {
+					// Broken symlink, or an entry removed after readdir
+					continue;
+				}
+				if (fileMatchFn && (ent->d_type != DT_REG) && (! fileMatchFn (fileMatchData, name))) {
+					continue;
+				}
+				errorPathList->push_back (OsUtil::getJoinedPath (path, name));
+				++errors;
+				continue;
+			}
+			if (S_ISDIR (st.st_mode)) {
+				isdir = true;
+			}
+			else if (S_ISREG (st.st_mode)) {
+				isfile = true;
+			}
+		}
+		if (isdir) {
+			subdirList->push_back (OsUtil::getJoinedPath (path, name));
+		}
+		else if (isfile) {
+			if (fileMatchFn && (ent->d_type != DT_REG) && (! fileMatchFn (fileMatchData, name))) {
+				continue;
+			}
+			destList->push_back (FileWalker::Entry (OsUtil::getJoinedPath (path, name), (int64_t) (st.st_mtime * 1000), (int64_t) st.st_size));
+			++files;
+		}
+	}
+	closedir (dir);
+#endif
+#if PLATFORM_WINDOWS
+	HANDLE h;
+	WIN32_FIND_DATA f;
+	StdString name, pattern;
+	int64_t mtime, size;
+	int files, errors;
+
+	pattern.assign (path);
+	pattern.append ("\\*");
+	h = FindFirstFile (pattern.c_str (), &f);
+	if (h == INVALID_HANDLE_VALUE) {
+		if (GetLastError () != ERROR_FILE_NOT_FOUND) {
+			SDL_LockMutex (walkMutex);
+			++errorCount;
+			SDL_UnlockMutex (walkMutex);
+		}
+		return;
+	}
+	SDL_LockMutex (walkMutex);
+	++directoryCount;
+	SDL_UnlockMutex (walkMutex);
+	files = 0;
+	errors = 0;
+	while (! isCancelled ()) {
+		name.assign (f.cFileName);
+		if ((! name.equals (".")) && (! name.equals ("..")) && (!(f.dwFileAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_REPARSE_POINT)))) {
+			if (f.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				subdirList->push_back (OsUtil::getJoinedPath (path, name));
+			}
+			else if ((! fileMatchFn) || fileMatchFn (fileMatchData, name)) {
+				mtime = f.ftLastWriteTime.dwHighDateTime;
+				mtime <<= 32;
+				mtime |= f.ftLastWriteTime.dwLowDateTime;
+				mtime /= 10000;
+				mtime -= 11644473600000ULL;
+				size = f.nFileSizeHigh;
+				size <<= 32;
+				size |= f.nFileSizeLow;
+				destList->push_back (FileWalker::Entry (OsUtil::getJoinedPath (path, name), mtime, size));
+				++files;
+			}
+		}
+		if (! FindNextFile (h, &f)) {
+			break;
+		}
+	}
+	FindClose (h);
+#endif
+	SDL_LockMutex (walkMutex);
+	fileCount += files;
+	errorCount += errors;
+	SDL_UnlockMutex (walkMutex);
+}
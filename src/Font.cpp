@@ -155,7 +155,7 @@ OpResult Font::load (Buffer *fontData, int pointSize) {
 			continue;
 		}
 		glyph.texturePath.sprintf ("*_Font_%s_%i_%i", name.c_str (), pointSize, (int) c);
-		glyph.texture = Resource::instance->createTexture (glyph.texturePath, surface);
+		glyph.texture = Resource::instance->createTexture (glyph.texturePath, surface, Resource::FontTextureCategory);
 		SDL_FreeSurface (surface);
 		free (pixels);
 		if (! glyph.texture) {
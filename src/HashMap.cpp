@@ -211,21 +211,25 @@ OpResult HashMap::readLine (void *itPtr, const StdString &line) {
 }
 
 OpResult HashMap::write (const StdString &filename) {
+	return (OsUtil::writeFileReplace (filename, createWriteBuffer ()));
+}
+
+Buffer *HashMap::createWriteBuffer () {
 	std::map<StdString, StdString>::const_iterator i1, i2;
-	StdString out;
+	Buffer *buffer;
 
 	isWriteDirty = false;
-	out.assign ("");
+	buffer = new Buffer ();
 	i1 = valueMap.cbegin ();
 	i2 = valueMap.cend ();
 	while (i1 != i2) {
-		out.append (i1->first);
-		out.append (" ");
-		out.append (i1->second);
-		out.append ("\n");
+		buffer->add ((uint8_t *) i1->first.c_str (), (int) i1->first.length ());
+		buffer->add (" ");
+		buffer->add ((uint8_t *) i1->second.c_str (), (int) i1->second.length ());
+		buffer->add ("\n");
 		++i1;
 	}
-	return (OsUtil::writeFile (filename, out.createBuffer ()));
+	return (buffer);
 }
 
 bool HashMap::exists (const StdString &key) const {
@@ -36,6 +36,7 @@
 
 #include "StringList.h"
 
+class Buffer;
 class Json;
 class JsonList;
 
@@ -77,9 +78,12 @@ public:
 	// Read values from configuration file data and store the resulting items in the map, optionally clearing the map before doing so. Returns a Result value.
 	OpResult read (const StdString &filename, bool shouldClear = false);
 
-	// Write values from the map to the specified file. Returns a Result value.
+	// Write values from the map to the specified file, replacing any previous file contents in a single operation. Returns a Result value.
 	OpResult write (const StdString &filename);
 
+	// Return a newly created Buffer object containing map values in configuration file format, as written by the write method, and clear the map's isWriteDirty flag
+	Buffer *createWriteBuffer ();
+
 	// Set the sort function that should be used to order items in generated map traversals
 	void sort (HashMap::SortFunction fn);
 
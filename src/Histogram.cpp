@@ -0,0 +1,173 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#include "Json.h"
+#include "Histogram.h"
+
+Histogram::Histogram ()
+: count (0)
+, sum (0)
+, min (0)
+, max (0)
+{
+	memset (buckets, 0, sizeof (buckets));
+}
+Histogram::~Histogram () {
+}
+
+void Histogram::reset () {
+	count = 0;
+	sum = 0;
+	min = 0;
+	max = 0;
+	memset (buckets, 0, sizeof (buckets));
+}
+
+int Histogram::getBucketIndex (int64_t value) {
+	int i;
+
+	// Bucket 0 holds the value zero and bucket n holds values in the range [2^(n-1), 2^n)
+	i = 0;
+	while ((value > 0) && (i < (Histogram::bucketCount - 1))) {
+		value >>= 1;
+		++i;
+	}
+	return (i);
+}
+
+void Histogram::add (int64_t value) {
+	if (value < 0) {
+		value = 0;
+	}
+	if ((count <= 0) || (value < min)) {
+		min = value;
+	}
+	if ((count <= 0) || (value > max)) {
+		max = value;
+	}
+	++count;
+	sum += value;
+	++(buckets[Histogram::getBucketIndex (value)]);
+}
+
+void Histogram::merge (const Histogram &otherHistogram) {
+	int i;
+
+	if (otherHistogram.count <= 0) {
+		return;
+	}
+	if ((count <= 0) || (otherHistogram.min < min)) {
+		min = otherHistogram.min;
+	}
+	if ((count <= 0) || (otherHistogram.max > max)) {
+		max = otherHistogram.max;
+	}
+	count += otherHistogram.count;
+	sum += otherHistogram.sum;
+	for (i = 0; i < Histogram::bucketCount; ++i) {
+		buckets[i] += otherHistogram.buckets[i];
+	}
+}
+
+double Histogram::getMean () const {
+	if (count <= 0) {
+		return (0.0f);
+	}
+	return ((double) sum / (double) count);
+}
+
+int64_t Histogram::getPercentile (double percentile) const {
+	int64_t target, n, lo, hi, result;
+	int i;
+
+	if (count <= 0) {
+		return (0);
+	}
+	if (percentile <= 0.0f) {
+		return (min);
+	}
+	if (percentile >= 100.0f) {
+		return (max);
+	}
+	target = (int64_t) ceil (percentile / 100.0f * (double) count);
+	if (target < 1) {
+		target = 1;
+	}
+	n = 0;
+	for (i = 0; i < Histogram::bucketCount; ++i) {
+		if ((n + buckets[i]) >= target) {
+			break;
+		}
+		n += buckets[i];
+	}
+	if (i >= Histogram::bucketCount) {
+		return (max);
+	}
+	if (i == 0) {
+		return (0);
+	}
+
+	// Interpolate linearly within the bucket range, clamped to the observed min and max values
+	lo = ((int64_t) 1) << (i - 1);
+	hi = (lo << 1) - 1;
+	if (lo < min) {
+		lo = min;
+	}
+	if (hi > max) {
+		hi = max;
+	}
+	result = lo;
+	if ((hi > lo) && (buckets[i] > 1)) {
+		result += (hi - lo) * (target - n - 1) / (buckets[i] - 1);
+	}
+	return (result);
+}
+
+StdString Histogram::toString () const {
+	return (StdString::createSprintf ("count=%lli mean=%.1f min=%lli p50=%lli p95=%lli p99=%lli max=%lli", (long long int) count, getMean (), (long long int) min, (long long int) getPercentile (50.0f), (long long int) getPercentile (95.0f), (long long int) getPercentile (99.0f), (long long int) max));
+}
+
+Json *Histogram::createJson () const {
+	Json *json;
+
+	json = new Json ();
+	json->set ("count", count);
+	json->set ("mean", getMean ());
+	json->set ("min", min);
+	json->set ("p50", getPercentile (50.0f));
+	json->set ("p90", getPercentile (90.0f));
+	json->set ("p95", getPercentile (95.0f));
+	json->set ("p99", getPercentile (99.0f));
+	json->set ("max", max);
+	return (json);
+}
@@ -0,0 +1,82 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Object that accumulates a distribution of int64_t sample values in logarithmic buckets
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include "StdString.h"
+
+class Json;
+
+class Histogram {
+public:
+	Histogram ();
+	~Histogram ();
+
+	static constexpr const int bucketCount = 40;
+
+	// Read-only data members
+	int64_t count;
+	int64_t sum;
+	int64_t min;
+	int64_t max;
+
+	// Remove all samples from the histogram
+	void reset ();
+
+	// Add a sample value to the histogram. Values less than zero are stored as zero.
+	void add (int64_t value);
+
+	// Add all samples from another histogram
+	void merge (const Histogram &otherHistogram);
+
+	// Return the mean of stored sample values, or zero if the histogram is empty
+	double getMean () const;
+
+	// Return an estimate of the sample value at the specified percentile (0.0 to 100.0), or zero if the histogram is empty
+	int64_t getPercentile (double percentile) const;
+
+	// Return a string description of the histogram
+	StdString toString () const;
+
+	// Return a newly created Json object containing histogram values
+	Json *createJson () const;
+
+private:
+	// Return the bucket index that should hold value
+	static int getBucketIndex (int64_t value);
+
+	int64_t buckets[Histogram::bucketCount];
+};
+#endif
@@ -0,0 +1,402 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#include "openssl/evp.h"
+#include "SdlUtil.h"
+#include "Log.h"
+#include "OsUtil.h"
+#include "StringList.h"
+#include "HashMap.h"
+#include "Buffer.h"
+#include "SharedBuffer.h"
+#include "BufferView.h"
+#include "HttpCache.h"
+
+constexpr const char *urlKey = "url";
+constexpr const char *etagKey = "etag";
+constexpr const char *lastModifiedKey = "lastModified";
+constexpr const char *fetchTimeKey = "fetchTime";
+constexpr const char *maxAgeKey = "maxAge";
+
+HttpCache::HttpCache (const StdString &cachePathValue, int64_t maxSizeValue)
+: cachePath (cachePathValue)
+, maxSize (maxSizeValue)
+, totalSize (0)
+, hitCount (0)
+, revalidateCount (0)
+, missCount (0)
+{
+	SdlUtil::createMutex (&mutex);
+}
+HttpCache::~HttpCache () {
+	SdlUtil::destroyMutex (&mutex);
+}
+
+OpResult HttpCache::open () {
+	StringList files, removekeys;
+	StringList::const_iterator i1, i2;
+	std::multimap<int64_t, StdString> fetchtimemap;
+	std::multimap<int64_t, StdString>::const_reverse_iterator j1, j2;
+	HashMap meta;
+	HttpCache::IndexEntry item;
+	StdString key, path;
+	OpResult result;
+
+	result = OsUtil::createDirectory (cachePath);
+	if (result != OpResult::Success) {
+		return (result);
+	}
+	result = OsUtil::readDirectory (cachePath, &files);
+	if (result != OpResult::Success) {
+		return (result);
+	}
+
+	SDL_LockMutex (mutex);
+	indexMap.clear ();
+	lruList.clear ();
+	totalSize = 0;
+	i1 = files.cbegin ();
+	i2 = files.cend ();
+	while (i1 != i2) {
+		path = OsUtil::getJoinedPath (cachePath, *i1);
+		if (i1->endsWith (StdString::createSprintf (".%s", HttpCache::metadataExtension))) {
+			key = i1->substr (0, i1->length () - strlen (HttpCache::metadataExtension) - 1);
+			if ((meta.read (path, true) != OpResult::Success) || (! meta.exists (urlKey))) {
+				OsUtil::removeFile (path);
+				OsUtil::removeFile (getBodyPath (key));
+			}
+			else {
+				item.entry.url = meta.find (urlKey, "");
+				item.entry.etag = meta.find (etagKey, "");
+				item.entry.lastModified = meta.find (lastModifiedKey, "");
+				item.entry.fetchTime = meta.find (fetchTimeKey, (int64_t) 0);
+				item.entry.maxAge = meta.find (maxAgeKey, (int64_t) -1);
+				item.entry.size = OsUtil::getFileSize (getBodyPath (key));
+				if ((item.entry.size < 0) || (! key.equals (HttpCache::getEntryKey (item.entry.url)))) {
+					OsUtil::removeFile (path);
+					OsUtil::removeFile (getBodyPath (key));
+				}
+				else {
+					indexMap[key] = item;
+					fetchtimemap.insert (std::pair<int64_t, StdString> (item.entry.fetchTime, key));
+					totalSize += item.entry.size;
+				}
+			}
+		}
+		else if (i1->endsWith (StdString::createSprintf (".%s.tmp", HttpCache::bodyExtension)) || i1->endsWith (StdString::createSprintf (".%s.tmp", HttpCache::metadataExtension))) {
+			OsUtil::removeFile (path);
+		}
+		++i1;
+	}
+	// Access history is not persisted, so entries loaded from disk are ranked by fetch time
+	j1 = fetchtimemap.crbegin ();
+	j2 = fetchtimemap.crend ();
+	while (j1 != j2) {
+		indexMap[j1->second].lruPosition = lruList.insert (lruList.end (), j1->second);
+		++j1;
+	}
+	evict (&removekeys);
+	Log::debug ("Open HTTP cache; path=\"%s\" entries=%i totalSize=%lli maxSize=%lli", cachePath.c_str (), (int) indexMap.size (), (long long int) totalSize, (long long int) maxSize);
+	SDL_UnlockMutex (mutex);
+	removeEntryFiles (removekeys);
+	return (OpResult::Success);
+}
+
+bool HttpCache::find (const StdString &url, HttpCache::Entry *destEntry) {
+	std::map<StdString, HttpCache::IndexEntry>::iterator pos;
+	bool found;
+
+	found = false;
+	SDL_LockMutex (mutex);
+	pos = indexMap.find (HttpCache::getEntryKey (url));
+	if ((pos != indexMap.end ()) && pos->second.entry.url.equals (url)) {
+		*destEntry = pos->second.entry;
+		found = true;
+	}
+	SDL_UnlockMutex (mutex);
+	return (found);
+}
+
+bool HttpCache::isFresh (const HttpCache::Entry &entry, int64_t now) {
+	if (entry.maxAge < 0) {
+		return (false);
+	}
+	return ((now - entry.fetchTime) < entry.maxAge);
+}
+
+SharedBuffer *HttpCache::readBody (const StdString &url) {
+	std::map<StdString, HttpCache::IndexEntry>::iterator pos;
+	SharedBuffer *body;
+	StringList removekeys;
+	StdString key;
+
+	key = HttpCache::getEntryKey (url);
+	body = new SharedBuffer ();
+	body->retain ();
+	if (! OsUtil::readFile (getBodyPath (key), body)) {
+		body->release ();
+		body = NULL;
+	}
+	SDL_LockMutex (mutex);
+	pos = indexMap.find (key);
+	if (! body) {
+		if (pos != indexMap.end ()) {
+			unindexEntry (pos);
+			removekeys.push_back (key);
+		}
+		SDL_UnlockMutex (mutex);
+		removeEntryFiles (removekeys);
+		return (NULL);
+	}
+	if (pos != indexMap.end ()) {
+		touch (pos);
+	}
+	SDL_UnlockMutex (mutex);
+	return (body);
+}
+
+OpResult HttpCache::store (const HttpCache::Entry &entry, const BufferView &body) {
+	std::map<StdString, HttpCache::IndexEntry>::iterator pos;
+	HttpCache::IndexEntry item;
+	StringList removekeys;
+	StdString key;
+	OpResult result;
+
+	if ((body.length > HttpCache::maxEntrySize) || (body.length > maxSize)) {
+		return (OpResult::InvalidParamError);
+	}
+	key = HttpCache::getEntryKey (entry.url);
+
+	// The previous entry leaves the index before its files are replaced, so that readers don't pair old metadata with a new body
+	SDL_LockMutex (mutex);
+	pos = indexMap.find (key);
+	if (pos != indexMap.end ()) {
+		unindexEntry (pos);
+	}
+	SDL_UnlockMutex (mutex);
+
+	item.entry = entry;
+	item.entry.size = body.length;
+	result = OsUtil::writeFileReplace (getBodyPath (key), body);
+	if (result == OpResult::Success) {
+		result = writeMetadata (key, item.entry);
+	}
+	if (result != OpResult::Success) {
+		OsUtil::removeFile (getMetadataPath (key));
+		OsUtil::removeFile (getBodyPath (key));
+		return (result);
+	}
+
+	SDL_LockMutex (mutex);
+	pos = indexMap.find (key);
+	if (pos != indexMap.end ()) {
+		unindexEntry (pos);
+	}
+	item.lruPosition = lruList.insert (lruList.begin (), key);
+	indexMap[key] = item;
+	totalSize += item.entry.size;
+	evict (&removekeys);
+	SDL_UnlockMutex (mutex);
+	removeEntryFiles (removekeys);
+	return (OpResult::Success);
+}
+
+void HttpCache::refresh (const HttpCache::Entry &entry) {
+	std::map<StdString, HttpCache::IndexEntry>::iterator pos;
+	HttpCache::Entry *item, meta;
+	StdString key;
+	bool found;
+
+	found = false;
+	key = HttpCache::getEntryKey (entry.url);
+	SDL_LockMutex (mutex);
+	pos = indexMap.find (key);
+	if (pos != indexMap.end ()) {
+		item = &(pos->second.entry);
+		item->fetchTime = entry.fetchTime;
+		item->maxAge = entry.maxAge;
+		if (! entry.etag.empty ()) {
+			item->etag.assign (entry.etag);
+		}
+		if (! entry.lastModified.empty ()) {
+			item->lastModified.assign (entry.lastModified);
+		}
+		meta = *item;
+		found = true;
+		touch (pos);
+	}
+	SDL_UnlockMutex (mutex);
+	if (found) {
+		writeMetadata (key, meta);
+	}
+}
+
+void HttpCache::remove (const StdString &url) {
+	std::map<StdString, HttpCache::IndexEntry>::iterator pos;
+	StringList removekeys;
+
+	SDL_LockMutex (mutex);
+	pos = indexMap.find (HttpCache::getEntryKey (url));
+	if (pos != indexMap.end ()) {
+		removekeys.push_back (pos->first);
+		unindexEntry (pos);
+	}
+	SDL_UnlockMutex (mutex);
+	removeEntryFiles (removekeys);
+}
+
+void HttpCache::countHit () {
+	SDL_LockMutex (mutex);
+	++hitCount;
+	SDL_UnlockMutex (mutex);
+}
+
+void HttpCache::countRevalidate () {
+	SDL_LockMutex (mutex);
+	++revalidateCount;
+	SDL_UnlockMutex (mutex);
+}
+
+void HttpCache::countMiss () {
+	SDL_LockMutex (mutex);
+	++missCount;
+	SDL_UnlockMutex (mutex);
+}
+
+void HttpCache::logStats () {
+	SDL_LockMutex (mutex);
+	Log::debug ("HTTP cache stats; entries=%i totalSize=%lli maxSize=%lli hitCount=%lli revalidateCount=%lli missCount=%lli", (int) indexMap.size (), (long long int) totalSize, (long long int) maxSize, (long long int) hitCount, (long long int) revalidateCount, (long long int) missCount);
+	SDL_UnlockMutex (mutex);
+}
+
+int64_t HttpCache::parseCacheControl (const StdString &headerValue, bool *isNoStore) {
+	std::list<StdString> parts;
+	std::list<StdString>::const_iterator i1, i2;
+	StdString directive;
+	int64_t maxage, seconds;
+
+	maxage = -1;
+	headerValue.lowercased ().split (",", &parts);
+	i1 = parts.cbegin ();
+	i2 = parts.cend ();
+	while (i1 != i2) {
+		directive = i1->trimmed ();
+		if (directive.equals ("no-store")) {
+			*isNoStore = true;
+		}
+		else if (directive.equals ("no-cache")) {
+			maxage = 0;
+		}
+		else if (directive.startsWith ("max-age=")) {
+			if (StdString (directive.substr (8)).parseInt (&seconds) && (seconds >= 0) && (maxage != 0)) {
+				maxage = seconds * 1000;
+			}
+		}
+		++i1;
+	}
+	return (maxage);
+}
+
+StdString HttpCache::getEntryKey (const StdString &url) {
+	StdString key;
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digestlen;
+
+	digestlen = 0;
+	if (! EVP_Digest (url.c_str (), url.length (), digest, &digestlen, EVP_sha256 (), NULL)) {
+		return (StdString ());
+	}
+	key.assignHex (digest, (int) digestlen);
+	return (key);
+}
+
+StdString HttpCache::getBodyPath (const StdString &key) const {
+	return (OsUtil::getJoinedPath (cachePath, StdString::createSprintf ("%s.%s", key.c_str (), HttpCache::bodyExtension)));
+}
+
+StdString HttpCache::getMetadataPath (const StdString &key) const {
+	return (OsUtil::getJoinedPath (cachePath, StdString::createSprintf ("%s.%s", key.c_str (), HttpCache::metadataExtension)));
+}
+
+OpResult HttpCache::writeMetadata (const StdString &key, const HttpCache::Entry &entry) {
+	HashMap meta;
+
+	meta.insert (urlKey, entry.url);
+	meta.insert (etagKey, entry.etag, "");
+	meta.insert (lastModifiedKey, entry.lastModified, "");
+	meta.insert (fetchTimeKey, entry.fetchTime);
+	meta.insert (maxAgeKey, entry.maxAge);
+	return (meta.write (getMetadataPath (key)));
+}
+
+void HttpCache::touch (std::map<StdString, HttpCache::IndexEntry>::iterator pos) {
+	lruList.splice (lruList.begin (), lruList, pos->second.lruPosition);
+}
+
+void HttpCache::unindexEntry (std::map<StdString, HttpCache::IndexEntry>::iterator pos) {
+	totalSize -= pos->second.entry.size;
+	lruList.erase (pos->second.lruPosition);
+	indexMap.erase (pos);
+}
+
+void HttpCache::evict (StringList *removeKeys) {
+	std::map<StdString, HttpCache::IndexEntry>::iterator pos;
+	int count;
+
+	count = 0;
+	while ((totalSize > maxSize) && (! lruList.empty ())) {
+		pos = indexMap.find (lruList.back ());
+		if (pos == indexMap.end ()) {
+			lruList.pop_back ();
+			continue;
+		}
+		removeKeys->push_back (pos->first);
+		unindexEntry (pos);
+		++count;
+	}
+	if (count > 0) {
+		Log::debug2 ("Evict HTTP cache entries; count=%i totalSize=%lli", count, (long long int) totalSize);
+	}
+}
+
+void HttpCache::removeEntryFiles (const StringList &removeKeys) {
+	StringList::const_iterator i1, i2;
+
+	i1 = removeKeys.cbegin ();
+	i2 = removeKeys.cend ();
+	while (i1 != i2) {
+		OsUtil::removeFile (getMetadataPath (*i1));
+		OsUtil::removeFile (getBodyPath (*i1));
+		++i1;
+	}
+}
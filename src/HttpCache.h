@@ -0,0 +1,136 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Object that stores HTTP response bodies on disk for reuse by later requests, with ETag and Last-Modified revalidation and size-bounded LRU eviction
+#ifndef HTTP_CACHE_H
+#define HTTP_CACHE_H
+
+class SharedBuffer;
+class StringList;
+class BufferView;
+
+class HttpCache {
+public:
+	HttpCache (const StdString &cachePathValue, int64_t maxSizeValue = HttpCache::defaultMaxSize);
+	~HttpCache ();
+
+	static constexpr const int64_t defaultMaxSize = (128 * 1024 * 1024);
+	static constexpr const int maxEntrySize = (16 * 1024 * 1024);
+	static constexpr const char *bodyExtension = "body";
+	static constexpr const char *metadataExtension = "meta";
+
+	struct Entry {
+		StdString url;
+		StdString etag;
+		StdString lastModified;
+		int64_t fetchTime; // milliseconds
+		int64_t maxAge; // milliseconds, or -1 if the response did not provide a freshness lifetime
+		int64_t size;
+		Entry ():
+			fetchTime (0),
+			maxAge (-1),
+			size (0) { }
+	};
+
+	// Read-only data members
+	StdString cachePath;
+	int64_t maxSize;
+	int64_t totalSize;
+	int64_t hitCount;
+	int64_t revalidateCount;
+	int64_t missCount;
+
+	// Create the cache directory if needed and load metadata for stored entries. Returns a Result value.
+	OpResult open ();
+
+	// Find the entry for the specified URL, store its values in destEntry, and return a boolean value indicating if the entry was found
+	bool find (const StdString &url, HttpCache::Entry *destEntry);
+
+	// Return a boolean value indicating if the provided entry can be used without revalidation at the specified millisecond time
+	static bool isFresh (const HttpCache::Entry &entry, int64_t now);
+
+	// Return a newly created SharedBuffer object holding the stored body for the specified URL, or NULL if no body was found. The caller is responsible for releasing the returned buffer.
+	SharedBuffer *readBody (const StdString &url);
+
+	// Store a response body and its metadata, replacing any previous entry for the same URL, then evict entries as needed to stay within maxSize. Files are written without holding the cache lock, so callers must not store entries from more than one thread at a time. Returns a Result value.
+	OpResult store (const HttpCache::Entry &entry, const BufferView &body);
+
+	// Update the fetch time and validators of a stored entry after a successful revalidation
+	void refresh (const HttpCache::Entry &entry);
+
+	// Remove the stored entry for the specified URL
+	void remove (const StdString &url);
+
+	// Record the outcome of a cache lookup in the hit, revalidate, or miss counter
+	void countHit ();
+	void countRevalidate ();
+	void countMiss ();
+
+	// Write cache stats to the log
+	void logStats ();
+
+	// Parse the max-age directive from a Cache-Control header value and return the resulting millisecond duration, or -1 if no max-age was present. If the value prohibits storage, set isNoStore to true.
+	static int64_t parseCacheControl (const StdString &headerValue, bool *isNoStore);
+
+private:
+	struct IndexEntry {
+		HttpCache::Entry entry;
+		std::list<StdString>::iterator lruPosition;
+	};
+
+	// Return the key used to name files holding data for the specified URL
+	static StdString getEntryKey (const StdString &url);
+
+	// Return the path of the file holding a cache entry's body or metadata
+	StdString getBodyPath (const StdString &key) const;
+	StdString getMetadataPath (const StdString &key) const;
+
+	// Write metadata for a cache entry and return a Result value
+	OpResult writeMetadata (const StdString &key, const HttpCache::Entry &entry);
+
+	// Move the specified index entry to the most recently used position
+	void touch (std::map<StdString, HttpCache::IndexEntry>::iterator pos);
+
+	// Remove a cache entry from the index without removing its files
+	void unindexEntry (std::map<StdString, HttpCache::IndexEntry>::iterator pos);
+
+	// Remove least recently used entries from the index until totalSize is less than or equal to maxSize, adding their keys to removeKeys. Must be invoked while holding the mutex.
+	void evict (StringList *removeKeys);
+
+	// Remove the files held by cache entries with the specified keys. Invoked without holding the mutex, after the entries leave the index.
+	void removeEntryFiles (const StringList &removeKeys);
+
+	std::map<StdString, HttpCache::IndexEntry> indexMap;
+	std::list<StdString> lruList;
+	SDL_mutex *mutex;
+};
+#endif
@@ -51,11 +51,12 @@ Image::Image (Sprite *sprite, int spriteFrame, bool shouldDestroySprite)
 , drawScale (1.0f)
 , isDrawColorEnabled (false)
 , shouldDestroySprite (shouldDestroySprite)
+, layerDrawAlpha (1.0f)
 {
 	SdlUtil::createMutex (&spriteTextureMutex);
 	maxSpriteWidth = (double) sprite->maxWidth;
 	maxSpriteHeight = (double) sprite->maxHeight;
-	spriteTexture = sprite->getTexture (spriteFrame, &spriteTextureWidth, &spriteTextureHeight, &spriteTexturePath);
+	spriteTexture = sprite->getTexture (spriteFrame, &spriteTextureWidth, &spriteTextureHeight, &spriteTexturePath, &spriteTextureRect);
 	if (! Resource::instance->loadTexture (spriteTexturePath, true)) {
 		spriteTexturePath.assign ("");
 	}
@@ -78,6 +79,7 @@ Image::~Image () {
 void Image::setSprite (Sprite *targetSprite, int frame) {
 	SDL_Texture *texture;
 	StdString path;
+	SDL_Rect srcrect;
 	int w, h;
 
 	if ((! targetSprite) || (frame < 0) || (frame >= targetSprite->frameCount)) {
@@ -91,7 +93,7 @@ void Image::setSprite (Sprite *targetSprite, int frame) {
 	sprite = targetSprite;
 	spriteFrame = frame;
 
-	texture = sprite->getTexture (spriteFrame, &w, &h, &path);
+	texture = sprite->getTexture (spriteFrame, &w, &h, &path, &srcrect);
 	if (! texture) {
 		return;
 	}
@@ -106,7 +108,9 @@ void Image::setSprite (Sprite *targetSprite, int frame) {
 	spriteTexture = texture;
 	spriteTextureWidth = w;
 	spriteTextureHeight = h;
+	spriteTextureRect = srcrect;
 	SDL_UnlockMutex (spriteTextureMutex);
+	invalidateLayer ();
 	maxSpriteWidth = (double) sprite->maxWidth;
 	maxSpriteHeight = (double) sprite->maxHeight;
 	resetSize ();
@@ -123,6 +127,7 @@ void Image::setScale (double scale) {
 void Image::setFrame (int frame) {
 	SDL_Texture *texture;
 	StdString path;
+	SDL_Rect srcrect;
 	int w, h;
 
 	if ((spriteFrame == frame) || (frame < 0) || (frame >= sprite->frameCount)) {
@@ -130,7 +135,7 @@ void Image::setFrame (int frame) {
 	}
 	spriteFrame = frame;
 
-	texture = sprite->getTexture (spriteFrame, &w, &h, &path);
+	texture = sprite->getTexture (spriteFrame, &w, &h, &path, &srcrect);
 	if (! texture) {
 		return;
 	}
@@ -145,7 +150,9 @@ void Image::setFrame (int frame) {
 	spriteTexture = texture;
 	spriteTextureWidth = w;
 	spriteTextureHeight = h;
+	spriteTextureRect = srcrect;
 	SDL_UnlockMutex (spriteTextureMutex);
+	invalidateLayer ();
 	resetSize ();
 }
 
@@ -158,6 +165,7 @@ void Image::setDrawColor (bool enable, const Color &color) {
 	if (isDrawColorEnabled) {
 		drawColor.assign (color);
 	}
+	invalidateLayer ();
 }
 
 void Image::translateAlpha (double startAlpha, double targetAlpha, int durationMs) {
@@ -192,6 +200,14 @@ void Image::doUpdate (int msElapsed) {
 	}
 	if (isDrawColorEnabled) {
 		drawColor.update (msElapsed);
+		if (! drawColor.equals (layerDrawColor)) {
+			layerDrawColor.assign (drawColor);
+			invalidateLayer ();
+		}
+	}
+	if (! FLOAT_EQUALS (drawAlpha, layerDrawAlpha)) {
+		layerDrawAlpha = drawAlpha;
+		invalidateLayer ();
 	}
 }
 
@@ -206,6 +222,7 @@ void Image::doDraw (double originX, double originY) {
 		rect.h = (int) height;
 
 		if (drawAlpha < 0.0f) {
+			SDL_SetTextureAlphaMod (spriteTexture, 255);
 			SDL_SetTextureBlendMode (spriteTexture, SDL_BLENDMODE_NONE);
 		}
 		else {
@@ -215,7 +232,10 @@ void Image::doDraw (double originX, double originY) {
 		if (isDrawColorEnabled) {
 			SDL_SetTextureColorMod (spriteTexture, drawColor.rByte, drawColor.gByte, drawColor.bByte);
 		}
-		SDL_RenderCopy (App::instance->render, spriteTexture, NULL, &rect);
+		else {
+			SDL_SetTextureColorMod (spriteTexture, 255, 255, 255);
+		}
+		SDL_RenderCopy (App::instance->render, spriteTexture, &spriteTextureRect, &rect);
 		if (isDrawColorEnabled) {
 			SDL_SetTextureColorMod (spriteTexture, 255, 255, 255);
 		}
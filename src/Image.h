@@ -55,6 +55,7 @@ public:
 	StdString spriteTexturePath;
 	int spriteTextureWidth;
 	int spriteTextureHeight;
+	SDL_Rect spriteTextureRect;
 	int spriteFrame;
 	double maxSpriteWidth;
 	double maxSpriteHeight;
@@ -92,5 +93,7 @@ protected:
 	SDL_mutex *spriteTextureMutex;
 	Position translateAlphaValue;
 	bool shouldDestroySprite;
+	double layerDrawAlpha;
+	Color layerDrawColor;
 };
 #endif
@@ -37,6 +37,7 @@
 #include "Log.h"
 #include "SpriteId.h"
 #include "UiConfiguration.h"
+#include "StringList.h"
 #include "Network.h"
 #include "MediaUtil.h"
 #include "TaskGroup.h"
@@ -465,7 +466,7 @@ void ImageWindow::doUpdate (int msElapsed) {
 					isLoadingImageData = true;
 					eventCallback (loadStartCallback);
 					retain ();
-					Network::instance->sendHttpGet (imageUrl, Network::HttpRequestCallbackContext (ImageWindow::createImageFromUrlHttpGetComplete, this));
+					Network::instance->sendHttpGet (imageUrl, Network::HttpRequestCallbackContext (ImageWindow::createImageFromUrlHttpGetComplete, this), StringList (), true);
 					break;
 				}
 				case ImageWindow::VideoFrameLoadType: {
@@ -502,6 +503,7 @@ void ImageWindow::executeCreateImageFromImageFile () {
 	SDL_RWops *rw;
 	SDL_Surface *surface, *scaledsurface;
 	SDL_Texture *texture;
+	SDL_Rect rect;
 	Sprite *sprite;
 	StdString path;
 	double scaledw, scaledh;
@@ -544,14 +546,18 @@ void ImageWindow::executeCreateImageFromImageFile () {
 	}
 
 	path.sprintf ("*_ImageWindow_%llx_%llx", (long long int) id, (long long int) App::instance->getUniqueId ());
-	texture = Resource::instance->createTexture (path, surface);
+	rect.x = 0;
+	rect.y = 0;
+	rect.w = surface->w;
+	rect.h = surface->h;
+	texture = Resource::instance->createPoolTexture (path, surface, Resource::ImageTextureCategory);
 	SDL_FreeSurface (surface);
 	if (! texture) {
 		endCreateImageFromImageFile (StdString::createSprintf ("Failed to create render texture, %s", Resource::instance->lastErrorMessage.c_str ()));
 		return;
 	}
 	sprite = new Sprite ();
-	sprite->addTexture (texture, path);
+	sprite->addTexture (texture, path, rect);
 	setImage (new Image (sprite, 0, true));
 	isImageDataLoaded = true;
 	reflow ();
@@ -600,6 +606,7 @@ void ImageWindow::executeCreateImageFromUrlResponseData () {
 	SDL_RWops *rw;
 	SDL_Surface *surface, *scaledsurface;
 	SDL_Texture *texture;
+	SDL_Rect rect;
 	Sprite *sprite;
 	StdString path;
 	double scaledw, scaledh;
@@ -630,14 +637,18 @@ void ImageWindow::executeCreateImageFromUrlResponseData () {
 	}
 
 	path.sprintf ("*_ImageWindow_%llx_%llx", (long long int) id, (long long int) App::instance->getUniqueId ());
-	texture = Resource::instance->createTexture (path, surface);
+	rect.x = 0;
+	rect.y = 0;
+	rect.w = surface->w;
+	rect.h = surface->h;
+	texture = Resource::instance->createPoolTexture (path, surface, Resource::ImageTextureCategory);
 	SDL_FreeSurface (surface);
 	if (! texture) {
 		endCreateImageFromUrl (StdString::createSprintf ("Failed to create render texture, %s", Resource::instance->lastErrorMessage.c_str ()));
 		return;
 	}
 	sprite = new Sprite ();
-	sprite->addTexture (texture, path);
+	sprite->addTexture (texture, path, rect);
 	setImage (new Image (sprite, 0, true));
 	isImageDataLoaded = true;
 	reflow ();
@@ -34,6 +34,7 @@
 #include "App.h"
 #include "SdlUtil.h"
 #include "OsUtil.h"
+#include "Profiler.h"
 #include "Input.h"
 
 Input *Input::instance = NULL;
@@ -214,6 +215,7 @@ void Input::pollEvents () {
 	std::map<SDL_Keycode, bool>::iterator i;
 	SDL_Event event;
 	int64_t now;
+	ProfilerZone zone ("Input::pollEvents");
 
 	now = OsUtil::getTime ();
 	while (SDL_PollEvent (&event)) {
@@ -146,6 +146,7 @@ void Label::setUnderlined (bool enable) {
 		return;
 	}
 	isUnderlined = enable;
+	invalidateLayer ();
 	underlineMargin = UiConfiguration::instance->textUnderlineMargin;
 	if (isUnderlined) {
 		height = maxGlyphTopBearing + underlineMargin + 1.0f;
@@ -160,6 +161,7 @@ void Label::setShadowed (bool enable, const Color &shadowColor, int shadowDx, in
 	textShadowDx = shadowDx;
 	textShadowDy = shadowDy;
 	isShadowed = enable;
+	invalidateLayer ();
 }
 
 void Label::setObscured (bool enable) {
@@ -258,6 +260,11 @@ void Label::doResize () {
 
 void Label::doUpdate (int msElapsed) {
 	textColor.update (msElapsed);
+	if ((! textColor.equals (layerTextColor)) || (! textShadowColor.equals (layerTextShadowColor))) {
+		layerTextColor.assign (textColor);
+		layerTextShadowColor.assign (textShadowColor);
+		invalidateLayer ();
+	}
 }
 
 void Label::setText (const StdString &textContent, UiConfiguration::FontType fontType, bool forceFontReload) {
@@ -292,6 +299,7 @@ void Label::setText (const StdString &textContent, UiConfiguration::FontType fon
 		return;
 	}
 
+	invalidateLayer ();
 	SDL_LockMutex (textMutex);
 	text.assign (textContent);
 	glyphList.clear ();
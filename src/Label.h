@@ -111,5 +111,7 @@ private:
 	double underlineMargin;
 	IntList kerningList;
 	SDL_mutex *textMutex;
+	Color layerTextColor;
+	Color layerTextShadowColor;
 };
 #endif
@@ -64,10 +64,42 @@ Log::Log ()
 , isFileWriteEnabled (false)
 , writeLevel (Log::ErrLevel)
 , isFileErrorLogged (false)
+, mutex (NULL)
+, writeFile (NULL)
+, lastFileCheckTime (0)
+, queue (NULL)
+, queueWritePosition (0)
+, queueReadPosition (0)
+, writerThread (NULL)
+, writerMutex (NULL)
+, writerCond (NULL)
+, isWriterRunning (false)
+, activeEnqueueCount (0)
+, droppedCount (0)
+, reportedDroppedCount (0)
 {
+	int i;
+
 	SdlUtil::createMutex (&mutex);
+	SdlUtil::createMutex (&writerMutex);
+	SdlUtil::createCond (&writerCond);
+	queue = new Log::QueueEntry[Log::queueSize];
+	for (i = 0; i < Log::queueSize; ++i) {
+		queue[i].sequence.store ((uint64_t) i, std::memory_order_relaxed);
+	}
 }
 Log::~Log () {
+	stop ();
+	if (writeFile) {
+		fclose (writeFile);
+		writeFile = NULL;
+	}
+	if (queue) {
+		delete[] queue;
+		queue = NULL;
+	}
+	SdlUtil::destroyCond (&writerCond);
+	SdlUtil::destroyMutex (&writerMutex);
 	SdlUtil::destroyMutex (&mutex);
 }
 
@@ -108,8 +140,14 @@ OpResult Log::openLogFile (const char *filename) {
 
 	fname.assign (filename);
 	if (fname.empty ()) {
+		SDL_LockMutex (mutex);
 		isFileWriteEnabled = false;
 		writeFilename.assign ("");
+		if (writeFile) {
+			fclose (writeFile);
+			writeFile = NULL;
+		}
+		SDL_UnlockMutex (mutex);
 		return (OpResult::Success);
 	}
 #if PLATFORM_LINUX || PLATFORM_MACOS
@@ -152,8 +190,15 @@ OpResult Log::openLogFile (const char *filename) {
 	}
 	close (fd);
 
+	SDL_LockMutex (mutex);
 	isFileWriteEnabled = true;
 	writeFilename.assign (fname);
+	if (writeFile) {
+		fclose (writeFile);
+		writeFile = NULL;
+	}
+	isFileErrorLogged = false;
+	SDL_UnlockMutex (mutex);
 	return (OpResult::Success);
 }
 
@@ -161,23 +206,67 @@ OpResult Log::openLogFile (const StdString &filename) {
 	return (openLogFile (filename.c_str ()));
 }
 
+OpResult Log::start () {
+	if (isWriterRunning.load ()) {
+		return (OpResult::Success);
+	}
+	isWriterRunning.store (true);
+	writerThread = SDL_CreateThread (Log::runWriter, "Log::runWriter", (void *) this);
+	if (! writerThread) {
+		isWriterRunning.store (false);
+		return (OpResult::ThreadCreateFailedError);
+	}
+	return (OpResult::Success);
+}
+
+void Log::stop () {
+	if (! writerThread) {
+		return;
+	}
+	isWriterRunning.store (false);
+	SDL_LockMutex (writerMutex);
+	SDL_CondSignal (writerCond);
+	SDL_UnlockMutex (writerMutex);
+	SDL_WaitThread (writerThread, NULL);
+	writerThread = NULL;
+
+	// A thread that found the writer running before it stopped may still be adding its message to the queue, so wait for those threads before writing queued messages from the caller
+	while (activeEnqueueCount.load () > 0) {
+		SDL_Delay (1);
+	}
+	writeQueue ();
+}
+
+bool Log::isLevelEnabled (Log::LogLevel level) const {
+	if (!(isStdoutWriteEnabled || isFileWriteEnabled)) {
+		return (false);
+	}
+	if ((level < 0) || ((int) level >= Log::levelCount)) {
+		return (true);
+	}
+	return ((int) level <= writeLevel);
+}
+
+bool Log::isWriteLevel (Log::LogLevel level) {
+	return (App::instance->log.isLevelEnabled (level));
+}
+
+int64_t Log::getDroppedCount () const {
+	return (droppedCount.load (std::memory_order_relaxed));
+}
+
 void Log::voutput (Log::LogLevel level, const char *str, va_list args) {
-	FILE *fp;
 	int64_t now;
 	va_list argscopy;
 	StdString text;
+	int retries;
 
-	if (!(isStdoutWriteEnabled || isFileWriteEnabled)) {
+	if (! isLevelEnabled (level)) {
 		return;
 	}
 	if ((level < 0) || ((int) level >= Log::levelCount)) {
 		level = Log::NoLevel;
 	}
-	if (level != Log::NoLevel) {
-		if (level > writeLevel) {
-			return;
-		}
-	}
 
 	now = OsUtil::getTime ();
 	text.appendSprintf ("[%s]", OsUtil::getTimestampString (now, true).c_str ());
@@ -190,26 +279,165 @@ void Log::voutput (Log::LogLevel level, const char *str, va_list args) {
 	text.appendVsprintf (str, argscopy);
 	va_end (argscopy);
 
+	activeEnqueueCount.fetch_add (1);
+	if (! isWriterRunning.load ()) {
+		activeEnqueueCount.fetch_sub (1);
+		text.append (CONFIG_NEWLINE);
+		writeText (text);
+		return;
+	}
+
+	retries = 0;
+	while (! enqueue (&text)) {
+		// A full queue drops messages above NOTICE level, while more severe messages wait for the writer
+		if ((level != Log::NoLevel) && (level > Log::NoticeLevel)) {
+			droppedCount.fetch_add (1, std::memory_order_relaxed);
+			activeEnqueueCount.fetch_sub (1);
+			return;
+		}
+		++retries;
+		if (retries > Log::maxEnqueueRetryCount) {
+			activeEnqueueCount.fetch_sub (1);
+			text.append (CONFIG_NEWLINE);
+			writeText (text);
+			return;
+		}
+		SDL_CondSignal (writerCond);
+		SDL_Delay (1);
+	}
+	activeEnqueueCount.fetch_sub (1);
+	if ((level == Log::ErrLevel) || (level == Log::WarningLevel)) {
+		SDL_CondSignal (writerCond);
+	}
+}
+
+bool Log::enqueue (StdString *text) {
+	Log::QueueEntry *entry;
+	uint64_t pos, seq;
+	int64_t diff;
+
+	pos = queueWritePosition.load (std::memory_order_relaxed);
+	while (true) {
+		entry = &(queue[pos & (Log::queueSize - 1)]);
+		seq = entry->sequence.load (std::memory_order_acquire);
+		diff = (int64_t) (seq - pos);
+		if (diff == 0) {
+			if (queueWritePosition.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (diff < 0) {
+			return (false);
+		}
+		else {
+			pos = queueWritePosition.load (std::memory_order_relaxed);
+		}
+	}
+	entry->text.swap (*text);
+	entry->sequence.store (pos + 1, std::memory_order_release);
+	if ((pos & ((Log::queueSize / 2) - 1)) == 0) {
+		SDL_CondSignal (writerCond);
+	}
+	return (true);
+}
+
+int Log::runWriter (void *logPtr) {
+	Log *it = (Log *) logPtr;
+
+	while (it->isWriterRunning.load ()) {
+		SDL_LockMutex (it->writerMutex);
+		if (it->isWriterRunning.load ()) {
+			SDL_CondWaitTimeout (it->writerCond, it->writerMutex, Log::writePeriod);
+		}
+		SDL_UnlockMutex (it->writerMutex);
+		it->writeQueue ();
+	}
+	it->writeQueue ();
+	return (0);
+}
+
+void Log::writeQueue () {
+	Log::QueueEntry *entry;
+	StdString batch;
+	int64_t dropped;
+
+	while (true) {
+		entry = &(queue[queueReadPosition & (Log::queueSize - 1)]);
+		if (entry->sequence.load (std::memory_order_acquire) != (queueReadPosition + 1)) {
+			break;
+		}
+		batch.append (entry->text);
+		batch.append (CONFIG_NEWLINE);
+		entry->text.clear ();
+		entry->sequence.store (queueReadPosition + Log::queueSize, std::memory_order_release);
+		++queueReadPosition;
+		if ((int) batch.length () >= Log::maxWriteBatchSize) {
+			writeText (batch);
+			batch.clear ();
+		}
+	}
+
+	dropped = droppedCount.load (std::memory_order_relaxed);
+	if (dropped != reportedDroppedCount) {
+		batch.appendSprintf ("[%s][%s] Log write queue full, dropped %lli messages (%lli total)%s", OsUtil::getTimestampString (OsUtil::getTime (), true).c_str (), Log::levelNames[Log::WarningLevel], (long long int) (dropped - reportedDroppedCount), (long long int) dropped, CONFIG_NEWLINE);
+		reportedDroppedCount = dropped;
+	}
+	if (! batch.empty ()) {
+		writeText (batch);
+	}
+}
+
+void Log::writeText (const StdString &text) {
+	int64_t now;
+
 	SDL_LockMutex (mutex);
 	if (isStdoutWriteEnabled) {
-		::printf ("%s%s", text.c_str (), CONFIG_NEWLINE);
+		fwrite (text.c_str (), 1, text.length (), stdout);
 	}
 	if (isFileWriteEnabled) {
-		fp = fopen (writeFilename.c_str (), "ab");
-		if (! fp) {
-			if (! isFileErrorLogged) {
+		if (writeFile) {
+			now = OsUtil::getTime ();
+			if ((now - lastFileCheckTime) >= Log::fileCheckPeriod) {
+				lastFileCheckTime = now;
+				if (isWriteFileReplaced ()) {
+					fclose (writeFile);
+					writeFile = NULL;
+					isFileErrorLogged = false;
+				}
+			}
+		}
+		if (! writeFile) {
+			writeFile = fopen (writeFilename.c_str (), "ab");
+			if ((! writeFile) && (! isFileErrorLogged)) {
 				::printf ("Warning: could not open log file %s for writing - %s\n", writeFilename.c_str (), strerror (errno));
 				isFileErrorLogged = true;
 			}
 		}
-		else {
-			fprintf (fp, "%s%s", text.c_str (), CONFIG_NEWLINE);
-			fclose (fp);
+		if (writeFile) {
+			fwrite (text.c_str (), 1, text.length (), writeFile);
+			fflush (writeFile);
 		}
 	}
 	SDL_UnlockMutex (mutex);
 }
 
+bool Log::isWriteFileReplaced () {
+#if PLATFORM_LINUX || PLATFORM_MACOS
+	struct stat pathstat, filestat;
+
+	if (stat (writeFilename.c_str (), &pathstat) != 0) {
+		return (true);
+	}
+	if (fstat (fileno (writeFile), &filestat) != 0) {
+		return (true);
+	}
+	return ((pathstat.st_dev != filestat.st_dev) || (pathstat.st_ino != filestat.st_ino));
+#else
+	// Windows does not allow an open log file to be renamed or removed
+	return (false);
+#endif
+}
+
 void Log::write (Log::LogLevel level, const char *str, ...) {
 	va_list ap;
 
@@ -289,6 +517,9 @@ void Log::debugSourcePosition (const char *fileName, const int fileLine, const c
 	va_list ap;
 	StdString text;
 
+	if (! Log::isWriteLevel (Log::DebugLevel)) {
+		return;
+	}
 	va_start (ap, str);
 	text.vsprintf (str, ap);
 	va_end (ap);
@@ -307,6 +538,9 @@ void Log::debug1SourcePosition (const char *fileName, const int fileLine, const
 	va_list ap;
 	StdString text;
 
+	if (! Log::isWriteLevel (Log::Debug1Level)) {
+		return;
+	}
 	va_start (ap, str);
 	text.vsprintf (str, ap);
 	va_end (ap);
@@ -325,6 +559,9 @@ void Log::debug2SourcePosition (const char *fileName, const int fileLine, const
 	va_list ap;
 	StdString text;
 
+	if (! Log::isWriteLevel (Log::Debug2Level)) {
+		return;
+	}
 	va_start (ap, str);
 	text.vsprintf (str, ap);
 	va_end (ap);
@@ -343,6 +580,9 @@ void Log::debug3SourcePosition (const char *fileName, const int fileLine, const
 	va_list ap;
 	StdString text;
 
+	if (! Log::isWriteLevel (Log::Debug3Level)) {
+		return;
+	}
 	va_start (ap, str);
 	text.vsprintf (str, ap);
 	va_end (ap);
@@ -361,6 +601,9 @@ void Log::debug4SourcePosition (const char *fileName, const int fileLine, const
 	va_list ap;
 	StdString text;
 
+	if (! Log::isWriteLevel (Log::Debug4Level)) {
+		return;
+	}
 	va_start (ap, str);
 	text.vsprintf (str, ap);
 	va_end (ap);
@@ -34,6 +34,9 @@
 #ifndef LOG_H
 #define LOG_H
 
+#include <stdint.h>
+#include <atomic>
+
 class Log {
 public:
 	Log ();
@@ -53,6 +56,11 @@ public:
 	};
 	static constexpr const int levelCount = 9;
 	static const char *levelNames[];
+	static constexpr const int queueSize = 4096;
+	static constexpr const int writePeriod = 100;
+	static constexpr const int maxWriteBatchSize = (256 * 1024);
+	static constexpr const int maxEnqueueRetryCount = 50;
+	static constexpr const int fileCheckPeriod = 1000;
 
 	// Read-write data members
 	bool isStdoutWriteEnabled;
@@ -73,9 +81,24 @@ public:
 	OpResult openLogFile (const char *filename);
 	OpResult openLogFile (const StdString &filename);
 
+	// Start a background thread that writes queued log messages in batches. Returns a Result value.
+	OpResult start ();
+
+	// Stop the background writer thread after writing all queued messages. Messages written after this call are written synchronously.
+	void stop ();
+
+	// Return a boolean value indicating if the log would write messages of the specified level
+	bool isLevelEnabled (Log::LogLevel level) const;
+
+	// Return the number of messages dropped because the write queue was full
+	int64_t getDroppedCount () const;
+
 	// Write a message to the log using the provided format string and va_list
 	void voutput (Log::LogLevel level, const char *str, va_list args);
 
+	// Return a boolean value indicating if the default log instance would write messages of the specified level
+	static bool isWriteLevel (Log::LogLevel level);
+
 	// Write a message to the default log instance using the specified parameters
 	static void write (Log::LogLevel level, const char *str, ...) __attribute__((format(printf, 2, 3)));
 	static void write (Log::LogLevel level, const char *str, va_list args);
@@ -116,7 +139,39 @@ public:
 	static void debug4SourcePosition (const char *fileName, const int fileLine, const char *str, ...) __attribute__((format(printf, 3, 4)));
 
 protected:
+	struct QueueEntry {
+		std::atomic<uint64_t> sequence;
+		StdString text;
+	};
+
+	// Add text to the write queue, exchanging its contents with an unused queue entry, and return a boolean value indicating if the text was queued
+	bool enqueue (StdString *text);
+
+	// Remove all entries from the write queue and write their text to log outputs
+	void writeQueue ();
+
+	// Write text to log outputs, which must include any line terminators
+	void writeText (const StdString &text);
+
+	// Return a boolean value indicating if writeFilename no longer names the open writeFile, as happens after the log file is rotated by an external tool. Must be invoked while holding mutex.
+	bool isWriteFileReplaced ();
+
+	// Execute the background writer thread
+	static int runWriter (void *logPtr);
+
 	bool isFileErrorLogged;
 	SDL_mutex *mutex;
+	FILE *writeFile;
+	int64_t lastFileCheckTime;
+	Log::QueueEntry *queue;
+	std::atomic<uint64_t> queueWritePosition;
+	uint64_t queueReadPosition;
+	SDL_Thread *writerThread;
+	SDL_mutex *writerMutex;
+	SDL_cond *writerCond;
+	std::atomic<bool> isWriterRunning;
+	std::atomic<int> activeEnqueueCount;
+	std::atomic<int64_t> droppedCount;
+	int64_t reportedDroppedCount;
 };
 #endif
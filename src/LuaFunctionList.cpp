@@ -55,13 +55,17 @@ extern "C" {
 #include "LuaPrintFunction.h"
 #include "LuaQuitFunction.h"
 #include "LuaSetvalueFunction.h"
+#include "LuaShowvideostatsFunction.h"
 #include "LuaSleepFunction.h"
+#include "LuaStartmeasureFunction.h"
 #include "LuaStartstreamFunction.h"
+#include "LuaStopmeasureFunction.h"
 #include "LuaStopstreamFunction.h"
 #include "LuaStreampathFunction.h"
 #include "LuaTargetFunction.h"
 #include "LuaTimeoutFunction.h"
 #include "LuaUntargetFunction.h"
+#include "LuaVideostatsFunction.h"
 #include "LuaFunctionList.h"
 
 LuaFunctionList *LuaFunctionList::instance = NULL;
@@ -91,13 +95,17 @@ LuaFunctionList::LuaFunctionList ()
 	push_back (new LuaPrintFunction ());
 	push_back (new LuaQuitFunction ());
 	push_back (new LuaSetvalueFunction ());
+	push_back (new LuaShowvideostatsFunction ());
 	push_back (new LuaSleepFunction ());
+	push_back (new LuaStartmeasureFunction ());
 	push_back (new LuaStartstreamFunction ());
+	push_back (new LuaStopmeasureFunction ());
 	push_back (new LuaStopstreamFunction ());
 	push_back (new LuaStreampathFunction ());
 	push_back (new LuaTargetFunction ());
 	push_back (new LuaTimeoutFunction ());
 	push_back (new LuaUntargetFunction ());
+	push_back (new LuaVideostatsFunction ());
 	sort (compareFunctions);
 }
 LuaFunctionList::~LuaFunctionList () {
@@ -46,6 +46,7 @@ extern "C" {
 int LuaScript::scriptTimeout = 7000; // ms
 StdString LuaScript::captureScreenPath;
 StdString LuaScript::captureWriterPath;
+int64_t LuaScript::measureFrameDropCount = 0;
 
 LuaScript::LuaScript (const StdString &script, bool shouldExitOnError)
 : script (script)
@@ -97,6 +98,7 @@ void LuaScript::run (void *itPtr) {
 
 	if ((it->runResult != OpResult::Success) && it->shouldExitOnError) {
 		Log::info ("Lua script failed, shutdown application; %s", it->runErrorText.c_str ());
+		App::instance->isScriptFailed = true;
 		App::instance->addUpdateTask (App::shutdownApplication, NULL);
 	}
 	delete (it);
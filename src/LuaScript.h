@@ -49,6 +49,7 @@ public:
 	static int scriptTimeout;
 	static StdString captureScreenPath;
 	static StdString captureWriterPath;
+	static int64_t measureFrameDropCount;
 
 	// Read-only data members
 	StdString script;
@@ -0,0 +1,136 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+extern "C" {
+#include "lua.h"
+#include "lauxlib.h"
+}
+#include "App.h"
+#include "OsUtil.h"
+#include "UiText.h"
+#include "UiStack.h"
+#include "Json.h"
+#include "TaskGroup.h"
+#include "Resource.h"
+#include "BufferPool.h"
+#include "Profiler.h"
+#include "Video.h"
+#include "LuaScript.h"
+#include "LuaStopmeasureFunction.h"
+
+// Store a measurement value in json and in the table at the top of the Lua stack
+static void setField (lua_State *L, Json *json, const char *key, int64_t value) {
+	json->set (key, value);
+	lua_pushinteger (L, (lua_Integer) value);
+	lua_setfield (L, -2, key);
+}
+static void setField (lua_State *L, Json *json, const char *key, double value) {
+	json->set (key, value);
+	lua_pushnumber (L, (lua_Number) value);
+	lua_setfield (L, -2, key);
+}
+
+static int exec (lua_State *L) {
+	Profiler::MeasureStats stats;
+	Resource::TextureStats texturestats;
+	std::vector<BufferPool::PoolStats> poolstats;
+	std::vector<BufferPool::PoolStats>::const_iterator i1, i2;
+	Json *json;
+	int64_t poolbytes;
+	char *path, buf[4096];
+	OpResult result;
+
+	path = NULL;
+	if (lua_gettop (L) >= 1) {
+		LuaFunction::argvString (L, 1, &path);
+	}
+	Profiler::instance->stopMeasure (&stats);
+	if ((! Profiler::instance->isTracing) && (! UiStack::instance->isProfilerWindowOpen ())) {
+		Profiler::instance->setEnabled (false);
+	}
+	Resource::instance->getTextureStats (&texturestats);
+	BufferPool::instance->getStats (&poolstats);
+	poolbytes = 0;
+	i1 = poolstats.cbegin ();
+	i2 = poolstats.cend ();
+	while (i1 != i2) {
+		poolbytes += ((int64_t) i1->blockSize) * (i1->inUseCount + i1->freeCount);
+		++i1;
+	}
+
+	json = new Json ();
+	lua_newtable (L);
+	setField (L, json, "duration", stats.duration);
+	setField (L, json, "frameCount", stats.frameTime.count);
+	setField (L, json, "fps", (stats.duration > 0) ? ((double) stats.frameTime.count * 1000.0f / (double) stats.duration) : 0.0f);
+	setField (L, json, "frameTimeMean", stats.frameTime.getMean () / 1000.0f);
+	setField (L, json, "frameTimeP50", (double) stats.frameTime.getPercentile (50.0f) / 1000.0f);
+	setField (L, json, "frameTimeP95", (double) stats.frameTime.getPercentile (95.0f) / 1000.0f);
+	setField (L, json, "frameTimeP99", (double) stats.frameTime.getPercentile (99.0f) / 1000.0f);
+	setField (L, json, "frameTimeMax", (double) stats.frameTime.max / 1000.0f);
+	setField (L, json, "droppedVideoFrames", Video::totalFrameDropCount.load (std::memory_order_relaxed) - LuaScript::measureFrameDropCount);
+	setField (L, json, "taskQueueDepth", (int64_t) TaskGroup::instance->runCount);
+	setField (L, json, "maxTaskQueueDepth", (int64_t) TaskGroup::instance->maxRunCount);
+	setField (L, json, "memoryBytes", OsUtil::getProcessMemorySize ());
+	setField (L, json, "textureBytes", texturestats.totalBytes);
+	setField (L, json, "bufferPoolBytes", poolbytes);
+
+	if (! path) {
+		Log::printf ("---- Measure stats ----");
+		Log::printf ("%s", json->toString ().c_str ());
+		delete (json);
+		return (1);
+	}
+	json->set ("time", OsUtil::getTime ());
+	result = OsUtil::writeFile (StdString (path), json->toString ().createBuffer ());
+	delete (json);
+	if (result != OpResult::Success) {
+		snprintf (buf, sizeof (buf), "%s: %s", UiText::instance->getText (UiTextId::FileOpenFailed).c_str (), path);
+		return (luaL_error (L, "%s", buf));
+	}
+	return (1);
+}
+
+LuaStopmeasureFunction::LuaStopmeasureFunction ()
+: LuaFunction ()
+{
+	name.assign ("stopmeasure");
+	parameters.assign ("[filename]");
+	fn = exec;
+}
+LuaStopmeasureFunction::~LuaStopmeasureFunction () {
+}
+
+StdString LuaStopmeasureFunction::getHelpText () {
+	return (UiText::instance->getText (UiTextId::LuaScriptStopmeasureHelpText));
+}
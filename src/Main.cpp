@@ -123,6 +123,9 @@ int main (int argc, char **argv)
 		}
 		exitstatus = 1;
 	}
+	else if (App::instance->isScriptFailed) {
+		exitstatus = 1;
+	}
 	exit (exitstatus);
 }
 
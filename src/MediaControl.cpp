@@ -51,27 +51,48 @@
 #include "PlayMarker.h"
 #include "MediaPlaylist.h"
 #include "MediaReader.h"
+#include "FileWalker.h"
+#include "MediaWatcher.h"
+#include "Profiler.h"
 #include "MediaControl.h"
 
 MediaControl *MediaControl::instance = NULL;
 
 constexpr const char *databaseName = "media.db";
 constexpr const char *metadataTableName = "MediaMetadata";
-constexpr const int metadataVersion = 1;
+constexpr const int metadataVersion = 2;
+constexpr const int fingerprintMetadataVersion = 2;
 constexpr const char *thumbnailDirectoryName = "thumbnail";
 constexpr const double writeThumbnailImagesProgressPercent = 95.0f;
 constexpr const int uiLogMaxMessageAge = (30 * 86400);
+constexpr const int maxMediaCountCacheSize = 64;
+constexpr const int maxRemovedMediaIds = 1024;
+constexpr const int64_t watchLimitScanPeriod = (10 * 60 * 1000);
+constexpr const int cleanBatchSize = 512;
+constexpr const int cleanProbeThreadCount = 8;
+constexpr const int cleanProbeMinPathsPerThread = 32;
 
 MediaControl::MediaControl ()
-: isStopped (false)
+: isWatchEnabled (true)
+, isStopped (false)
 , isReady (false)
 , isConfigured (false)
 , mediaThumbnailCount (MediaControl::defaultMediaThumbnailCount)
 , configureMediaThumbnailCount (MediaControl::defaultMediaThumbnailCount)
+, watcher (NULL)
+, removedMediaIdCount (0)
+, isWatchLimitNotified (false)
+, isWatchCleanPending (false)
+, lastWatchLimitScanTime (0)
+, mediaCountCacheUpdateCount (-1)
+, mediaCountCacheClearCount (0)
 , isTaskCancelled (false)
 {
 	SdlUtil::createMutex (&statusMutex);
 	SdlUtil::createMutex (&taskListMutex);
+	SdlUtil::createMutex (&mediaCountCacheMutex);
+	SdlUtil::createMutex (&watchMutex);
+	watcher = new MediaWatcher ();
 }
 MediaControl::~MediaControl () {
 	if (! databasePath.empty ()) {
@@ -80,6 +101,12 @@ MediaControl::~MediaControl () {
 	}
 	SdlUtil::destroyMutex (&statusMutex);
 	SdlUtil::destroyMutex (&taskListMutex);
+	SdlUtil::destroyMutex (&mediaCountCacheMutex);
+	if (watcher) {
+		delete (watcher);
+		watcher = NULL;
+	}
+	SdlUtil::destroyMutex (&watchMutex);
 }
 
 void MediaControl::createInstance () {
@@ -125,6 +152,7 @@ OpResult MediaControl::start () {
 void MediaControl::stop () {
 	isStopped = true;
 	isTaskCancelled = true;
+	watcher->stop ();
 }
 
 OpResult MediaControl::openDatabase () {
@@ -149,6 +177,13 @@ OpResult MediaControl::openDatabase () {
 	}
 	if (result == OpResult::Success) {
 		version = Database::instance->readMetadataVersion (databasePath, StdString (metadataTableName));
+		if (version < fingerprintMetadataVersion) {
+			// Fails without effect if the table was created with a fingerprint column
+			Database::instance->exec (databasePath, MediaItem::addFingerprintColumnSql);
+		}
+		result = Database::instance->exec (databasePath, MediaItem::createFingerprintIndexSql);
+	}
+	if (result == OpResult::Success) {
 		if (version < metadataVersion) {
 			Database::instance->writeMetadataVersion (databasePath, StdString (metadataTableName), metadataVersion);
 		}
@@ -216,16 +251,155 @@ void MediaControl::getStatus (int taskType, MediaControl::TaskResult *taskResult
 	SDL_UnlockMutex (statusMutex);
 }
 
+int MediaControl::countMediaItems (const StdString &searchKey, StdString *errorMessage) {
+	std::map<StdString, int>::iterator pos;
+	int updatecount, clearcount, count;
+
+	SDL_LockMutex (statusMutex);
+	updatecount = status.updateCount;
+	SDL_UnlockMutex (statusMutex);
+
+	SDL_LockMutex (mediaCountCacheMutex);
+	if (updatecount != mediaCountCacheUpdateCount) {
+		mediaCountCache.clear ();
+		mediaCountCacheUpdateCount = updatecount;
+	}
+	clearcount = mediaCountCacheClearCount;
+	pos = mediaCountCache.find (searchKey);
+	if (pos != mediaCountCache.end ()) {
+		count = pos->second;
+		SDL_UnlockMutex (mediaCountCacheMutex);
+		if (errorMessage) {
+			errorMessage->assign ("");
+		}
+		return (count);
+	}
+	SDL_UnlockMutex (mediaCountCacheMutex);
+
+	count = MediaItem::countDatabaseRecords (databasePath, errorMessage, searchKey);
+	if (count < 0) {
+		return (-1);
+	}
+	SDL_LockMutex (mediaCountCacheMutex);
+	if ((updatecount == mediaCountCacheUpdateCount) && (clearcount == mediaCountCacheClearCount)) {
+		if ((int) mediaCountCache.size () >= maxMediaCountCacheSize) {
+			mediaCountCache.clear ();
+		}
+		mediaCountCache.insert (std::pair<StdString, int> (searchKey, count));
+	}
+	SDL_UnlockMutex (mediaCountCacheMutex);
+	return (count);
+}
+
+void MediaControl::addRemovedMediaIds (const StringList &mediaIds) {
+	SDL_LockMutex (watchMutex);
+	removedMediaIds.append (mediaIds);
+	removedMediaIdCount += (int64_t) mediaIds.size ();
+	while ((int) removedMediaIds.size () > maxRemovedMediaIds) {
+		removedMediaIds.pop_front ();
+	}
+	SDL_UnlockMutex (watchMutex);
+}
+
+bool MediaControl::readRemovedMediaIds (int64_t *removeCount, StringList *destList) {
+	StringList::const_iterator i1;
+	int64_t count;
+	bool result;
+
+	destList->clear ();
+	result = true;
+	SDL_LockMutex (watchMutex);
+	if ((*removeCount >= 0) && (*removeCount < removedMediaIdCount)) {
+		count = removedMediaIdCount - *removeCount;
+		if (count > (int64_t) removedMediaIds.size ()) {
+			result = false;
+		}
+		else {
+			i1 = removedMediaIds.cend ();
+			std::advance (i1, -count);
+			destList->insert (destList->end (), i1, removedMediaIds.cend ());
+		}
+	}
+	*removeCount = removedMediaIdCount;
+	SDL_UnlockMutex (watchMutex);
+	return (result);
+}
+
+void MediaControl::clearMediaCountCache () {
+	SDL_LockMutex (mediaCountCacheMutex);
+	mediaCountCache.clear ();
+	++mediaCountCacheClearCount;
+	SDL_UnlockMutex (mediaCountCacheMutex);
+}
+
 void MediaControl::clearTaskResult (int taskType) {
 	lockStatus ();
 	taskResultMap.erase (taskType);
 	unlockStatus ();
 }
 
+void MediaControl::getTaskStats (MediaControl::TaskStats *destStats) {
+	SDL_LockMutex (statusMutex);
+	*destStats = taskStats;
+	SDL_UnlockMutex (statusMutex);
+}
+
 void MediaControl::update (int msElapsed) {
 	std::list<MediaControl::Task>::iterator t;
 	MediaControl::Status updatestatus;
-	bool shouldupdatestatus;
+	MediaWatcher::Changes changes;
+	int64_t now;
+	bool shouldupdatestatus, shouldrunupdate;
+	ProfilerZone zone ("MediaControl::update");
+
+	if (isReady && (! isStopped)) {
+		if (watcher->readChanges (&changes)) {
+			if (changes.isOverflowed) {
+				Log::debug ("Media watch event queue overflow, running full scan");
+				scan ();
+			}
+			else {
+				SDL_LockMutex (watchMutex);
+				watchUpdatePaths.splice (watchUpdatePaths.end (), changes.updatePaths);
+				watchRemovePaths.splice (watchRemovePaths.end (), changes.removePaths);
+				watchScanDirectoryPaths.splice (watchScanDirectoryPaths.end (), changes.scanDirectoryPaths);
+				SDL_UnlockMutex (watchMutex);
+			}
+			if (changes.hasRemovedDirectory) {
+				isWatchCleanPending = true;
+			}
+		}
+		SDL_LockMutex (watchMutex);
+		shouldrunupdate = (! watchUpdatePaths.empty ()) || (! watchRemovePaths.empty ()) || (! watchScanDirectoryPaths.empty ());
+		SDL_UnlockMutex (watchMutex);
+		if (shouldrunupdate && (! isRunningTask (MediaControl::UpdateTask))) {
+			runTask (MediaControl::UpdateTask);
+		}
+		else if (isWatchCleanPending && (! shouldrunupdate) && (! isRunningTask (MediaControl::UpdateTask))) {
+			// A removed directory may have moved elsewhere in the watched tree, so the clean task waits for the update task to match moved files by fingerprint before removing records for files that no longer exist
+			isWatchCleanPending = false;
+			clean ();
+		}
+		if (watcher->isWatchLimitReached) {
+			now = OsUtil::getTime ();
+			if (! isWatchLimitNotified) {
+				isWatchLimitNotified = true;
+				lastWatchLimitScanTime = now;
+				UiLog::instance->write (0, "%s", UiText::instance->getText (UiTextId::MediaWatchLimitReached).capitalized ().c_str ());
+				App::instance->showNotification (UiText::instance->getText (UiTextId::MediaWatchLimitReached).capitalized ());
+			}
+			else if ((now - lastWatchLimitScanTime) >= watchLimitScanPeriod) {
+				// Changes in directories without a watch are found only by scan and clean tasks
+				lastWatchLimitScanTime = now;
+				if (! isRunningTask (MediaControl::ScanTask)) {
+					scan ();
+				}
+				if (! isRunningTask (MediaControl::CleanTask)) {
+					clean ();
+				}
+			}
+		}
+	}
 
 	shouldupdatestatus = false;
 	getStatus (&updatestatus);
@@ -285,6 +459,16 @@ void MediaControl::update (int msElapsed) {
 						TaskGroup::instance->run (TaskGroup::RunContext (MediaControl::scanMediaFiles, this));
 						break;
 					}
+					case MediaControl::UpdateTask: {
+						updatestatus.taskType = t->taskType;
+						updatestatus.statusText.assign (UiText::instance->getText (UiTextId::Scanning).capitalized ());
+						updatestatus.taskText1.assign (UiText::instance->getText (UiTextId::Scanning).capitalized ());
+						updatestatus.taskText2.assign ("");
+						updatestatus.taskProgressPercent = -1.0f;
+						shouldupdatestatus = true;
+						TaskGroup::instance->run (TaskGroup::RunContext (MediaControl::updateMediaFiles, this));
+						break;
+					}
 					case MediaControl::CleanTask: {
 						updatestatus.taskType = t->taskType;
 						updatestatus.statusText.assign (UiText::instance->getText (UiTextId::Cleaning).capitalized ());
@@ -360,6 +544,9 @@ void MediaControl::endTask (int taskType, const StdString &resultText1, const St
 	status.taskText1.assign ("");
 	status.taskText2.assign ("");
 	status.taskProgressPercent = -1.0f;
+	if (logErrorMessage) {
+		++(taskStats.failedTaskCount);
+	}
 	j = taskResultMap.find (taskType);
 	if (j == taskResultMap.end ()) {
 		taskResultMap.insert (std::pair<int, MediaControl::TaskResult> (taskType, MediaControl::TaskResult (resultText1, resultText2)));
@@ -495,6 +682,7 @@ void MediaControl::executeReadyMediaControl () {
 	if (! dbexists) {
 		scan ();
 	}
+	startWatch ();
 	endTask (MediaControl::ReadyTask, UiText::instance->getText (UiTextId::Ready).capitalized ());
 }
 
@@ -520,6 +708,17 @@ void MediaControl::configure (const StringList &mediaSourcePathValue, const StdS
 	configureMediaThumbnailCount = mediaThumbnailCountValue;
 	runTask (MediaControl::ConfigureTask);
 }
+
+void MediaControl::configureBatch (const StringList &mediaSourcePathValue, const StdString &dataPathValue, int mediaThumbnailCountValue) {
+	mediaSourcePath.assign (mediaSourcePathValue);
+	dataPath.assign (dataPathValue);
+	mediaThumbnailCount = mediaThumbnailCountValue;
+	isReady = false;
+	isConfigured = (! mediaSourcePath.empty ()) && (! dataPath.empty ());
+	if (isConfigured) {
+		runTask (MediaControl::ReadyTask);
+	}
+}
 void MediaControl::applyConfigureSettings (void *itPtr) {
 	MediaControl *it = (MediaControl *) itPtr;
 
@@ -620,6 +819,7 @@ void MediaControl::executeApplyConfigureSettings () {
 	status.mediaCount = 0;
 	unlockStatus ();
 	scan ();
+	startWatch ();
 	endTask (MediaControl::ConfigureTask, UiText::instance->getText (UiTextId::ConfigurationUpdated).capitalized ());
 }
 
@@ -632,16 +832,10 @@ void MediaControl::scanMediaFiles (void *itPtr) {
 	it->executeScanMediaFiles ();
 }
 void MediaControl::executeScanMediaFiles () {
-	StringList findfiles;
-	StringList::const_iterator i1, i2;
-	std::list<MediaItem> scanitems;
-	std::list<MediaItem>::iterator j1, j2;
-	MediaItem item;
-	StdString path, errmsg, errtype;
-	OpResult result;
-	int64_t mtime;
-	int filecount, scancount, recordcount, addcount, errorcount;
-	bool found;
+	FileWalker walker;
+	std::list<FileWalker::Entry> findfiles;
+	StdString errmsg;
+	int recordcount;
 
 	UiLog::instance->write (0, "%s", UiText::instance->getText (UiTextId::BeginMediaScan).capitalized ().c_str ());
 	recordcount = MediaItem::countDatabaseRecords (databasePath, &errmsg);
@@ -653,64 +847,88 @@ void MediaControl::executeScanMediaFiles () {
 	status.taskText2.assign (UiText::instance->getText (UiTextId::ReadingMediaDirectory).capitalized ());
 	unlockStatus ();
 
-	i1 = mediaSourcePath.cbegin ();
-	i2 = mediaSourcePath.cend ();
-	while (i1 != i2) {
-		if (isTaskCancelled) {
-			endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
-			return;
-		}
-		executeScanMediaFiles_readDirectory (*i1, &findfiles);
-		++i1;
-	}
+	walker.fileMatchFn = MediaControl::matchMediaFileName;
+	walker.cancelFlag = &isTaskCancelled;
+	walker.walk (mediaSourcePath, &findfiles);
+	Log::debug ("Media directory scan; directoryCount=%i fileCount=%i errorCount=%i", walker.directoryCount, walker.fileCount, walker.errorCount);
 	if (isTaskCancelled) {
 		endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
 		return;
 	}
-	if (findfiles.empty ()) {
-		endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::ScanComplete).capitalized (), StdString::createSprintf ("0 %s", UiText::instance->getText (UiTextId::NewFilesFound).c_str ()), StdString::createSprintf ("%s: 0 %s", UiText::instance->getText (UiTextId::EndMediaScan).capitalized ().c_str (), UiText::instance->getText (UiTextId::NewFilesFound).c_str ()));
+	executeScanMediaFiles_processEntries (MediaControl::ScanTask, findfiles, walker.errorPaths, recordcount);
+}
+void MediaControl::executeScanMediaFiles_processEntries (int taskType, const std::list<FileWalker::Entry> &entries, const StringList &errorPaths, int recordCount) {
+	std::list<FileWalker::Entry>::const_iterator i1, i2;
+	StringList::const_iterator k1, k2;
+	FileWalker::Entry entry;
+	std::list<MediaItem> scanitems;
+	std::list<MediaItem>::iterator j1, j2;
+	MediaItem item;
+	StdString errmsg, errtype, fingerprint;
+	OpResult result;
+	int filecount, scancount, recordcount, addcount, errorcount, movecount;
+	bool found;
+
+	recordcount = recordCount;
+	errorcount = 0;
+	k1 = errorPaths.cbegin ();
+	k2 = errorPaths.cend ();
+	while (k1 != k2) {
+		++errorcount;
+		Log::debug ("Failed to read media file; path=\"%s\" err=\"Error reading file mtime\"", k1->c_str ());
+		UiLog::instance->write (0, "%s: %s, \"%s\" in directory \"%s\"", UiText::instance->getText (UiTextId::ScanError).capitalized ().c_str (), UiText::instance->getText (UiTextId::FileOpenFailed).capitalized ().c_str (), OsUtil::getPathBasename (*k1).c_str (), OsUtil::getPathDirname (*k1).c_str ());
+		++k1;
+	}
+	if (entries.empty ()) {
+		endTask (taskType, UiText::instance->getText (UiTextId::ScanComplete).capitalized (), StdString::createSprintf ("0 %s", UiText::instance->getText (UiTextId::NewFilesFound).c_str ()), (taskType == MediaControl::ScanTask) ? StdString::createSprintf ("%s: 0 %s", UiText::instance->getText (UiTextId::EndMediaScan).capitalized ().c_str (), UiText::instance->getText (UiTextId::NewFilesFound).c_str ()) : StdString ());
 		return;
 	}
-	findfiles.sort ();
-	errorcount = 0;
-	i1 = findfiles.cbegin ();
-	i2 = findfiles.cend ();
+	movecount = 0;
+	i1 = entries.cbegin ();
+	i2 = entries.cend ();
 	while (i1 != i2) {
 		if (isTaskCancelled) {
-			endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
+			endTask (taskType, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
 			return;
 		}
-		path = *i1;
+		entry = *i1;
 		++i1;
 
-		mtime = OsUtil::getFileMtime (path);
-		if (mtime < 0) {
-			++errorcount;
-			Log::debug ("Failed to read media file; path=\"%s\" err=\"Error reading file mtime\"", path.c_str ());
-			UiLog::instance->write (0, "%s: %s, \"%s\" in directory \"%s\"", UiText::instance->getText (UiTextId::ScanError).capitalized ().c_str (), UiText::instance->getText (UiTextId::FileOpenFailed).capitalized ().c_str (), OsUtil::getPathBasename (path).c_str (), OsUtil::getPathDirname (path).c_str ());
-			continue;
-		}
-		found = item.readDatabaseMediaPathRow (databasePath, &errmsg, path);
+		found = item.readDatabaseMediaPathRow (databasePath, &errmsg, entry.path);
 		if (! errmsg.empty ()) {
 			Log::debug ("Failed to read database record; err=\"%s\"", errmsg.c_str ());
 			continue;
 		}
 		if (found) {
-			if (item.mtime == mtime) {
+			if (item.mtime == entry.mtime) {
 				continue;
 			}
+			fingerprint = entry.fingerprint.empty () ? OsUtil::getFileFingerprint (entry.path) : entry.fingerprint;
 			item.clear (item.mediaId);
 		}
 		else {
+			fingerprint = entry.fingerprint.empty () ? OsUtil::getFileFingerprint (entry.path) : entry.fingerprint;
+			if (executeScanMediaFiles_moveRecord (entry, fingerprint, &errmsg)) {
+				++movecount;
+				continue;
+			}
+			if (! errmsg.empty ()) {
+				Log::debug ("Failed to read database record; err=\"%s\"", errmsg.c_str ());
+			}
 			item.clear (RecordStore::instance->getRecordId (SystemInterface::CommandId_MediaItem));
 		}
-		item.mtime = mtime;
-		item.mediaPath.assign (path);
-		item.mediaDirname.assign (OsUtil::getPathDirname (path));
-		item.name.assign (OsUtil::getPathBasename (path));
+		item.fingerprint.assign (fingerprint);
+		item.mtime = entry.mtime;
+		item.mediaFileSize = entry.size;
+		item.mediaPath.assign (entry.path);
+		item.mediaDirname.assign (OsUtil::getPathDirname (entry.path));
+		item.name.assign (OsUtil::getPathBasename (entry.path));
 		item.sortKey.assign (item.name.lowercased ().filtered (MediaItem::sortKeyCharacters));
 		scanitems.push_back (item);
 	}
+	if (movecount > 0) {
+		Log::debug ("Media scan matched moved files; moveCount=%i", movecount);
+	}
 	filecount = (int) scanitems.size ();
 	addcount = 0;
 	scancount = 0;
@@ -718,7 +936,7 @@ void MediaControl::executeScanMediaFiles () {
 	j2 = scanitems.end ();
 	while (j1 != j2) {
 		if (isTaskCancelled) {
-			endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
+			endTask (taskType, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
 			return;
 		}
 		++scancount;
@@ -730,11 +948,14 @@ void MediaControl::executeScanMediaFiles () {
 
 		result = executeScanMediaFiles_processFile (j1, &errmsg);
 		if (isTaskCancelled) {
-			endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
+			endTask (taskType, UiText::instance->getText (UiTextId::ScanCancelled).capitalized (), StdString (), UiText::instance->getText (UiTextId::MediaScanCancelled).capitalized ());
 			return;
 		}
 		if (result != OpResult::Success) {
 			++errorcount;
+			lockStatus ();
+			++(taskStats.scanErrorCount);
+			unlockStatus ();
 			Log::debug ("Failed to read media file; path=\"%s\" err=\"%s\"", j1->mediaPath.c_str (), errmsg.c_str ());
 
 			if (result == OpResult::MalformedDataError) {
@@ -752,6 +973,10 @@ void MediaControl::executeScanMediaFiles () {
 			++addcount;
 		}
 		lockStatus ();
+		if (result == OpResult::Success) {
+			++(taskStats.scanFileCount);
+			taskStats.scanReadBytes += j1->mediaFileSize;
+		}
 		status.mediaCount = recordcount + addcount;
 		status.taskProgressPercent = 100.0f;
 		unlockStatus ();
@@ -760,50 +985,93 @@ void MediaControl::executeScanMediaFiles () {
 
 	recordcount = MediaItem::countDatabaseRecords (databasePath, &errmsg);
 	if (recordcount < 0) {
-		endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::MediaScanFailed).capitalized (), UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("%s: %s", UiText::instance->getText (UiTextId::MediaScanFailed).capitalized ().c_str (), UiText::instance->getText (UiTextId::InternalApplicationError).capitalized ().c_str ()), errmsg.c_str ());
+		endTask (taskType, UiText::instance->getText (UiTextId::MediaScanFailed).capitalized (), UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("%s: %s", UiText::instance->getText (UiTextId::MediaScanFailed).capitalized ().c_str (), UiText::instance->getText (UiTextId::InternalApplicationError).capitalized ().c_str ()), errmsg.c_str ());
 		return;
 	}
 	lockStatus ();
 	status.mediaCount = recordcount;
 	unlockStatus ();
-	endTask (MediaControl::ScanTask, UiText::instance->getText (UiTextId::ScanComplete).capitalized (), UiText::instance->getCountText (addcount, UiTextId::NewFileFound, UiTextId::NewFilesFound), StdString::createSprintf ("%s: %s, %s", UiText::instance->getText (UiTextId::EndMediaScan).capitalized ().c_str (), UiText::instance->getCountText (addcount, UiTextId::NewFileFound, UiTextId::NewFilesFound).c_str (), UiText::instance->getCountText (errorcount, UiTextId::ScanError, UiTextId::ScanErrors).c_str ()));
+	if ((taskType != MediaControl::ScanTask) && (addcount <= 0) && (errorcount <= 0)) {
+		endTask (taskType, UiText::instance->getText (UiTextId::ScanComplete).capitalized (), UiText::instance->getCountText (addcount, UiTextId::NewFileFound, UiTextId::NewFilesFound));
+		return;
+	}
+	endTask (taskType, UiText::instance->getText (UiTextId::ScanComplete).capitalized (), UiText::instance->getCountText (addcount, UiTextId::NewFileFound, UiTextId::NewFilesFound), StdString::createSprintf ("%s: %s, %s", UiText::instance->getText (UiTextId::EndMediaScan).capitalized ().c_str (), UiText::instance->getCountText (addcount, UiTextId::NewFileFound, UiTextId::NewFilesFound).c_str (), UiText::instance->getCountText (errorcount, UiTextId::ScanError, UiTextId::ScanErrors).c_str ()));
 }
-void MediaControl::executeScanMediaFiles_readDirectory (const StdString &scanPath, StringList *destList) {
+bool MediaControl::executeScanMediaFiles_moveRecord (const FileWalker::Entry &entry, const StdString &fingerprint, StdString *errorMessage) {
+	std::list<MediaItem> items;
+	std::list<MediaItem>::iterator i1, i2;
+	StdString sql, oldpath;
 	OpResult result;
-	StringList files;
-	StringList::const_iterator i1, i2;
-	StdString path;
-	int filetype;
 
-	if (isTaskCancelled) {
-		return;
+	errorMessage->assign ("");
+	if (fingerprint.empty ()) {
+		return (false);
 	}
-	result = OsUtil::readDirectory (scanPath, &files);
-	if (result != OpResult::Success) {
-		return;
+	if (! MediaItem::readDatabaseMovedFileRows (databasePath, errorMessage, &items, fingerprint, OsUtil::getPathBasename (entry.path), entry.size)) {
+		return (false);
 	}
-	i1 = files.cbegin ();
-	i2 = files.cend ();
+	i1 = items.begin ();
+	i2 = items.end ();
 	while (i1 != i2) {
-		if (isTaskCancelled) {
-			break;
+		if (OsUtil::fileExists (i1->mediaPath)) {
+			++i1;
+			continue;
 		}
-		path = *i1;
-		++i1;
-		if (path.equals (".") || path.equals ("..")) {
+		// A name and size match is too weak to trust when the old location can't be read, as with an unmounted volume
+		if (i1->fingerprint.empty () && (! OsUtil::directoryExists (OsUtil::getPathDirname (i1->mediaPath)))) {
+			++i1;
+			continue;
+		}
+		oldpath.assign (i1->mediaPath);
+		i1->mediaPath.assign (entry.path);
+		i1->mediaDirname.assign (OsUtil::getPathDirname (entry.path));
+		i1->name.assign (OsUtil::getPathBasename (entry.path));
+		i1->sortKey.assign (i1->name.lowercased ().filtered (MediaItem::sortKeyCharacters));
+		i1->mtime = entry.mtime;
+		i1->fingerprint.assign (fingerprint);
+		sql = i1->getUpdatePathSql ();
+		if (sql.empty ()) {
+			++i1;
 			continue;
 		}
-		path = OsUtil::getJoinedPath (scanPath, path);
-		filetype = OsUtil::getFileType (path);
-		if (filetype == OsUtil::DirectoryFile) {
-			executeScanMediaFiles_readDirectory (path, destList);
+		result = Database::instance->exec (databasePath, sql, errorMessage);
+		if (result != OpResult::Success) {
+			return (false);
 		}
-		else if (filetype == OsUtil::RegularFile) {
-			if (MediaUtil::isMediaFileExtension (OsUtil::getPathExtension (path))) {
-				destList->push_back (path);
+		Log::debug ("Media file moved; mediaId=%s oldPath=\"%s\" path=\"%s\"", i1->mediaId.c_str (), oldpath.c_str (), entry.path.c_str ());
+		return (true);
+	}
+	return (false);
+}
+bool MediaControl::matchMovedFileEntry (const MediaItem &item, std::list<FileWalker::Entry> *entries) {
+	std::list<FileWalker::Entry>::iterator i1, i2;
+	StdString name;
+
+	name = OsUtil::getPathBasename (item.mediaPath);
+	i1 = entries->begin ();
+	i2 = entries->end ();
+	while (i1 != i2) {
+		if (i1->size == item.mediaFileSize) {
+			if (item.fingerprint.empty ()) {
+				if (OsUtil::getPathBasename (i1->path).equals (name)) {
+					return (true);
+				}
+			}
+			else {
+				if (i1->fingerprint.empty ()) {
+					i1->fingerprint = OsUtil::getFileFingerprint (i1->path);
+				}
+				if (i1->fingerprint.equals (item.fingerprint)) {
+					return (true);
+				}
 			}
 		}
+		++i1;
 	}
+	return (false);
+}
+bool MediaControl::matchMediaFileName (void *data, const StdString &fileName) {
+	return (MediaUtil::isMediaFileExtension (OsUtil::getPathExtension (fileName)));
 }
 OpResult MediaControl::executeScanMediaFiles_processFile (std::list<MediaItem>::iterator item, StdString *errorMessage) {
 	MediaReader reader;
@@ -966,6 +1234,9 @@ OpResult MediaControl::executeScanMediaFiles_writeThumbnailImages (std::list<Med
 			}
 			item->thumbnailTimestamps.push_back (reader.videoFrameTimestamp);
 			++imagecount;
+			lockStatus ();
+			++(taskStats.thumbnailCount);
+			unlockStatus ();
 		}
 
 		lockStatus ();
@@ -977,6 +1248,112 @@ OpResult MediaControl::executeScanMediaFiles_writeThumbnailImages (std::list<Med
 	return (OpResult::Success);
 }
 
+void MediaControl::startWatch () {
+	OpResult result;
+
+	if (! isWatchEnabled) {
+		return;
+	}
+	SDL_LockMutex (watchMutex);
+	watchUpdatePaths.clear ();
+	watchRemovePaths.clear ();
+	watchScanDirectoryPaths.clear ();
+	SDL_UnlockMutex (watchMutex);
+	isWatchLimitNotified = false;
+	watcher->fileMatchFn = MediaControl::matchMediaFileName;
+	result = watcher->start (mediaSourcePath);
+	if ((result != OpResult::Success) && (result != OpResult::NotImplementedError)) {
+		Log::debug ("Failed to start media watch; err=%i", result);
+	}
+}
+void MediaControl::updateMediaFiles (void *itPtr) {
+	MediaControl *it = (MediaControl *) itPtr;
+
+	it->executeUpdateMediaFiles ();
+}
+void MediaControl::executeUpdateMediaFiles () {
+	FileWalker walker;
+	StringList updatepaths, removepaths, scanpaths, removeids;
+	StringList::const_iterator i1, i2;
+	std::list<FileWalker::Entry> entries;
+	FileWalker::Entry entry;
+	MediaItem item;
+	StdString errmsg, sql, path;
+	OpResult result;
+	int recordcount;
+
+	SDL_LockMutex (watchMutex);
+	updatepaths.swap (watchUpdatePaths);
+	removepaths.swap (watchRemovePaths);
+	scanpaths.swap (watchScanDirectoryPaths);
+	SDL_UnlockMutex (watchMutex);
+
+	if (! scanpaths.empty ()) {
+		walker.fileMatchFn = MediaControl::matchMediaFileName;
+		walker.cancelFlag = &isTaskCancelled;
+		walker.walk (scanpaths, &entries);
+	}
+	i1 = updatepaths.cbegin ();
+	i2 = updatepaths.cend ();
+	while (i1 != i2) {
+		if (FileWalker::readEntry (*i1, &entry)) {
+			entries.push_back (entry);
+		}
+		++i1;
+	}
+
+	i1 = removepaths.cbegin ();
+	i2 = removepaths.cend ();
+	while (i1 != i2) {
+		if (isTaskCancelled) {
+			break;
+		}
+		path = *i1;
+		++i1;
+		if (OsUtil::fileExists (path)) {
+			continue;
+		}
+		if (! item.readDatabaseMediaPathRow (databasePath, &errmsg, path)) {
+			continue;
+		}
+		if (MediaControl::matchMovedFileEntry (item, &entries)) {
+			// Keep the record for the scan below to update with its new path
+			continue;
+		}
+		sql = MediaItem::getDeleteSql (item.mediaId);
+		result = Database::instance->exec (databasePath, sql, &errmsg);
+		if (result != OpResult::Success) {
+			Log::debug ("Failed to remove media record; path=\"%s\" err=\"%s\"", path.c_str (), errmsg.c_str ());
+			continue;
+		}
+		removeids.push_back (item.mediaId);
+		path = OsUtil::getJoinedPath (dataPath, item.mediaId);
+		if (OsUtil::directoryExists (path)) {
+			result = OsUtil::removeDirectory (path, true);
+			if (result != OpResult::Success) {
+				Log::debug ("Failed to remove data directory; path=\"%s\"", path.c_str ());
+			}
+		}
+	}
+	if (! removeids.empty ()) {
+		addRemovedMediaIds (removeids);
+	}
+	if (isTaskCancelled) {
+		endTask (MediaControl::UpdateTask, UiText::instance->getText (UiTextId::ScanCancelled).capitalized ());
+		return;
+	}
+
+	recordcount = MediaItem::countDatabaseRecords (databasePath, &errmsg);
+	if (recordcount < 0) {
+		endTask (MediaControl::UpdateTask, UiText::instance->getText (UiTextId::MediaScanFailed).capitalized (), UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString (), errmsg.c_str ());
+		return;
+	}
+	lockStatus ();
+	status.mediaCount = recordcount;
+	unlockStatus ();
+	executeScanMediaFiles_processEntries (MediaControl::UpdateTask, entries, walker.errorPaths, recordcount);
+}
+
 void MediaControl::clean () {
 	runTask (MediaControl::CleanTask);
 }
@@ -988,62 +1365,109 @@ void MediaControl::cleanMediaData (void *itPtr) {
 void MediaControl::executeCleanMediaData () {
 	OpResult result;
 	StdString errmsg;
+	std::set<StdString> recordids;
 	int recordcount;
-	int64_t filesize;
+	int64_t filesize, recordfilesize;
 
 	UiLog::instance->write (0, "%s", UiText::instance->getText (UiTextId::BeginMediaDataClean).capitalized ().c_str ());
-	result = executeCleanMediaData_removeRecords (&recordcount, &errmsg);
+	result = executeCleanMediaData_removeRecords (&recordcount, &recordfilesize, &recordids, &errmsg);
 	if (result != OpResult::Success) {
 		endTask (MediaControl::CleanTask, UiText::instance->getText (UiTextId::CleanFailed).capitalized (), UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("%s: %s", UiText::instance->getText (UiTextId::CleanFailed).capitalized ().c_str (), UiText::instance->getText (UiTextId::InternalApplicationError).capitalized ().c_str ()), errmsg.c_str ());
 		return;
 	}
-	result = executeCleanMediaData_removeFiles (&filesize, &errmsg);
-	if (result != OpResult::Success) {
-		endTask (MediaControl::CleanTask, UiText::instance->getText (UiTextId::CleanFailed).capitalized (), UiText::instance->getText (UiTextId::FileOperationError).capitalized (), StdString::createSprintf ("%s: %s", UiText::instance->getText (UiTextId::CleanFailed).capitalized ().c_str (), UiText::instance->getText (UiTextId::FileOperationError).capitalized ().c_str ()), errmsg.c_str ());
-		return;
+	filesize = 0;
+	if (! isTaskCancelled) {
+		result = executeCleanMediaData_removeFiles (recordids, &filesize, &errmsg);
+		if (result != OpResult::Success) {
+			endTask (MediaControl::CleanTask, UiText::instance->getText (UiTextId::CleanFailed).capitalized (), UiText::instance->getText (UiTextId::FileOperationError).capitalized (), StdString::createSprintf ("%s: %s", UiText::instance->getText (UiTextId::CleanFailed).capitalized ().c_str (), UiText::instance->getText (UiTextId::FileOperationError).capitalized ().c_str ()), errmsg.c_str ());
+			return;
+		}
 	}
+	filesize += recordfilesize;
+	lockStatus ();
+	taskStats.removedRecordCount += recordcount;
+	taskStats.removedFileBytes += filesize;
+	unlockStatus ();
 	endTask (MediaControl::CleanTask, UiText::instance->getText (UiTextId::CleanComplete).capitalized (), UiText::instance->getCountText (recordcount, UiTextId::MediaRecordRemoved, UiTextId::MediaRecordsRemoved), StdString::createSprintf ("%s: %s, %s %s", UiText::instance->getText (UiTextId::EndMediaDataClean).capitalized ().c_str (), UiText::instance->getCountText (recordcount, UiTextId::MediaRecordRemoved, UiTextId::MediaRecordsRemoved).c_str (), UiText::instance->getByteCountText (filesize).c_str (), UiText::instance->getText (UiTextId::Freed).c_str ()));
 }
-OpResult MediaControl::executeCleanMediaData_removeRecords (int *removedRecordCount, StdString *errorMessage) {
-	constexpr const int pageSize = 64;
-	std::list<MediaItem> items;
-	std::list<MediaItem>::const_iterator i1, i2;
-	StringList removeids;
-	StringList::const_iterator j1, j2;
-	StdString sql;
+OpResult MediaControl::executeCleanMediaData_removeRecords (int *removedRecordCount, int64_t *removedFileSize, std::set<StdString> *recordIds, StdString *errorMessage) {
+	StringList rows, removeids;
+	StringList::const_iterator i1, i2;
+	std::vector<StdString> ids, paths;
+	std::vector<char> exists;
+	StdString lastid, sql;
 	OpResult result;
-	int offset, removecount, recordcount;
+	int i, count, readcount, removecount, recordcount;
+	int64_t removesize;
 
-	offset = 0;
+	recordcount = MediaItem::countDatabaseRecords (databasePath, errorMessage);
+	if (recordcount < 0) {
+		return (OpResult::SqliteOperationFailedError);
+	}
+	recordIds->clear ();
+	readcount = 0;
 	removecount = 0;
-	while (true) {
-		if (! MediaItem::readDatabaseRows (databasePath, errorMessage, &items, StdString (), offset, pageSize)) {
+	removesize = 0;
+	while (! isTaskCancelled) {
+		if (! MediaItem::readDatabasePathRows (databasePath, errorMessage, &rows, lastid, cleanBatchSize)) {
 			return (OpResult::SqliteOperationFailedError);
 		}
-		if (items.empty ()) {
+		if (rows.empty ()) {
 			break;
 		}
-		i1 = items.cbegin ();
-		i2 = items.cend ();
+		ids.clear ();
+		paths.clear ();
+		i1 = rows.cbegin ();
+		i2 = rows.cend ();
 		while (i1 != i2) {
-			if (! OsUtil::fileExists (i1->mediaPath)) {
-				removeids.push_back (i1->mediaId);
+			ids.push_back (*i1);
+			++i1;
+			if (i1 == i2) {
+				break;
 			}
+			paths.push_back (*i1);
 			++i1;
 		}
-		offset += (int) items.size ();
-	}
+		lastid.assign (ids.back ());
+		MediaControl::probeCleanPaths (paths, &exists);
+
+		removeids.clear ();
+		count = (int) ids.size ();
+		for (i = 0; i < count; ++i) {
+			if (exists[i]) {
+				recordIds->insert (ids[i]);
+			}
+			else {
+				removeids.push_back (ids[i]);
+			}
+		}
+		if (! removeids.empty ()) {
+			sql = MediaItem::getDeleteSql (removeids);
+			result = Database::instance->exec (databasePath, sql, errorMessage);
+			if (result != OpResult::Success) {
+				return (result);
+			}
+			removecount += (int) removeids.size ();
+			addRemovedMediaIds (removeids);
+			i1 = removeids.cbegin ();
+			i2 = removeids.cend ();
+			while (i1 != i2) {
+				result = executeCleanMediaData_removeDataDirectory (*i1, &removesize, errorMessage);
+				if (result != OpResult::Success) {
+					return (result);
+				}
+				++i1;
+			}
+		}
 
-	j1 = removeids.cbegin ();
-	j2 = removeids.cend ();
-	while (j1 != j2) {
-		sql = MediaItem::getDeleteSql (*j1);
-		result = Database::instance->exec (databasePath, sql, errorMessage);
-		if (result != OpResult::Success) {
-			return (result);
+		readcount += count;
+		lockStatus ();
+		status.mediaCount = recordcount - removecount;
+		status.taskText2.sprintf ("(%i/%i)", readcount, recordcount);
+		if (recordcount > 0) {
+			status.taskProgressPercent = ((double) readcount) * 100.0f / ((double) recordcount);
 		}
-		++removecount;
-		++j1;
+		unlockStatus ();
 	}
 
 	recordcount = MediaItem::countDatabaseRecords (databasePath, errorMessage);
@@ -1056,15 +1480,18 @@ OpResult MediaControl::executeCleanMediaData_removeRecords (int *removedRecordCo
 	if (removedRecordCount) {
 		*removedRecordCount = removecount;
 	}
+	if (removedFileSize) {
+		*removedFileSize = removesize;
+	}
 	return (OpResult::Success);
 }
-OpResult MediaControl::executeCleanMediaData_removeFiles (int64_t *removedFileSize, StdString *errorMessage) {
+OpResult MediaControl::executeCleanMediaData_removeFiles (const std::set<StdString> &recordIds, int64_t *removedFileSize, StdString *errorMessage) {
 	OpResult result;
 	StringList files;
 	StringList::const_iterator i1, i2;
 	MediaItem item;
 	StdString id, path;
-	int64_t removesize, filesize;
+	int64_t removesize;
 
 	result = OsUtil::readDirectory (dataPath, &files);
 	if (result != OpResult::Success) {
@@ -1077,7 +1504,10 @@ OpResult MediaControl::executeCleanMediaData_removeFiles (int64_t *removedFileSi
 	while (i1 != i2) {
 		id = *i1;
 		++i1;
-		if ((! id.isUuid ()) || (RecordStore::instance->getRecordIdCommand (id) != SystemInterface::CommandId_MediaItem)) {
+		if (isTaskCancelled) {
+			break;
+		}
+		if ((! id.isUuid ()) || (recordIds.count (id) > 0) || (RecordStore::instance->getRecordIdCommand (id) != SystemInterface::CommandId_MediaItem)) {
 			continue;
 		}
 		path = OsUtil::getJoinedPath (dataPath, id);
@@ -1090,13 +1520,8 @@ OpResult MediaControl::executeCleanMediaData_removeFiles (int64_t *removedFileSi
 		if (! errorMessage->empty ()) {
 			return (OpResult::SqliteOperationFailedError);
 		}
-		filesize = OsUtil::getDirectorySize (path);
-		if (filesize > 0) {
-			removesize += filesize;
-		}
-		result = OsUtil::removeDirectory (path, true);
+		result = executeCleanMediaData_removeDataDirectory (id, &removesize, errorMessage);
 		if (result != OpResult::Success) {
-			errorMessage->sprintf ("Failed to remove directory; path=\"%s\" result=%i", path.c_str (), result);
 			return (result);
 		}
 	}
@@ -1105,3 +1530,93 @@ OpResult MediaControl::executeCleanMediaData_removeFiles (int64_t *removedFileSi
 	}
 	return (OpResult::Success);
 }
+OpResult MediaControl::executeCleanMediaData_removeDataDirectory (const StdString &mediaId, int64_t *removedFileSize, StdString *errorMessage) {
+	OpResult result;
+	StdString path;
+	int64_t filesize;
+
+	path = OsUtil::getJoinedPath (dataPath, mediaId);
+	if (OsUtil::getFileType (path) != OsUtil::DirectoryFile) {
+		return (OpResult::Success);
+	}
+	filesize = OsUtil::getDirectorySize (path);
+	result = OsUtil::removeDirectory (path, true);
+	if (result != OpResult::Success) {
+		errorMessage->sprintf ("Failed to remove directory; path=\"%s\" result=%i", path.c_str (), result);
+		return (result);
+	}
+	if ((filesize > 0) && removedFileSize) {
+		*removedFileSize += filesize;
+	}
+	return (OpResult::Success);
+}
+
+void MediaControl::probeCleanPaths (const std::vector<StdString> &paths, std::vector<char> *existsFlags) {
+	MediaControl::CleanProbeContext *ctx;
+	int i, count;
+
+	existsFlags->assign (paths.size (), 0);
+	if (paths.empty ()) {
+		return;
+	}
+	// A probe task that starts after the caller has claimed every path finds no work and only releases its reference, so the caller never waits on queued tasks that have not yet been scheduled
+	ctx = new MediaControl::CleanProbeContext ();
+	ctx->paths = &paths;
+	ctx->existsFlags = existsFlags;
+	ctx->pathCount = (int) paths.size ();
+	SdlUtil::createMutex (&(ctx->completeMutex));
+	SdlUtil::createCond (&(ctx->completeCond));
+	count = ctx->pathCount / cleanProbeMinPathsPerThread;
+	if (count > cleanProbeThreadCount) {
+		count = cleanProbeThreadCount;
+	}
+	for (i = 0; i < count; ++i) {
+		++(ctx->refcount);
+		if (! TaskGroup::instance->run (TaskGroup::RunContext (MediaControl::runCleanProbe, ctx))) {
+			--(ctx->refcount);
+			break;
+		}
+	}
+	MediaControl::executeCleanProbe (ctx);
+	SDL_LockMutex (ctx->completeMutex);
+	while (ctx->completeCount < ctx->pathCount) {
+		SDL_CondWait (ctx->completeCond, ctx->completeMutex);
+	}
+	SDL_UnlockMutex (ctx->completeMutex);
+	MediaControl::releaseCleanProbe (ctx);
+}
+void MediaControl::runCleanProbe (void *contextPtr) {
+	MediaControl::CleanProbeContext *ctx;
+
+	ctx = (MediaControl::CleanProbeContext *) contextPtr;
+	MediaControl::executeCleanProbe (ctx);
+	MediaControl::releaseCleanProbe (ctx);
+}
+void MediaControl::executeCleanProbe (MediaControl::CleanProbeContext *ctx) {
+	int i;
+	char exists;
+
+	while (true) {
+		i = ctx->nextIndex.fetch_add (1);
+		if (i >= ctx->pathCount) {
+			break;
+		}
+		// A record with no mediaPath is skipped by the clean rather than removed
+		exists = (ctx->paths->at (i).empty () || OsUtil::fileExists (ctx->paths->at (i))) ? 1 : 0;
+		SDL_LockMutex (ctx->completeMutex);
+		(*(ctx->existsFlags))[i] = exists;
+		++(ctx->completeCount);
+		if (ctx->completeCount >= ctx->pathCount) {
+			SDL_CondBroadcast (ctx->completeCond);
+		}
+		SDL_UnlockMutex (ctx->completeMutex);
+	}
+}
+void MediaControl::releaseCleanProbe (MediaControl::CleanProbeContext *ctx) {
+	if (ctx->refcount.fetch_sub (1) > 1) {
+		return;
+	}
+	SdlUtil::destroyCond (&(ctx->completeCond));
+	SdlUtil::destroyMutex (&(ctx->completeMutex));
+	delete (ctx);
+}
@@ -34,10 +34,13 @@
 #ifndef MEDIA_CONTROL_H
 #define MEDIA_CONTROL_H
 
+#include <atomic>
 #include "StringList.h"
+#include "FileWalker.h"
 
 class MediaItem;
 class MediaReader;
+class MediaWatcher;
 
 class MediaControl {
 public:
@@ -64,6 +67,7 @@ public:
 	static constexpr const int ScanTask = 3;
 	static constexpr const int CleanTask = 4;
 	static constexpr const int ConfigureTask = 5;
+	static constexpr const int UpdateTask = 6;
 
 	// Configuration values for mediaThumbnailCount
 	static constexpr const int MediaThumbnailEveryHour = 0;
@@ -77,6 +81,9 @@ public:
 	static constexpr const int mediaThumbnailValuesCount = 8;
 	static constexpr const int defaultMediaThumbnailCount = MediaThumbnailDivide12;
 
+	// Read-write data members
+	bool isWatchEnabled; // If false, media source paths are not watched for file changes after the media control becomes ready
+
 	// Read-only data members
 	bool isStopped;
 	bool isReady;
@@ -102,6 +109,9 @@ public:
 	// Run a task to change the media control configuration
 	void configure (const StringList &mediaSourcePathValue, const StdString &dataPathValue, int mediaThumbnailCountValue);
 
+	// Set configuration values without storing them in application prefs, and run a task to open the media database. This method is used in place of start for batch operations that run without the application window.
+	void configureBatch (const StringList &mediaSourcePathValue, const StdString &dataPathValue, int mediaThumbnailCountValue);
+
 	// Return true if provided fields match the current media control configuration
 	bool matchConfiguration (const StringList &mediaSourcePathValue, const StdString &dataPathValue, int mediaThumbnailCountValue);
 
@@ -111,6 +121,9 @@ public:
 	// Run a task to clean unused media data
 	void clean ();
 
+	// Start watching media source paths for file changes, replacing any previous watch. Changed files are processed by an update task without a full scan.
+	void startWatch ();
+
 	// Return the path value for the specified thumbnail image file
 	StdString getThumbnailPath (const StdString &mediaId, int64_t thumbnailTimestamp);
 
@@ -136,6 +149,24 @@ public:
 			isTaskRunning (false),
 			taskProgressPercent (-1.0f) { }
 	};
+	struct TaskStats {
+		int scanFileCount;
+		int scanErrorCount;
+		int thumbnailCount;
+		int64_t scanReadBytes;
+		int removedRecordCount;
+		int64_t removedFileBytes;
+		int failedTaskCount;
+		TaskStats ():
+			scanFileCount (0),
+			scanErrorCount (0),
+			thumbnailCount (0),
+			scanReadBytes (0),
+			removedRecordCount (0),
+			removedFileBytes (0),
+			failedTaskCount (0) { }
+	};
+
 	struct TaskResult {
 		StdString text1;
 		StdString text2;
@@ -153,11 +184,24 @@ public:
 	// Clear task result fields of the specified type
 	void clearTaskResult (int taskType);
 
+	// Copy counts accumulated by scan and clean tasks into destStats
+	void getTaskStats (MediaControl::TaskStats *destStats);
+
 	// Return true if a task matching taskType has been queued
 	bool isRunningTask (int taskType);
 
+	// Return the number of MediaItem database records matching searchKey, or -1 if a database error occurred. Count values are cached for each searchKey until the next change to the status update count.
+	int countMediaItems (const StdString &searchKey, StdString *errorMessage = NULL);
+
+	// Insert ID values of MediaItem records removed by media control tasks after removeCount into destList, clearing the list before doing so, and store the current remove count in removeCount. If removeCount is negative, only the current remove count is stored. Returns false if the list of removed ID values no longer holds all records removed after removeCount, in which case the caller should reload any MediaItem records it holds.
+	bool readRemovedMediaIds (int64_t *removeCount, StringList *destList);
+
+	// Clear media counts cached by countMediaItems. Callers that modify MediaItem records outside of media control tasks, such as tag edits, must invoke this method after the write completes.
+	void clearMediaCountCache ();
+
 private:
 	MediaControl::Status status;
+	MediaControl::TaskStats taskStats;
 	std::map<int, MediaControl::TaskResult> taskResultMap;
 	SDL_mutex *statusMutex;
 	StdString primeMediaSourcePath;
@@ -165,6 +209,20 @@ private:
 	StringList configureMediaSourcePath;
 	StdString configureDataPath;
 	int configureMediaThumbnailCount;
+	MediaWatcher *watcher;
+	StringList watchUpdatePaths;
+	StringList watchRemovePaths;
+	StringList watchScanDirectoryPaths;
+	SDL_mutex *watchMutex;
+	StringList removedMediaIds;
+	int64_t removedMediaIdCount;
+	bool isWatchLimitNotified;
+	bool isWatchCleanPending;
+	int64_t lastWatchLimitScanTime;
+	std::map<StdString, int> mediaCountCache;
+	int mediaCountCacheUpdateCount;
+	int mediaCountCacheClearCount;
+	SDL_mutex *mediaCountCacheMutex;
 
 	// Open the media control's database connection and return a Result value
 	OpResult openDatabase ();
@@ -175,9 +233,15 @@ private:
 	// Unlock the status object and increase the update count
 	void unlockStatus ();
 
+	// FileWalker match function that selects files with a media file extension
+	static bool matchMediaFileName (void *data, const StdString &fileName);
+
 	// Set ended state after a task completes
 	void endTask (int taskType, const StdString &resultText1, const StdString &resultText2 = StdString (), const StdString &uiLogMessage = StdString (), const char *logErrorMessage = NULL);
 
+	// Add ID values of MediaItem records removed from the database, for consumers of readRemovedMediaIds
+	void addRemovedMediaIds (const StringList &mediaIds);
+
 	struct Task {
 		int taskType;
 		bool isRunning;
@@ -193,7 +257,7 @@ private:
 	};
 	std::list<MediaControl::Task> taskList;
 	SDL_mutex *taskListMutex;
-	bool isTaskCancelled;
+	std::atomic<bool> isTaskCancelled;
 
 	// Task functions
 	static void applyPrimeSettings (void *itPtr);
@@ -207,13 +271,48 @@ private:
 
 	static void scanMediaFiles (void *itPtr);
 	void executeScanMediaFiles ();
-	void executeScanMediaFiles_readDirectory (const StdString &scanPath, StringList *destList);
+	void executeScanMediaFiles_processEntries (int taskType, const std::list<FileWalker::Entry> &entries, const StringList &errorPaths, int recordCount);
 	OpResult executeScanMediaFiles_processFile (std::list<MediaItem>::iterator item, StdString *errorMessage);
 	OpResult executeScanMediaFiles_writeThumbnailImages (std::list<MediaItem>::iterator item, StdString *errorMessage, const MediaReader &metadataReader);
 
+	// Find a record for a media file that was moved or renamed to the path in entry, and update the record's path fields to match. Records are matched by content fingerprint, and by name and size for records stored without a fingerprint whose old directory is still readable. Returns true if a moved record was found and updated, keeping its mediaId, tags, markers, and thumbnails.
+	bool executeScanMediaFiles_moveRecord (const FileWalker::Entry &entry, const StdString &fingerprint, StdString *errorMessage);
+
+	// Return true if a file in entries appears to hold the content of item's media file after a move, storing any fingerprint computed for the comparison in the matching entry
+	static bool matchMovedFileEntry (const MediaItem &item, std::list<FileWalker::Entry> *entries);
+
+	static void updateMediaFiles (void *itPtr);
+	void executeUpdateMediaFiles ();
+
 	static void cleanMediaData (void *itPtr);
 	void executeCleanMediaData ();
-	OpResult executeCleanMediaData_removeRecords (int *removedRecordCount, StdString *errorMessage);
-	OpResult executeCleanMediaData_removeFiles (int64_t *removedFileSize, StdString *errorMessage);
+	OpResult executeCleanMediaData_removeRecords (int *removedRecordCount, int64_t *removedFileSize, std::set<StdString> *recordIds, StdString *errorMessage);
+	OpResult executeCleanMediaData_removeFiles (const std::set<StdString> &recordIds, int64_t *removedFileSize, StdString *errorMessage);
+	OpResult executeCleanMediaData_removeDataDirectory (const StdString &mediaId, int64_t *removedFileSize, StdString *errorMessage);
+
+	struct CleanProbeContext {
+		const std::vector<StdString> *paths;
+		std::vector<char> *existsFlags;
+		int pathCount;
+		std::atomic<int> nextIndex;
+		int completeCount;
+		std::atomic<int> refcount;
+		SDL_mutex *completeMutex;
+		SDL_cond *completeCond;
+		CleanProbeContext ():
+			paths (NULL),
+			existsFlags (NULL),
+			pathCount (0),
+			nextIndex (0),
+			completeCount (0),
+			refcount (1),
+			completeMutex (NULL),
+			completeCond (NULL) { }
+	};
+	// Set existsFlags to indicate which items in paths name an existing file, checking paths with a bounded set of TaskGroup tasks
+	static void probeCleanPaths (const std::vector<StdString> &paths, std::vector<char> *existsFlags);
+	static void runCleanProbe (void *contextPtr);
+	static void executeCleanProbe (MediaControl::CleanProbeContext *ctx);
+	static void releaseCleanProbe (MediaControl::CleanProbeContext *ctx);
 };
 #endif
@@ -50,6 +50,7 @@ constexpr const int FindWait = 3;
 
 MediaControlSearch::MediaControlSearch ()
 : MediaSearch ()
+, removedMediaIdCount (-1)
 {
 }
 MediaControlSearch::~MediaControlSearch () {
@@ -57,6 +58,7 @@ MediaControlSearch::~MediaControlSearch () {
 
 void MediaControlSearch::update (int msElapsed) {
 	MediaControl::Status status;
+	StringList removedids;
 
 	switch (stage) {
 		case Uninitialized: {
@@ -87,12 +89,17 @@ void MediaControlSearch::update (int msElapsed) {
 			else if (shouldAdvanceSearch) {
 				shouldAdvanceSearch = false;
 				isLoading = true;
-				resultOffset += pageSize;
 				stage = FindWait;
 				retain ();
 				TaskGroup::instance->run (TaskGroup::RunContext (MediaControlSearch::findMediaItems, this));
 			}
 			else {
+				if (! MediaControl::instance->readRemovedMediaIds (&removedMediaIdCount, &removedids)) {
+					shouldReloadSearch = true;
+				}
+				else if (! removedids.empty ()) {
+					removeDeletedRecords (removedids);
+				}
 				MediaControl::instance->getStatus (&status);
 				if (status.mediaCount >= 0) {
 					mediaAvailableCount = status.mediaCount;
@@ -104,11 +111,13 @@ void MediaControlSearch::update (int msElapsed) {
 			searchKey.assign (nextSearchKey);
 			sortOrder = nextSortOrder;
 			isLoading = true;
-			resultOffset = 0;
+			seekItem.clear ();
 			setSize = 0;
 			isFindComplete = false;
 			shouldAdvanceSearch = false;
 			searchReceiveCount = 0;
+			removedMediaIdCount = -1;
+			MediaControl::instance->readRemovedMediaIds (&removedMediaIdCount, &removedids);
 			stage = FindWait;
 			retain ();
 			TaskGroup::instance->run (TaskGroup::RunContext (MediaControlSearch::findMediaItems, this));
@@ -142,24 +151,24 @@ void MediaControlSearch::findMediaItems (void *itPtr) {
 void MediaControlSearch::executeFindMediaItems () {
 	StdString errmsg;
 	std::list<MediaItem>::const_iterator i1, i2;
-	Json *record;
 
 	foundRecordIds.clear ();
 	mediaItemList.clear ();
-	setSize = MediaItem::countDatabaseRecords (MediaControl::instance->databasePath, &errmsg, searchKey);
+	setSize = MediaControl::instance->countMediaItems (searchKey, &errmsg);
 	if (setSize < 0) {
 		return;
 	}
 	if (setSize > 0) {
-		if (! MediaItem::readDatabaseRows (MediaControl::instance->databasePath, &errmsg, &mediaItemList, searchKey, resultOffset, pageSize, sortOrder)) {
+		if (! MediaItem::readDatabaseSeekRows (MediaControl::instance->databasePath, &errmsg, &mediaItemList, seekItem.mediaId.empty () ? NULL : &seekItem, searchKey, pageSize, sortOrder)) {
 			return;
 		}
+		if (! mediaItemList.empty ()) {
+			seekItem.copyValues (mediaItemList.back ());
+		}
 		i1 = mediaItemList.cbegin ();
 		i2 = mediaItemList.cend ();
 		while (i1 != i2) {
-			record = i1->createRecord (agentId);
-			RecordStore::instance->insert (record, true);
-			delete (record);
+			RecordStore::instance->insertMediaItem (*i1, agentId, true);
 			foundRecordIds.push_back (i1->mediaId);
 			insertedRecordIds.push_back (i1->mediaId);
 			++searchReceiveCount;
@@ -170,6 +179,37 @@ void MediaControlSearch::executeFindMediaItems () {
 	lastStatusUpdateTime = OsUtil::getTime ();
 }
 
+void MediaControlSearch::removeDeletedRecords (const StringList &mediaIds) {
+	StringList::const_iterator i1, i2;
+	int count;
+
+	eventRecordIds.clear ();
+	i1 = mediaIds.cbegin ();
+	i2 = mediaIds.cend ();
+	while (i1 != i2) {
+		if (insertedRecordIds.contains (*i1)) {
+			insertedRecordIds.remove (*i1);
+			eventRecordIds.push_back (*i1);
+		}
+		++i1;
+	}
+	if (eventRecordIds.empty ()) {
+		return;
+	}
+	eventCallback (removeRecordsCallback);
+	RecordStore::instance->remove (eventRecordIds);
+	count = (int) eventRecordIds.size ();
+	setSize -= count;
+	if (setSize < 0) {
+		setSize = 0;
+	}
+	searchReceiveCount -= count;
+	if (searchReceiveCount < 0) {
+		searchReceiveCount = 0;
+	}
+	eventRecordIds.clear ();
+}
+
 void MediaControlSearch::doResetSearch (const StdString &searchKeyValue, int sortOrderValue) {
 	nextSearchKey.assign (searchKeyValue);
 	nextSortOrder = sortOrderValue;
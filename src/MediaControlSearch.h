@@ -34,6 +34,7 @@
 #ifndef MEDIA_CONTROL_SEARCH_H
 #define MEDIA_CONTROL_SEARCH_H
 
+#include "MediaItem.h"
 #include "MediaSearch.h"
 
 class MediaControlSearch : public MediaSearch {
@@ -53,6 +54,11 @@ private:
 	static void findMediaItems (void *itPtr);
 	void executeFindMediaItems ();
 
+	// Remove any records listed in mediaIds from the search results, as needed after media control tasks delete them
+	void removeDeletedRecords (const StringList &mediaIds);
+
 	std::list<MediaItem> mediaItemList;
+	MediaItem seekItem;
+	int64_t removedMediaIdCount;
 };
 #endif
@@ -35,14 +35,17 @@
 #include "Json.h"
 #include "SystemInterface.h"
 #include "RecordStore.h"
+#include "SharedMediaItem.h"
 #include "Database.h"
 #include "MediaReader.h"
 #include "MediaItem.h"
 
-const StdString MediaItem::createTableSql = StdString ("CREATE TABLE IF NOT EXISTS MediaItem(id TEXT PRIMARY KEY, name TEXT, mediaPath TEXT, mediaDirname TEXT, thumbnailTimestamps TEXT, mtime INTEGER, duration INTEGER, mediaFileSize INTEGER, totalBitrate INTEGER, isVideo INTEGER, isAudio INTEGER, hasAudioAlbumArt INTEGER, frameRate REAL, videoBitrate INTEGER, width INTEGER, height INTEGER, audioSampleRate INTEGER, audioChannels INTEGER, audioBitrate INTEGER, tags TEXT, sortKey TEXT); CREATE UNIQUE INDEX IF NOT EXISTS MediaItemPath ON MediaItem(mediaPath); CREATE INDEX IF NOT EXISTS MediaItemSortKey ON MediaItem(sortKey); CREATE INDEX IF NOT EXISTS MediaItemDirname ON MediaItem(mediaDirname); CREATE INDEX IF NOT EXISTS MediaItemMtime ON MediaItem(mtime);");
+const StdString MediaItem::createTableSql = StdString ("CREATE TABLE IF NOT EXISTS MediaItem(id TEXT PRIMARY KEY, name TEXT, mediaPath TEXT, mediaDirname TEXT, thumbnailTimestamps TEXT, mtime INTEGER, duration INTEGER, mediaFileSize INTEGER, totalBitrate INTEGER, isVideo INTEGER, isAudio INTEGER, hasAudioAlbumArt INTEGER, frameRate REAL, videoBitrate INTEGER, width INTEGER, height INTEGER, audioSampleRate INTEGER, audioChannels INTEGER, audioBitrate INTEGER, tags TEXT, sortKey TEXT, fingerprint TEXT); CREATE UNIQUE INDEX IF NOT EXISTS MediaItemPath ON MediaItem(mediaPath); DROP INDEX IF EXISTS MediaItemSortKey; DROP INDEX IF EXISTS MediaItemDirname; DROP INDEX IF EXISTS MediaItemMtime; CREATE INDEX IF NOT EXISTS MediaItemSortKeyId ON MediaItem(sortKey, id); CREATE INDEX IF NOT EXISTS MediaItemDirnameSortKeyId ON MediaItem(mediaDirname, sortKey, id); CREATE INDEX IF NOT EXISTS MediaItemMtimeId ON MediaItem(mtime, id);");
+const StdString MediaItem::addFingerprintColumnSql = StdString ("ALTER TABLE MediaItem ADD COLUMN fingerprint TEXT;");
+const StdString MediaItem::createFingerprintIndexSql = StdString ("CREATE INDEX IF NOT EXISTS MediaItemFingerprint ON MediaItem(fingerprint); CREATE INDEX IF NOT EXISTS MediaItemNameSize ON MediaItem(name, mediaFileSize);");
 const StdString MediaItem::sortKeyCharacters = StdString ("abcdefghijklmnopqrstuvwxyz0123456789");
-constexpr const char *selectSql = "SELECT id, name, mediaPath, mediaDirname, thumbnailTimestamps, mtime, duration, mediaFileSize, totalBitrate, isVideo, isAudio, hasAudioAlbumArt, frameRate, videoBitrate, width, height, audioSampleRate, audioChannels, audioBitrate, tags, sortKey FROM MediaItem";
-constexpr const int selectColumnCount = 20;
+constexpr const char *selectSql = "SELECT id, name, mediaPath, mediaDirname, thumbnailTimestamps, mtime, duration, mediaFileSize, totalBitrate, isVideo, isAudio, hasAudioAlbumArt, frameRate, videoBitrate, width, height, audioSampleRate, audioChannels, audioBitrate, tags, sortKey, fingerprint FROM MediaItem";
+constexpr const int selectColumnCount = 21;
 
 MediaItem::MediaItem ()
 : mtime (0)
@@ -92,6 +95,7 @@ void MediaItem::clear (const StdString &mediaIdValue) {
 	thumbnailTimestamps.clear ();
 	tags.clear ();
 	sortKey.assign ("");
+	fingerprint.assign ("");
 }
 
 void MediaItem::copyValues (const MediaItem &source) {
@@ -117,6 +121,7 @@ void MediaItem::copyValues (const MediaItem &source) {
 	thumbnailTimestamps.assign (source.thumbnailTimestamps);
 	tags.assign (source.tags);
 	sortKey.assign (source.sortKey);
+	fingerprint.assign (source.fingerprint);
 }
 
 bool MediaItem::isValid () const {
@@ -205,13 +210,16 @@ bool MediaItem::readRecord (Json *record) {
 }
 
 bool MediaItem::readRecordStore (const StdString &mediaIdValue) {
-	Json record;
+	SharedMediaItem *item;
 
 	clear ();
-	if (! RecordStore::instance->find (&record, mediaIdValue, SystemInterface::CommandId_MediaItem)) {
+	item = RecordStore::instance->findMediaItem (mediaIdValue);
+	if (! item) {
 		return (false);
 	}
-	return (readRecord (&record));
+	copyValues (item->item);
+	item->release ();
+	return (isValid ());
 }
 
 bool MediaItem::readMediaReader (const MediaReader &reader) {
@@ -326,6 +334,10 @@ bool MediaItem::copyDatabaseRowValues (int columnCount, char **columnValues, cha
 	val = columnValues[i];
 	sortKey.assign (val ? val : "");
 
+	++i;
+	val = columnValues[i];
+	fingerprint.assign (val ? val : "");
+
 	return (true);
 }
 
@@ -378,15 +390,7 @@ bool MediaItem::readDatabaseRows (const StdString &databasePath, StdString *erro
 	destList->clear ();
 	sql.assign (selectSql);
 	sql.append (MediaItem::getSelectWhereSql (searchKey));
-	if (sortOrder == SystemInterface::Constant_NewestSort) {
-		sql.append (" ORDER BY mtime DESC");
-	}
-	else if (sortOrder == SystemInterface::Constant_FilePathSort) {
-		sql.append (" ORDER BY mediaDirname ASC, sortKey ASC");
-	}
-	else {
-		sql.append (" ORDER BY sortKey ASC");
-	}
+	sql.append (MediaItem::getSelectOrderSql (sortOrder));
 	if (limit > 0) {
 		sql.appendSprintf (" LIMIT %i", limit);
 		if (offset > 0) {
@@ -403,6 +407,45 @@ bool MediaItem::readDatabaseRows (const StdString &databasePath, StdString *erro
 	}
 	return (true);
 }
+bool MediaItem::readDatabaseSeekRows (const StdString &databasePath, StdString *errorMessage, std::list<MediaItem> *destList, const MediaItem *seekItem, const StdString &searchKey, int limit, int sortOrder) {
+	StdString sql, where, seek;
+	OpResult result;
+
+	destList->clear ();
+	where = MediaItem::getSelectConditionSql (searchKey);
+	if (seekItem) {
+		seek = MediaItem::getSelectSeekSql (*seekItem, sortOrder);
+	}
+	sql.assign (selectSql);
+	if ((! where.empty ()) && (! seek.empty ())) {
+		sql.append (" WHERE (");
+		sql.append (where);
+		sql.append (") AND ");
+		sql.append (seek);
+	}
+	else if (! where.empty ()) {
+		sql.append (" WHERE ");
+		sql.append (where);
+	}
+	else if (! seek.empty ()) {
+		sql.append (" WHERE ");
+		sql.append (seek);
+	}
+	sql.append (MediaItem::getSelectOrderSql (sortOrder));
+	if (limit > 0) {
+		sql.appendSprintf (" LIMIT %i", limit);
+	}
+	sql.append (";");
+	result = Database::instance->exec (databasePath, sql, errorMessage, MediaItem::readDatabaseRows_row, destList);
+	if (result != OpResult::Success) {
+		return (false);
+	}
+	if (errorMessage) {
+		errorMessage->assign ("");
+	}
+	return (true);
+}
+
 int MediaItem::readDatabaseRows_row (void *destListPtr, int columnCount, char **columnValues, char **columnNames) {
 	MediaItem item;
 
@@ -413,6 +456,68 @@ int MediaItem::readDatabaseRows_row (void *destListPtr, int columnCount, char **
 	return (0);
 }
 
+bool MediaItem::readDatabaseMovedFileRows (const StdString &databasePath, StdString *errorMessage, std::list<MediaItem> *destList, const StdString &fingerprintValue, const StdString &nameValue, int64_t mediaFileSizeValue) {
+	StdString sql;
+	OpResult result;
+
+	destList->clear ();
+	if (fingerprintValue.empty ()) {
+		return (true);
+	}
+	sql.assign (selectSql);
+	sql.append (" WHERE fingerprint=");
+	sql.append (Database::getColumnValueSql (fingerprintValue));
+	sql.append (" OR ((fingerprint IS NULL OR fingerprint='') AND name=");
+	sql.append (Database::getColumnValueSql (nameValue));
+	sql.append (" AND mediaFileSize=");
+	sql.append (Database::getColumnValueSql (mediaFileSizeValue));
+	sql.append (");");
+	result = Database::instance->exec (databasePath, sql, errorMessage, MediaItem::readDatabaseRows_row, destList);
+	if (result != OpResult::Success) {
+		return (false);
+	}
+	if (errorMessage) {
+		errorMessage->assign ("");
+	}
+	return (true);
+}
+
+bool MediaItem::readDatabasePathRows (const StdString &databasePath, StdString *errorMessage, StringList *destList, const StdString &afterMediaId, int limit) {
+	StdString sql;
+	OpResult result;
+
+	destList->clear ();
+	sql.assign ("SELECT id, mediaPath FROM MediaItem");
+	if (! afterMediaId.empty ()) {
+		sql.append (" WHERE id>");
+		sql.append (Database::getColumnValueSql (afterMediaId));
+	}
+	sql.append (" ORDER BY id");
+	if (limit > 0) {
+		sql.appendSprintf (" LIMIT %i", limit);
+	}
+	sql.append (";");
+	result = Database::instance->exec (databasePath, sql, errorMessage, MediaItem::readDatabasePathRows_row, destList);
+	if (result != OpResult::Success) {
+		return (false);
+	}
+	if (errorMessage) {
+		errorMessage->assign ("");
+	}
+	return (true);
+}
+int MediaItem::readDatabasePathRows_row (void *destListPtr, int columnCount, char **columnValues, char **columnNames) {
+	StringList *destlist;
+
+	if ((columnCount < 2) || (! columnValues[0])) {
+		return (-1);
+	}
+	destlist = (StringList *) destListPtr;
+	destlist->push_back (StdString (columnValues[0]));
+	destlist->push_back (StdString (columnValues[1] ? columnValues[1] : ""));
+	return (0);
+}
+
 bool MediaItem::readDatabaseMetadata (const StdString &databasePath, StdString *errorMessage, int64_t *mediaSizeTotal, int64_t *mediaDurationTotal) {
 	StdString sql;
 	OpResult result;
@@ -533,6 +638,8 @@ StdString MediaItem::getUpsertSql () const {
 	fields.push_back (Database::getColumnValueSql (tags.toJsonString ()));
 	fields.push_back (StdString ("sortKey"));
 	fields.push_back (Database::getColumnValueSql (sortKey));
+	fields.push_back (StdString ("fingerprint"));
+	fields.push_back (Database::getColumnValueSql (fingerprint));
 	s.assign ("INSERT INTO ");
 	s.append (Database::getRowInsertSql (StdString ("MediaItem"), fields));
 
@@ -550,6 +657,17 @@ StdString MediaItem::getUpsertSql () const {
 }
 
 StdString MediaItem::getSelectWhereSql (const StdString &searchKey) {
+	StdString sql;
+
+	sql = MediaItem::getSelectConditionSql (searchKey);
+	if (sql.empty ()) {
+		return (StdString ());
+	}
+	sql.insert (0, " WHERE ");
+	return (sql);
+}
+
+StdString MediaItem::getSelectConditionSql (const StdString &searchKey) {
 	StdString sql, key, tag, chars;
 
 	if (searchKey.empty ()) {
@@ -561,7 +679,7 @@ StdString MediaItem::getSelectWhereSql (const StdString &searchKey) {
 		if (! key.endsWith ("%")) {
 			key.append ("%");
 		}
-		sql.assign (" WHERE (mediaPath LIKE ");
+		sql.assign ("(mediaPath LIKE ");
 		sql.append (Database::getColumnValueSql (key));
 		sql.append (")");
 		return (sql);
@@ -574,7 +692,7 @@ StdString MediaItem::getSelectWhereSql (const StdString &searchKey) {
 		if (! key.endsWith ("%")) {
 			key.append ("%");
 		}
-		sql.assign (" WHERE (sortKey LIKE ");
+		sql.assign ("(sortKey LIKE ");
 		sql.append (Database::getColumnValueSql (key));
 		sql.append (") OR (tags LIKE ");
 		tag.assign ("[\"");
@@ -591,6 +709,69 @@ StdString MediaItem::getSelectWhereSql (const StdString &searchKey) {
 	return (sql);
 }
 
+StdString MediaItem::getSelectOrderSql (int sortOrder) {
+	if (sortOrder == SystemInterface::Constant_NewestSort) {
+		return (StdString (" ORDER BY mtime DESC, id DESC"));
+	}
+	if (sortOrder == SystemInterface::Constant_FilePathSort) {
+		return (StdString (" ORDER BY mediaDirname ASC, sortKey ASC, id ASC"));
+	}
+	return (StdString (" ORDER BY sortKey ASC, id ASC"));
+}
+
+StdString MediaItem::getSelectSeekSql (const MediaItem &seekItem, int sortOrder) {
+	StdString sql;
+
+	if (seekItem.mediaId.empty ()) {
+		return (StdString ());
+	}
+	if (sortOrder == SystemInterface::Constant_NewestSort) {
+		sql.assign ("((mtime, id) < (");
+		sql.append (Database::getColumnValueSql (seekItem.mtime));
+	}
+	else if (sortOrder == SystemInterface::Constant_FilePathSort) {
+		sql.assign ("((mediaDirname, sortKey, id) > (");
+		sql.append (Database::getColumnValueSql (seekItem.mediaDirname));
+		sql.append (", ");
+		sql.append (Database::getColumnValueSql (seekItem.sortKey));
+	}
+	else {
+		sql.assign ("((sortKey, id) > (");
+		sql.append (Database::getColumnValueSql (seekItem.sortKey));
+	}
+	sql.append (", ");
+	sql.append (Database::getColumnValueSql (seekItem.mediaId));
+	sql.append ("))");
+	return (sql);
+}
+
+StdString MediaItem::getUpdatePathSql () const {
+	StdString sql;
+	StringList fields;
+
+	if (mediaId.empty () || mediaPath.empty ()) {
+		return (StdString ());
+	}
+	fields.push_back (StdString ("name"));
+	fields.push_back (Database::getColumnValueSql (name));
+	fields.push_back (StdString ("mediaPath"));
+	fields.push_back (Database::getColumnValueSql (mediaPath));
+	fields.push_back (StdString ("mediaDirname"));
+	fields.push_back (Database::getColumnValueSql (mediaDirname));
+	fields.push_back (StdString ("mtime"));
+	fields.push_back (Database::getColumnValueSql (mtime));
+	fields.push_back (StdString ("sortKey"));
+	fields.push_back (Database::getColumnValueSql (sortKey));
+	fields.push_back (StdString ("fingerprint"));
+	fields.push_back (Database::getColumnValueSql (fingerprint));
+	sql.assign ("UPDATE MediaItem SET ");
+	sql.append (Database::getRowUpdateSql (fields));
+	sql.append (" WHERE id=");
+	sql.append (Database::getColumnValueSql (mediaId));
+	sql.append (";");
+	return (sql);
+}
+
 StdString MediaItem::getUpdateTagsSql (const StdString &mediaId, const StringList &tags) {
 	StdString sql;
 
@@ -616,6 +797,29 @@ StdString MediaItem::getDeleteSql (const StdString &mediaId) {
 	sql.append (";");
 	return (sql);
 }
+StdString MediaItem::getDeleteSql (const StringList &mediaIds) {
+	StringList::const_iterator i1, i2;
+	StdString sql;
+	bool first;
+
+	if (mediaIds.empty ()) {
+		return (StdString ());
+	}
+	sql.assign ("DELETE FROM MediaItem WHERE id IN (");
+	first = true;
+	i1 = mediaIds.cbegin ();
+	i2 = mediaIds.cend ();
+	while (i1 != i2) {
+		if (! first) {
+			sql.append (",");
+		}
+		first = false;
+		sql.append (Database::getColumnValueSql (*i1));
+		++i1;
+	}
+	sql.append (");");
+	return (sql);
+}
 
 StdString MediaItem::getDeleteAllSql () {
 	return (StdString ("DELETE FROM MediaItem;"));
@@ -46,6 +46,8 @@ public:
 	~MediaItem ();
 
 	static const StdString createTableSql;
+	static const StdString addFingerprintColumnSql;
+	static const StdString createFingerprintIndexSql;
 	static const StdString sortKeyCharacters;
 
 	StdString mediaId;
@@ -70,6 +72,7 @@ public:
 	Int64List thumbnailTimestamps;
 	StringList tags;
 	StdString sortKey;
+	StdString fingerprint;
 
 	// Return a string representation of the MediaItem
 	StdString toString () const;
@@ -104,6 +107,16 @@ public:
 	static bool readDatabaseRows (const StdString &databasePath, StdString *errorMessage, std::list<MediaItem> *destList, const StdString &searchKey = StdString (), int offset = 0, int limit = 0, int sortOrder = -1);
 	static int readDatabaseRows_row (void *destListPtr, int columnCount, char **columnValues, char **columnNames);
 
+	// Read MediaItem records that could hold the previous location of a moved file and add them to destList, clearing the list before doing so. Records match if their fingerprint equals fingerprintValue, or if they have no stored fingerprint and match the file's name and size. Returns true if the operation succeeded.
+	static bool readDatabaseMovedFileRows (const StdString &databasePath, StdString *errorMessage, std::list<MediaItem> *destList, const StdString &fingerprintValue, const StdString &nameValue, int64_t mediaFileSizeValue);
+
+	// Read up to limit MediaItem records that follow seekItem in sortOrder and add them to destList, clearing the list before doing so. If seekItem is NULL, read from the start of the sorted set. Unlike an offset read, the database seeks directly to the first result row by index. Returns true if the operation succeeded.
+	static bool readDatabaseSeekRows (const StdString &databasePath, StdString *errorMessage, std::list<MediaItem> *destList, const MediaItem *seekItem, const StdString &searchKey, int limit, int sortOrder);
+
+	// Read id and mediaPath values from up to limit MediaItem records with an id greater than afterMediaId, in id order, and add them to destList as consecutive id/path pairs, clearing the list before doing so. An empty afterMediaId reads from the first record, and a record with no mediaPath is added with an empty path. Returns true if the operation succeeded.
+	static bool readDatabasePathRows (const StdString &databasePath, StdString *errorMessage, StringList *destList, const StdString &afterMediaId, int limit);
+	static int readDatabasePathRows_row (void *destListPtr, int columnCount, char **columnValues, char **columnNames);
+
 	// Compute metadata fields from database records and store them into the provided pointers. Returns true if the operation succeeded.
 	static bool readDatabaseMetadata (const StdString &databasePath, StdString *errorMessage, int64_t *mediaSizeTotal, int64_t *mediaDurationTotal);
 	static int readDatabaseMetadata_row (void *int64Ptr, int columnCount, char **columnValues, char **columnNames);
@@ -114,12 +127,27 @@ public:
 	// Return an SQL SELECT WHERE clause generated from searchKey, or an empty string if no WHERE clause applies
 	static StdString getSelectWhereSql (const StdString &searchKey);
 
+	// Return an SQL condition expression generated from searchKey, or an empty string if no condition applies
+	static StdString getSelectConditionSql (const StdString &searchKey);
+
+	// Return an SQL ORDER BY clause for sortOrder, ending with an id column to provide a unique row ordering
+	static StdString getSelectOrderSql (int sortOrder);
+
+	// Return an SQL condition expression that matches records following seekItem in sortOrder, or an empty string if seekItem has no mediaId
+	static StdString getSelectSeekSql (const MediaItem &seekItem, int sortOrder);
+
+	// Return an SQL UPDATE statement that modifies a record's path, name, mtime, and fingerprint fields
+	StdString getUpdatePathSql () const;
+
 	// Return an SQL UPDATE statement that modifies a record's tags field
 	static StdString getUpdateTagsSql (const StdString &mediaId, const StringList &tags);
 
 	// Return an SQL DELETE statement targeting a record matching mediaId
 	static StdString getDeleteSql (const StdString &mediaId);
 
+	// Return an SQL DELETE statement targeting all records matching an item in mediaIds
+	static StdString getDeleteSql (const StringList &mediaIds);
+
 	// Return an SQL DELETE statement that clears all records
 	static StdString getDeleteAllSql ();
 
@@ -37,7 +37,7 @@
 #include "UiConfiguration.h"
 #include "UiText.h"
 #include "MediaUtil.h"
-#include "Json.h"
+#include "SharedMediaItem.h"
 #include "Widget.h"
 #include "Sprite.h"
 #include "SpriteId.h"
@@ -53,8 +53,8 @@
 constexpr const double windowWidthScale = 0.8f;
 constexpr const double tagTextWidthScale = 0.1f;
 
-MediaItemDetailWindow::MediaItemDetailWindow (Json *mediaItemRecord)
-: MediaItemWindow (mediaItemRecord)
+MediaItemDetailWindow::MediaItemDetailWindow (SharedMediaItem *mediaItemSnapshot)
+: MediaItemWindow (mediaItemSnapshot)
 , isControlVisible (false)
 , nameFont (UiConfiguration::BodyFont)
 {
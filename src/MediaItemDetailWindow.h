@@ -38,7 +38,7 @@
 #include "Panel.h"
 #include "MediaItemWindow.h"
 
-class Json;
+class SharedMediaItem;
 class SpriteGroup;
 class ImageWindow;
 class LabelWindow;
@@ -46,7 +46,7 @@ class Button;
 
 class MediaItemDetailWindow : public MediaItemWindow {
 public:
-	MediaItemDetailWindow (Json *mediaItemRecord);
+	MediaItemDetailWindow (SharedMediaItem *mediaItemSnapshot);
 	~MediaItemDetailWindow ();
 
 	// Return a typecasted pointer to the provided widget, or NULL if the widget does not appear to be of the correct type
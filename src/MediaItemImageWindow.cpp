@@ -35,7 +35,7 @@
 #include "ClassId.h"
 #include "UiConfiguration.h"
 #include "UiText.h"
-#include "Json.h"
+#include "SharedMediaItem.h"
 #include "Widget.h"
 #include "Color.h"
 #include "Label.h"
@@ -45,8 +45,8 @@
 #include "Button.h"
 #include "MediaItemImageWindow.h"
 
-MediaItemImageWindow::MediaItemImageWindow (Json *mediaItemRecord)
-: MediaItemWindow (mediaItemRecord)
+MediaItemImageWindow::MediaItemImageWindow (SharedMediaItem *mediaItemSnapshot)
+: MediaItemWindow (mediaItemSnapshot)
 {
 	classId = ClassId::MediaItemImageWindow;
 	setFillBg (true, Color (0.5f, 0.5f, 0.5f));
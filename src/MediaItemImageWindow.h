@@ -37,7 +37,7 @@
 #include "Widget.h"
 #include "MediaItemWindow.h"
 
-class Json;
+class SharedMediaItem;
 class SpriteGroup;
 class ImageWindow;
 class LabelWindow;
@@ -45,7 +45,7 @@ class Button;
 
 class MediaItemImageWindow : public MediaItemWindow {
 public:
-	MediaItemImageWindow (Json *mediaItemRecord);
+	MediaItemImageWindow (SharedMediaItem *mediaItemSnapshot);
 	~MediaItemImageWindow ();
 
 	// Superclass override methods
@@ -930,6 +930,7 @@ void MediaItemUi::executeAddMediaItemTag (const StdString &tag) {
 		App::instance->showNotification (UiText::instance->getText (UiTextId::MediaItemUiTagRecordUpdateError));
 		return;
 	}
+	MediaControl::instance->clearMediaCountCache ();
 	mediaItem.tags.push_back (tag);
 	storeRecord ();
 	App::instance->showNotification (UiText::instance->getText (UiTextId::MediaItemUiAddTagCompleteText));
@@ -1006,6 +1007,7 @@ void MediaItemUi::executeRemoveMediaItemTag (const StdString &tag) {
 		App::instance->showNotification (UiText::instance->getText (UiTextId::MediaItemUiTagRecordUpdateError));
 		return;
 	}
+	MediaControl::instance->clearMediaCountCache ();
 	mediaItem.tags.assign (cmdtags);
 	storeRecord ();
 	App::instance->showNotification (UiText::instance->getText (UiTextId::MediaItemUiRemoveTagCompleteText));
@@ -1014,15 +1016,12 @@ void MediaItemUi::executeRemoveMediaItemTag (const StdString &tag) {
 void MediaItemUi::storeRecord () {
 	MediaItem item;
 	StdString errmsg;
-	Json *record;
 
 	if (! item.readDatabaseMediaIdRow (MediaControl::instance->databasePath, &errmsg, mediaId)) {
 		Log::debug ("Failed to read MediaItem record; id=\"%s\" err=\"%s\"", mediaId.c_str (), errmsg.c_str ());
 		return;
 	}
-	record = item.createRecord (MediaControl::instance->agentId);
-	RecordStore::instance->insert (record);
-	delete (record);
+	RecordStore::instance->insertMediaItem (item, MediaControl::instance->agentId);
 	App::instance->shouldSyncRecordStore = true;
 }
 
@@ -39,7 +39,7 @@
 #include "UiText.h"
 #include "MediaUtil.h"
 #include "MediaControl.h"
-#include "Json.h"
+#include "SharedMediaItem.h"
 #include "Sprite.h"
 #include "SpriteId.h"
 #include "SpriteGroup.h"
@@ -52,7 +52,7 @@
 #include "TextFlow.h"
 #include "MediaItemWindow.h"
 
-MediaItemWindow::MediaItemWindow (Json *mediaItemRecord)
+MediaItemWindow::MediaItemWindow (SharedMediaItem *mediaItemSnapshot)
 : Panel ()
 , isPlayable (false)
 , isSelected (false)
@@ -62,7 +62,8 @@ MediaItemWindow::MediaItemWindow (Json *mediaItemRecord)
 	classId = ClassId::MediaItemWindow;
 
 	setFillBg (true, Color (0.5f, 0.5f, 0.5f));
-	if (! mediaItem.readRecord (mediaItemRecord)) {
+	mediaItem.copyValues (mediaItemSnapshot->item);
+	if (! mediaItem.isValid ()) {
 		mediaId.assign ("");
 	}
 	else {
@@ -39,7 +39,7 @@
 #include "MediaItem.h"
 #include "Panel.h"
 
-class Json;
+class SharedMediaItem;
 class Sprite;
 class Label;
 class LabelWindow;
@@ -48,7 +48,7 @@ class Button;
 
 class MediaItemWindow : public Panel {
 public:
-	MediaItemWindow (Json *mediaItemRecord);
+	MediaItemWindow (SharedMediaItem *mediaItemSnapshot);
 	virtual ~MediaItemWindow ();
 
 	// Return a typecasted pointer to the provided widget, or NULL if the widget does not appear to be of the correct type
@@ -83,6 +83,7 @@ MediaPlaylistWindow::MediaPlaylistWindow ()
 	setCornerRadius (UiConfiguration::instance->cornerRadius);
 	setFillBg (true, UiConfiguration::instance->mediumBackgroundColor);
 	setPaddingScale (0.5f, 0.5f);
+	setLayerCache (true);
 	windowWidth = App::instance->drawableWidth * windowWidthScale;
 
 	headerIcon = add (new Image (SpriteGroup::instance->getSprite (SpriteId::SpriteGroup_playlistIcon)));
@@ -512,7 +513,6 @@ void MediaPlaylistWindow::executeLoadRecords () {
 	StringList::const_iterator i1, i2;
 	StdString errmsg;
 	MediaItem mediaitem;
-	Json *record;
 
 	SDL_LockMutex (loadMutex);
 	ids.swap (loadIds);
@@ -521,9 +521,7 @@ void MediaPlaylistWindow::executeLoadRecords () {
 	i2 = ids.cend ();
 	while (i1 != i2) {
 		if (mediaitem.readDatabaseMediaIdRow (MediaControl::instance->databasePath, &errmsg, *i1)) {
-			record = mediaitem.createRecord (MediaControl::instance->agentId);
-			RecordStore::instance->insert (record, true);
-			delete (record);
+			RecordStore::instance->insertMediaItem (mediaitem, MediaControl::instance->agentId, true);
 
 			SDL_LockMutex (loadMutex);
 			mediaItemIds.push_back (*i1);
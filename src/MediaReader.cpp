@@ -42,7 +42,6 @@ extern "C" {
 }
 #include "SDL2/SDL_image.h"
 #include "App.h"
-#include "SdlUtil.h"
 #include "TaskGroup.h"
 #include "Resource.h"
 #include "OsUtil.h"
@@ -89,11 +88,9 @@ MediaReader::MediaReader ()
 , createTextureCallbackData (NULL)
 , writeVideoFrameJpegCallback (NULL)
 , writeVideoFrameJpegCallbackData (NULL)
-, refcount (0)
 {
 	int i;
 
-	SdlUtil::createMutex (&refcountMutex);
 	for (i = 0; i < MediaReader::imageDataPlaneCount; ++i) {
 		swsImageData[i] = NULL;
 		swsImageLineSizes[i] = 0;
@@ -102,31 +99,6 @@ MediaReader::MediaReader ()
 MediaReader::~MediaReader () {
 	clearRead ();
 	clearVideoFrame ();
-	SdlUtil::destroyMutex (&refcountMutex);
-}
-
-void MediaReader::retain () {
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
-}
-void MediaReader::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
-		delete (this);
-	}
 }
 
 void MediaReader::clearMetadata () {
@@ -689,7 +661,7 @@ void MediaReader::executeCreateTexture () {
 		return;
 	}
 	videoFrameTexturePath.sprintf ("*_MediaReader_%llx", (long long int) App::instance->getUniqueId ());
-	videoFrameTexture = Resource::instance->createTexture (videoFrameTexturePath, videoFrameScaledWidth, videoFrameScaledHeight, true);
+	videoFrameTexture = Resource::instance->createTexture (videoFrameTexturePath, videoFrameScaledWidth, videoFrameScaledHeight, true, Resource::VideoTextureCategory);
 	if (! videoFrameTexture) {
 		videoFrameTexturePath.assign ("");
 		lastErrorMessage.assign ("Failed to create texture");
@@ -34,6 +34,7 @@
 #ifndef MEDIA_READER_H
 #define MEDIA_READER_H
 
+#include "Refcounted.h"
 extern "C" {
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
@@ -42,7 +43,7 @@ extern "C" {
 }
 #include "MediaUtil.h"
 
-class MediaReader {
+class MediaReader : public Refcounted {
 public:
 	MediaReader ();
 	~MediaReader ();
@@ -73,12 +74,6 @@ public:
 	StdString writeOutputPath;
 	int jpegQuality;
 
-	// Increase the object's refcount
-	void retain ();
-
-	// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
-	void release ();
-
 	// Set the media path targeted by the reader
 	void setMediaPath (const StdString &mediaPathValue, bool isResourceMediaPathValue = false);
 
@@ -149,7 +144,5 @@ private:
 	void *createTextureCallbackData;
 	MediaReader::WriteVideoFrameJpegCallback writeVideoFrameJpegCallback;
 	void *writeVideoFrameJpegCallbackData;
-	int refcount;
-	SDL_mutex *refcountMutex;
 };
 #endif
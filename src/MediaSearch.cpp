@@ -44,48 +44,16 @@ MediaSearch::MediaSearch ()
 , mediaAvailableCount (0)
 , isLoading (false)
 , isFindComplete (false)
-, resultOffset (0)
 , setSize (0)
 , searchReceiveCount (0)
 , stage (0)
 , shouldReloadSearch (false)
 , shouldAdvanceSearch (false)
 , nextSortOrder (SystemInterface::Constant_NameSort)
-, refcountMutex (NULL)
-, refcount (0)
 {
-	refcountMutex = SDL_CreateMutex ();
 }
 MediaSearch::~MediaSearch () {
 	RecordStore::instance->remove (insertedRecordIds);
-	if (refcountMutex) {
-		SDL_DestroyMutex (refcountMutex);
-		refcountMutex = NULL;
-	}
-}
-
-void MediaSearch::retain () {
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
-}
-void MediaSearch::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
-		delete (this);
-	}
 }
 
 bool MediaSearch::eventCallback (const MediaSearch::EventCallbackContext &callback) {
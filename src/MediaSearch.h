@@ -35,10 +35,11 @@
 #define MEDIA_SEARCH_H
 
 #include "StringList.h"
+#include "Refcounted.h"
 
 class MediaItem;
 
-class MediaSearch {
+class MediaSearch : public Refcounted {
 public:
 	MediaSearch ();
 	virtual ~MediaSearch ();
@@ -71,16 +72,9 @@ public:
 	StdString searchKey;
 	bool isLoading;
 	bool isFindComplete;
-	int resultOffset;
 	int setSize;
 	int searchReceiveCount;
 
-	// Increase the object's refcount
-	void retain ();
-
-	// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
-	void release ();
-
 	// Invoke any function contained in callback and return a boolean value indicating if a function executed
 	bool eventCallback (const MediaSearch::EventCallbackContext &callback);
 
@@ -109,7 +103,5 @@ protected:
 	int nextSortOrder;
 
 private:
-	SDL_mutex *refcountMutex;
-	int refcount;
 };
 #endif
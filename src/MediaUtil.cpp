@@ -88,7 +88,7 @@ static void avLog (void *avcl, int level, const char *fmt, va_list vl) {
 			break;
 		}
 	}
-	if (! show) {
+	if ((! show) || (! Log::isWriteLevel (loglevel))) {
 		return;
 	}
 
@@ -0,0 +1,367 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#if PLATFORM_LINUX
+#include <sys/types.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <poll.h>
+#include <errno.h>
+#endif
+#include "SdlUtil.h"
+#include "OsUtil.h"
+#include "Log.h"
+#include "StringList.h"
+#include "FileWalker.h"
+#include "MediaWatcher.h"
+
+constexpr const int pollPeriod = 250;
+#if PLATFORM_LINUX
+constexpr const uint32_t watchEventMask = (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_DONT_FOLLOW);
+#endif
+
+MediaWatcher::MediaWatcher ()
+: fileMatchFn (NULL)
+, fileMatchData (NULL)
+, coalescePeriod (MediaWatcher::defaultCoalescePeriod)
+, isWatching (false)
+, watchCount (0)
+, isWatchLimitReached (false)
+, inotifyFd (-1)
+, watchThread (NULL)
+, isStopRequested (false)
+, isOverflowed (false)
+, hasRemovedDirectory (false)
+, firstEventTime (0)
+, lastEventTime (0)
+{
+	SdlUtil::createMutex (&changesMutex);
+}
+MediaWatcher::~MediaWatcher () {
+	stop ();
+	SdlUtil::destroyMutex (&changesMutex);
+}
+
+OpResult MediaWatcher::start (const StringList &rootPaths) {
+#if PLATFORM_LINUX
+	StringList::const_iterator i1, i2;
+
+	stop ();
+	isWatchLimitReached = false;
+	inotifyFd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd < 0) {
+		Log::debug ("Failed to start media watch; err=\"inotify_init1: %s\"", strerror (errno));
+		return (OpResult::SystemOperationFailedError);
+	}
+	i1 = rootPaths.cbegin ();
+	i2 = rootPaths.cend ();
+	while (i1 != i2) {
+		addWatches (*i1);
+		++i1;
+	}
+	isStopRequested = false;
+	watchThread = SDL_CreateThread (MediaWatcher::runWatch, "MediaWatcher::runWatch", (void *) this);
+	if (! watchThread) {
+		close (inotifyFd);
+		inotifyFd = -1;
+		watchPathMap.clear ();
+		return (OpResult::ThreadCreateFailedError);
+	}
+	isWatching = true;
+	Log::debug ("Start media watch; watchCount=%i isWatchLimitReached=%i", watchCount, isWatchLimitReached ? 1 : 0);
+	return (OpResult::Success);
+#else
+	return (OpResult::NotImplementedError);
+#endif
+}
+
+void MediaWatcher::stop () {
+	int result;
+
+	if (watchThread) {
+		isStopRequested = true;
+		SDL_WaitThread (watchThread, &result);
+		watchThread = NULL;
+	}
+#if PLATFORM_LINUX
+	if (inotifyFd >= 0) {
+		close (inotifyFd);
+		inotifyFd = -1;
+	}
+#endif
+	watchPathMap.clear ();
+	watchCount = 0;
+	isWatching = false;
+	SDL_LockMutex (changesMutex);
+	updatePathSet.clear ();
+	removePathSet.clear ();
+	scanDirectoryPaths.clear ();
+	isOverflowed = false;
+	hasRemovedDirectory = false;
+	firstEventTime = 0;
+	lastEventTime = 0;
+	SDL_UnlockMutex (changesMutex);
+}
+
+bool MediaWatcher::readChanges (MediaWatcher::Changes *destChanges) {
+	int64_t now;
+	bool result;
+
+	result = false;
+	now = OsUtil::getTime ();
+	SDL_LockMutex (changesMutex);
+	if ((lastEventTime > 0) && (((now - lastEventTime) >= coalescePeriod) || ((now - firstEventTime) >= MediaWatcher::maxCoalescePeriod))) {
+		destChanges->updatePaths.clear ();
+		destChanges->updatePaths.insert (destChanges->updatePaths.end (), updatePathSet.cbegin (), updatePathSet.cend ());
+		destChanges->removePaths.clear ();
+		destChanges->removePaths.insert (destChanges->removePaths.end (), removePathSet.cbegin (), removePathSet.cend ());
+		destChanges->scanDirectoryPaths.clear ();
+		destChanges->scanDirectoryPaths.swap (scanDirectoryPaths);
+		destChanges->isOverflowed = isOverflowed;
+		destChanges->hasRemovedDirectory = hasRemovedDirectory;
+		updatePathSet.clear ();
+		removePathSet.clear ();
+		isOverflowed = false;
+		hasRemovedDirectory = false;
+		firstEventTime = 0;
+		lastEventTime = 0;
+		result = true;
+	}
+	SDL_UnlockMutex (changesMutex);
+	return (result);
+}
+
+void MediaWatcher::addFileChange (const StdString &path, bool isRemoved) {
+	if (isRemoved) {
+		updatePathSet.erase (path);
+		removePathSet.insert (path);
+	}
+	else {
+		removePathSet.erase (path);
+		updatePathSet.insert (path);
+	}
+}
+
+void MediaWatcher::addWatches (const StdString &path) {
+#if PLATFORM_LINUX
+	DIR *dir;
+	struct dirent *ent;
+	StringList subdirs;
+	StringList::const_iterator i1, i2;
+	int wd;
+
+	if (isWatchLimitReached) {
+		return;
+	}
+	wd = inotify_add_watch (inotifyFd, path.c_str (), watchEventMask);
+	if (wd < 0) {
+		if ((errno == ENOSPC) || (errno == ENOMEM)) {
+			Log::warning ("Media watch limit reached, changes in unwatched directories will be found by periodic scans; watchCount=%i path=\"%s\" err=\"%s\"", watchCount, path.c_str (), strerror (errno));
+			isWatchLimitReached = true;
+		}
+		else {
+			Log::debug ("Failed to add media watch; path=\"%s\" err=\"%s\"", path.c_str (), strerror (errno));
+		}
+		return;
+	}
+	if (watchPathMap.find (wd) == watchPathMap.end ()) {
+		++watchCount;
+	}
+	watchPathMap[wd] = path;
+
+	dir = opendir (path.c_str ());
+	if (! dir) {
+		return;
+	}
+	while (true) {
+		ent = readdir (dir);
+		if (! ent) {
+			break;
+		}
+		if ((ent->d_type != DT_DIR) && (ent->d_type != DT_UNKNOWN)) {
+			continue;
+		}
+		if ((ent->d_name[0] == '.') && ((ent->d_name[1] == '\0') || ((ent->d_name[1] == '.') && (ent->d_name[2] == '\0')))) {
+			continue;
+		}
+		if ((ent->d_type == DT_UNKNOWN) && (OsUtil::getFileType (OsUtil::getJoinedPath (path, StdString (ent->d_name))) != OsUtil::DirectoryFile)) {
+			continue;
+		}
+		subdirs.push_back (OsUtil::getJoinedPath (path, StdString (ent->d_name)));
+	}
+	closedir (dir);
+
+	i1 = subdirs.cbegin ();
+	i2 = subdirs.cend ();
+	while (i1 != i2) {
+		addWatches (*i1);
+		++i1;
+	}
+#endif
+}
+
+void MediaWatcher::removeWatches (const StdString &path) {
+#if PLATFORM_LINUX
+	std::map<int, StdString>::iterator i1, i2;
+	StdString prefix;
+
+	prefix.assign (path);
+	prefix.append ("/");
+	i1 = watchPathMap.begin ();
+	i2 = watchPathMap.end ();
+	while (i1 != i2) {
+		if (i1->second.equals (path) || i1->second.startsWith (prefix)) {
+			inotify_rm_watch (inotifyFd, i1->first);
+			i1 = watchPathMap.erase (i1);
+			--watchCount;
+			continue;
+		}
+		++i1;
+	}
+#endif
+}
+
+int MediaWatcher::runWatch (void *itPtr) {
+	((MediaWatcher *) itPtr)->executeWatch ();
+	return (0);
+}
+void MediaWatcher::executeWatch () {
+#if PLATFORM_LINUX
+	std::map<int, StdString>::iterator pos;
+	struct pollfd pfd;
+	struct inotify_event *event;
+	char buf[8192] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+	StdString path, name;
+	StringList newdirs, movedirs;
+	StringList::const_iterator i1, i2;
+	ssize_t len;
+	char *ptr;
+	int64_t now;
+	bool ischanged;
+
+	while (! isStopRequested) {
+		pfd.fd = inotifyFd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll (&pfd, 1, pollPeriod) <= 0) {
+			continue;
+		}
+		ischanged = false;
+		while (true) {
+			len = read (inotifyFd, buf, sizeof (buf));
+			if (len <= 0) {
+				break;
+			}
+			SDL_LockMutex (changesMutex);
+			for (ptr = buf; ptr < (buf + len); ptr += sizeof (struct inotify_event) + event->len) {
+				event = (struct inotify_event *) ptr;
+				if (event->mask & IN_Q_OVERFLOW) {
+					isOverflowed = true;
+					ischanged = true;
+					continue;
+				}
+				pos = watchPathMap.find (event->wd);
+				if (pos == watchPathMap.end ()) {
+					continue;
+				}
+				if (event->mask & IN_IGNORED) {
+					watchPathMap.erase (pos);
+					--watchCount;
+					continue;
+				}
+				if (event->len <= 0) {
+					continue;
+				}
+				name.assign (event->name);
+				path = OsUtil::getJoinedPath (pos->second, name);
+				if (event->mask & IN_ISDIR) {
+					if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+						newdirs.push_back (path);
+						scanDirectoryPaths.push_back (path);
+						ischanged = true;
+					}
+					else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+						if (event->mask & IN_MOVED_FROM) {
+							movedirs.push_back (path);
+						}
+						hasRemovedDirectory = true;
+						ischanged = true;
+					}
+					continue;
+				}
+				if (fileMatchFn && (! fileMatchFn (fileMatchData, name))) {
+					continue;
+				}
+				if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+					addFileChange (path, false);
+					ischanged = true;
+				}
+				else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+					addFileChange (path, true);
+					ischanged = true;
+				}
+			}
+			if (ischanged) {
+				now = OsUtil::getTime ();
+				if (firstEventTime <= 0) {
+					firstEventTime = now;
+				}
+				lastEventTime = now;
+			}
+			SDL_UnlockMutex (changesMutex);
+		}
+
+		if (! movedirs.empty ()) {
+			// A directory moved out of the watched tree keeps its watches, reporting events under stale paths. Watches for a directory moved within the tree are added again from its IN_MOVED_TO event.
+			i1 = movedirs.cbegin ();
+			i2 = movedirs.cend ();
+			while (i1 != i2) {
+				removeWatches (*i1);
+				++i1;
+			}
+			movedirs.clear ();
+		}
+		if (! newdirs.empty ()) {
+			i1 = newdirs.cbegin ();
+			i2 = newdirs.cend ();
+			while (i1 != i2) {
+				addWatches (*i1);
+				++i1;
+			}
+			newdirs.clear ();
+		}
+	}
+#endif
+}
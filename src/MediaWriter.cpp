@@ -38,6 +38,7 @@ extern "C" {
 #include "libavutil/pixfmt.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/mathematics.h"
+#include "libavutil/opt.h"
 #include "libswscale/swscale.h"
 }
 #include "App.h"
@@ -61,6 +62,10 @@ MediaWriter::MediaWriter ()
 , videoRatecontrolBufferMultiplier (0.0f)
 , videoGopRate (0.0f)
 , videoMaxBframes (-1)
+, videoEncodeThreadCount (0)
+, videoScaleThreadCount (0)
+, isDuplicateFrameElisionEnabled (false)
+, maxDuplicateFrameInterval (-1)
 , isWriting (false)
 , isWriteFailed (false)
 , isRunning (false)
@@ -68,6 +73,7 @@ MediaWriter::MediaWriter ()
 , writeReferenceTime (0)
 , frameReceiveCount (0)
 , packetWriteCount (0)
+, duplicateFrameCount (0)
 , avFormatContext (NULL)
 , videoCodec (NULL)
 , videoCodecContext (NULL)
@@ -77,43 +83,18 @@ MediaWriter::MediaWriter ()
 , swsContext (NULL)
 , swsSourceWidth (0)
 , swsSourceHeight (0)
-, refcount (0)
+, lastDuplicateFramePts (-1)
+, swsSourceFrame (NULL)
 {
 	videoPixelFormat = MediaUtil::swsEncodePixelFormat;
 	SdlUtil::createMutex (&framesMutex);
 	SdlUtil::createCond (&framesCond);
-	SdlUtil::createMutex (&refcountMutex);
 }
 MediaWriter::~MediaWriter () {
 	clearWrite ();
 	clearFrames ();
 	SdlUtil::destroyCond (&framesCond);
 	SdlUtil::destroyMutex (&framesMutex);
-	SdlUtil::destroyMutex (&refcountMutex);
-}
-
-void MediaWriter::retain () {
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
-}
-void MediaWriter::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
-		delete (this);
-	}
 }
 
 void MediaWriter::clearWrite () {
@@ -121,6 +102,11 @@ void MediaWriter::clearWrite () {
 		nextVideoFrame.imageData->release ();
 		nextVideoFrame.imageData = NULL;
 	}
+	if (lastVideoFrame.imageData) {
+		lastVideoFrame.imageData->release ();
+		lastVideoFrame.imageData = NULL;
+	}
+	lastDuplicateFramePts = -1;
 	memset (videoFrameEncodeSlice, 0, sizeof (videoFrameEncodeSlice));
 	memset (videoFrameEncodeStride, 0, sizeof (videoFrameEncodeStride));
 
@@ -133,6 +119,10 @@ void MediaWriter::clearWrite () {
 		av_frame_free (&avFrame);
 		avFrame = NULL;
 	}
+	if (swsSourceFrame) {
+		av_frame_free (&swsSourceFrame);
+		swsSourceFrame = NULL;
+	}
 	if (videoCodecContext) {
 		avcodec_free_context (&videoCodecContext);
 		videoCodecContext = NULL;
@@ -223,11 +213,24 @@ void MediaWriter::start (const StdString &writePathValue) {
 	if (videoMaxBframes < 0) {
 		videoMaxBframes = MediaWriter::defaultVideoMaxBframes;
 	}
+	if (videoEncodePreset.empty ()) {
+		videoEncodePreset.assign (MediaWriter::defaultX264Preset);
+	}
+	if (videoEncodeThreadCount < 0) {
+		videoEncodeThreadCount = 0;
+	}
+	if (videoScaleThreadCount < 0) {
+		videoScaleThreadCount = 0;
+	}
+	if (maxDuplicateFrameInterval < 0) {
+		maxDuplicateFrameInterval = MediaWriter::defaultMaxDuplicateFrameInterval;
+	}
 	writePath.assign (writePathValue);
 	isStopped = false;
 	writeReferenceTime = 0;
 	frameReceiveCount = 0;
 	packetWriteCount = 0;
+	duplicateFrameCount = 0;
 	isRunning = true;
 	retain ();
 	if (! TaskGroup::instance->run (TaskGroup::RunContext (MediaWriter::writePackets, this))) {
@@ -269,6 +272,11 @@ void MediaWriter::executeWritePackets () {
 		failWrite (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), "av_frame_alloc error");
 		return;
 	}
+	swsSourceFrame = av_frame_alloc ();
+	if (! swsSourceFrame) {
+		failWrite (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), "av_frame_alloc error");
+		return;
+	}
 	avformat_alloc_output_context2 (&avFormatContext, NULL, NULL, writePath.c_str ());
 	if (! avFormatContext) {
 		failWrite (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), "avformat_alloc_output_context2 failed");
@@ -326,7 +334,7 @@ void MediaWriter::executeWritePackets () {
 				continue;
 			}
 		}
-		if (! processVideoFrame ()) {
+		if (! writeNextVideoFrame ()) {
 			break;
 		}
 	}
@@ -346,11 +354,15 @@ void MediaWriter::executeWritePackets () {
 		if (! nextVideoFrame.imageData) {
 			break;
 		}
-		if (! processVideoFrame ()) {
+		if (! writeNextVideoFrame ()) {
 			break;
 		}
 	}
 	if (! isWriteFailed) {
+		writeLastDuplicateFrame ();
+	}
+	if (! isWriteFailed) {
+		Log::debug ("Stream publish end; path=\"%s\" frames=%lli duplicateFrames=%lli packets=%lli", writePath.c_str (), (long long int) frameReceiveCount, (long long int) duplicateFrameCount, (long long int) packetWriteCount);
 		result = avcodec_send_frame (videoCodecContext, NULL);
 		writeVideoPackets ();
 	}
@@ -371,7 +383,26 @@ bool MediaWriter::resetSwsContext (int sourceWidth, int sourceHeight) {
 	clearSwsContext ();
 	swsSourceWidth = sourceWidth;
 	swsSourceHeight = sourceHeight;
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT (6, 1, 100)
+	// Contexts configured with a threads option divide each sws_scale_frame call into slices processed in parallel
+	swsContext = sws_alloc_context ();
+	if (swsContext) {
+		av_opt_set_int (swsContext, "srcw", swsSourceWidth, 0);
+		av_opt_set_int (swsContext, "srch", swsSourceHeight, 0);
+		av_opt_set_int (swsContext, "src_format", MediaUtil::swsRenderPixelFormat, 0);
+		av_opt_set_int (swsContext, "dstw", videoWidth, 0);
+		av_opt_set_int (swsContext, "dsth", videoHeight, 0);
+		av_opt_set_int (swsContext, "dst_format", videoPixelFormat, 0);
+		av_opt_set_int (swsContext, "sws_flags", SWS_BILINEAR, 0);
+		av_opt_set_int (swsContext, "threads", videoScaleThreadCount, 0);
+		if (sws_init_context (swsContext, NULL, NULL) < 0) {
+			sws_freeContext (swsContext);
+			swsContext = NULL;
+		}
+	}
+#else
 	swsContext = sws_getContext (swsSourceWidth, swsSourceHeight, MediaUtil::swsRenderPixelFormat, videoWidth, videoHeight, videoPixelFormat, SWS_BILINEAR, NULL, NULL, NULL);
+#endif
 	if (! swsContext) {
 		failWrite (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), "sws_getContext error");
 		return (false);
@@ -404,6 +435,7 @@ bool MediaWriter::addVideoStream () {
 	videoCodecContext->pix_fmt = videoPixelFormat;
 	videoCodecContext->bit_rate = videoBitrate;
 	videoCodecContext->max_b_frames = videoMaxBframes;
+	videoCodecContext->thread_count = videoEncodeThreadCount;
 
 	n = (double) videoBitrate;
 	videoCodecContext->rc_min_rate = (int64_t) (n * (1.0f - videoRatecontrolRangeMultiplier));
@@ -429,7 +461,7 @@ bool MediaWriter::addVideoStream () {
 		videoCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 	}
 	dict = NULL;
-	av_dict_set (&dict, "preset", MediaWriter::defaultX264Preset, 0);
+	av_dict_set (&dict, "preset", videoEncodePreset.c_str (), 0);
 	result = avcodec_open2 (videoCodecContext, videoCodec, &dict);
 	av_dict_free (&dict);
 	if (result < 0) {
@@ -467,9 +499,30 @@ bool MediaWriter::processVideoFrame () {
 		failWrite (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), "av_frame_make_writable failed");
 		return (false);
 	}
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT (6, 1, 100)
+	swsSourceFrame->format = MediaUtil::swsRenderPixelFormat;
+	swsSourceFrame->width = nextVideoFrame.imageWidth;
+	swsSourceFrame->height = nextVideoFrame.imageHeight;
+	swsSourceFrame->data[0] = nextVideoFrame.imageData->data;
+	swsSourceFrame->linesize[0] = nextVideoFrame.imageLineSize;
+	swsSourceFrame->buf[0] = av_buffer_create (nextVideoFrame.imageData->data, nextVideoFrame.imageLineSize * nextVideoFrame.imageHeight, MediaWriter::releaseImageData, nextVideoFrame.imageData, AV_BUFFER_FLAG_READONLY);
+	if (! swsSourceFrame->buf[0]) {
+		av_frame_unref (swsSourceFrame);
+		failWrite (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), "av_buffer_create failed");
+		return (false);
+	}
+	// swsSourceFrame->buf[0] holds a reference to the image data, so the frame can share it with sws_scale_frame without a copy
+	nextVideoFrame.imageData->retain ();
+	result = sws_scale_frame (swsContext, avFrame, swsSourceFrame);
+	av_frame_unref (swsSourceFrame);
+	if (result >= 0) {
+		result = videoHeight;
+	}
+#else
 	videoFrameEncodeSlice[0] = nextVideoFrame.imageData->data;
 	videoFrameEncodeStride[0] = nextVideoFrame.imageLineSize;
 	result = sws_scale (swsContext, videoFrameEncodeSlice, videoFrameEncodeStride, 0, nextVideoFrame.imageHeight, avFrame->data, avFrame->linesize);
+#endif
 	nextVideoFrame.imageData->release ();
 	nextVideoFrame.imageData = NULL;
 	if (result != videoHeight) {
@@ -488,6 +541,60 @@ bool MediaWriter::processVideoFrame () {
 	return (true);
 }
 
+void MediaWriter::releaseImageData (void *opaque, uint8_t *data) {
+	((SharedBuffer *) opaque)->release ();
+}
+
+bool MediaWriter::writeNextVideoFrame () {
+	if (! isDuplicateFrameElisionEnabled) {
+		return (processVideoFrame ());
+	}
+	if (isDuplicateVideoFrame ()) {
+		lastDuplicateFramePts = nextVideoFrame.pts;
+		++duplicateFrameCount;
+		nextVideoFrame.imageData->release ();
+		nextVideoFrame.imageData = NULL;
+		return (true);
+	}
+	if (lastVideoFrame.imageData) {
+		lastVideoFrame.imageData->release ();
+	}
+	lastVideoFrame = nextVideoFrame;
+	if (lastVideoFrame.imageData) {
+		lastVideoFrame.imageData->retain ();
+	}
+	lastDuplicateFramePts = -1;
+	return (processVideoFrame ());
+}
+
+bool MediaWriter::isDuplicateVideoFrame () {
+	if ((! nextVideoFrame.imageData) || (! lastVideoFrame.imageData)) {
+		return (false);
+	}
+	if ((nextVideoFrame.imageWidth != lastVideoFrame.imageWidth) || (nextVideoFrame.imageHeight != lastVideoFrame.imageHeight) || (nextVideoFrame.imageLineSize != lastVideoFrame.imageLineSize)) {
+		return (false);
+	}
+	if ((maxDuplicateFrameInterval > 0) && ((nextVideoFrame.pts - lastVideoFrame.pts) >= (int64_t) maxDuplicateFrameInterval)) {
+		// Encode a repeated image periodically so that long static periods don't leave the stream without frames to seek to
+		return (false);
+	}
+	if (nextVideoFrame.imageData->length != lastVideoFrame.imageData->length) {
+		return (false);
+	}
+	return (memcmp (nextVideoFrame.imageData->data, lastVideoFrame.imageData->data, nextVideoFrame.imageData->length) == 0);
+}
+
+bool MediaWriter::writeLastDuplicateFrame () {
+	if ((lastDuplicateFramePts < 0) || (! lastVideoFrame.imageData)) {
+		return (true);
+	}
+	nextVideoFrame = lastVideoFrame;
+	nextVideoFrame.pts = lastDuplicateFramePts;
+	lastVideoFrame.imageData = NULL;
+	lastDuplicateFramePts = -1;
+	return (processVideoFrame ());
+}
+
 bool MediaWriter::writeVideoPackets () {
 	int result;
 
@@ -34,6 +34,7 @@
 #ifndef MEDIA_WRITER_H
 #define MEDIA_WRITER_H
 
+#include "Refcounted.h"
 extern "C" {
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
@@ -44,7 +45,7 @@ extern "C" {
 
 class SharedBuffer;
 
-class MediaWriter {
+class MediaWriter : public Refcounted {
 public:
 	MediaWriter ();
 	~MediaWriter ();
@@ -58,6 +59,7 @@ public:
 	static constexpr const int defaultVideoMaxBframes = 1;
 	static constexpr const char *defaultX264Preset = "medium";
 	static constexpr const int defaultVideoFrameDropLag = 10000;
+	static constexpr const int defaultMaxDuplicateFrameInterval = 1000;
 
 	// Read-write data members
 	StdString videoCodecName;
@@ -72,6 +74,11 @@ public:
 	double videoRatecontrolBufferMultiplier;
 	double videoGopRate; // Seconds per group of pictures
 	int videoMaxBframes;
+	StdString videoEncodePreset;
+	int videoEncodeThreadCount; // Zero to select a thread count automatically
+	int videoScaleThreadCount; // Zero to select a thread count automatically
+	bool isDuplicateFrameElisionEnabled;
+	int maxDuplicateFrameInterval; // Milliseconds
 
 	// Read-only data members
 	StdString writePath;
@@ -83,12 +90,7 @@ public:
 	int64_t writeReferenceTime;
 	int64_t frameReceiveCount;
 	int64_t packetWriteCount;
-
-	// Increase the object's refcount
-	void retain ();
-
-	// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
-	void release ();
+	int64_t duplicateFrameCount;
 
 	// Open the output stream and begin media write
 	void start (const StdString &writePathValue);
@@ -137,6 +139,18 @@ private:
 	bool processVideoFrame ();
 	bool writeVideoPackets ();
 
+	// Encode nextVideoFrame, or discard it if duplicate frame elision is enabled and its image matches lastVideoFrame. Returns a boolean value indicating if the operation succeeded.
+	bool writeNextVideoFrame ();
+
+	// Return a boolean value indicating if nextVideoFrame holds the same image as lastVideoFrame
+	bool isDuplicateVideoFrame ();
+
+	// Encode lastVideoFrame again with the timestamp of the last discarded duplicate frame, if any, so that the stream duration covers all received frames. Returns a boolean value indicating if the operation succeeded.
+	bool writeLastDuplicateFrame ();
+
+	// Callback function for use with av_buffer_create
+	static void releaseImageData (void *opaque, uint8_t *data);
+
 	AVFormatContext *avFormatContext;
 	AVCodec *videoCodec;
 	AVCodecContext *videoCodecContext;
@@ -150,9 +164,10 @@ private:
 	SDL_mutex *framesMutex;
 	SDL_cond *framesCond;
 	MediaWriter::VideoFrame nextVideoFrame;
+	MediaWriter::VideoFrame lastVideoFrame;
+	int64_t lastDuplicateFramePts;
+	AVFrame *swsSourceFrame;
 	uint8_t *videoFrameEncodeSlice[AV_NUM_DATA_POINTERS];
 	int videoFrameEncodeStride[AV_NUM_DATA_POINTERS];
-	int refcount;
-	SDL_mutex *refcountMutex;
 };
 #endif
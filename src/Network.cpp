@@ -62,11 +62,15 @@
 #include "App.h"
 #include "SdlUtil.h"
 #include "Log.h"
+#include "OsUtil.h"
 #include "Buffer.h"
 #include "SharedBuffer.h"
+#include "BufferView.h"
 #include "StringList.h"
 #include "Ipv4Address.h"
 #include "Resource.h"
+#include "TaskGroup.h"
+#include "HttpCache.h"
 #include "Network.h"
 
 Network *Network::instance = NULL;
@@ -74,16 +78,22 @@ constexpr const int maxDatagramSize = 1500; // bytes
 constexpr const char *caBundlePath = "tls/cert.pem";
 
 Network::Network ()
-: maxRequestThreads (Network::defaultMaxRequestThreads)
+: maxHttpTransfers (Network::defaultMaxHttpTransfers)
+, maxHostHttpTransfers (Network::defaultMaxHostHttpTransfers)
 , allowUnverifiedHttps (false)
 , enableDatagramSocket (false)
 , isStarted (false)
 , isStopped (false)
 , datagramPort (0)
+, httpCache (NULL)
 , datagramSendThread (NULL)
 , datagramReceiveThread (NULL)
 , datagramSocket (-1)
-, httpRequestThreadStopCount (0)
+, nextHttpRequestSequence (0)
+, httpThread (NULL)
+, isHttpThreadEnded (false)
+, curlMulti (NULL)
+, curlShare (NULL)
 #if PLATFORM_WINDOWS
 , isWsaStarted (false)
 #endif
@@ -91,7 +101,6 @@ Network::Network ()
 	SdlUtil::createMutex (&datagramSendMutex);
 	SdlUtil::createCond (&datagramSendCond);
 	SdlUtil::createMutex (&httpRequestQueueMutex);
-	SdlUtil::createCond (&httpRequestQueueCond);
 
 	caBundleBlob.data = NULL;
 	caBundleBlob.len = 0;
@@ -99,10 +108,17 @@ Network::Network ()
 }
 Network::~Network () {
 	stop ();
+	if (! httpThread) {
+		cleanupCurl ();
+	}
 	SdlUtil::destroyCond (&datagramSendCond);
 	SdlUtil::destroyMutex (&datagramSendMutex);
-	SdlUtil::destroyCond (&httpRequestQueueCond);
 	SdlUtil::destroyMutex (&httpRequestQueueMutex);
+	if (httpCache) {
+		httpCache->logStats ();
+		delete (httpCache);
+		httpCache = NULL;
+	}
 }
 
 void Network::createInstance () {
@@ -135,37 +151,54 @@ void Network::clearDatagramQueue () {
 
 void Network::clearHttpRequestQueue () {
 	SDL_LockMutex (httpRequestQueueMutex);
-	while (! httpRequestQueue.empty ()) {
-		httpRequestQueue.pop ();
-	}
-	SDL_CondBroadcast (httpRequestQueueCond);
+	httpRequestQueueMap.clear ();
 	SDL_UnlockMutex (httpRequestQueueMutex);
 }
 
-void Network::waitHttpRequestThreads () {
-	std::list<SDL_Thread *>::iterator i1, i2;
+void Network::waitHttpThread () {
 	int result;
 
-	SDL_LockMutex (httpRequestQueueMutex);
-	SDL_CondBroadcast (httpRequestQueueCond);
-	SDL_UnlockMutex (httpRequestQueueMutex);
+	if (! httpThread) {
+		return;
+	}
+	if (curlMulti) {
+		curl_multi_wakeup (curlMulti);
+	}
+	SDL_WaitThread (httpThread, &result);
+	httpThread = NULL;
+	cleanupCurl ();
+}
 
-	i1 = httpRequestThreadList.begin ();
-	i2 = httpRequestThreadList.end ();
+void Network::cleanupCurl () {
+	std::list<CURL *>::iterator i1, i2;
+
+	i1 = idleCurlHandles.begin ();
+	i2 = idleCurlHandles.end ();
 	while (i1 != i2) {
-		SDL_WaitThread (*i1, &result);
+		curl_easy_cleanup (*i1);
 		++i1;
 	}
-	httpRequestThreadList.clear ();
+	idleCurlHandles.clear ();
+	if (curlMulti) {
+		curl_multi_cleanup (curlMulti);
+		curlMulti = NULL;
+	}
+	if (curlShare) {
+		curl_share_cleanup (curlShare);
+		curlShare = NULL;
+	}
+	if (isStarted) {
+		curl_global_cleanup ();
+		isStarted = false;
+	}
 }
 
 OpResult Network::start () {
 	Buffer *buffer;
 	struct sockaddr_in saddr;
 	OpResult result;
-	int i, cresult;
+	int cresult;
 	socklen_t namelen;
-	SDL_Thread *thread;
 #if PLATFORM_LINUX || PLATFORM_MACOS
 	int sockopt;
 	struct protoent *proto;
@@ -179,8 +212,11 @@ OpResult Network::start () {
 	if (isStarted) {
 		return (OpResult::Success);
 	}
-	if (maxRequestThreads <= 0) {
-		maxRequestThreads = Network::defaultMaxRequestThreads;
+	if (maxHttpTransfers <= 0) {
+		maxHttpTransfers = Network::defaultMaxHttpTransfers;
+	}
+	if (maxHostHttpTransfers <= 0) {
+		maxHostHttpTransfers = Network::defaultMaxHostHttpTransfers;
 	}
 #if PLATFORM_WINDOWS
 	if (! isWsaStarted) {
@@ -204,7 +240,7 @@ OpResult Network::start () {
 		Resource::instance->unloadFile (StdString (caBundlePath));
 		caBundleBlob.data = (void *) caBundle.c_str ();
 		caBundleBlob.len = caBundle.length ();
-		caBundleBlob.flags = CURL_BLOB_COPY;
+		caBundleBlob.flags = CURL_BLOB_NOCOPY;
 	}
 
 	SSL_library_init ();
@@ -212,6 +248,29 @@ OpResult Network::start () {
 	if (cresult != 0) {
 		return (OpResult::LibcurlOperationFailedError);
 	}
+
+	// curlShare is used only from the HTTP thread, so it needs no lock callbacks
+	curlShare = curl_share_init ();
+	if (curlShare) {
+		curl_share_setopt (curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt (curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
+	curlMulti = curl_multi_init ();
+	if (! curlMulti) {
+		return (OpResult::LibcurlOperationFailedError);
+	}
+	curl_multi_setopt (curlMulti, CURLMOPT_PIPELINING, (long) CURLPIPE_MULTIPLEX);
+	curl_multi_setopt (curlMulti, CURLMOPT_MAX_HOST_CONNECTIONS, (long) maxHostHttpTransfers);
+	curl_multi_setopt (curlMulti, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long) maxHttpTransfers);
+	if ((! httpCache) && (! httpCachePath.empty ())) {
+		httpCache = new HttpCache (httpCachePath);
+		result = httpCache->open ();
+		if (result != OpResult::Success) {
+			Log::warning ("Failed to open HTTP cache; path=\"%s\" err=%i", httpCachePath.c_str (), result);
+			delete (httpCache);
+			httpCache = NULL;
+		}
+	}
 	result = resetInterfaces ();
 	if (result != OpResult::Success) {
 		return (result);
@@ -275,21 +334,18 @@ OpResult Network::start () {
 		}
 	}
 
-	for (i = 0; i < maxRequestThreads; ++i) {
-		thread = SDL_CreateThread (Network::runHttpRequestThread, StdString::createSprintf ("runHttpRequestThread_%i", i).c_str (), this);
-		if (! thread) {
-			return (OpResult::ThreadCreateFailedError);
-		}
-		httpRequestThreadList.push_back (thread);
-	}
-
 	isStarted = true;
-	Log::debug ("Network start; datagramSocket=%i datagramPort=%i maxRequestThreads=%i", datagramSocket, datagramPort, maxRequestThreads);
+	isHttpThreadEnded = false;
+	httpThread = SDL_CreateThread (Network::runHttpThread, "runHttpThread", this);
+	if (! httpThread) {
+		return (OpResult::ThreadCreateFailedError);
+	}
+	Log::debug ("Network start; datagramSocket=%i datagramPort=%i maxHttpTransfers=%i maxHostHttpTransfers=%i curlVersion=%s", datagramSocket, datagramPort, maxHttpTransfers, maxHostHttpTransfers, curl_version ());
 	return (OpResult::Success);
 }
 
 void Network::stop () {
-	Network::HttpRequestContext item;
+	std::map<StdString, std::queue<Network::HttpRequestContext>>::iterator i1, i2;
 
 #if PLATFORM_WINDOWS
 	if (isWsaStarted) {
@@ -314,14 +370,20 @@ void Network::stop () {
 
 	httpShutdownList.clear ();
 	SDL_LockMutex (httpRequestQueueMutex);
-	while (! httpRequestQueue.empty ()) {
-		item = httpRequestQueue.front ();
-		httpShutdownList.push_back (item);
-		httpRequestQueue.pop ();
+	i1 = httpRequestQueueMap.begin ();
+	i2 = httpRequestQueueMap.end ();
+	while (i1 != i2) {
+		while (! i1->second.empty ()) {
+			httpShutdownList.push_back (i1->second.front ());
+			i1->second.pop ();
+		}
+		++i1;
 	}
-	SDL_CondBroadcast (httpRequestQueueCond);
+	httpRequestQueueMap.clear ();
 	SDL_UnlockMutex (httpRequestQueueMutex);
-	curl_global_cleanup ();
+	if (curlMulti) {
+		curl_multi_wakeup (curlMulti);
+	}
 }
 
 void Network::waitThreads () {
@@ -341,7 +403,7 @@ void Network::waitThreads () {
 	}
 	httpShutdownList.clear ();
 
-	waitHttpRequestThreads ();
+	waitHttpThread ();
 	if (datagramReceiveThread) {
 		SDL_WaitThread (datagramReceiveThread, &result);
 		datagramReceiveThread = NULL;
@@ -353,7 +415,7 @@ void Network::waitThreads () {
 }
 
 bool Network::isStopComplete () {
-	return (isStopped && (httpRequestThreadStopCount >= maxRequestThreads));
+	return (isStopped && ((! httpThread) || isHttpThreadEnded));
 }
 
 OpResult Network::resetInterfaces () {
@@ -686,17 +748,23 @@ void Network::sendBroadcastDatagram (int targetPort, Buffer *messageData) {
 	SDL_UnlockMutex (datagramSendMutex);
 }
 
-void Network::sendHttpGet (const StdString &targetUrl, Network::HttpRequestCallbackContext callback, const StringList &headerList) {
+void Network::sendHttpGet (const StdString &targetUrl, Network::HttpRequestCallbackContext callback, const StringList &headerList, bool isCacheEnabled) {
 	Network::HttpRequestContext item;
+	Network::HttpTransfer *transfer;
 
 	item.method.assign ("GET");
 	item.url.assign (targetUrl);
 	item.callback = callback;
 	item.headerList.assign (headerList);
-	SDL_LockMutex (httpRequestQueueMutex);
-	httpRequestQueue.push (item);
-	SDL_CondSignal (httpRequestQueueCond);
-	SDL_UnlockMutex (httpRequestQueueMutex);
+	item.isCacheEnabled = isCacheEnabled;
+	if ((! isStopped) && hasFreshCacheEntry (item)) {
+		transfer = new Network::HttpTransfer ();
+		transfer->request = item;
+		transfer->isCacheHit = true;
+		startHttpResponseTask (transfer);
+		return;
+	}
+	enqueueHttpRequest (&item);
 }
 
 void Network::sendHttpPost (const StdString &targetUrl, const StdString &postData, Network::HttpRequestCallbackContext callback, const StringList &headerList) {
@@ -707,10 +775,45 @@ void Network::sendHttpPost (const StdString &targetUrl, const StdString &postDat
 	item.postData.assign (postData);
 	item.callback = callback;
 	item.headerList.assign (headerList);
+	enqueueHttpRequest (&item);
+}
+
+void Network::enqueueHttpRequest (Network::HttpRequestContext *item) {
+	item->host.assign (Network::getUrlHost (item->url));
 	SDL_LockMutex (httpRequestQueueMutex);
-	httpRequestQueue.push (item);
-	SDL_CondSignal (httpRequestQueueCond);
+	item->sequence = nextHttpRequestSequence;
+	++nextHttpRequestSequence;
+	httpRequestQueueMap[item->host].push (*item);
 	SDL_UnlockMutex (httpRequestQueueMutex);
+	if (curlMulti) {
+		curl_multi_wakeup (curlMulti);
+	}
+}
+
+bool Network::dequeueHttpRequest (Network::HttpRequestContext *destItem) {
+	std::map<StdString, std::queue<Network::HttpRequestContext>>::iterator i1, i2, pos;
+
+	// Each host keeps its own FIFO queue. Among hosts with transfer capacity, the oldest queued request goes first.
+	pos = httpRequestQueueMap.end ();
+	i1 = httpRequestQueueMap.begin ();
+	i2 = httpRequestQueueMap.end ();
+	while (i1 != i2) {
+		if ((! i1->second.empty ()) && (getHostTransferCount (i1->first) < maxHostHttpTransfers)) {
+			if ((pos == httpRequestQueueMap.end ()) || (i1->second.front ().sequence < pos->second.front ().sequence)) {
+				pos = i1;
+			}
+		}
+		++i1;
+	}
+	if (pos == httpRequestQueueMap.end ()) {
+		return (false);
+	}
+	*destItem = pos->second.front ();
+	pos->second.pop ();
+	if (pos->second.empty ()) {
+		httpRequestQueueMap.erase (pos);
+	}
+	return (true);
 }
 
 int Network::sendTo (const StdString &targetHostname, int targetPort, Buffer *messageData) {
@@ -775,77 +878,173 @@ int Network::broadcastSendTo (int targetPort, Buffer *messageData) {
 	return (result);
 }
 
-int Network::runHttpRequestThread (void *itPtr) {
+int Network::runHttpThread (void *itPtr) {
 	Network *it = (Network *) itPtr;
 	Network::HttpRequestContext item;
-	int result, statuscode;
-	SharedBuffer *responsebuffer;
+	std::list<Network::HttpRequestContext> failedlist;
+	std::list<Network::HttpRequestContext>::iterator i1, i2;
+	Network::HttpTransfer *transfer;
+	CURLMsg *msg;
+	CURLcode code;
+	int count, running;
 
-	SDL_LockMutex (it->httpRequestQueueMutex);
-	while (true) {
-		if (it->isStopped) {
-			break;
-		}
-		if (it->httpRequestQueue.empty ()) {
-			SDL_CondWait (it->httpRequestQueueCond, it->httpRequestQueueMutex);
-			continue;
+	while (! it->isStopped) {
+		SDL_LockMutex (it->httpRequestQueueMutex);
+		while (((int) it->httpTransferList.size ()) < it->maxHttpTransfers) {
+			if (! it->dequeueHttpRequest (&item)) {
+				break;
+			}
+			if (it->startHttpTransfer (item) != OpResult::Success) {
+				failedlist.push_back (item);
+			}
 		}
-		item = it->httpRequestQueue.front ();
-		it->httpRequestQueue.pop ();
 		SDL_UnlockMutex (it->httpRequestQueueMutex);
 
-		statuscode = 0;
-		responsebuffer = NULL;
-		result = it->sendHttpRequest (&item, &statuscode, &responsebuffer);
-		if (result != OpResult::Success) {
-			statuscode = 0;
+		if (! failedlist.empty ()) {
+			i1 = failedlist.begin ();
+			i2 = failedlist.end ();
+			while (i1 != i2) {
+				if (i1->callback.callback) {
+					i1->callback.callback (i1->callback.callbackData, i1->url, 0, NULL);
+				}
+				++i1;
+			}
+			failedlist.clear ();
 		}
-		if (item.callback.callback) {
-			item.callback.callback (item.callback.callbackData, item.url, statuscode, responsebuffer);
+
+		running = 0;
+		curl_multi_perform (it->curlMulti, &running);
+		while (true) {
+			msg = curl_multi_info_read (it->curlMulti, &count);
+			if (! msg) {
+				break;
+			}
+			if (msg->msg == CURLMSG_DONE) {
+				code = msg->data.result;
+				transfer = NULL;
+				curl_easy_getinfo (msg->easy_handle, CURLINFO_PRIVATE, (char **) &transfer);
+				if (transfer) {
+					it->endHttpTransfer (transfer, code);
+				}
+			}
 		}
-		if (responsebuffer) {
-			responsebuffer->release ();
-			responsebuffer = NULL;
+		if (it->isStopped) {
+			break;
 		}
+		curl_multi_poll (it->curlMulti, NULL, 0, Network::httpPollPeriod, NULL);
+	}
 
-		SDL_LockMutex (it->httpRequestQueueMutex);
+	while (! it->httpTransferList.empty ()) {
+		it->endHttpTransfer (it->httpTransferList.front (), CURLE_ABORTED_BY_CALLBACK);
 	}
-	++(it->httpRequestThreadStopCount);
+	SDL_LockMutex (it->httpRequestQueueMutex);
+	it->isHttpThreadEnded = true;
 	SDL_UnlockMutex (it->httpRequestQueueMutex);
-
 	return (0);
 }
 
-OpResult Network::sendHttpRequest (Network::HttpRequestContext *item, int *statusCode, SharedBuffer **responseBuffer) {
+bool Network::hasFreshCacheEntry (const Network::HttpRequestContext &item) {
+	HttpCache::Entry entry;
+
+	if ((! httpCache) || (! item.isCacheEnabled)) {
+		return (false);
+	}
+	if (! httpCache->find (item.url, &entry)) {
+		return (false);
+	}
+	return (HttpCache::isFresh (entry, OsUtil::getTime ()));
+}
+
+void Network::startHttpResponseTask (Network::HttpTransfer *transfer) {
+	StdString queueid;
+
+	// Cache writes run one at a time, so that concurrent stores of the same URL don't share a temporary file
+	if ((! transfer->isCacheHit) && httpCache && transfer->request.isCacheEnabled) {
+		queueid.assign (Network::httpCacheTaskQueueId);
+	}
+	if (! TaskGroup::instance->run (TaskGroup::RunContext (Network::runHttpResponse, transfer, queueid))) {
+		executeHttpResponse (transfer);
+	}
+}
+
+void Network::runHttpResponse (void *transferPtr) {
+	Network::instance->executeHttpResponse ((Network::HttpTransfer *) transferPtr);
+}
+
+void Network::executeHttpResponse (Network::HttpTransfer *transfer) {
+	if (transfer->isCacheHit) {
+		transfer->responseBuffer = httpCache->readBody (transfer->request.url);
+		if (! transfer->responseBuffer) {
+			if (! isStopped) {
+				// The cache entry was evicted after the freshness check, so fetch the resource instead
+				enqueueHttpRequest (&(transfer->request));
+				delete (transfer);
+				return;
+			}
+		}
+		else {
+			transfer->statusCode = Network::HttpOkCode;
+			httpCache->countHit ();
+			Log::debug2 ("HTTP cache hit; url=\"%s\" length=%i", transfer->request.url.c_str (), transfer->responseBuffer->length);
+		}
+	}
+	else if (transfer->responseBuffer && httpCache && transfer->request.isCacheEnabled) {
+		updateHttpCache (transfer);
+	}
+
+	if (transfer->request.callback.callback) {
+		transfer->request.callback.callback (transfer->request.callback.callbackData, transfer->request.url, transfer->statusCode, transfer->responseBuffer);
+	}
+	if (transfer->responseBuffer) {
+		transfer->responseBuffer->release ();
+		transfer->responseBuffer = NULL;
+	}
+	delete (transfer);
+}
+
+OpResult Network::startHttpTransfer (const Network::HttpRequestContext &item) {
+	Network::HttpTransfer *transfer;
 	CURL *curl;
-	struct curl_slist *headers;
-	CURLcode code;
-	SharedBuffer *buffer;
 	StringList::const_iterator i1, i2;
+	HttpCache::Entry cacheentry;
 	StdString headertext;
-	long responsecode;
-	OpResult result;
 
-	curl = curl_easy_init ();
-	if (! curl) {
-		return (OpResult::LibcurlOperationFailedError);
+	if (! (item.method.equals ("GET") || item.method.equals ("POST"))) {
+		return (OpResult::UnknownMethodError);
 	}
-	result = OpResult::Success;
-	responsecode = 0;
-	headers = NULL;
-	code = CURLE_UNKNOWN_OPTION;
-	buffer = new SharedBuffer ();
-	buffer->retain ();
+	if (! idleCurlHandles.empty ()) {
+		curl = idleCurlHandles.front ();
+		idleCurlHandles.pop_front ();
+	}
+	else {
+		curl = curl_easy_init ();
+		if (! curl) {
+			return (OpResult::LibcurlOperationFailedError);
+		}
+	}
+
+	transfer = new Network::HttpTransfer ();
+	transfer->request = item;
+	transfer->host.assign (Network::getUrlHost (item.url));
+	transfer->curl = curl;
+	transfer->responseBuffer = new SharedBuffer ();
+	transfer->responseBuffer->retain ();
 	curl_easy_setopt (curl, CURLOPT_VERBOSE, 0);
 	curl_easy_setopt (curl, CURLOPT_NOSIGNAL, 1);
+	curl_easy_setopt (curl, CURLOPT_PRIVATE, (char *) transfer);
 	curl_easy_setopt (curl, CURLOPT_WRITEFUNCTION, Network::curlWrite);
-	curl_easy_setopt (curl, CURLOPT_WRITEDATA, buffer);
+	curl_easy_setopt (curl, CURLOPT_WRITEDATA, transfer->responseBuffer);
 	curl_easy_setopt (curl, CURLOPT_NOPROGRESS, 0);
 	curl_easy_setopt (curl, CURLOPT_PROGRESSFUNCTION, Network::curlProgress);
+	curl_easy_setopt (curl, CURLOPT_HTTP_VERSION, (long) CURL_HTTP_VERSION_2TLS);
+	curl_easy_setopt (curl, CURLOPT_PIPEWAIT, 1L);
+	if (curlShare) {
+		curl_easy_setopt (curl, CURLOPT_SHARE, curlShare);
+	}
 
-	if (! item->headerList.empty ()) {
-		i1 = item->headerList.cbegin ();
-		i2 = item->headerList.cend ();
+	if (! transfer->request.headerList.empty ()) {
+		i1 = transfer->request.headerList.cbegin ();
+		i2 = transfer->request.headerList.cend ();
 		while (i1 != i2) {
 			headertext = *i1;
 			++i1;
@@ -855,17 +1054,37 @@ OpResult Network::sendHttpRequest (Network::HttpRequestContext *item, int *statu
 			headertext.append (": ");
 			headertext.append (*i1);
 			++i1;
-			headers = curl_slist_append (headers, headertext.c_str ());
+			transfer->headers = curl_slist_append (transfer->headers, headertext.c_str ());
+		}
+	}
+	if (httpCache && item.isCacheEnabled) {
+		curl_easy_setopt (curl, CURLOPT_HEADERFUNCTION, Network::curlHeader);
+		curl_easy_setopt (curl, CURLOPT_HEADERDATA, transfer);
+		if (httpCache->find (item.url, &cacheentry)) {
+			transfer->isRevalidating = true;
+			if (! cacheentry.etag.empty ()) {
+				headertext.sprintf ("%s: %s", Network::HttpIfNoneMatchHeader, cacheentry.etag.c_str ());
+				transfer->headers = curl_slist_append (transfer->headers, headertext.c_str ());
+			}
+			if (! cacheentry.lastModified.empty ()) {
+				headertext.sprintf ("%s: %s", Network::HttpIfModifiedSinceHeader, cacheentry.lastModified.c_str ());
+				transfer->headers = curl_slist_append (transfer->headers, headertext.c_str ());
+			}
+		}
+		else {
+			httpCache->countMiss ();
 		}
-		curl_easy_setopt (curl, CURLOPT_HTTPHEADER, headers);
+	}
+	if (transfer->headers) {
+		curl_easy_setopt (curl, CURLOPT_HTTPHEADER, transfer->headers);
 	}
 
-	curl_easy_setopt (curl, CURLOPT_URL, item->url.c_str ());
+	curl_easy_setopt (curl, CURLOPT_URL, transfer->request.url.c_str ());
 	if (! httpUserAgent.empty ()) {
 		curl_easy_setopt (curl, CURLOPT_USERAGENT, httpUserAgent.c_str ());
 	}
 
-	if (item->url.startsWith ("https://")) {
+	if (transfer->request.url.startsWith ("https://")) {
 		curl_easy_setopt (curl, CURLOPT_USE_SSL, CURLUSESSL_ALL);
 		if (allowUnverifiedHttps) {
 			curl_easy_setopt (curl, CURLOPT_SSL_VERIFYPEER, 0);
@@ -878,49 +1097,136 @@ OpResult Network::sendHttpRequest (Network::HttpRequestContext *item, int *statu
 		}
 	}
 
-	if (item->method.equals ("GET")) {
-		code = curl_easy_perform (curl);
-	}
-	else if (item->method.equals ("POST")) {
+	if (transfer->request.method.equals ("POST")) {
 		curl_easy_setopt (curl, CURLOPT_POST, 1);
-		curl_easy_setopt (curl, CURLOPT_POSTFIELDS, item->postData.c_str ());
-		curl_easy_setopt (curl, CURLOPT_POSTFIELDSIZE, item->postData.length ());
-		code = curl_easy_perform (curl);
+		curl_easy_setopt (curl, CURLOPT_POSTFIELDS, transfer->request.postData.c_str ());
+		curl_easy_setopt (curl, CURLOPT_POSTFIELDSIZE, transfer->request.postData.length ());
 	}
-	else {
-		result = OpResult::UnknownMethodError;
+
+	if (curl_multi_add_handle (curlMulti, curl) != CURLM_OK) {
+		curl_easy_cleanup (curl);
+		if (transfer->headers) {
+			curl_slist_free_all (transfer->headers);
+		}
+		transfer->responseBuffer->release ();
+		delete (transfer);
+		return (OpResult::LibcurlOperationFailedError);
 	}
+	httpTransferList.push_back (transfer);
+	++(hostTransferCountMap[transfer->host]);
+	return (OpResult::Success);
+}
+
+void Network::endHttpTransfer (Network::HttpTransfer *transfer, CURLcode code) {
+	std::map<StdString, int>::iterator pos;
+	long responsecode, connectcount, httpversion;
 
-	if (result == OpResult::Success) {
-		if (code != CURLE_OK) {
-			result = OpResult::LibcurlOperationFailedError;
+	transfer->statusCode = 0;
+	if (code == CURLE_OK) {
+		responsecode = 0;
+		if (curl_easy_getinfo (transfer->curl, CURLINFO_RESPONSE_CODE, &responsecode) == CURLE_OK) {
+			transfer->statusCode = (int) responsecode;
 		}
 	}
+	else if (transfer->responseBuffer) {
+		transfer->responseBuffer->release ();
+		transfer->responseBuffer = NULL;
+	}
+	if (Log::isWriteLevel (Log::Debug2Level)) {
+		connectcount = 0;
+		httpversion = 0;
+		curl_easy_getinfo (transfer->curl, CURLINFO_NUM_CONNECTS, &connectcount);
+		curl_easy_getinfo (transfer->curl, CURLINFO_HTTP_VERSION, &httpversion);
+		Log::debug2 ("HTTP transfer end; url=\"%s\" curlCode=%i statusCode=%i newConnections=%li httpVersion=%li", transfer->request.url.c_str (), (int) code, transfer->statusCode, connectcount, httpversion);
+	}
 
-	if (result != OpResult::Success) {
-		delete (buffer);
+	curl_multi_remove_handle (curlMulti, transfer->curl);
+	if (((int) idleCurlHandles.size ()) < Network::maxIdleCurlHandles) {
+		curl_easy_reset (transfer->curl);
+		idleCurlHandles.push_back (transfer->curl);
 	}
 	else {
-		code = curl_easy_getinfo (curl, CURLINFO_RESPONSE_CODE, &responsecode);
-		if (code == CURLE_OK) {
-			if (statusCode) {
-				*statusCode = (int) responsecode;
-			}
+		curl_easy_cleanup (transfer->curl);
+	}
+	transfer->curl = NULL;
+	if (transfer->headers) {
+		curl_slist_free_all (transfer->headers);
+		transfer->headers = NULL;
+	}
+	pos = hostTransferCountMap.find (transfer->host);
+	if (pos != hostTransferCountMap.end ()) {
+		--(pos->second);
+		if (pos->second <= 0) {
+			hostTransferCountMap.erase (pos);
+		}
+	}
+	httpTransferList.remove (transfer);
+	startHttpResponseTask (transfer);
+}
+
+void Network::updateHttpCache (Network::HttpTransfer *transfer) {
+	HttpCache::Entry entry;
+	SharedBuffer *body;
+
+	entry.url.assign (transfer->request.url);
+	entry.etag.assign (transfer->responseEtag);
+	entry.lastModified.assign (transfer->responseLastModified);
+	entry.fetchTime = OsUtil::getTime ();
+	entry.maxAge = transfer->responseMaxAge;
+	if (transfer->statusCode == Network::HttpNotModifiedCode) {
+		if (! transfer->isRevalidating) {
+			return;
 		}
-		if (responseBuffer) {
-			*responseBuffer = buffer;
+		body = httpCache->readBody (transfer->request.url);
+		if (! body) {
+			return;
 		}
-		else {
-			delete (buffer);
+		httpCache->refresh (entry);
+		httpCache->countRevalidate ();
+		if (transfer->responseBuffer) {
+			transfer->responseBuffer->release ();
+		}
+		transfer->responseBuffer = body;
+		transfer->statusCode = Network::HttpOkCode;
+		return;
+	}
+	if (transfer->statusCode != Network::HttpOkCode) {
+		return;
+	}
+	if (transfer->isResponseNoStore || (entry.etag.empty () && entry.lastModified.empty () && (entry.maxAge <= 0))) {
+		if (transfer->isRevalidating) {
+			httpCache->remove (transfer->request.url);
 		}
+		return;
+	}
+	httpCache->store (entry, BufferView (transfer->responseBuffer->data, transfer->responseBuffer->length));
+}
+
+int Network::getHostTransferCount (const StdString &host) const {
+	std::map<StdString, int>::const_iterator pos;
+
+	pos = hostTransferCountMap.find (host);
+	if (pos == hostTransferCountMap.cend ()) {
+		return (0);
 	}
+	return (pos->second);
+}
+
+StdString Network::getUrlHost (const StdString &url) {
+	size_t pos1, pos2;
 
-	curl_easy_cleanup (curl);
-	if (headers) {
-		curl_slist_free_all (headers);
-		headers = NULL;
+	pos1 = url.find ("://");
+	if (pos1 == StdString::npos) {
+		pos1 = 0;
 	}
-	return (result);
+	else {
+		pos1 += 3;
+	}
+	pos2 = url.find_first_of ("/?#", pos1);
+	if (pos2 == StdString::npos) {
+		return (url.substr (pos1));
+	}
+	return (url.substr (pos1, pos2 - pos1));
 }
 
 size_t Network::curlWrite (char *ptr, size_t size, size_t nmemb, void *userdata) {
@@ -939,3 +1245,48 @@ int Network::curlProgress (void *clientp, double dltotal, double dlnow, double u
 	}
 	return (0);
 }
+
+size_t Network::curlHeader (char *buffer, size_t size, size_t nitems, void *userdata) {
+	Network::HttpTransfer *transfer;
+	StdString line, name, value;
+	size_t total, pos;
+	bool nostore;
+
+	transfer = (Network::HttpTransfer *) userdata;
+	total = size * nitems;
+	line.assign (buffer, total);
+	if (line.startsWith ("HTTP/")) {
+		// Each status line begins a new header block, as happens after a redirect or an interim response
+		transfer->responseEtag.assign ("");
+		transfer->responseLastModified.assign ("");
+		transfer->responseMaxAge = -1;
+		transfer->isResponseNoStore = false;
+		return (total);
+	}
+	pos = line.find (':');
+	if (pos == StdString::npos) {
+		return (total);
+	}
+	name = StdString (line.substr (0, pos)).trimmed ().lowercased ();
+	value = StdString (line.substr (pos + 1)).trimmed ();
+	if (name.equals (StdString (Network::HttpEtagHeader).lowercased ())) {
+		transfer->responseEtag.assign (value);
+	}
+	else if (name.equals (StdString (Network::HttpLastModifiedHeader).lowercased ())) {
+		transfer->responseLastModified.assign (value);
+	}
+	else if (name.equals (StdString (Network::HttpCacheControlHeader).lowercased ())) {
+		nostore = false;
+		transfer->responseMaxAge = HttpCache::parseCacheControl (value, &nostore);
+		if (nostore) {
+			transfer->isResponseNoStore = true;
+		}
+	}
+	else if (name.equals (StdString (Network::HttpVaryHeader).lowercased ())) {
+		// Cache entries are keyed by URL alone, so a response selected by request headers can't be reused safely
+		if (! value.empty ()) {
+			transfer->isResponseNoStore = true;
+		}
+	}
+	return (total);
+}
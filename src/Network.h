@@ -37,6 +37,7 @@
 #include "curl/curl.h"
 
 class Buffer;
+class HttpCache;
 class SharedBuffer;
 class StringList;
 
@@ -52,14 +53,25 @@ public:
 	// Clear static instance data
 	static void freeInstance ();
 
-	static constexpr const int defaultMaxRequestThreads = 3;
+	static constexpr const int defaultMaxHttpTransfers = 8;
+	static constexpr const int defaultMaxHostHttpTransfers = 4;
+	static constexpr const int httpPollPeriod = 1000; // milliseconds
+	static constexpr const int maxIdleCurlHandles = 8;
 	static constexpr const char *localhostAddress = "127.0.0.1";
+	static constexpr const char *httpCacheTaskQueueId = "Network::httpCache";
 
 	static constexpr const int HttpOkCode = 200;
+	static constexpr const int HttpNotModifiedCode = 304;
 	static constexpr const int HttpUnauthorizedCode = 401;
 	static constexpr const char *HttpAcceptHeader = "Accept";
+	static constexpr const char *HttpCacheControlHeader = "Cache-Control";
 	static constexpr const char *HttpContentTypeHeader = "Content-Type";
+	static constexpr const char *HttpEtagHeader = "ETag";
 	static constexpr const char *HttpHostHeader = "Host";
+	static constexpr const char *HttpIfModifiedSinceHeader = "If-Modified-Since";
+	static constexpr const char *HttpIfNoneMatchHeader = "If-None-Match";
+	static constexpr const char *HttpLastModifiedHeader = "Last-Modified";
+	static constexpr const char *HttpVaryHeader = "Vary";
 	static constexpr const char *ApplicationJsonContentType = "application/json";
 	static constexpr const char *WwwFormUrlencodedContentType = "application/x-www-form-urlencoded";
 
@@ -88,8 +100,10 @@ public:
 	};
 
 	// Read-write data members
-	int maxRequestThreads;
+	int maxHttpTransfers;
+	int maxHostHttpTransfers;
 	StdString httpUserAgent;
+	StdString httpCachePath;
 	bool allowUnverifiedHttps;
 	bool enableDatagramSocket;
 	Network::DatagramCallbackContext datagramCallback;
@@ -98,6 +112,7 @@ public:
 	bool isStarted;
 	bool isStopped;
 	int datagramPort;
+	HttpCache *httpCache;
 
 	// Initialize networking functionality and acquire resources as needed. Returns a Result value.
 	OpResult start ();
@@ -120,8 +135,8 @@ public:
 	// Send a datagram packet to all known broadcast addresses using data from the provided buffer. This class becomes responsible for freeing messageData when it's no longer needed.
 	void sendBroadcastDatagram (int targetPort, Buffer *messageData);
 
-	// Send an HTTP GET request and invoke the provided callback when complete. If headerList is provided, apply each pair of contained items as the name and value of a request header.
-	void sendHttpGet (const StdString &targetUrl, Network::HttpRequestCallbackContext callback, const StringList &headerList = StringList ());
+	// Send an HTTP GET request and invoke the provided callback when complete. If headerList is provided, apply each pair of contained items as the name and value of a request header. If isCacheEnabled is true and httpCachePath is set, serve the response from the HTTP cache when possible and store cacheable responses.
+	void sendHttpGet (const StdString &targetUrl, Network::HttpRequestCallbackContext callback, const StringList &headerList = StringList (), bool isCacheEnabled = false);
 
 	// Send an HTTP POST request and invoke the provided callback when complete. If headerList is provided, apply each pair of contained items as the name and value of a request header.
 	void sendHttpPost (const StdString &targetUrl, const StdString &postData, Network::HttpRequestCallbackContext callback, const StringList &headerList = StringList ());
@@ -133,8 +148,8 @@ private:
 	// Run a thread that receives messages from datagramSocket
 	static int runDatagramReceiveThread (void *itPtr);
 
-	// Run a thread that sends HTTP requests submitted by outside callers
-	static int runHttpRequestThread (void *itPtr);
+	// Run a thread that executes HTTP requests submitted by outside callers, driving all transfers through curlMulti
+	static int runHttpThread (void *itPtr);
 
 	struct Interface {
 		int id;
@@ -165,8 +180,36 @@ private:
 		StdString postData;
 		StringList headerList;
 		Network::HttpRequestCallbackContext callback;
+		bool isCacheEnabled;
+		StdString host;
+		int64_t sequence;
 		HttpRequestContext ():
-			method ("GET") { }
+			method ("GET"),
+			isCacheEnabled (false),
+			sequence (0) { }
+	};
+	struct HttpTransfer {
+		Network::HttpRequestContext request;
+		StdString host;
+		CURL *curl;
+		struct curl_slist *headers;
+		SharedBuffer *responseBuffer;
+		int statusCode;
+		bool isCacheHit;
+		bool isRevalidating;
+		StdString responseEtag;
+		StdString responseLastModified;
+		int64_t responseMaxAge;
+		bool isResponseNoStore;
+		HttpTransfer ():
+			curl (NULL),
+			headers (NULL),
+			responseBuffer (NULL),
+			statusCode (0),
+			isCacheHit (false),
+			isRevalidating (false),
+			responseMaxAge (-1),
+			isResponseNoStore (false) { }
 	};
 
 	// Populate the interface map with data regarding available network interfaces. Returns a Result value.
@@ -178,8 +221,11 @@ private:
 	// Remove all items from the HTTP request queue
 	void clearHttpRequestQueue ();
 
-	// Wait all HTTP request threads
-	void waitHttpRequestThreads ();
+	// Wait for the HTTP thread to end
+	void waitHttpThread ();
+
+	// Release curl multi, share, and easy handles, and clean up libcurl global state
+	void cleanupCurl ();
 
 	// Execute a sendto call to transmit a datagram packet
 	int sendTo (const StdString &targetHostname, int targetPort, Buffer *messageData);
@@ -187,11 +233,40 @@ private:
 	// Execute sendto calls to transmit a datagram packet to each available broadcast address
 	int broadcastSendTo (int targetPort, Buffer *messageData);
 
-	// Execute operations to send an HTTP request and gather the response data. Returns a Result value. If successful, this method stores values in the provided pointers, and the caller is responsible for releasing any created SharedBuffer object.
-	OpResult sendHttpRequest (Network::HttpRequestContext *item, int *statusCode, SharedBuffer **responseBuffer);
+	// Add an HTTP request to the queue for its host and wake the HTTP thread
+	void enqueueHttpRequest (Network::HttpRequestContext *item);
+
+	// Remove the oldest queued HTTP request whose host has fewer than maxHostHttpTransfers active transfers, store it in destItem, and return a boolean value indicating if a request was found. Must be invoked while holding httpRequestQueueMutex.
+	bool dequeueHttpRequest (Network::HttpRequestContext *destItem);
+
+	// Return a boolean value indicating if the provided HTTP request has a fresh response in httpCache
+	bool hasFreshCacheEntry (const Network::HttpRequestContext &item);
+
+	// Run a task that completes transfer by applying httpCache updates or reading a cached body, then invoking the request callback and freeing transfer. If the task can't be started, execute it on the calling thread.
+	void startHttpResponseTask (Network::HttpTransfer *transfer);
+
+	// Task functions
+	static void runHttpResponse (void *transferPtr);
+	void executeHttpResponse (Network::HttpTransfer *transfer);
+
+	// Add a transfer for the provided HTTP request to curlMulti. Returns a Result value.
+	OpResult startHttpTransfer (const Network::HttpRequestContext &item);
+
+	// Remove a transfer from curlMulti after it completes with the provided result code and start a task to deliver its response
+	void endHttpTransfer (Network::HttpTransfer *transfer, CURLcode code);
+
+	// Apply the response of a completed cache-enabled transfer to httpCache, replacing a not-modified status and empty body with the stored response where applicable
+	void updateHttpCache (Network::HttpTransfer *transfer);
+
+	// Return the number of active transfers for the specified host
+	int getHostTransferCount (const StdString &host) const;
+
+	// Return the host portion of the provided URL
+	static StdString getUrlHost (const StdString &url);
 
 	// Callback functions for use with libcurl
 	static size_t curlWrite (char *ptr, size_t size, size_t nmemb, void *userdata);
+	static size_t curlHeader (char *buffer, size_t size, size_t nitems, void *userdata);
 	static int curlProgress (void *clientp, double dltotal, double dlnow, double ultotal, double ulnow);
 
 	std::map<StdString, Network::Interface> interfaceMap;
@@ -201,12 +276,17 @@ private:
 	SDL_mutex *datagramSendMutex;
 	SDL_cond *datagramSendCond;
 	int datagramSocket;
-	std::queue<Network::HttpRequestContext> httpRequestQueue;
+	std::map<StdString, std::queue<Network::HttpRequestContext>> httpRequestQueueMap;
+	int64_t nextHttpRequestSequence;
 	std::list<Network::HttpRequestContext> httpShutdownList;
 	SDL_mutex *httpRequestQueueMutex;
-	SDL_cond *httpRequestQueueCond;
-	std::list<SDL_Thread *> httpRequestThreadList;
-	int httpRequestThreadStopCount;
+	SDL_Thread *httpThread;
+	bool isHttpThreadEnded;
+	CURLM *curlMulti;
+	CURLSH *curlShare;
+	std::list<Network::HttpTransfer *> httpTransferList;
+	std::map<StdString, int> hostTransferCountMap;
+	std::list<CURL *> idleCurlHandles;
 	StdString caBundle;
 	struct curl_blob caBundleBlob;
 #if PLATFORM_WINDOWS
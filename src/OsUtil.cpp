@@ -39,20 +39,30 @@
 #include <dirent.h>
 #include <signal.h>
 #endif
+#if PLATFORM_MACOS
+#include <mach/mach.h>
+#endif
 #if PLATFORM_WINDOWS
 #include <time.h>
 #include <windows.h>
 #include <processthreadsapi.h>
+#include <psapi.h>
 #include <ShellAPI.h>
+#include <io.h>
 #endif
 #include <sys/stat.h>
 #include <errno.h>
 #include "StringList.h"
 #include "Buffer.h"
+#include "BufferView.h"
 #include "OsUtil.h"
 
 const char *OsUtil::monthNames[12] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
 
+constexpr const int fingerprintBlockSize = (64 * 1024);
+constexpr const uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+constexpr const uint64_t fnvPrime = 1099511628211ULL;
+
 int64_t OsUtil::getTime () {
 	int64_t t;
 #if PLATFORM_LINUX || PLATFORM_MACOS
@@ -104,6 +114,45 @@ int OsUtil::getProcessId () {
 #endif
 }
 
+int64_t OsUtil::getProcessMemorySize () {
+#if PLATFORM_LINUX
+	FILE *fp;
+	long long int pages, residentpages;
+	long pagesize;
+	int result;
+
+	fp = fopen ("/proc/self/statm", "r");
+	if (! fp) {
+		return (0);
+	}
+	result = fscanf (fp, "%lli %lli", &pages, &residentpages);
+	fclose (fp);
+	pagesize = sysconf (_SC_PAGESIZE);
+	if ((result != 2) || (pagesize <= 0)) {
+		return (0);
+	}
+	return ((int64_t) residentpages * pagesize);
+#endif
+#if PLATFORM_MACOS
+	struct mach_task_basic_info info;
+	mach_msg_type_number_t count;
+
+	count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info (mach_task_self (), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS) {
+		return (0);
+	}
+	return ((int64_t) info.resident_size);
+#endif
+#if PLATFORM_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (! K32GetProcessMemoryInfo (GetCurrentProcess (), &counters, sizeof (counters))) {
+		return (0);
+	}
+	return ((int64_t) counters.WorkingSetSize);
+#endif
+}
+
 StdString OsUtil::getTimestampString (int64_t timestamp, bool isTimezoneEnabled) {
 	StdString s;
 #if PLATFORM_LINUX || PLATFORM_MACOS
@@ -630,26 +679,42 @@ bool OsUtil::fileExists (const StdString &path) {
 
 Buffer *OsUtil::readFile (const StdString &path) {
 	Buffer *buf;
+
+	buf = new Buffer ();
+	if (! OsUtil::readFile (path, buf)) {
+		delete (buf);
+		return (NULL);
+	}
+	return (buf);
+}
+bool OsUtil::readFile (const StdString &path, Buffer *destBuffer) {
 	FILE *fp;
 	uint8_t data[8192];
+	long filesize;
 	int len;
 
 	fp = fopen (path.c_str (), "rb");
 	if (! fp) {
-		return (NULL);
+		return (false);
+	}
+	if (fseek (fp, 0, SEEK_END) == 0) {
+		filesize = ftell (fp);
+		if ((filesize > 0) && (filesize < INT32_MAX)) {
+			destBuffer->reserve (destBuffer->length + (int) filesize);
+		}
+		fseek (fp, 0, SEEK_SET);
 	}
-	buf = new Buffer ();
 	while (true) {
 		len = (int) fread (data, 1, sizeof (data), fp);
 		if (len > 0) {
-			buf->add (data, len);
+			destBuffer->add (data, len);
 		}
 		if (len < (int) sizeof (data)) {
 			break;
 		}
 	}
 	fclose (fp);
-	return (buf);
+	return (true);
 }
 
 OpResult OsUtil::readFileLines (const StdString &path, OsUtil::ReadFileLinesCallback callback, void *callbackData, int maxLineLength) {
@@ -777,6 +842,82 @@ OpResult OsUtil::writeFile (const StdString &path, Buffer *writeData, bool freeW
 	return (result);
 }
 
+OpResult OsUtil::writeFileReplace (const StdString &path, Buffer *writeData, bool freeWriteData) {
+	OpResult result;
+
+	if (! writeData) {
+		return (OpResult::InvalidParamError);
+	}
+	result = OsUtil::writeFileReplace (path, BufferView (writeData->data, writeData->length));
+	if (freeWriteData) {
+		delete (writeData);
+	}
+	return (result);
+}
+OpResult OsUtil::writeFileReplace (const StdString &path, const BufferView &writeData) {
+	OpResult result;
+	StdString tmppath;
+	FILE *fp;
+	size_t wlen, datalen;
+	const uint8_t *pos;
+
+	if (path.empty ()) {
+		return (OpResult::InvalidParamError);
+	}
+	result = OpResult::Success;
+	tmppath.sprintf ("%s.tmp", path.c_str ());
+	fp = fopen (tmppath.c_str (), "wb");
+	if (! fp) {
+		result = OpResult::FileOpenFailedError;
+	}
+	else {
+		pos = writeData.data;
+		datalen = (size_t) writeData.length;
+		while (datalen > 0) {
+			wlen = fwrite (pos, 1, datalen, fp);
+			if (wlen <= 0) {
+				result = OpResult::FileOperationFailedError;
+				break;
+			}
+			datalen -= wlen;
+			pos += wlen;
+		}
+		if (fflush (fp) != 0) {
+			result = OpResult::FileOperationFailedError;
+		}
+#if PLATFORM_LINUX || PLATFORM_MACOS
+		if ((result == OpResult::Success) && (fsync (fileno (fp)) != 0)) {
+			result = OpResult::FileOperationFailedError;
+		}
+#endif
+#if PLATFORM_WINDOWS
+		if ((result == OpResult::Success) && (! FlushFileBuffers ((HANDLE) _get_osfhandle (_fileno (fp))))) {
+			result = OpResult::FileOperationFailedError;
+		}
+#endif
+		if (fclose (fp) != 0) {
+			result = OpResult::FileOperationFailedError;
+		}
+	}
+
+	if (result == OpResult::Success) {
+#if PLATFORM_LINUX || PLATFORM_MACOS
+		if (rename (tmppath.c_str (), path.c_str ()) != 0) {
+			result = OpResult::FileOperationFailedError;
+		}
+#endif
+#if PLATFORM_WINDOWS
+		if (! MoveFileEx (tmppath.c_str (), path.c_str (), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+			result = OpResult::FileOperationFailedError;
+		}
+#endif
+	}
+	if (result != OpResult::Success) {
+		OsUtil::removeFile (tmppath);
+	}
+	return (result);
+}
+
 OpResult OsUtil::removeFile (const StdString &path) {
 #if PLATFORM_LINUX || PLATFORM_MACOS
 	if (unlink (path.c_str ()) != 0) {
@@ -859,6 +1000,60 @@ int64_t OsUtil::getFileSize (const StdString &path) {
 #endif
 }
 
+StdString OsUtil::getFileFingerprint (const StdString &path) {
+	FILE *fp;
+	uint8_t *data, *d, *end;
+	int64_t size, offsets[3];
+	uint64_t hashes[3];
+	int i, len;
+	bool seekok;
+
+	size = OsUtil::getFileSize (path);
+	if (size < 0) {
+		return (StdString ());
+	}
+	fp = fopen (path.c_str (), "rb");
+	if (! fp) {
+		return (StdString ());
+	}
+	data = (uint8_t *) malloc (fingerprintBlockSize);
+	if (! data) {
+		fclose (fp);
+		return (StdString ());
+	}
+	offsets[0] = 0;
+	offsets[1] = (size > fingerprintBlockSize) ? ((size - fingerprintBlockSize) / 2) : 0;
+	offsets[2] = (size > fingerprintBlockSize) ? (size - fingerprintBlockSize) : 0;
+	for (i = 0; i < 3; ++i) {
+#if PLATFORM_WINDOWS
+		seekok = (_fseeki64 (fp, offsets[i], SEEK_SET) == 0);
+#else
+		seekok = (fseeko (fp, (off_t) offsets[i], SEEK_SET) == 0);
+#endif
+		if (! seekok) {
+			break;
+		}
+		len = (int) fread (data, 1, fingerprintBlockSize, fp);
+		if (ferror (fp)) {
+			break;
+		}
+		hashes[i] = fnvOffsetBasis;
+		d = data;
+		end = data + len;
+		while (d < end) {
+			hashes[i] ^= *d;
+			hashes[i] *= fnvPrime;
+			++d;
+		}
+	}
+	free (data);
+	fclose (fp);
+	if (i < 3) {
+		return (StdString ());
+	}
+	return (StdString::createSprintf ("%llx:%016llx:%016llx:%016llx", (unsigned long long int) size, (unsigned long long int) hashes[0], (unsigned long long int) hashes[1], (unsigned long long int) hashes[2]));
+}
+
 int64_t OsUtil::getDirectorySize (const StdString &path) {
 	StringList files;
 	StringList::const_iterator i1, i2;
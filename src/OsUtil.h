@@ -35,6 +35,7 @@
 #define OS_UTIL_H
 
 class Buffer;
+class BufferView;
 class StringList;
 
 class OsUtil {
@@ -55,6 +56,12 @@ public:
 	static constexpr const char *displayModeEnvKey = "DISPLAY_MODE";
 	static constexpr const char *runScriptEnvKey = "RUN_SCRIPT";
 	static constexpr const char *runFileEnvKey = "RUN_FILE";
+	static constexpr const char *prefsWriteDelayEnvKey = "PREFS_WRITE_DELAY";
+	static constexpr const char *captureVideoPresetEnvKey = "CAPTURE_VIDEO_PRESET";
+	static constexpr const char *captureVideoThreadsEnvKey = "CAPTURE_VIDEO_THREADS";
+	static constexpr const char *captureVideoScaleThreadsEnvKey = "CAPTURE_VIDEO_SCALE_THREADS";
+	static constexpr const char *captureSkipDuplicateFramesEnvKey = "CAPTURE_SKIP_DUPLICATE_FRAMES";
+	static constexpr const char *profileTraceFilenameEnvKey = "PROFILE_TRACE_FILENAME";
 
 	// Return the current time in milliseconds since the epoch
 	static int64_t getTime ();
@@ -65,6 +72,9 @@ public:
 	// Return the application's process ID
 	static int getProcessId ();
 
+	// Return the application's resident memory size in bytes, or zero if the value could not be determined
+	static int64_t getProcessMemorySize ();
+
 	// Return a string containing formatted text representing the time and date of the specified millisecond timestamp. A timestamp of zero or less indicates that the current timestamp should be used.
 	static StdString getTimestampString (int64_t timestamp = 0, bool isTimezoneEnabled = false);
 
@@ -123,6 +133,9 @@ public:
 	// Read the file at the specified path and return a newly created Buffer object holding the resulting data, or NULL if the file read failed. If a Buffer is returned by this method, the caller must delete it when no longer needed.
 	static Buffer *readFile (const StdString &path);
 
+	// Read the file at the specified path, append its data to destBuffer, and return a boolean value indicating if the file read succeeded
+	static bool readFile (const StdString &path, Buffer *destBuffer);
+
 	typedef OpResult (*ReadFileLinesCallback) (void *data, const StdString &line);
 	// Read the file at the specified path, invoke the provided callback with text preceding each newline, and return a result value
 	static OpResult readFileLines (const StdString &path, OsUtil::ReadFileLinesCallback callback, void *callbackData, int maxLineLength = 65536);
@@ -130,6 +143,10 @@ public:
 	// Write file data to the specified path and return a Result value. If freeWriteData is true, free the writeData buffer.
 	static OpResult writeFile (const StdString &path, Buffer *writeData, bool freeWriteData = true);
 
+	// Write file data to a temporary file, then rename it to the specified path, replacing any previous file in a single operation. Returns a Result value. If freeWriteData is true, free the writeData buffer.
+	static OpResult writeFileReplace (const StdString &path, Buffer *writeData, bool freeWriteData = true);
+	static OpResult writeFileReplace (const StdString &path, const BufferView &writeData);
+
 	// Remove the named file and return a Result value
 	static OpResult removeFile (const StdString &path);
 
@@ -145,6 +162,9 @@ public:
 	// Return the size of the regular file at the specified path, or -1 if no such file was found
 	static int64_t getFileSize (const StdString &path);
 
+	// Return a content fingerprint for the regular file at the specified path, composed of the file size and hashes of blocks read from the start, middle, and end of the file, or an empty string if the file could not be read
+	static StdString getFileFingerprint (const StdString &path);
+
 	// Return the total size of files in the directory at the specified path, or -1 if no such directory was found
 	static int64_t getDirectorySize (const StdString &path);
 
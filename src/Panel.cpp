@@ -101,6 +101,7 @@ Panel::Panel ()
 , dropShadowWidth (0.0f)
 , isFixedSize (false)
 , isWaiting (false)
+, isLayerCacheEnabled (false)
 , layout (Panel::NoLayout)
 , detailSize (-1)
 , detailMaxWidth (0.0f)
@@ -328,6 +329,7 @@ void Panel::removeWidget (Widget *targetWidget) {
 		if (widget == targetWidget) {
 			widgetList.erase (i1);
 			widget->release ();
+			invalidateLayerContent ();
 			break;
 		}
 		++i1;
@@ -480,17 +482,27 @@ void Panel::doUpdate (int msElapsed) {
 	std::list<Widget *> addwidgets;
 	std::list<Widget *>::iterator i1, i2;
 	Widget *widget;
-	bool found;
+	bool found, changed;
 
 	bgColor.update (msElapsed);
 	borderColor.update (msElapsed);
+	changed = false;
+	if ((! bgColor.equals (layerBgColor)) || (! borderColor.equals (layerBorderColor)) || (! dropShadowColor.equals (layerDropShadowColor))) {
+		layerBgColor.assign (bgColor);
+		layerBorderColor.assign (borderColor);
+		layerDropShadowColor.assign (dropShadowColor);
+		changed = true;
+	}
 
 	SDL_LockMutex (widgetAddListMutex);
 	addwidgets.swap (widgetAddList);
 	SDL_UnlockMutex (widgetAddListMutex);
 
 	SDL_LockMutex (widgetListMutex);
-	widgetList.splice (widgetList.end (), addwidgets);
+	if (! addwidgets.empty ()) {
+		widgetList.splice (widgetList.end (), addwidgets);
+		changed = true;
+	}
 	while (true) {
 		found = false;
 		i1 = widgetList.begin ();
@@ -508,6 +520,7 @@ void Panel::doUpdate (int msElapsed) {
 		if (! found) {
 			break;
 		}
+		changed = true;
 	}
 	sortWidgetList ();
 	resetExtents ();
@@ -517,10 +530,21 @@ void Panel::doUpdate (int msElapsed) {
 	while (i1 != i2) {
 		widget = *i1;
 		widget->update (msElapsed, screenX - viewOriginX, screenY - viewOriginY);
+		if (widget->isLayerInvalid) {
+			widget->isLayerInvalid = false;
+			changed = true;
+		}
 		++i1;
 	}
 	SDL_UnlockMutex (widgetListMutex);
 
+	if (isLayerCacheEnabled && (! isComposeDrawEnabled)) {
+		setComposeDraw (true);
+	}
+	if (changed) {
+		invalidateLayerContent ();
+	}
+
 	waitPanelHandle.compact ();
 	waitProgressBarHandle.compact ();
 	if (waitPanel) {
@@ -771,7 +795,7 @@ void Panel::doResetInputState () {
 void Panel::doDraw (double originX, double originY) {
 	SDL_Renderer *render;
 	SDL_Texture *cornertexture;
-	SDL_Rect rect;
+	SDL_Rect rect, srcrect;
 	std::list<Widget *>::iterator i1, i2;
 	Widget *widget;
 	int x0, y0, texturew, textureh;
@@ -797,7 +821,7 @@ void Panel::doDraw (double originX, double originY) {
 
 		if ((cornerSize > 0) && ((int) width >= cornerSize) && ((int) height >= cornerSize)) {
 			if (topLeftCornerRadius > 0) {
-				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (topLeftCornerRadius, &texturew, &textureh);
+				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (topLeftCornerRadius, &texturew, &textureh, NULL, &srcrect);
 				if (cornertexture) {
 					rect.x = x0;
 					rect.y = y0;
@@ -810,13 +834,13 @@ void Panel::doDraw (double originX, double originY) {
 					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
 					SDL_SetTextureAlphaMod (cornertexture, bgColor.aByte);
 					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					SDL_RenderCopy (render, cornertexture, &srcrect, &rect);
 
 					App::instance->popClipRect ();
 				}
 			}
 			if (topRightCornerRadius > 0) {
-				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (topRightCornerRadius, &texturew, &textureh);
+				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (topRightCornerRadius, &texturew, &textureh, NULL, &srcrect);
 				if (cornertexture) {
 					rect.x = x0 + (int) width - topRightCornerRadius;
 					rect.y = y0;
@@ -830,13 +854,13 @@ void Panel::doDraw (double originX, double originY) {
 					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
 					SDL_SetTextureAlphaMod (cornertexture, bgColor.aByte);
 					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					SDL_RenderCopy (render, cornertexture, &srcrect, &rect);
 
 					App::instance->popClipRect ();
 				}
 			}
 			if (bottomLeftCornerRadius > 0) {
-				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (bottomLeftCornerRadius, &texturew, &textureh);
+				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (bottomLeftCornerRadius, &texturew, &textureh, NULL, &srcrect);
 				if (cornertexture) {
 					rect.x = x0;
 					rect.y = y0 + (int) height - bottomLeftCornerRadius;
@@ -850,13 +874,13 @@ void Panel::doDraw (double originX, double originY) {
 					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
 					SDL_SetTextureAlphaMod (cornertexture, bgColor.aByte);
 					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					SDL_RenderCopy (render, cornertexture, &srcrect, &rect);
 
 					App::instance->popClipRect ();
 				}
 			}
 			if (bottomRightCornerRadius > 0) {
-				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (bottomRightCornerRadius, &texturew, &textureh);
+				cornertexture = RenderResource::instance->roundedCornerSprite->getScaleTexture (bottomRightCornerRadius, &texturew, &textureh, NULL, &srcrect);
 				if (cornertexture) {
 					rect.x = x0 + (int) width - bottomRightCornerRadius;
 					rect.y = y0 + (int) height - bottomRightCornerRadius;
@@ -871,7 +895,7 @@ void Panel::doDraw (double originX, double originY) {
 					SDL_SetTextureColorMod (cornertexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
 					SDL_SetTextureAlphaMod (cornertexture, bgColor.aByte);
 					SDL_SetTextureBlendMode (cornertexture, SDL_BLENDMODE_BLEND);
-					SDL_RenderCopy (render, cornertexture, NULL, &rect);
+					SDL_RenderCopy (render, cornertexture, &srcrect, &rect);
 
 					App::instance->popClipRect ();
 				}
@@ -1457,6 +1481,26 @@ void Panel::sortWidgetList () {
 	}
 
 	widgetList.sort (Widget::compareZLevel);
+	invalidateLayerContent ();
+}
+
+void Panel::invalidateLayerContent () {
+	invalidateLayer ();
+	if (isComposeDrawEnabled) {
+		shouldComposeRender = true;
+	}
+}
+
+void Panel::setLayerCache (bool enable) {
+	if (enable && (! App::instance->isTextureRenderEnabled)) {
+		enable = false;
+	}
+	if (isLayerCacheEnabled == enable) {
+		return;
+	}
+	isLayerCacheEnabled = enable;
+	setComposeDraw (isLayerCacheEnabled);
+	invalidateLayer ();
 }
 
 void Panel::setLayout (int layoutType) {
@@ -1475,6 +1519,7 @@ void Panel::setFillBg (bool enable, const Color &color) {
 	else {
 		isFilledBg = false;
 	}
+	invalidateLayerContent ();
 }
 
 void Panel::setCornerRadius (int radius) {
@@ -1660,6 +1705,7 @@ void Panel::setCornerRadius (int topLeftRadius, int topRightRadius, int bottomLe
 		amt = bottomRightRadius;
 	}
 	cornerSize = amt * 2;
+	invalidateLayerContent ();
 }
 
 void Panel::setBorder (bool enable, const Color &color, double borderWidthValue) {
@@ -1674,6 +1720,7 @@ void Panel::setBorder (bool enable, const Color &color, double borderWidthValue)
 	else {
 		isBordered = false;
 	}
+	invalidateLayerContent ();
 }
 
 void Panel::setDropShadow (bool enable, const Color &color, double dropShadowWidthValue) {
@@ -1688,6 +1735,7 @@ void Panel::setDropShadow (bool enable, const Color &color, double dropShadowWid
 	else {
 		isDropShadowed = false;
 	}
+	invalidateLayerContent ();
 }
 
 void Panel::doSetExtents () {
@@ -1718,6 +1766,7 @@ void Panel::setViewOrigin (double originX, double originY) {
 	}
 	viewOriginX = x;
 	viewOriginY = y;
+	invalidateLayerContent ();
 	doSetViewOrigin ();
 }
 
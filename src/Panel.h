@@ -116,6 +116,7 @@ public:
 	double dropShadowWidth;
 	bool isFixedSize;
 	bool isWaiting;
+	bool isLayerCacheEnabled;
 	int layout;
 	int detailSize;
 	double detailMaxWidth;
@@ -220,6 +221,9 @@ public:
 	// Set the waiting option. If enabled, the panel disables input, shades it content, and shows a progress bar widget.
 	void setWaiting (bool enable);
 
+	// Set the layer cache option. If enabled, the panel renders its content to a retained texture and renders again only after a change to the layout or drawn state of the panel or its child widgets. Content drawn outside the panel's extent, such as its drop shadow, is not retained.
+	void setLayerCache (bool enable);
+
 	// Update widget state to reflect the latest input events
 	void processInput ();
 
@@ -274,6 +278,9 @@ protected:
 	// Check if the widget list is correctly sorted for drawing by z-level, and sort the list if not. This method must only be invoked while holding a lock on widgetListMutex.
 	void sortWidgetList ();
 
+	// Mark the panel's own drawn content as changed, causing its cached layer and any cached layer that holds the panel to render again
+	void invalidateLayerContent ();
+
 	bool isMouseInputStarted;
 	int lastMouseLeftUpCount;
 	int lastMouseLeftDownCount;
@@ -314,5 +321,8 @@ protected:
 	WidgetHandle<Panel> waitPanelHandle;
 	ProgressBar *waitProgressBar;
 	WidgetHandle<ProgressBar> waitProgressBarHandle;
+	Color layerBgColor;
+	Color layerBorderColor;
+	Color layerDropShadowColor;
 };
 #endif
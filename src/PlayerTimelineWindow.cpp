@@ -35,6 +35,7 @@
 #include "ClassId.h"
 #include "SystemInterface.h"
 #include "RecordStore.h"
+#include "SharedMediaItem.h"
 #include "Widget.h"
 #include "Color.h"
 #include "Label.h"
@@ -104,7 +105,7 @@ PlayerTimelineWindow::~PlayerTimelineWindow () {
 }
 
 void PlayerTimelineWindow::readRecord (const StdString &recordIdValue) {
-	Json *record;
+	SharedMediaItem *item;
 	double w;
 
 	if (recordId.equals (recordIdValue)) {
@@ -115,13 +116,13 @@ void PlayerTimelineWindow::readRecord (const StdString &recordIdValue) {
 	if (recordType != SystemInterface::CommandId_MediaItem) {
 		return;
 	}
-	record = RecordStore::instance->find (recordIdValue, recordType);
-	if (! record) {
+	item = RecordStore::instance->findMediaItem (recordIdValue);
+	if (! item) {
 		recordType = -1;
 	}
 	else {
-		playDuration = SystemInterface::instance->getCommandNumberParam (record, SystemInterface::Field_duration, (int64_t) 0);
-		delete (record);
+		playDuration = item->item.duration;
+		item->release ();
 	}
 	if (recordType < 0) {
 		return;
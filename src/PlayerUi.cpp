@@ -49,6 +49,7 @@
 #include "Toolbar.h"
 #include "SystemInterface.h"
 #include "RecordStore.h"
+#include "SharedMediaItem.h"
 #include "Database.h"
 #include "CardView.h"
 #include "Menu.h"
@@ -707,7 +708,7 @@ void PlayerUi::doResize_processItems (void *itPtr, Widget *itemWidget) {
 void PlayerUi::doSyncRecordStore () {
 	StringList::const_iterator i1, i2;
 	StdString mediaid;
-	Json record;
+	SharedMediaItem *record;
 	MediaItemWindow *item;
 	MediaItemDetailWindow *mediaitemdetail;
 	MediaItemImageWindow *mediaitemimage;
@@ -718,17 +719,19 @@ void PlayerUi::doSyncRecordStore () {
 	while (i1 != i2) {
 		mediaid = *i1;
 		if (! cardView->contains (mediaid)) {
-			if (RecordStore::instance->find (&record, mediaid, SystemInterface::CommandId_MediaItem, true)) {
+			record = RecordStore::instance->findMediaItem (mediaid, true);
+			if (record) {
 				if (mediaWindowMode == DetailLineWindowMode) {
-					mediaitemdetail = new MediaItemDetailWindow (&record);
+					mediaitemdetail = new MediaItemDetailWindow (record);
 					item = mediaitemdetail;
 					row = MediaItemDetailRow;
 				}
 				else {
-					mediaitemimage = new MediaItemImageWindow (&record);
+					mediaitemimage = new MediaItemImageWindow (record);
 					item = mediaitemimage;
 					row = MediaItemImageRow;
 				}
+				record->release ();
 
 				item->mediaImageClickCallback = Widget::EventCallbackContext (PlayerUi::mediaItemWindowImageClicked, this);
 				item->viewButtonClickCallback = Widget::EventCallbackContext (PlayerUi::mediaItemWindowViewButtonClicked, this);
@@ -1597,7 +1600,6 @@ void PlayerUi::executeAddTags (PlayerUi::TagTask *task) {
 	OpResult result;
 	StringList::const_iterator i1, i2;
 	MediaItem mediaitem;
-	Json *record;
 	bool err;
 
 	if (task->tag.empty () || task->mediaItemIds.empty ()) {
@@ -1616,9 +1618,8 @@ void PlayerUi::executeAddTags (PlayerUi::TagTask *task) {
 					err = true;
 				}
 				else {
-					record = mediaitem.createRecord (MediaControl::instance->agentId);
-					RecordStore::instance->insert (record);
-					delete (record);
+					RecordStore::instance->insertMediaItem (mediaitem, MediaControl::instance->agentId);
+					MediaControl::instance->clearMediaCountCache ();
 				}
 			}
 		}
@@ -1647,7 +1648,6 @@ void PlayerUi::executeRemoveTags (PlayerUi::TagTask *task) {
 	OpResult result;
 	StringList::const_iterator i1, i2;
 	MediaItem mediaitem;
-	Json *record;
 	bool err;
 
 	if (task->tag.empty () || task->mediaItemIds.empty ()) {
@@ -1666,9 +1666,8 @@ void PlayerUi::executeRemoveTags (PlayerUi::TagTask *task) {
 					err = true;
 				}
 				else {
-					record = mediaitem.createRecord (MediaControl::instance->agentId);
-					RecordStore::instance->insert (record);
-					delete (record);
+					RecordStore::instance->insertMediaItem (mediaitem, MediaControl::instance->agentId);
+					MediaControl::instance->clearMediaCountCache ();
 				}
 			}
 		}
@@ -51,6 +51,7 @@
 #include "TextFlow.h"
 #include "ProgressRing.h"
 #include "IconLabelWindow.h"
+#include "StatsWindow.h"
 #include "Video.h"
 #include "WaveformShader.h"
 #include "PlayerTimelineWindow.h"
@@ -69,6 +70,9 @@ constexpr const int subtitleZLevel = 2;
 constexpr const int messageZLevel = 3;
 constexpr const int timelineZLevel = 4;
 constexpr const int controlZLevel = 5;
+constexpr const int statsUpdatePeriod = 1000; // ms
+
+std::atomic<bool> PlayerWindow::isPlaybackStatsVisible (false);
 
 PlayerWindow::PlayerWindow (double windowWidth, double windowHeight, int soundMixVolume, bool isSoundMuted)
 : Panel ()
@@ -100,6 +104,8 @@ PlayerWindow::PlayerWindow (double windowWidth, double windowHeight, int soundMi
 , subtitleBottomMargin (0.0f)
 , progressRingHandle (&progressRing)
 , progressRingShowClock (0)
+, statsWindowHandle (&statsWindow)
+, statsUpdateClock (0)
 , isPlayStarting (false)
 , maximizeWidth (1.0f)
 , maximizeHeight (1.0f)
@@ -376,6 +382,9 @@ void PlayerWindow::reflow () {
 	if (waveform) {
 		waveform->position.assign ((width / 2.0f) - (waveform->width / 2.0f), height - waveform->height);
 	}
+	if (statsWindow) {
+		statsWindow->position.assign (width - statsWindow->width, closeButton->height);
+	}
 
 	if (width < (App::instance->drawableWidth * 0.25f)) {
 		subtitleFont = UiConfiguration::SmallSubtitleFont;
@@ -490,6 +499,7 @@ void PlayerWindow::doUpdate (int msElapsed) {
 		}
 	}
 
+	updatePlaybackStats (msElapsed);
 	timeline->setPlayPosition (video->isPlaying ? video->playTimestamp : -1);
 	if ((recordType < 0) || (! timeline->isVisible) || (timelineHoverTimestamp < 0) || (video->videoStreamFrameWidth <= 0) || (video->videoStreamFrameHeight <= 0)) {
 		timelinePopupHandle.destroyAndClear ();
@@ -570,6 +580,40 @@ void PlayerWindow::doUpdate (int msElapsed) {
 	}
 }
 
+void PlayerWindow::updatePlaybackStats (int msElapsed) {
+	Video::PlaybackStats stats;
+	StdString maxtext;
+
+	if (! isPlaybackStatsVisible) {
+		if (statsWindow) {
+			statsWindowHandle.destroyAndClear ();
+		}
+		return;
+	}
+	if (! statsWindow) {
+		statsWindowHandle.assign (new StatsWindow ());
+		statsWindow->setFillBg (true, Color (0.0f, 0.0f, 0.0f, UiConfiguration::instance->scrimBackgroundAlpha));
+		statsWindow->isInputSuspended = true;
+		add (statsWindow, messageZLevel);
+		statsUpdateClock = 0;
+	}
+	statsUpdateClock -= msElapsed;
+	if (statsUpdateClock > 0) {
+		return;
+	}
+	statsUpdateClock = statsUpdatePeriod;
+
+	video->getPlaybackStats (&stats);
+	maxtext = UiText::instance->getText (UiTextId::Max);
+	statsWindow->setItem (UiText::instance->getText (UiTextId::Frames).capitalized (), StdString::createSprintf ("%i %s, %i %s, %i %s", stats.videoFrameRenderCount, UiText::instance->getText (UiTextId::Rendered).c_str (), stats.videoPacketDropCount, UiText::instance->getText (UiTextId::DroppedLate).c_str (), stats.videoFrameSkipCount, UiText::instance->getText (UiTextId::Skipped).c_str ()));
+	statsWindow->setItem (UiText::instance->getText (UiTextId::Decode).capitalized (), StdString::createSprintf ("p50 %lli p95 %lli %s %lli us", (long long int) stats.decodeTime.getPercentile (50.0f), (long long int) stats.decodeTime.getPercentile (95.0f), maxtext.c_str (), (long long int) stats.decodeTime.max));
+	statsWindow->setItem (UiText::instance->getText (UiTextId::Scale).capitalized (), StdString::createSprintf ("p50 %lli p95 %lli %s %lli us", (long long int) stats.scaleTime.getPercentile (50.0f), (long long int) stats.scaleTime.getPercentile (95.0f), maxtext.c_str (), (long long int) stats.scaleTime.max));
+	statsWindow->setItem (UiText::instance->getText (UiTextId::Upload).capitalized (), StdString::createSprintf ("p50 %lli p95 %lli %s %lli us", (long long int) stats.textureUploadTime.getPercentile (50.0f), (long long int) stats.textureUploadTime.getPercentile (95.0f), maxtext.c_str (), (long long int) stats.textureUploadTime.max));
+	statsWindow->setItem (UiText::instance->getText (UiTextId::AvDrift), StdString::createSprintf ("%lli ms, p95 %lli ms", (long long int) stats.avDrift, (long long int) stats.avDriftSize.getPercentile (95.0f)));
+	statsWindow->setItem (UiText::instance->getText (UiTextId::Queue).capitalized (), StdString::createSprintf ("%i %s (%s %i), %lli ms %s", stats.framesQueueDepth, UiText::instance->getText (UiTextId::Frames).c_str (), maxtext.c_str (), stats.maxFramesQueueDepth, (long long int) stats.audioBufferedTime, UiText::instance->getText (UiTextId::Audio).c_str ()));
+	statsWindow->position.assign (width - statsWindow->width, closeButton->height);
+}
+
 bool PlayerWindow::doProcessMouseState (const Widget::MouseState &mouseState) {
 	bool consumed;
 
@@ -891,6 +935,7 @@ void PlayerWindow::setVisualizerType (int typeValue) {
 			waveform->setSourceVideo (video);
 			addWidget (waveform, visualizerZLevel);
 		}
+		waveform->setDisplayMode ((visualizerType == PlayerWindow::SpectrumVisualizer) ? WaveformShader::SpectrumMode : WaveformShader::WaveformMode);
 		reflow ();
 	}
 }
@@ -910,7 +955,8 @@ void PlayerWindow::getWaveformSize (double *w, double *h) {
 			*h = windowHeight;
 			break;
 		}
-		case PlayerWindow::MediumWaveformVisualizer: {
+		case PlayerWindow::MediumWaveformVisualizer:
+		case PlayerWindow::SpectrumVisualizer: {
 			*w = windowWidth;
 			*h = windowHeight * 0.25f;
 			break;
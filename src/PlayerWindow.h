@@ -34,6 +34,7 @@
 #ifndef PLAYER_WINDOW_H
 #define PLAYER_WINDOW_H
 
+#include <atomic>
 #include "SoundMixer.h"
 #include "MediaItem.h"
 #include "Position.h"
@@ -53,6 +54,7 @@ class TextFlow;
 class ProgressRing;
 class IconLabelWindow;
 class PlayerTimelineWindow;
+class StatsWindow;
 
 class PlayerWindow : public Panel {
 public:
@@ -63,6 +65,7 @@ public:
 	static PlayerWindow *castWidget (Widget *widget);
 
 	// Read-write data members
+	static std::atomic<bool> isPlaybackStatsVisible;
 	Widget::EventCallbackContext detachCallback;
 	Widget::EventCallbackContext maximizeCallback;
 	Widget::EventCallbackContext settingsChangeCallback;
@@ -119,7 +122,8 @@ public:
 	static constexpr const int MediumWaveformVisualizer = 1;
 	static constexpr const int LargeWaveformVisualizer = 2;
 	static constexpr const int SmallWaveformVisualizer = 3;
-	static constexpr const int VisualizerTypeCount = 4;
+	static constexpr const int SpectrumVisualizer = 4;
+	static constexpr const int VisualizerTypeCount = 5;
 	// Set the display state of the player's visualizer animation
 	void setVisualizerType (int typeValue);
 
@@ -163,6 +167,9 @@ private:
 	// Set w and h to width and height values that should be used as the waveform size for visualizerType
 	void getWaveformSize (double *w, double *h);
 
+	// Create, update, or remove statsWindow as appropriate for isPlaybackStatsVisible
+	void updatePlaybackStats (int msElapsed);
+
 	bool isControlVisible;
 	int controlHideClock;
 	int controlHideMouseX;
@@ -200,6 +207,9 @@ private:
 	WidgetHandle<ProgressRing> progressRingHandle;
 	ProgressRing *progressRing;
 	int progressRingShowClock;
+	WidgetHandle<StatsWindow> statsWindowHandle;
+	StatsWindow *statsWindow;
+	int statsUpdateClock;
 	bool isPlayStarting;
 	Position maximizePosition;
 	double maximizeWidth;
@@ -0,0 +1,409 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#include <string.h>
+#include "Log.h"
+#include "SdlUtil.h"
+#include "OsUtil.h"
+#include "Buffer.h"
+#include "Profiler.h"
+
+Profiler *Profiler::instance = NULL;
+std::atomic<bool> Profiler::isEnabled (false);
+thread_local Profiler::ThreadZoneBufferRef Profiler::threadZoneBuffer;
+
+Profiler::Profiler ()
+: maxTraceEventCount (Profiler::defaultMaxTraceEventCount)
+, isTracing (false)
+, isMeasuring (false)
+, droppedTraceEventCount (0)
+, profilerMutex (NULL)
+, traceStartCounter (0)
+, frameCount (0)
+, frameHistoryPosition (0)
+, measureStartTime (0)
+{
+	SdlUtil::createMutex (&profilerMutex);
+	memset (frameHistory, 0, sizeof (frameHistory));
+	threadNames.insert (std::pair<SDL_threadID, StdString> (SDL_ThreadID (), StdString ("main")));
+}
+Profiler::~Profiler () {
+	std::list<Profiler::ThreadZoneBuffer *>::iterator i1, i2;
+
+	Profiler::isEnabled.store (false);
+	SDL_LockMutex (profilerMutex);
+	i1 = threadZoneBuffers.begin ();
+	i2 = threadZoneBuffers.end ();
+	while (i1 != i2) {
+		(*i1)->isDetached.store (true);
+		Profiler::releaseThreadZoneBuffer (*i1);
+		++i1;
+	}
+	threadZoneBuffers.clear ();
+	SDL_UnlockMutex (profilerMutex);
+	SdlUtil::destroyMutex (&profilerMutex);
+}
+
+Profiler::ThreadZoneBufferRef::~ThreadZoneBufferRef () {
+	if (buffer) {
+		buffer->isThreadEnded.store (true);
+		Profiler::releaseThreadZoneBuffer (buffer);
+		buffer = NULL;
+	}
+}
+
+void Profiler::createInstance () {
+	if (! Profiler::instance) {
+		Profiler::instance = new Profiler ();
+	}
+}
+void Profiler::freeInstance () {
+	if (Profiler::instance) {
+		delete (Profiler::instance);
+		Profiler::instance = NULL;
+	}
+}
+
+void Profiler::setEnabled (bool enable) {
+	SDL_LockMutex (profilerMutex);
+	collectZones ();
+	if (enable && (! Profiler::isEnabled.load ())) {
+		frameCount = 0;
+		frameHistoryPosition = 0;
+		memset (frameHistory, 0, sizeof (frameHistory));
+		frameTime.reset ();
+		zoneStats.clear ();
+	}
+	if (! enable) {
+		isTracing = false;
+		isMeasuring = false;
+		traceEvents.clear ();
+	}
+	Profiler::isEnabled.store (enable);
+	SDL_UnlockMutex (profilerMutex);
+}
+
+void Profiler::startTrace () {
+	setEnabled (true);
+	SDL_LockMutex (profilerMutex);
+	collectZones ();
+	traceEvents.clear ();
+	droppedTraceEventCount = 0;
+	traceStartCounter = SDL_GetPerformanceCounter ();
+	isTracing = true;
+	SDL_UnlockMutex (profilerMutex);
+}
+
+void Profiler::endTrace (const StdString &path, Profiler::Trace *destTrace) {
+	destTrace->path.assign (path);
+	destTrace->events.clear ();
+	SDL_LockMutex (profilerMutex);
+	collectZones ();
+	isTracing = false;
+	destTrace->events.swap (traceEvents);
+	destTrace->threadNames = threadNames;
+	destTrace->startCounter = traceStartCounter;
+	destTrace->droppedEventCount = droppedTraceEventCount;
+	SDL_UnlockMutex (profilerMutex);
+}
+
+OpResult Profiler::writeTraceFile (const Profiler::Trace &trace) {
+	Buffer *buffer;
+	OpResult result;
+
+	buffer = Profiler::createTraceBuffer (trace.events, trace.threadNames, trace.startCounter);
+	result = OsUtil::writeFile (trace.path, buffer);
+	if (result != OpResult::Success) {
+		Log::err ("Failed to write profiler trace; path=\"%s\" err=%i", trace.path.c_str (), result);
+		return (result);
+	}
+	Log::info ("Wrote profiler trace; path=\"%s\" eventCount=%i droppedEventCount=%lli", trace.path.c_str (), (int) trace.events.size (), (long long int) trace.droppedEventCount);
+	return (OpResult::Success);
+}
+
+OpResult Profiler::writeTrace (const StdString &path) {
+	Profiler::Trace trace;
+
+	endTrace (path, &trace);
+	return (Profiler::writeTraceFile (trace));
+}
+
+void Profiler::startMeasure () {
+	setEnabled (true);
+	SDL_LockMutex (profilerMutex);
+	measureFrameTime.reset ();
+	measureStartTime = OsUtil::getTime ();
+	isMeasuring = true;
+	SDL_UnlockMutex (profilerMutex);
+}
+
+void Profiler::stopMeasure (Profiler::MeasureStats *destStats) {
+	SDL_LockMutex (profilerMutex);
+	destStats->startTime = measureStartTime;
+	destStats->duration = isMeasuring ? (OsUtil::getTime () - measureStartTime) : 0;
+	destStats->frameTime = measureFrameTime;
+	isMeasuring = false;
+	SDL_UnlockMutex (profilerMutex);
+}
+
+void Profiler::setThreadName (const char *threadName) {
+	SDL_threadID id;
+
+	id = SDL_ThreadID ();
+	SDL_LockMutex (profilerMutex);
+	threadNames[id].assign (threadName);
+	SDL_UnlockMutex (profilerMutex);
+}
+
+void Profiler::addZone (const char *name, uint64_t startCounter, uint64_t endCounter) {
+	Profiler::ThreadZoneBuffer *buffer;
+	Profiler::ZoneRecord *record;
+	int pos, next;
+
+	buffer = Profiler::threadZoneBuffer.buffer;
+	if ((! buffer) || buffer->isDetached.load (std::memory_order_relaxed)) {
+		buffer = createThreadZoneBuffer ();
+	}
+	pos = buffer->writePosition.load (std::memory_order_relaxed);
+	next = (pos + 1) % Profiler::threadZoneBufferSize;
+	if (next == buffer->readPosition.load (std::memory_order_acquire)) {
+		buffer->dropCount.fetch_add (1, std::memory_order_relaxed);
+		return;
+	}
+	record = &(buffer->records[pos]);
+	record->name = name;
+	record->startCounter = startCounter;
+	record->endCounter = endCounter;
+	buffer->writePosition.store (next, std::memory_order_release);
+}
+
+Profiler::ThreadZoneBuffer *Profiler::createThreadZoneBuffer () {
+	Profiler::ThreadZoneBuffer *buffer;
+
+	// A buffer detached by a previous Profiler instance is still held by this thread
+	if (Profiler::threadZoneBuffer.buffer) {
+		Profiler::releaseThreadZoneBuffer (Profiler::threadZoneBuffer.buffer);
+		Profiler::threadZoneBuffer.buffer = NULL;
+	}
+	buffer = new Profiler::ThreadZoneBuffer ();
+	buffer->threadId = SDL_ThreadID ();
+	SDL_LockMutex (profilerMutex);
+	threadZoneBuffers.push_back (buffer);
+	SDL_UnlockMutex (profilerMutex);
+	Profiler::threadZoneBuffer.buffer = buffer;
+	return (buffer);
+}
+
+void Profiler::releaseThreadZoneBuffer (Profiler::ThreadZoneBuffer *buffer) {
+	if (buffer->refcount.fetch_sub (1) == 1) {
+		delete (buffer);
+	}
+}
+
+void Profiler::collectZones () {
+	std::list<Profiler::ThreadZoneBuffer *>::iterator i1, i2;
+	Profiler::ThreadZoneBuffer *buffer;
+	Profiler::ZoneRecord *record;
+	int pos, end;
+	int64_t dropcount;
+	bool ended;
+
+	i1 = threadZoneBuffers.begin ();
+	i2 = threadZoneBuffers.end ();
+	while (i1 != i2) {
+		buffer = *i1;
+		// Read the ended flag first, so that zones written before the thread ended are collected in this pass
+		ended = buffer->isThreadEnded.load ();
+		pos = buffer->readPosition.load (std::memory_order_relaxed);
+		end = buffer->writePosition.load (std::memory_order_acquire);
+		while (pos != end) {
+			record = &(buffer->records[pos]);
+			storeZone (record->name, buffer->threadId, record->startCounter, record->endCounter);
+			pos = (pos + 1) % Profiler::threadZoneBufferSize;
+		}
+		buffer->readPosition.store (pos, std::memory_order_release);
+		dropcount = buffer->dropCount.exchange (0);
+		if (isTracing) {
+			droppedTraceEventCount += dropcount;
+		}
+		if (ended) {
+			i1 = threadZoneBuffers.erase (i1);
+			Profiler::releaseThreadZoneBuffer (buffer);
+		}
+		else {
+			++i1;
+		}
+	}
+}
+
+void Profiler::storeZone (const char *name, SDL_threadID threadId, uint64_t startCounter, uint64_t endCounter) {
+	std::map<const char *, Profiler::ZoneStats>::iterator pos;
+	int64_t duration;
+
+	duration = Profiler::getCounterDuration (startCounter, endCounter);
+	pos = zoneStats.find (name);
+	if (pos == zoneStats.end ()) {
+		pos = zoneStats.insert (std::pair<const char *, Profiler::ZoneStats> (name, Profiler::ZoneStats ())).first;
+	}
+	++(pos->second.count);
+	pos->second.totalTime += duration;
+	if (duration > pos->second.maxTime) {
+		pos->second.maxTime = duration;
+	}
+	if (isTracing) {
+		if ((int) traceEvents.size () < maxTraceEventCount) {
+			traceEvents.push_back (Profiler::TraceEvent (name, threadId, startCounter, endCounter));
+		}
+		else {
+			++droppedTraceEventCount;
+		}
+	}
+}
+
+void Profiler::addFrame (int64_t frameTimeValue) {
+	SDL_LockMutex (profilerMutex);
+	collectZones ();
+	frameHistory[frameHistoryPosition] = frameTimeValue;
+	frameHistoryPosition = (frameHistoryPosition + 1) % Profiler::frameHistorySize;
+	++frameCount;
+	frameTime.add (frameTimeValue);
+	if (isMeasuring) {
+		measureFrameTime.add (frameTimeValue);
+	}
+	SDL_UnlockMutex (profilerMutex);
+}
+
+int64_t Profiler::getCounterDuration (uint64_t startCounter, uint64_t endCounter) {
+	if (endCounter <= startCounter) {
+		return (0);
+	}
+	return ((int64_t) (((double) (endCounter - startCounter)) * 1000000.0f / (double) SDL_GetPerformanceFrequency ()));
+}
+
+void Profiler::getFrameStats (Profiler::FrameStats *destStats) {
+	int i, count, pos;
+
+	SDL_LockMutex (profilerMutex);
+	destStats->frameCount = frameCount;
+	count = (frameCount < Profiler::frameHistorySize) ? (int) frameCount : Profiler::frameHistorySize;
+	pos = (frameHistoryPosition - count + Profiler::frameHistorySize) % Profiler::frameHistorySize;
+	for (i = 0; i < count; ++i) {
+		destStats->frameHistory[i] = frameHistory[pos];
+		pos = (pos + 1) % Profiler::frameHistorySize;
+	}
+	destStats->historyCount = count;
+	destStats->frameTime = frameTime;
+	SDL_UnlockMutex (profilerMutex);
+}
+
+void Profiler::getZoneStats (std::map<StdString, Profiler::ZoneStats> *destMap, bool shouldReset) {
+	std::map<const char *, Profiler::ZoneStats>::const_iterator i1, i2;
+
+	destMap->clear ();
+	SDL_LockMutex (profilerMutex);
+	collectZones ();
+	i1 = zoneStats.cbegin ();
+	i2 = zoneStats.cend ();
+	while (i1 != i2) {
+		destMap->insert (std::pair<StdString, Profiler::ZoneStats> (StdString (i1->first), i1->second));
+		++i1;
+	}
+	if (shouldReset) {
+		zoneStats.clear ();
+	}
+	SDL_UnlockMutex (profilerMutex);
+}
+
+Buffer *Profiler::createTraceBuffer (const std::vector<Profiler::TraceEvent> &events, const std::map<SDL_threadID, StdString> &names, uint64_t startCounter) {
+	std::vector<Profiler::TraceEvent>::const_iterator i1, i2;
+	std::map<SDL_threadID, StdString>::const_iterator j1, j2;
+	Buffer *buffer;
+	StdString line;
+	int pid;
+	bool first;
+
+	pid = OsUtil::getProcessId ();
+	buffer = new Buffer ();
+	buffer->add ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	first = true;
+	j1 = names.cbegin ();
+	j2 = names.cend ();
+	while (j1 != j2) {
+		line.sprintf ("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":%llu,\"args\":{\"name\":%s}}", first ? "" : ",\n", pid, (unsigned long long int) j1->first, Profiler::getJsonString (j1->second.c_str ()).c_str ());
+		buffer->add (line.c_str ());
+		first = false;
+		++j1;
+	}
+	i1 = events.cbegin ();
+	i2 = events.cend ();
+	while (i1 != i2) {
+		line.sprintf ("%s{\"name\":%s,\"ph\":\"X\",\"pid\":%i,\"tid\":%llu,\"ts\":%lli,\"dur\":%lli}", first ? "" : ",\n", Profiler::getJsonString (i1->name).c_str (), pid, (unsigned long long int) i1->threadId, (long long int) Profiler::getCounterDuration (startCounter, i1->startCounter), (long long int) Profiler::getCounterDuration (i1->startCounter, i1->endCounter));
+		buffer->add (line.c_str ());
+		first = false;
+		++i1;
+	}
+	buffer->add ("\n]}\n");
+	return (buffer);
+}
+
+StdString Profiler::getJsonString (const char *text) {
+	StdString s;
+	const char *c;
+
+	s.assign ("\"");
+	c = text;
+	while (*c) {
+		switch (*c) {
+			case '"': {
+				s.append ("\\\"");
+				break;
+			}
+			case '\\': {
+				s.append ("\\\\");
+				break;
+			}
+			default: {
+				if (((unsigned char) *c) < 0x20) {
+					s.appendSprintf ("\\u%04x", (unsigned int) (unsigned char) *c);
+				}
+				else {
+					s.push_back (*c);
+				}
+				break;
+			}
+		}
+		++c;
+	}
+	s.append ("\"");
+	return (s);
+}
@@ -0,0 +1,254 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Class that records timed code zones and frame times for display in an overlay window and export as Chrome trace JSON
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <vector>
+#include "Histogram.h"
+
+class Buffer;
+
+class Profiler {
+public:
+	Profiler ();
+	~Profiler ();
+	static Profiler *instance;
+
+	// Initialize static instance data
+	static void createInstance ();
+
+	// Clear static instance data
+	static void freeInstance ();
+
+	static constexpr const int frameHistorySize = 240;
+	static constexpr const int defaultMaxTraceEventCount = 1000000;
+	static constexpr const int threadZoneBufferSize = 1024;
+
+	// True if zone and frame timing is active. ProfilerZone checks this value inline, so instrumented code paths cost a single load and branch while the profiler is disabled.
+	static std::atomic<bool> isEnabled;
+
+	// Read-write data members
+	int maxTraceEventCount;
+
+	// Read-only data members
+	bool isTracing;
+	bool isMeasuring;
+	int64_t droppedTraceEventCount;
+
+	// Enable or disable zone and frame timing. Disabling the profiler also ends any trace in progress without writing it.
+	void setEnabled (bool enable);
+
+	// Enable the profiler and begin storing zone events for trace export, discarding any previously stored events
+	void startTrace ();
+
+	struct TraceEvent {
+		const char *name;
+		SDL_threadID threadId;
+		uint64_t startCounter;
+		uint64_t endCounter;
+		TraceEvent ():
+			name (NULL),
+			threadId (0),
+			startCounter (0),
+			endCounter (0) { }
+		TraceEvent (const char *name, SDL_threadID threadId, uint64_t startCounter, uint64_t endCounter):
+			name (name),
+			threadId (threadId),
+			startCounter (startCounter),
+			endCounter (endCounter) { }
+	};
+	struct Trace {
+		StdString path;
+		std::vector<Profiler::TraceEvent> events;
+		std::map<SDL_threadID, StdString> threadNames;
+		uint64_t startCounter;
+		int64_t droppedEventCount;
+		Trace ():
+			startCounter (0),
+			droppedEventCount (0) { }
+	};
+
+	// End any trace in progress and move its stored zone events into destTrace, for writing to path by writeTraceFile. The profiler remains enabled after the trace ends.
+	void endTrace (const StdString &path, Profiler::Trace *destTrace);
+
+	// Write a trace as Chrome trace JSON to its path and return a Result value. This method does not access profiler state and may be invoked from any thread.
+	static OpResult writeTraceFile (const Profiler::Trace &trace);
+
+	// End any trace in progress, write stored zone events as Chrome trace JSON to path, and return a Result value. The profiler remains enabled after the trace ends.
+	OpResult writeTrace (const StdString &path);
+
+	struct MeasureStats {
+		int64_t startTime;
+		int64_t duration;
+		Histogram frameTime;
+		MeasureStats ():
+			startTime (0),
+			duration (0) { }
+	};
+
+	// Enable the profiler and begin collecting frame times for a measurement window, discarding values from any previous window
+	void startMeasure ();
+
+	// End any measurement window in progress and copy its values into destStats. Frame time values are measured in microseconds and the window duration in milliseconds. The profiler remains enabled after the window ends.
+	void stopMeasure (Profiler::MeasureStats *destStats);
+
+	// Set the name shown for the calling thread in exported traces
+	void setThreadName (const char *threadName);
+
+	// Store timing data for a completed zone. name must point to a string with static storage duration, such as a string literal. Zones are written to a buffer owned by the calling thread without taking a lock, and collected into zone stats and trace events once per frame.
+	void addZone (const char *name, uint64_t startCounter, uint64_t endCounter);
+
+	// Store the duration of a completed application frame, measured in microseconds
+	void addFrame (int64_t frameTimeValue);
+
+	// Return the number of microseconds elapsed between two performance counter values
+	static int64_t getCounterDuration (uint64_t startCounter, uint64_t endCounter);
+
+	struct FrameStats {
+		int64_t frameCount;
+		int historyCount;
+		int64_t frameHistory[Profiler::frameHistorySize]; // Most recent frame times in microseconds, oldest first
+		Histogram frameTime;
+		FrameStats ():
+			frameCount (0),
+			historyCount (0) { }
+	};
+	struct ZoneStats {
+		int64_t count;
+		int64_t totalTime;
+		int64_t maxTime;
+		ZoneStats ():
+			count (0),
+			totalTime (0),
+			maxTime (0) { }
+	};
+
+	// Copy frame time values into destStats. frameTime holds all frames recorded since the profiler was enabled.
+	void getFrameStats (Profiler::FrameStats *destStats);
+
+	// Copy accumulated zone values into destMap, keyed by zone name. If shouldReset is true, clear accumulated values after copying them.
+	void getZoneStats (std::map<StdString, Profiler::ZoneStats> *destMap, bool shouldReset = false);
+
+private:
+	struct ZoneRecord {
+		const char *name;
+		uint64_t startCounter;
+		uint64_t endCounter;
+	};
+	// Ring of completed zones written by one thread and read while holding profilerMutex
+	struct ThreadZoneBuffer {
+		SDL_threadID threadId;
+		Profiler::ZoneRecord records[Profiler::threadZoneBufferSize];
+		std::atomic<int> writePosition;
+		std::atomic<int> readPosition;
+		std::atomic<int64_t> dropCount;
+		std::atomic<bool> isThreadEnded;
+		std::atomic<bool> isDetached;
+		std::atomic<int> refcount; // Held by the owning thread and by the profiler
+		ThreadZoneBuffer ():
+			threadId (0),
+			writePosition (0),
+			readPosition (0),
+			dropCount (0),
+			isThreadEnded (false),
+			isDetached (false),
+			refcount (2) { }
+	};
+	// Object that releases the calling thread's zone buffer when the thread ends
+	struct ThreadZoneBufferRef {
+		Profiler::ThreadZoneBuffer *buffer;
+		ThreadZoneBufferRef ():
+			buffer (NULL) { }
+		~ThreadZoneBufferRef ();
+	};
+	static thread_local Profiler::ThreadZoneBufferRef threadZoneBuffer;
+
+	// Return a newly created zone buffer for the calling thread, after adding it to threadZoneBuffers
+	Profiler::ThreadZoneBuffer *createThreadZoneBuffer ();
+
+	// Drop one reference to a zone buffer, deleting the buffer if no references remain
+	static void releaseThreadZoneBuffer (Profiler::ThreadZoneBuffer *buffer);
+
+	// Move completed zones from all thread buffers into zone stats and trace events. Must be invoked while holding profilerMutex.
+	void collectZones ();
+
+	// Store timing data for a completed zone. Must be invoked while holding profilerMutex.
+	void storeZone (const char *name, SDL_threadID threadId, uint64_t startCounter, uint64_t endCounter);
+
+	// Return a newly created Buffer object containing Chrome trace JSON for the provided events and thread names, with timestamps relative to startCounter
+	static Buffer *createTraceBuffer (const std::vector<Profiler::TraceEvent> &events, const std::map<SDL_threadID, StdString> &names, uint64_t startCounter);
+
+	// Return a JSON string value with special characters escaped
+	static StdString getJsonString (const char *text);
+
+	SDL_mutex *profilerMutex;
+	uint64_t traceStartCounter;
+	std::vector<Profiler::TraceEvent> traceEvents;
+	std::map<SDL_threadID, StdString> threadNames;
+	std::map<const char *, Profiler::ZoneStats> zoneStats;
+	std::list<Profiler::ThreadZoneBuffer *> threadZoneBuffers;
+	int64_t frameCount;
+	int64_t frameHistory[Profiler::frameHistorySize];
+	int frameHistoryPosition;
+	Histogram frameTime;
+	int64_t measureStartTime;
+	Histogram measureFrameTime;
+};
+
+// Object that measures the time between its construction and destruction as a named Profiler zone. Declare a ProfilerZone at the start of a block to time the remainder of that block.
+class ProfilerZone {
+public:
+	ProfilerZone (const char *name)
+	: name (NULL)
+	, startCounter (0)
+	{
+		if (Profiler::isEnabled.load (std::memory_order_relaxed)) {
+			this->name = name;
+			startCounter = SDL_GetPerformanceCounter ();
+		}
+	}
+	~ProfilerZone () {
+		if (name) {
+			Profiler::instance->addZone (name, startCounter, SDL_GetPerformanceCounter ());
+		}
+	}
+
+private:
+	const char *name;
+	uint64_t startCounter;
+};
+#endif
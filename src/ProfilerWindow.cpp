@@ -0,0 +1,221 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#include <algorithm>
+#include "App.h"
+#include "UiText.h"
+#include "UiTextId.h"
+#include "UiConfiguration.h"
+#include "StatsWindow.h"
+#include "ProfilerWindow.h"
+
+ProfilerWindow::ProfilerWindow (double graphWidth, double graphHeight)
+: Panel ()
+, graphWidth (graphWidth)
+, graphHeight (graphHeight)
+, statsUpdateClock (0)
+{
+	setFillBg (true, Color (0.0f, 0.0f, 0.0f, UiConfiguration::instance->scrimBackgroundAlpha));
+	isInputSuspended = true;
+	statsWindow = (StatsWindow *) addWidget (new StatsWindow ());
+	statsWindow->setFixedPadding (true, 0.0f, 0.0f);
+	fastBarRects.reserve (Profiler::frameHistorySize);
+	mediumBarRects.reserve (Profiler::frameHistorySize);
+	slowBarRects.reserve (Profiler::frameHistorySize);
+	updateStats ();
+}
+ProfilerWindow::~ProfilerWindow () {
+}
+
+void ProfilerWindow::reflow () {
+	double w;
+
+	resetPadding ();
+	statsWindow->position.assign (widthPadding, heightPadding + graphHeight + UiConfiguration::instance->marginSize);
+	w = graphWidth;
+	if (statsWindow->width > w) {
+		w = statsWindow->width;
+	}
+	setFixedSize (true, w + (widthPadding * 2.0f), statsWindow->position.y + statsWindow->height + heightPadding);
+}
+
+void ProfilerWindow::doUpdate (int msElapsed) {
+	Panel::doUpdate (msElapsed);
+	statsUpdateClock -= msElapsed;
+	if (statsUpdateClock <= 0) {
+		statsUpdateClock = ProfilerWindow::statsUpdatePeriod;
+		updateStats ();
+	}
+}
+
+void ProfilerWindow::updateStats () {
+	Profiler::FrameStats stats;
+	std::map<StdString, Profiler::ZoneStats> zones;
+	std::map<StdString, Profiler::ZoneStats>::const_iterator i1, i2;
+	std::list<std::pair<int64_t, StdString> > sortlist;
+	std::list<std::pair<int64_t, StdString> >::const_reverse_iterator j1, j2;
+	StringList names;
+	StringList::const_iterator k1, k2;
+	int64_t sorted[Profiler::frameHistorySize], sum;
+	double seconds;
+	int i, count;
+
+	// StatsWindow doesn't remove individual items, so rebuild it after enough distinct zones have been shown
+	if ((int) zoneItemNames.size () > (ProfilerWindow::maxZoneItemCount * 2)) {
+		statsWindow->clearItems ();
+		zoneItemNames.clear ();
+	}
+
+	Profiler::instance->getFrameStats (&stats);
+	count = stats.historyCount;
+	sum = 0;
+	for (i = 0; i < count; ++i) {
+		sorted[i] = stats.frameHistory[i];
+		sum += sorted[i];
+	}
+	std::sort (sorted, sorted + count);
+	if (count > 0) {
+		statsWindow->setItem (UiText::instance->getText (UiTextId::Frame).capitalized (), StdString::createSprintf ("%.1f fps, p50 %.2f p95 %.2f p99 %.2f max %.2f ms", (sum > 0) ? ((double) count * 1000000.0f / (double) sum) : 0.0f, (double) sorted[(count * 50) / 100] / 1000.0f, (double) sorted[(count * 95) / 100] / 1000.0f, (double) sorted[(count * 99) / 100] / 1000.0f, (double) sorted[count - 1] / 1000.0f));
+	}
+	else {
+		statsWindow->setItem (UiText::instance->getText (UiTextId::Frame).capitalized (), StdString ("-"));
+	}
+	statsWindow->setItem (UiText::instance->getText (UiTextId::Trace).capitalized (), UiText::instance->getText (Profiler::instance->isTracing ? UiTextId::Recording : UiTextId::Off));
+
+	// Show zones with the highest total time during the last update period
+	Profiler::instance->getZoneStats (&zones, true);
+	seconds = ((double) ProfilerWindow::statsUpdatePeriod) / 1000.0f;
+	i1 = zones.cbegin ();
+	i2 = zones.cend ();
+	while (i1 != i2) {
+		sortlist.push_back (std::pair<int64_t, StdString> (i1->second.totalTime, i1->first));
+		++i1;
+	}
+	sortlist.sort ();
+	j1 = sortlist.crbegin ();
+	j2 = sortlist.crend ();
+	while ((j1 != j2) && ((int) names.size () < ProfilerWindow::maxZoneItemCount)) {
+		i1 = zones.find (j1->second);
+		statsWindow->setItem (j1->second, StdString::createSprintf ("%.1f/s, avg %.3f max %.3f ms", (double) i1->second.count / seconds, ((double) i1->second.totalTime / (double) i1->second.count) / 1000.0f, (double) i1->second.maxTime / 1000.0f));
+		names.push_back (j1->second);
+		++j1;
+	}
+
+	// Clear values for previously shown zones that no longer appear in the list
+	k1 = zoneItemNames.cbegin ();
+	k2 = zoneItemNames.cend ();
+	while (k1 != k2) {
+		if (! names.contains (*k1)) {
+			statsWindow->setItem (*k1, StdString ("-"));
+		}
+		++k1;
+	}
+	k1 = names.cbegin ();
+	k2 = names.cend ();
+	while (k1 != k2) {
+		if (! zoneItemNames.contains (*k1)) {
+			zoneItemNames.push_back (*k1);
+		}
+		++k1;
+	}
+	reflow ();
+}
+
+void ProfilerWindow::doDraw (double originX, double originY) {
+	SDL_Renderer *render;
+	SDL_Rect rect;
+	int64_t t;
+	double x0, y0, barwidth, h;
+	int i;
+
+	Panel::doDraw (originX, originY);
+
+	// Frame times are read during draw so that the graph reflects every presented frame, not only those seen at the stats update period
+	render = App::instance->render;
+	Profiler::instance->getFrameStats (&drawFrameStats);
+	x0 = originX + position.x + widthPadding;
+	y0 = originY + position.y + heightPadding;
+	barwidth = graphWidth / (double) Profiler::frameHistorySize;
+	fastBarRects.clear ();
+	mediumBarRects.clear ();
+	slowBarRects.clear ();
+	for (i = 0; i < drawFrameStats.historyCount; ++i) {
+		t = drawFrameStats.frameHistory[i];
+		if (t > ProfilerWindow::graphMaxFrameTime) {
+			t = ProfilerWindow::graphMaxFrameTime;
+		}
+		h = graphHeight * (double) t / (double) ProfilerWindow::graphMaxFrameTime;
+		if (h < 1.0f) {
+			h = 1.0f;
+		}
+		rect.x = (int) (x0 + ((double) (Profiler::frameHistorySize - drawFrameStats.historyCount + i) * barwidth));
+		rect.w = (int) (x0 + ((double) (Profiler::frameHistorySize - drawFrameStats.historyCount + i + 1) * barwidth)) - rect.x;
+		if (rect.w < 1) {
+			rect.w = 1;
+		}
+		rect.h = (int) h;
+		rect.y = (int) (y0 + graphHeight) - rect.h;
+		if (drawFrameStats.frameHistory[i] <= ProfilerWindow::targetFrameTime) {
+			fastBarRects.push_back (rect);
+		}
+		else if (drawFrameStats.frameHistory[i] <= ProfilerWindow::slowFrameTime) {
+			mediumBarRects.push_back (rect);
+		}
+		else {
+			slowBarRects.push_back (rect);
+		}
+	}
+
+	SDL_SetRenderDrawBlendMode (render, SDL_BLENDMODE_NONE);
+	if (! fastBarRects.empty ()) {
+		SDL_SetRenderDrawColor (render, UiConfiguration::instance->statusOkTextColor.rByte, UiConfiguration::instance->statusOkTextColor.gByte, UiConfiguration::instance->statusOkTextColor.bByte, 255);
+		SDL_RenderFillRects (render, &(fastBarRects[0]), (int) fastBarRects.size ());
+	}
+	if (! mediumBarRects.empty ()) {
+		SDL_SetRenderDrawColor (render, UiConfiguration::instance->warningTextColor.rByte, UiConfiguration::instance->warningTextColor.gByte, UiConfiguration::instance->warningTextColor.bByte, 255);
+		SDL_RenderFillRects (render, &(mediumBarRects[0]), (int) mediumBarRects.size ());
+	}
+	if (! slowBarRects.empty ()) {
+		SDL_SetRenderDrawColor (render, UiConfiguration::instance->errorTextColor.rByte, UiConfiguration::instance->errorTextColor.gByte, UiConfiguration::instance->errorTextColor.bByte, 255);
+		SDL_RenderFillRects (render, &(slowBarRects[0]), (int) slowBarRects.size ());
+	}
+
+	// Mark the frame time that corresponds to 60 frames per second
+	rect.x = (int) x0;
+	rect.w = (int) graphWidth;
+	rect.h = 1;
+	rect.y = (int) (y0 + graphHeight - (graphHeight * (double) ProfilerWindow::targetFrameTime / (double) ProfilerWindow::graphMaxFrameTime));
+	SDL_SetRenderDrawColor (render, UiConfiguration::instance->primaryTextColor.rByte, UiConfiguration::instance->primaryTextColor.gByte, UiConfiguration::instance->primaryTextColor.bByte, 255);
+	SDL_RenderFillRect (render, &rect);
+	SDL_SetRenderDrawColor (render, 0, 0, 0, 0);
+}
@@ -173,6 +173,9 @@ void ProgressBar::doUpdate (int msElapsed) {
 	}
 
 	fillColor.update (msElapsed);
+
+	// Fill color animates continuously, requiring a redraw on each update
+	invalidateLayer ();
 }
 
 void ProgressBar::doDraw (double originX, double originY) {
@@ -94,16 +94,19 @@ void ProgressRing::doUpdate (int msElapsed) {
 		}
 	}
 	fillColor.update (msElapsed);
+	invalidateLayer ();
 }
 
 void ProgressRing::doDraw (double originX, double originY) {
 	SDL_Texture *bgtexture, *filltexture;
-	SDL_Rect rect;
+	SDL_Rect rect, bgrect, fillrect;
 
-	bgtexture = UiConfiguration::instance->progressRingSprite->getRingTexture (100.0f);
+	bgtexture = UiConfiguration::instance->progressRingSprite->getRingTexture (100.0f, NULL, NULL, &bgrect);
 	if (! bgtexture) {
 		return;
 	}
+	SDL_SetTextureAlphaMod (bgtexture, 255);
+	SDL_SetTextureBlendMode (bgtexture, SDL_BLENDMODE_BLEND);
 	rect.x = (int) (originX + position.x);
 	rect.y = (int) (originY + position.y);
 	rect.w = (int) width;
@@ -116,9 +119,9 @@ void ProgressRing::doDraw (double originX, double originY) {
 		else {
 			SDL_SetTextureColorMod (bgtexture, fillColor.rByte, fillColor.gByte, fillColor.bByte);
 		}
-		SDL_RenderCopy (App::instance->render, bgtexture, NULL, &rect);
+		SDL_RenderCopy (App::instance->render, bgtexture, &bgrect, &rect);
 		if (fillEnd > 0.0f) {
-			filltexture = UiConfiguration::instance->progressRingSprite->getRingTexture (fillEnd);
+			filltexture = UiConfiguration::instance->progressRingSprite->getRingTexture (fillEnd, NULL, NULL, &fillrect);
 			if (filltexture) {
 				if (fillStage <= 1) {
 					SDL_SetTextureColorMod (filltexture, fillColor.rByte, fillColor.gByte, fillColor.bByte);
@@ -126,19 +129,21 @@ void ProgressRing::doDraw (double originX, double originY) {
 				else {
 					SDL_SetTextureColorMod (filltexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
 				}
-				SDL_RenderCopy (App::instance->render, filltexture, NULL, &rect);
+				SDL_RenderCopy (App::instance->render, filltexture, &fillrect, &rect);
 			}
 		}
 	}
 	else {
 		SDL_SetTextureColorMod (bgtexture, bgColor.rByte, bgColor.gByte, bgColor.bByte);
-		SDL_RenderCopy (App::instance->render, bgtexture, NULL, &rect);
+		SDL_RenderCopy (App::instance->render, bgtexture, &bgrect, &rect);
 		if (progressValue > 0.0f) {
-			filltexture = UiConfiguration::instance->progressRingSprite->getRingTexture ((progressValue / targetProgressValue) * 100.0f);
+			filltexture = UiConfiguration::instance->progressRingSprite->getRingTexture ((progressValue / targetProgressValue) * 100.0f, NULL, NULL, &fillrect);
 			if (filltexture) {
 				SDL_SetTextureColorMod (filltexture, fillColor.rByte, fillColor.gByte, fillColor.bByte);
-				SDL_RenderCopy (App::instance->render, filltexture, NULL, &rect);
+				SDL_RenderCopy (App::instance->render, filltexture, &fillrect, &rect);
 			}
 		}
 	}
+	// Ring frames share an atlas page, so restore the default color for other frames drawn from it
+	SDL_SetTextureColorMod (bgtexture, 255, 255, 255);
 }
@@ -31,11 +31,10 @@
 * If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
 */
 #include "Config.h"
-#include "App.h"
 #include "Log.h"
 #include "MathUtil.h"
-#include "Resource.h"
 #include "RenderResource.h"
+#include "SpriteAtlas.h"
 #include "ProgressRingSprite.h"
 
 const double fillIncrement = 2.5f;
@@ -48,7 +47,7 @@ ProgressRingSprite::ProgressRingSprite ()
 ProgressRingSprite::~ProgressRingSprite () {
 }
 
-SDL_Texture *ProgressRingSprite::getRingTexture (double percentFill, int *width, int *height) const {
+SDL_Texture *ProgressRingSprite::getRingTexture (double percentFill, int *width, int *height, SDL_Rect *sourceRect) const {
 	int index;
 
 	index = (int) percentFill;
@@ -58,17 +57,15 @@ SDL_Texture *ProgressRingSprite::getRingTexture (double percentFill, int *width,
 	else if (index > 99) {
 		index = 99;
 	}
-	return (getTexture (fillFrames[index], width, height));
+	return (getTexture (fillFrames[index], width, height, NULL, sourceRect));
 }
 
 OpResult ProgressRingSprite::load (double scale) {
+	SpriteAtlas atlas;
 	OpResult result;
 	double fill, lastfill;
-	int framesize, fillindex;
-	Uint32 *pixels;
+	int framesize, fillindex, id;
 	SDL_Surface *surface;
-	SDL_Texture *texture;
-	StdString path;
 
 	result = OpResult::Success;
 	framesize = (int) scale;
@@ -78,32 +75,22 @@ OpResult ProgressRingSprite::load (double scale) {
 
 	fill = 0.0f;
 	while (fill <= 100.0f) {
-		pixels = (Uint32 *) malloc (framesize * framesize * sizeof (Uint32));
-		if (! pixels) {
-			Log::err ("Failed to create texture; err=\"Out of memory, dimensions %ix%i\"", framesize, framesize);
-			result = OpResult::OutOfMemoryError;
-			break;
-		}
-		writeProgressRingRenderPixels (scale, fill, pixels);
-		surface = SDL_CreateRGBSurfaceFrom (pixels, framesize, framesize, 32, framesize * sizeof (Uint32), RenderResource::instance->pixelRMask, RenderResource::instance->pixelGMask, RenderResource::instance->pixelBMask, RenderResource::instance->pixelAMask);
+		surface = SDL_CreateRGBSurface (0, framesize, framesize, 32, RenderResource::instance->pixelRMask, RenderResource::instance->pixelGMask, RenderResource::instance->pixelBMask, RenderResource::instance->pixelAMask);
 		if (! surface) {
-			free (pixels);
-			Log::err ("Failed to create texture; err=\"SDL_CreateRGBSurfaceFrom, %s\"", SDL_GetError ());
+			Log::err ("Failed to create texture; err=\"SDL_CreateRGBSurface, %s\"", SDL_GetError ());
 			result = OpResult::SdlOperationFailedError;
 			break;
 		}
-		path.sprintf ("*_ProgressRingSprite::load_%llx", (long long int) App::instance->getUniqueId ());
-		texture = Resource::instance->createTexture (path, surface);
-		SDL_FreeSurface (surface);
-		free (pixels);
-		if (! texture) {
+		writeProgressRingRenderPixels (scale, fill, (Uint32 *) surface->pixels);
+		id = atlas.addSurface (surface);
+		if (id < 0) {
 			result = OpResult::SdlOperationFailedError;
 			break;
 		}
-		addTexture (texture, path);
+		atlasFrameIds.push_back (id);
 
 		while (fillindex < (int) fill) {
-			fillFrames[fillindex] = frameCount - 1;
+			fillFrames[fillindex] = ((int) atlasFrameIds.size ()) - 1;
 			++fillindex;
 		}
 		lastfill = fill;
@@ -112,6 +99,13 @@ OpResult ProgressRingSprite::load (double scale) {
 			fill = 100.0f;
 		}
 	}
+	if (result == OpResult::Success) {
+		result = atlas.build ();
+	}
+	if (result == OpResult::Success) {
+		result = loadAtlasFrames (&atlas);
+	}
+	atlasFrameIds.clear ();
 	return (result);
 }
 
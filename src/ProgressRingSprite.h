@@ -41,11 +41,11 @@ public:
 	ProgressRingSprite ();
 	~ProgressRingSprite ();
 
-	// Load sprite data as a series of scaled images generated by pixel render functions using default parameters and return a Result value
+	// Load sprite data as a series of scaled images generated by pixel render functions using default parameters and return a Result value. Generated images are packed into a shared atlas texture.
 	OpResult load (double scale);
 
-	// Return the SDL_Texture object at the specified render scale, or NULL if no such texture was found. If a texture is found and int pointers are provided, those values are filled in with texture attributes.
-	SDL_Texture *getRingTexture (double percentFill, int *width = NULL, int *height = NULL) const;
+	// Return the SDL_Texture object for the specified fill percentage, or NULL if no such texture was found. If a texture is found, write texture attributes to any provided pointer values. The returned texture is an atlas page, and callers should draw from the region written to sourceRect.
+	SDL_Texture *getRingTexture (double percentFill, int *width = NULL, int *height = NULL, SDL_Rect *sourceRect = NULL) const;
 
 private:
 	// Write render data to the provided pixels buffer
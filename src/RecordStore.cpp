@@ -38,6 +38,8 @@
 #include "Json.h"
 #include "SystemInterface.h"
 #include "Prng.h"
+#include "MediaItem.h"
+#include "SharedMediaItem.h"
 #include "RecordStore.h"
 
 RecordStore *RecordStore::instance = NULL;
@@ -73,6 +75,9 @@ void RecordStore::clear () {
 		if (i1->second.json) {
 			delete (i1->second.json);
 		}
+		if (i1->second.mediaItem) {
+			i1->second.mediaItem->release ();
+		}
 		++i1;
 	}
 	recordMap.clear ();
@@ -80,10 +85,8 @@ void RecordStore::clear () {
 }
 
 bool RecordStore::insert (Json *sourceRecord, bool retainOverwrite) {
-	std::map<StdString, RecordStore::RecordEntry>::iterator pos;
 	StdString id;
 	RecordStore::RecordEntry entry;
-	Json *json;
 
 	if (! sourceRecord) {
 		return (false);
@@ -92,26 +95,75 @@ bool RecordStore::insert (Json *sourceRecord, bool retainOverwrite) {
 	if (id.empty ()) {
 		return (false);
 	}
+	entry.commandId = SystemInterface::instance->getCommandId (sourceRecord);
+	entry.agentId = SystemInterface::instance->getCommandAgentId (sourceRecord);
+	if (entry.commandId == SystemInterface::CommandId_MediaItem) {
+		entry.mediaItem = new SharedMediaItem ();
+		if (entry.mediaItem->item.readRecord (sourceRecord)) {
+			entry.mediaItem->item.agentId.assign (entry.agentId);
+		}
+		else {
+			entry.mediaItem->release ();
+			entry.mediaItem = NULL;
+		}
+	}
+	entry.json = sourceRecord->copy ();
+	SDL_LockMutex (mutex);
+	storeEntry (id, entry, retainOverwrite);
+	SDL_UnlockMutex (mutex);
+	return (true);
+}
+
+bool RecordStore::insertMediaItem (const MediaItem &item, const StdString &agentIdValue, bool retainOverwrite) {
+	RecordStore::RecordEntry entry;
 
-	json = sourceRecord->copy ();
+	if (item.mediaId.empty ()) {
+		return (false);
+	}
+	entry.commandId = SystemInterface::CommandId_MediaItem;
+	entry.mediaItem = new SharedMediaItem (item);
+	if (! agentIdValue.empty ()) {
+		entry.mediaItem->item.agentId.assign (agentIdValue);
+	}
+	entry.agentId.assign (entry.mediaItem->item.agentId);
 	SDL_LockMutex (mutex);
+	storeEntry (item.mediaId, entry, retainOverwrite);
+	SDL_UnlockMutex (mutex);
+	return (true);
+}
+
+void RecordStore::storeEntry (const StdString &id, const RecordStore::RecordEntry &entry, bool retainOverwrite) {
+	std::map<StdString, RecordStore::RecordEntry>::iterator pos;
+	int refcount;
+
+	refcount = 1;
 	pos = recordMap.find (id);
 	if (pos != recordMap.end ()) {
-		if (pos->second.json) {
-			delete (pos->second.json);
-		}
-		pos->second.json = json;
+		refcount = pos->second.refcount;
 		if (retainOverwrite) {
-			++(pos->second.refcount);
+			++refcount;
 		}
+		eraseEntry (pos);
 	}
-	else {
-		entry.json = json;
-		entry.refcount = 1;
-		recordMap.insert (std::pair<StdString, RecordStore::RecordEntry> (id, entry));
+	pos = recordMap.insert (std::pair<StdString, RecordStore::RecordEntry> (id, entry)).first;
+	pos->second.refcount = refcount;
+}
+
+void RecordStore::eraseEntry (std::map<StdString, RecordStore::RecordEntry>::iterator pos) {
+	if (pos->second.json) {
+		delete (pos->second.json);
 	}
-	SDL_UnlockMutex (mutex);
-	return (true);
+	if (pos->second.mediaItem) {
+		pos->second.mediaItem->release ();
+	}
+	recordMap.erase (pos);
+}
+
+Json *RecordStore::getEntryJson (RecordStore::RecordEntry *entry) {
+	if ((! entry->json) && entry->mediaItem) {
+		entry->json = entry->mediaItem->item.createRecord (entry->agentId);
+	}
+	return (entry->json);
 }
 
 void RecordStore::remove (const StdString &recordId) {
@@ -122,8 +174,7 @@ void RecordStore::remove (const StdString &recordId) {
 	if (pos != recordMap.end ()) {
 		--(pos->second.refcount);
 		if (pos->second.refcount <= 0) {
-			delete (pos->second.json);
-			recordMap.erase (pos);
+			eraseEntry (pos);
 		}
 	}
 	SDL_UnlockMutex (mutex);
@@ -143,8 +194,7 @@ void RecordStore::remove (const StringList &recordIds) {
 		if (pos != recordMap.end ()) {
 			--(pos->second.refcount);
 			if (pos->second.refcount <= 0) {
-				delete (pos->second.json);
-				recordMap.erase (pos);
+				eraseEntry (pos);
 			}
 		}
 		++i1;
@@ -177,8 +227,8 @@ Json *RecordStore::find (const StdString &recordId, int recordType, bool retainR
 	SDL_LockMutex (mutex);
 	pos = recordMap.find (recordId);
 	if (pos != recordMap.end ()) {
-		if ((recordType < 0) || (SystemInterface::instance->getCommandId (pos->second.json) == recordType)) {
-			result = pos->second.json->copy ();
+		if ((recordType < 0) || (pos->second.commandId == recordType)) {
+			result = getEntryJson (&(pos->second))->copy ();
 			if (retainRecord) {
 				++(pos->second.refcount);
 			}
@@ -195,10 +245,10 @@ bool RecordStore::find (Json *destJson, const StdString &recordId, int recordTyp
 	SDL_LockMutex (mutex);
 	pos = recordMap.find (recordId);
 	if (pos != recordMap.end ()) {
-		if ((recordType < 0) || (SystemInterface::instance->getCommandId (pos->second.json) == recordType)) {
+		if ((recordType < 0) || (pos->second.commandId == recordType)) {
 			result = true;
 			if (destJson) {
-				destJson->copyValue (pos->second.json);
+				destJson->copyValue (getEntryJson (&(pos->second)));
 			}
 			if (retainRecord) {
 				++(pos->second.refcount);
@@ -209,6 +259,24 @@ bool RecordStore::find (Json *destJson, const StdString &recordId, int recordTyp
 	return (result);
 }
 
+SharedMediaItem *RecordStore::findMediaItem (const StdString &recordId, bool retainRecord) {
+	std::map<StdString, RecordStore::RecordEntry>::iterator pos;
+	SharedMediaItem *result;
+
+	result = NULL;
+	SDL_LockMutex (mutex);
+	pos = recordMap.find (recordId);
+	if ((pos != recordMap.end ()) && pos->second.mediaItem) {
+		result = pos->second.mediaItem;
+		result->retain ();
+		if (retainRecord) {
+			++(pos->second.refcount);
+		}
+	}
+	SDL_UnlockMutex (mutex);
+	return (result);
+}
+
 Json *RecordStore::find (RecordStore::FindMatchFunction matchFn, void *matchData, bool retainRecord) {
 	std::map<StdString, RecordStore::RecordEntry>::iterator i1, i2;
 	Json *result;
@@ -218,7 +286,7 @@ Json *RecordStore::find (RecordStore::FindMatchFunction matchFn, void *matchData
 	i1 = recordMap.begin ();
 	i2 = recordMap.end ();
 	while (i1 != i2) {
-		if (matchFn (matchData, i1->second.json)) {
+		if (matchFn (matchData, getEntryJson (&(i1->second)))) {
 			result = i1->second.json->copy ();
 			if (retainRecord) {
 				++(i1->second.refcount);
@@ -239,7 +307,7 @@ bool RecordStore::find (Json *destJson, RecordStore::FindMatchFunction matchFn,
 	i1 = recordMap.begin ();
 	i2 = recordMap.end ();
 	while (i1 != i2) {
-		if (matchFn (matchData, i1->second.json)) {
+		if (matchFn (matchData, getEntryJson (&(i1->second)))) {
 			result = true;
 			if (destJson) {
 				destJson->copyValue (i1->second.json);
@@ -265,7 +333,7 @@ void RecordStore::findRecords (RecordStore::FindMatchFunction matchFn, void *mat
 	i1 = recordMap.begin ();
 	i2 = recordMap.end ();
 	while (i1 != i2) {
-		if (matchFn (matchData, i1->second.json)) {
+		if (matchFn (matchData, getEntryJson (&(i1->second)))) {
 			destList->push_back (i1->second.json->copy ());
 		}
 		++i1;
@@ -281,7 +349,7 @@ void RecordStore::findRecordIds (RecordStore::FindMatchFunction matchFn, void *m
 	i1 = recordMap.begin ();
 	i2 = recordMap.end ();
 	while (i1 != i2) {
-		if (matchFn (matchData, i1->second.json)) {
+		if (matchFn (matchData, getEntryJson (&(i1->second)))) {
 			destList->push_back (i1->first);
 		}
 		++i1;
@@ -38,6 +38,8 @@ class Json;
 class JsonList;
 class HashMap;
 class StringList;
+class MediaItem;
+class SharedMediaItem;
 
 class RecordStore {
 public:
@@ -68,6 +70,9 @@ public:
 	// Copy sourceRecord, add the copy to the record store and return true if the operation succeeded. If retainOverwrite is true, increase the record's refcount when overwriting an existing entry.
 	bool insert (Json *sourceRecord, bool retainOverwrite = false);
 
+	// Add a MediaItem record to the record store as a shared snapshot of item, without creating a Json object, and return true if the operation succeeded. If retainOverwrite is true, increase the record's refcount when overwriting an existing entry.
+	bool insertMediaItem (const MediaItem &item, const StdString &agentIdValue, bool retainOverwrite = false);
+
 	// Release the record with the specified ID and delete it from the record store if its refcount is 0 or less
 	void remove (const StdString &recordId);
 
@@ -83,6 +88,9 @@ public:
 	// Find a record matching the specified ID with an optional type, copy its value to destJson and return true if the record was found. If retainRecord is true, increase the record's refcount.
 	bool find (Json *destJson, const StdString &recordId, int recordType = -1, bool retainRecord = false);
 
+	// Find the MediaItem record matching the specified ID and return its shared snapshot, or NULL if no such record was found. If retainRecord is true, increase the record's refcount. If a SharedMediaItem object is returned by this method, it must be released when no longer needed.
+	SharedMediaItem *findMediaItem (const StdString &recordId, bool retainRecord = false);
+
 	// Find the first record passing a match predicate function and return a copy of the associated Json object, or NULL if no such record was found. If retainRecord is true, increase the record's refcount. If a Json object is returned by this method, it must be deleted when no longer needed.
 	Json *find (RecordStore::FindMatchFunction matchFn, void *matchData, bool retainRecord = false);
 
@@ -105,12 +113,26 @@ public:
 private:
 	struct RecordEntry {
 		Json *json;
+		SharedMediaItem *mediaItem;
+		int commandId;
+		StdString agentId;
 		int refcount;
 		RecordEntry ():
 			json (NULL),
+			mediaItem (NULL),
+			commandId (-1),
 			refcount (0) { }
 	};
 	std::map<StdString, RecordStore::RecordEntry> recordMap;
 	SDL_mutex *mutex;
+
+	// Store entry as the record matching id, replacing any existing entry. If retainOverwrite is true, increase the record's refcount when replacing. Must be invoked while holding the mutex.
+	void storeEntry (const StdString &id, const RecordStore::RecordEntry &entry, bool retainOverwrite);
+
+	// Free resources held by an entry and remove it from the record map. Must be invoked while holding the mutex.
+	void eraseEntry (std::map<StdString, RecordStore::RecordEntry>::iterator pos);
+
+	// Return the entry's Json object, creating it from the MediaItem snapshot if needed. Only Json find methods reach this path; MediaItem consumers read snapshots from findMediaItem. Must be invoked while holding the mutex.
+	Json *getEntryJson (RecordStore::RecordEntry *entry);
 };
 #endif
@@ -44,12 +44,14 @@
 #include "UiTextId.h"
 #include "Font.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Resource.h"
 
 Resource *Resource::instance = NULL;
 
 Resource::Resource ()
-: dataPath ("")
+: textureBudgetBytes (Resource::defaultTextureBudgetBytes)
+, dataPath ("")
 , freetype (NULL)
 , isBundleFile (false)
 , isOpen (false)
@@ -99,6 +101,8 @@ void Resource::clearFileMap () {
 
 void Resource::clearTextureMap () {
 	std::map<StdString, Resource::TextureData>::iterator i1, i2;
+	std::list<Resource::PoolTextureData>::iterator j1, j2;
+	int i;
 
 	SDL_LockMutex (textureMapMutex);
 	i1 = textureMap.begin ();
@@ -111,6 +115,27 @@ void Resource::clearTextureMap () {
 		++i1;
 	}
 	textureMap.clear ();
+	textureCompactList.clear ();
+
+	j1 = texturePool.begin ();
+	j2 = texturePool.end ();
+	while (j1 != j2) {
+		if (j1->texture) {
+			SDL_DestroyTexture (j1->texture);
+			j1->texture = NULL;
+		}
+		++j1;
+	}
+	texturePool.clear ();
+
+	textureStats.totalBytes = 0;
+	textureStats.textureCount = 0;
+	textureStats.pooledBytes = 0;
+	textureStats.pooledCount = 0;
+	for (i = 0; i < Resource::TextureCategoryCount; ++i) {
+		textureStats.categoryBytes[i] = 0;
+		textureStats.categoryCount[i] = 0;
+	}
 	SDL_UnlockMutex (textureMapMutex);
 }
 
@@ -214,6 +239,8 @@ void Resource::close () {
 }
 
 void Resource::compact () {
+	ProfilerZone zone ("Resource::compact");
+
 	compactFontMap ();
 	compactFileMap ();
 	compactTextureMap ();
@@ -247,6 +274,7 @@ void Resource::compactFileMap () {
 void Resource::compactTextureMap () {
 	std::vector<StdString>::iterator i1, i2;
 	std::map<StdString, Resource::TextureData>::iterator j;
+	Resource::PoolTextureData pooltexture;
 
 	if (textureCompactList.empty ()) {
 		return;
@@ -258,7 +286,21 @@ void Resource::compactTextureMap () {
 		j = textureMap.find (*i1);
 		if (j != textureMap.end ()) {
 			if (j->second.refcount <= 0) {
-				SDL_DestroyTexture (j->second.texture);
+				textureStats.categoryBytes[j->second.category] -= j->second.byteCount;
+				--(textureStats.categoryCount[j->second.category]);
+				--(textureStats.textureCount);
+				if (j->second.poolKey >= 0) {
+					pooltexture.texture = j->second.texture;
+					pooltexture.poolKey = j->second.poolKey;
+					pooltexture.byteCount = j->second.byteCount;
+					texturePool.push_front (pooltexture);
+					textureStats.pooledBytes += pooltexture.byteCount;
+					++(textureStats.pooledCount);
+				}
+				else {
+					SDL_DestroyTexture (j->second.texture);
+					textureStats.totalBytes -= j->second.byteCount;
+				}
 				j->second.texture = NULL;
 				textureMap.erase (j);
 			}
@@ -266,6 +308,7 @@ void Resource::compactTextureMap () {
 		++i1;
 	}
 	textureCompactList.clear ();
+	evictPoolTextures ();
 	SDL_UnlockMutex (textureMapMutex);
 }
 
@@ -514,6 +557,9 @@ Buffer *Resource::loadFile (const StdString &path) {
 	}
 
 	buffer = new Buffer ();
+	if ((sz > 0) && (sz < INT32_MAX)) {
+		buffer->reserve ((int) sz);
+	}
 	while (sz > 0) {
 		rlen = (size_t) sz;
 		if (rlen > sizeof (buf)) {
@@ -587,7 +633,6 @@ SDL_Surface *Resource::loadSurface (const StdString &path) {
 
 SDL_Texture *Resource::loadTexture (const StdString &path, bool refcountOnly) {
 	std::map<StdString, Resource::TextureData>::iterator i;
-	Resource::TextureData data;
 	StdString loadpath;
 	SDL_RWops *rw;
 	SDL_Surface *surface;
@@ -639,18 +684,15 @@ SDL_Texture *Resource::loadTexture (const StdString &path, bool refcountOnly) {
 		return (NULL);
 	}
 
-	data.texture = texture;
-	data.refcount = 1;
 	SDL_LockMutex (textureMapMutex);
-	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
+	insertTexture (path, texture, Resource::AssetTextureCategory, -1);
 	SDL_UnlockMutex (textureMapMutex);
 
 	return (texture);
 }
 
-SDL_Texture *Resource::createTexture (const StdString &path, SDL_Surface *surface) {
+SDL_Texture *Resource::createTexture (const StdString &path, SDL_Surface *surface, int category) {
 	std::map<StdString, Resource::TextureData>::iterator i;
-	Resource::TextureData data;
 	SDL_Texture *texture;
 
 	texture = NULL;
@@ -669,46 +711,276 @@ SDL_Texture *Resource::createTexture (const StdString &path, SDL_Surface *surfac
 		failLoad (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("SDL_CreateTextureFromSurface failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ()).c_str ());
 		return (NULL);
 	}
-	data.texture = texture;
-	data.refcount = 1;
 	SDL_LockMutex (textureMapMutex);
-	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
+	insertTexture (path, texture, category, -1);
 	SDL_UnlockMutex (textureMapMutex);
 	return (texture);
 }
 
-SDL_Texture *Resource::createTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess) {
-	std::map<StdString, Resource::TextureData>::iterator i;
-	Resource::TextureData data;
+SDL_Texture *Resource::createTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess, int category) {
+	if ((textureWidth <= 0) || (textureHeight <= 0)) {
+		return (NULL);
+	}
+	return (acquirePoolTexture (path, textureWidth, textureHeight, isStreamingTextureAccess, category));
+}
+
+SDL_Texture *Resource::createPoolTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess, int category) {
 	SDL_Texture *texture;
+	int poolw, poolh;
 
 	if ((textureWidth <= 0) || (textureHeight <= 0)) {
 		return (NULL);
 	}
+	poolw = Resource::getPoolTextureSize (textureWidth);
+	poolh = Resource::getPoolTextureSize (textureHeight);
+	texture = acquirePoolTexture (path, poolw, poolh, isStreamingTextureAccess, category);
+	if (texture && ((poolw > textureWidth) || (poolh > textureHeight))) {
+		clearTextureMargin (texture, textureWidth, textureHeight, poolw, poolh, isStreamingTextureAccess);
+	}
+	return (texture);
+}
+
+void Resource::clearTextureMargin (SDL_Texture *texture, int regionWidth, int regionHeight, int textureWidth, int textureHeight, bool isStreamingTextureAccess) {
+	SDL_Texture *target;
+	SDL_Rect rects[2];
+	uint8_t *pixels;
+	int i, count, pitch, y;
+
+	// Filtered draws of the region sample texels just outside it, so margin pixels left by a previous user must not remain
+	count = 0;
+	if (textureWidth > regionWidth) {
+		rects[count].x = regionWidth;
+		rects[count].y = 0;
+		rects[count].w = textureWidth - regionWidth;
+		rects[count].h = textureHeight;
+		++count;
+	}
+	if (textureHeight > regionHeight) {
+		rects[count].x = 0;
+		rects[count].y = regionHeight;
+		rects[count].w = regionWidth;
+		rects[count].h = textureHeight - regionHeight;
+		++count;
+	}
+	if (count <= 0) {
+		return;
+	}
+	if (isStreamingTextureAccess) {
+		for (i = 0; i < count; ++i) {
+			if (SDL_LockTexture (texture, &(rects[i]), (void **) &pixels, &pitch) != 0) {
+				Log::debug ("Failed to clear texture margin, SDL_LockTexture: %s", SDL_GetError ());
+				return;
+			}
+			for (y = 0; y < rects[i].h; ++y) {
+				memset (pixels, 0, rects[i].w * sizeof (Uint32));
+				pixels += pitch;
+			}
+			SDL_UnlockTexture (texture);
+		}
+		return;
+	}
+	target = SDL_GetRenderTarget (App::instance->render);
+	if (SDL_SetRenderTarget (App::instance->render, texture) != 0) {
+		Log::debug ("Failed to clear texture margin, SDL_SetRenderTarget: %s", SDL_GetError ());
+		return;
+	}
+	SDL_SetRenderDrawBlendMode (App::instance->render, SDL_BLENDMODE_NONE);
+	SDL_SetRenderDrawColor (App::instance->render, 0, 0, 0, 0);
+	SDL_RenderFillRects (App::instance->render, rects, count);
+	SDL_SetRenderTarget (App::instance->render, target);
+}
+
+SDL_Texture *Resource::createPoolTexture (const StdString &path, SDL_Surface *surface, int category) {
+	SDL_Surface *converted, *src;
+	SDL_Texture *texture;
+	SDL_Rect rect;
+	int result;
+
+	if ((! surface) || (surface->w <= 0) || (surface->h <= 0)) {
+		return (NULL);
+	}
+	converted = NULL;
+	src = surface;
+	if (surface->format->format != SDL_PIXELFORMAT_RGBA32) {
+		converted = SDL_ConvertSurfaceFormat (surface, SDL_PIXELFORMAT_RGBA32, 0);
+		if (! converted) {
+			failLoad (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("SDL_ConvertSurfaceFormat failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ()).c_str ());
+			return (NULL);
+		}
+		src = converted;
+	}
+
+	texture = createPoolTexture (path, src->w, src->h, true, category);
+	if (texture) {
+		rect.x = 0;
+		rect.y = 0;
+		rect.w = src->w;
+		rect.h = src->h;
+		if (SDL_MUSTLOCK (src)) {
+			SDL_LockSurface (src);
+		}
+		result = SDL_UpdateTexture (texture, &rect, src->pixels, src->pitch);
+		if (SDL_MUSTLOCK (src)) {
+			SDL_UnlockSurface (src);
+		}
+		if (result != 0) {
+			failLoad (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("SDL_UpdateTexture failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ()).c_str ());
+			unloadTexture (path);
+			texture = NULL;
+		}
+	}
+	if (converted) {
+		SDL_FreeSurface (converted);
+	}
+	return (texture);
+}
+
+SDL_Texture *Resource::acquirePoolTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess, int category) {
+	std::map<StdString, Resource::TextureData>::iterator i;
+	std::list<Resource::PoolTextureData>::iterator j1, j2;
+	SDL_Texture *texture;
+	int64_t key;
+
+	key = Resource::getPoolKey (textureWidth, textureHeight, isStreamingTextureAccess);
 	texture = NULL;
 	SDL_LockMutex (textureMapMutex);
 	i = textureMap.find (path);
 	if (i != textureMap.end ()) {
 		++(i->second.refcount);
 		texture = i->second.texture;
+		SDL_UnlockMutex (textureMapMutex);
+		return (texture);
+	}
+
+	j1 = texturePool.begin ();
+	j2 = texturePool.end ();
+	while (j1 != j2) {
+		if (j1->poolKey == key) {
+			texture = j1->texture;
+			textureStats.pooledBytes -= j1->byteCount;
+			--(textureStats.pooledCount);
+			textureStats.totalBytes -= j1->byteCount;
+			texturePool.erase (j1);
+			break;
+		}
+		++j1;
 	}
-	SDL_UnlockMutex (textureMapMutex);
 	if (texture) {
+		++(textureStats.poolHitCount);
+		SDL_SetTextureBlendMode (texture, SDL_BLENDMODE_BLEND);
+		SDL_SetTextureColorMod (texture, 255, 255, 255);
+		SDL_SetTextureAlphaMod (texture, 255);
+		insertTexture (path, texture, category, key);
+		SDL_UnlockMutex (textureMapMutex);
 		return (texture);
 	}
+	++(textureStats.poolMissCount);
+	SDL_UnlockMutex (textureMapMutex);
+
 	texture = SDL_CreateTexture (App::instance->render, SDL_PIXELFORMAT_RGBA32, isStreamingTextureAccess ? SDL_TEXTUREACCESS_STREAMING : SDL_TEXTUREACCESS_TARGET, textureWidth, textureHeight);
 	if (! texture) {
-		failLoad (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("SDL_CreateTextureFromSurface failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ()).c_str ());
+		failLoad (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("SDL_CreateTexture failed; path=\"%s\" err=\"%s\"", path.c_str (), SDL_GetError ()).c_str ());
 		return (NULL);
 	}
+	SDL_LockMutex (textureMapMutex);
+	insertTexture (path, texture, category, key);
+	evictPoolTextures ();
+	SDL_UnlockMutex (textureMapMutex);
+	return (texture);
+}
 
+void Resource::insertTexture (const StdString &path, SDL_Texture *texture, int category, int64_t poolKey) {
+	Resource::TextureData data;
+
+	if ((category < 0) || (category >= Resource::TextureCategoryCount)) {
+		category = Resource::AssetTextureCategory;
+	}
 	data.texture = texture;
 	data.refcount = 1;
-	SDL_LockMutex (textureMapMutex);
+	data.category = category;
+	data.byteCount = Resource::getTextureByteCount (texture);
+	data.poolKey = poolKey;
 	textureMap.insert (std::pair<StdString, Resource::TextureData> (path, data));
+
+	textureStats.totalBytes += data.byteCount;
+	if (textureStats.totalBytes > textureStats.peakBytes) {
+		textureStats.peakBytes = textureStats.totalBytes;
+	}
+	++(textureStats.textureCount);
+	textureStats.categoryBytes[category] += data.byteCount;
+	++(textureStats.categoryCount[category]);
+}
+
+void Resource::evictPoolTextures () {
+	Resource::PoolTextureData *item;
+
+	while ((textureStats.totalBytes > textureBudgetBytes) && (! texturePool.empty ())) {
+		item = &(texturePool.back ());
+		SDL_DestroyTexture (item->texture);
+		textureStats.totalBytes -= item->byteCount;
+		textureStats.pooledBytes -= item->byteCount;
+		--(textureStats.pooledCount);
+		++(textureStats.evictCount);
+		texturePool.pop_back ();
+	}
+}
+
+int64_t Resource::getTextureByteCount (SDL_Texture *texture) {
+	Uint32 format;
+	int access, w, h, bpp;
+	int64_t count;
+
+	if (SDL_QueryTexture (texture, &format, &access, &w, &h) != 0) {
+		return (0);
+	}
+	bpp = SDL_BYTESPERPIXEL (format);
+	if (bpp <= 0) {
+		bpp = 4;
+	}
+	count = (int64_t) w * (int64_t) h * (int64_t) bpp;
+	if (access == SDL_TEXTUREACCESS_STREAMING) {
+		// Render backends such as OpenGL keep a system memory copy of streaming textures for use by SDL_LockTexture
+		count *= 2;
+	}
+	return (count);
+}
+
+int64_t Resource::getPoolKey (int textureWidth, int textureHeight, bool isStreamingTextureAccess) {
+	return ((((int64_t) textureWidth) << 32) | (((int64_t) textureHeight) << 1) | (isStreamingTextureAccess ? 1 : 0));
+}
+
+int Resource::getPoolTextureSize (int requestSize) {
+	int step;
+
+	if (requestSize <= 64) {
+		step = 16;
+	}
+	else if (requestSize <= 512) {
+		step = 64;
+	}
+	else {
+		step = 128;
+	}
+	return (((requestSize + step - 1) / step) * step);
+}
+
+void Resource::getTextureStats (Resource::TextureStats *destStats) {
+	SDL_LockMutex (textureMapMutex);
+	*destStats = textureStats;
 	SDL_UnlockMutex (textureMapMutex);
+}
 
-	return (texture);
+void Resource::logTextureStats () {
+	Resource::TextureStats stats;
+	int i;
+
+	getTextureStats (&stats);
+	Log::debug ("Texture stats; totalBytes=%lli peakBytes=%lli textureCount=%i pooledBytes=%lli pooledCount=%i poolHitCount=%lli poolMissCount=%lli evictCount=%lli", (long long int) stats.totalBytes, (long long int) stats.peakBytes, stats.textureCount, (long long int) stats.pooledBytes, stats.pooledCount, (long long int) stats.poolHitCount, (long long int) stats.poolMissCount, (long long int) stats.evictCount);
+	for (i = 0; i < Resource::TextureCategoryCount; ++i) {
+		if (stats.categoryCount[i] > 0) {
+			Log::debug ("Texture category stats; category=%i bytes=%lli count=%i", i, (long long int) stats.categoryBytes[i], stats.categoryCount[i]);
+		}
+	}
 }
 
 void Resource::unloadTexture (const StdString &path) {
@@ -51,6 +51,50 @@ public:
 	// Clear static instance data
 	static void freeInstance ();
 
+	// Texture category values, used to group texture memory usage in stats
+	static constexpr const int AssetTextureCategory = 0;
+	static constexpr const int FontTextureCategory = 1;
+	static constexpr const int ImageTextureCategory = 2;
+	static constexpr const int VideoTextureCategory = 3;
+	static constexpr const int ShaderTextureCategory = 4;
+	static constexpr const int ComposeTextureCategory = 5;
+	static constexpr const int CaptureTextureCategory = 6;
+	static constexpr const int TextureCategoryCount = 7;
+
+	static constexpr const int64_t defaultTextureBudgetBytes = (256 * 1024 * 1024);
+
+	struct TextureStats {
+		int64_t totalBytes;
+		int64_t peakBytes;
+		int textureCount;
+		int64_t pooledBytes;
+		int pooledCount;
+		int64_t categoryBytes[Resource::TextureCategoryCount];
+		int categoryCount[Resource::TextureCategoryCount];
+		int64_t poolHitCount;
+		int64_t poolMissCount;
+		int64_t evictCount;
+		TextureStats ():
+			totalBytes (0),
+			peakBytes (0),
+			textureCount (0),
+			pooledBytes (0),
+			pooledCount (0),
+			poolHitCount (0),
+			poolMissCount (0),
+			evictCount (0) {
+			int i;
+
+			for (i = 0; i < Resource::TextureCategoryCount; ++i) {
+				categoryBytes[i] = 0;
+				categoryCount[i] = 0;
+			}
+		}
+	};
+
+	// Read-write data members
+	int64_t textureBudgetBytes; // Unreferenced pooled textures are destroyed while total texture memory exceeds this size
+
 	// Read-only data members
 	StdString dataPath;
 	StdString lastErrorMessage;
@@ -86,14 +130,26 @@ public:
 	SDL_Texture *loadTexture (const StdString &path, bool refcountOnly = false);
 
 	// Create a texture from a surface and associate it with a path. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. The surface object is not modified or freed by this method. This method must be invoked only from the application's main thread.
-	SDL_Texture *createTexture (const StdString &path, SDL_Surface *surface);
+	SDL_Texture *createTexture (const StdString &path, SDL_Surface *surface, int category = Resource::AssetTextureCategory);
+
+	// Create a render target texture of the specified size and associate it with a path, reusing an unreferenced pooled texture of the same size if one is available. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. The content of a reused texture is not cleared. This method must be invoked only from the application's main thread.
+	SDL_Texture *createTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess = false, int category = Resource::AssetTextureCategory);
+
+	// Create a pooled texture at least as large as the specified size and associate it with a path. Texture dimensions are rounded up to a size bucket to allow reuse across similar sizes, and the caller should read, write, and draw only the region from (0, 0) to (textureWidth, textureHeight). Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. Pixels outside the region are cleared, but the content of the region in a reused texture is not. This method must be invoked only from the application's main thread.
+	SDL_Texture *createPoolTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess, int category);
 
-	// Create a render target texture of the specified size and associate it with a path. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. This method must be invoked only from the application's main thread.
-	SDL_Texture *createTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess = false);
+	// Create a pooled streaming texture holding a copy of the surface's pixels and associate it with a path. The texture is sized as in createPoolTexture, with surface content placed at (0, 0). The surface object is not modified or freed by this method. Returns a pointer to the resulting SDL_Texture, or NULL if the texture could not be created. This method must be invoked only from the application's main thread.
+	SDL_Texture *createPoolTexture (const StdString &path, SDL_Surface *surface, int category);
 
 	// Unload previously acquired texture resources from the specified path
 	void unloadTexture (const StdString &path);
 
+	// Store current texture memory usage into destStats
+	void getTextureStats (Resource::TextureStats *destStats);
+
+	// Write texture stats to the log
+	void logTextureStats ();
+
 	// Load a Font asset from a ttf file at the specified resource path. Returns a pointer to the resulting Font, or NULL if the font could not be loaded. This method must be invoked only from the application's main thread.
 	Font *loadFont (const StdString &path, int pointSize);
 
@@ -122,6 +178,24 @@ private:
 	struct TextureData {
 		SDL_Texture *texture;
 		int refcount;
+		int category;
+		int64_t byteCount;
+		int64_t poolKey;
+		TextureData ():
+			texture (NULL),
+			refcount (0),
+			category (Resource::AssetTextureCategory),
+			byteCount (0),
+			poolKey (-1) { }
+	};
+	struct PoolTextureData {
+		SDL_Texture *texture;
+		int64_t poolKey;
+		int64_t byteCount;
+		PoolTextureData ():
+			texture (NULL),
+			poolKey (-1),
+			byteCount (0) { }
 	};
 	struct FontData {
 		Font *font;
@@ -142,6 +216,10 @@ private:
 	std::vector<StdString> textureCompactList;
 	SDL_mutex *textureMapMutex;
 
+	// Unreferenced textures available for reuse, ordered from most to least recently released
+	std::list<Resource::PoolTextureData> texturePool;
+	Resource::TextureStats textureStats;
+
 	// A map of font keys to FontData objects
 	std::map<StdString, Resource::FontData> fontMap;
 	std::vector<StdString> fontCompactList;
@@ -168,6 +246,27 @@ private:
 	// Remove unreferenced items from the font map
 	void compactFontMap ();
 
+	// Return a texture from the pool or a newly created texture matching the specified size and access, and add it to the texture map under path with a refcount of 1. Returns NULL if the texture could not be created.
+	SDL_Texture *acquirePoolTexture (const StdString &path, int textureWidth, int textureHeight, bool isStreamingTextureAccess, int category);
+
+	// Add a texture to the texture map with a refcount of 1 and update stats. If poolKey is not negative, the texture is returned to the pool when no longer referenced. Must be invoked while holding textureMapMutex.
+	void insertTexture (const StdString &path, SDL_Texture *texture, int category, int64_t poolKey);
+
+	// Destroy unreferenced pooled textures, least recently used first, while total texture memory exceeds textureBudgetBytes. Must be invoked while holding textureMapMutex.
+	void evictPoolTextures ();
+
+	// Return the number of bytes used by the specified texture's pixels, including the system memory copy held for streaming textures
+	static int64_t getTextureByteCount (SDL_Texture *texture);
+
+	// Clear pixels outside the region from (0, 0) to (regionWidth, regionHeight) in a texture of the specified size. This method must be invoked only from the application's main thread.
+	void clearTextureMargin (SDL_Texture *texture, int regionWidth, int regionHeight, int textureWidth, int textureHeight, bool isStreamingTextureAccess);
+
+	// Return the pool key for textures of the specified size and access
+	static int64_t getPoolKey (int textureWidth, int textureHeight, bool isStreamingTextureAccess);
+
+	// Return the texture size that createPoolTexture allocates for the specified requested size
+	static int getPoolTextureSize (int requestSize);
+
 	// Set failure state for a load operation
 	void failLoad (const StdString &lastErrorMessageValue, const char *logErrorMessage = NULL);
 
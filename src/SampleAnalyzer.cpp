@@ -0,0 +1,360 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SAMPLE_ANALYZER_SSE2 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#define SAMPLE_ANALYZER_NEON 1
+#endif
+#include "SampleAnalyzer.h"
+
+SampleAnalyzer::SampleAnalyzer ()
+: sampleFormat (AUDIO_F32)
+, channelCount (1)
+, fftWindowSum (1.0f)
+{
+	double a;
+	int i, j, bits, n;
+
+	fftWindow.resize (SampleAnalyzer::fftSize);
+	fftReal.resize (SampleAnalyzer::fftSize);
+	fftImag.resize (SampleAnalyzer::fftSize);
+	fftCos.resize (SampleAnalyzer::fftSize / 2);
+	fftSin.resize (SampleAnalyzer::fftSize / 2);
+	fftBitReverse.resize (SampleAnalyzer::fftSize);
+
+	fftWindowSum = 0.0f;
+	for (i = 0; i < SampleAnalyzer::fftSize; ++i) {
+		fftWindow[i] = (float) (0.5f - (0.5f * cos (2.0f * M_PI * (double) i / (double) (SampleAnalyzer::fftSize - 1))));
+		fftWindowSum += fftWindow[i];
+	}
+	for (i = 0; i < (SampleAnalyzer::fftSize / 2); ++i) {
+		a = -2.0f * M_PI * (double) i / (double) SampleAnalyzer::fftSize;
+		fftCos[i] = (float) cos (a);
+		fftSin[i] = (float) sin (a);
+	}
+	bits = 0;
+	n = SampleAnalyzer::fftSize;
+	while (n > 1) {
+		n >>= 1;
+		++bits;
+	}
+	for (i = 0; i < SampleAnalyzer::fftSize; ++i) {
+		n = 0;
+		for (j = 0; j < bits; ++j) {
+			if (i & (1 << j)) {
+				n |= (1 << (bits - 1 - j));
+			}
+		}
+		fftBitReverse[i] = n;
+	}
+}
+SampleAnalyzer::~SampleAnalyzer () {
+}
+
+void SampleAnalyzer::setFormat (SDL_AudioFormat sampleFormatValue, int channelCountValue) {
+	sampleFormat = sampleFormatValue;
+	channelCount = channelCountValue;
+	if (channelCount < 1) {
+		channelCount = 1;
+	}
+}
+
+void SampleAnalyzer::convertSamples (const uint8_t *data, int frameCount, float *destValues) {
+	float scale;
+	int i, j, sum;
+
+	// Each format uses its own loop so that per-sample work has no branches or indirect calls, allowing the compiler to vectorize it
+	switch (sampleFormat) {
+		case AUDIO_S8: {
+			const int8_t *s = (const int8_t *) data;
+			scale = 1.0f / (128.0f * (float) channelCount);
+			for (i = 0; i < frameCount; ++i) {
+				sum = 0;
+				for (j = 0; j < channelCount; ++j) {
+					sum += s[j];
+				}
+				destValues[i] = (float) sum * scale;
+				s += channelCount;
+			}
+			break;
+		}
+		case AUDIO_U8: {
+			const uint8_t *s = data;
+			scale = 1.0f / (128.0f * (float) channelCount);
+			for (i = 0; i < frameCount; ++i) {
+				sum = 0;
+				for (j = 0; j < channelCount; ++j) {
+					sum += ((int) s[j]) - 128;
+				}
+				destValues[i] = (float) sum * scale;
+				s += channelCount;
+			}
+			break;
+		}
+		case AUDIO_S16LSB:
+		case AUDIO_S16MSB: {
+			const int16_t *s = (const int16_t *) data;
+			scale = 1.0f / (32768.0f * (float) channelCount);
+			for (i = 0; i < frameCount; ++i) {
+				sum = 0;
+				for (j = 0; j < channelCount; ++j) {
+					sum += s[j];
+				}
+				destValues[i] = (float) sum * scale;
+				s += channelCount;
+			}
+			break;
+		}
+		case AUDIO_U16LSB:
+		case AUDIO_U16MSB: {
+			const uint16_t *s = (const uint16_t *) data;
+			scale = 1.0f / (32768.0f * (float) channelCount);
+			for (i = 0; i < frameCount; ++i) {
+				sum = 0;
+				for (j = 0; j < channelCount; ++j) {
+					sum += ((int) s[j]) - 32768;
+				}
+				destValues[i] = (float) sum * scale;
+				s += channelCount;
+			}
+			break;
+		}
+		case AUDIO_S32LSB:
+		case AUDIO_S32MSB: {
+			const int32_t *s = (const int32_t *) data;
+			float v;
+			scale = 1.0f / (2147483648.0f * (float) channelCount);
+			for (i = 0; i < frameCount; ++i) {
+				v = 0.0f;
+				for (j = 0; j < channelCount; ++j) {
+					v += (float) s[j];
+				}
+				destValues[i] = v * scale;
+				s += channelCount;
+			}
+			break;
+		}
+		default: {
+			const float *s = (const float *) data;
+			float v;
+			if (channelCount == 1) {
+				memcpy (destValues, s, frameCount * sizeof (float));
+				break;
+			}
+			if (channelCount == 2) {
+				for (i = 0; i < frameCount; ++i) {
+					destValues[i] = (s[i * 2] + s[(i * 2) + 1]) * 0.5f;
+				}
+				break;
+			}
+			scale = 1.0f / (float) channelCount;
+			for (i = 0; i < frameCount; ++i) {
+				v = 0.0f;
+				for (j = 0; j < channelCount; ++j) {
+					v += s[j];
+				}
+				destValues[i] = v * scale;
+				s += channelCount;
+			}
+			break;
+		}
+	}
+}
+
+void SampleAnalyzer::reduceBlock (const float *values, int valueCount, float *minValue, float *maxValue, float *rmsValue) {
+	float minval, maxval, sumsquares, v;
+	int i;
+
+	if (valueCount <= 0) {
+		*minValue = 0.0f;
+		*maxValue = 0.0f;
+		*rmsValue = 0.0f;
+		return;
+	}
+	i = 0;
+	minval = values[0];
+	maxval = values[0];
+	sumsquares = 0.0f;
+#if SAMPLE_ANALYZER_SSE2
+	if (valueCount >= 4) {
+		__m128 vmin, vmax, vsum, x;
+		float lanes[4];
+
+		vmin = _mm_loadu_ps (values);
+		vmax = vmin;
+		vsum = _mm_setzero_ps ();
+		while ((i + 4) <= valueCount) {
+			x = _mm_loadu_ps (values + i);
+			vmin = _mm_min_ps (vmin, x);
+			vmax = _mm_max_ps (vmax, x);
+			vsum = _mm_add_ps (vsum, _mm_mul_ps (x, x));
+			i += 4;
+		}
+		_mm_storeu_ps (lanes, vmin);
+		minval = fminf (fminf (lanes[0], lanes[1]), fminf (lanes[2], lanes[3]));
+		_mm_storeu_ps (lanes, vmax);
+		maxval = fmaxf (fmaxf (lanes[0], lanes[1]), fmaxf (lanes[2], lanes[3]));
+		_mm_storeu_ps (lanes, vsum);
+		sumsquares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+#elif SAMPLE_ANALYZER_NEON
+	if (valueCount >= 4) {
+		float32x4_t vmin, vmax, vsum, x;
+		float lanes[4];
+
+		vmin = vld1q_f32 (values);
+		vmax = vmin;
+		vsum = vdupq_n_f32 (0.0f);
+		while ((i + 4) <= valueCount) {
+			x = vld1q_f32 (values + i);
+			vmin = vminq_f32 (vmin, x);
+			vmax = vmaxq_f32 (vmax, x);
+			vsum = vmlaq_f32 (vsum, x, x);
+			i += 4;
+		}
+		vst1q_f32 (lanes, vmin);
+		minval = fminf (fminf (lanes[0], lanes[1]), fminf (lanes[2], lanes[3]));
+		vst1q_f32 (lanes, vmax);
+		maxval = fmaxf (fmaxf (lanes[0], lanes[1]), fmaxf (lanes[2], lanes[3]));
+		vst1q_f32 (lanes, vsum);
+		sumsquares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+#endif
+	while (i < valueCount) {
+		v = values[i];
+		if (v < minval) {
+			minval = v;
+		}
+		if (v > maxval) {
+			maxval = v;
+		}
+		sumsquares += v * v;
+		++i;
+	}
+	*minValue = minval;
+	*maxValue = maxval;
+	*rmsValue = sqrtf (sumsquares / (float) valueCount);
+}
+
+void SampleAnalyzer::computeSpectrum (const float *values, int valueCount, float *destBins, int binCount) {
+	float mag, maxmag, db, scale;
+	double minratio, ratio;
+	int i, n, start, end, k, halfsize;
+
+	if (binCount <= 0) {
+		return;
+	}
+	n = valueCount;
+	if (n > SampleAnalyzer::fftSize) {
+		n = SampleAnalyzer::fftSize;
+	}
+	for (i = 0; i < n; ++i) {
+		fftReal[fftBitReverse[i]] = values[i] * fftWindow[i];
+	}
+	for (i = n; i < SampleAnalyzer::fftSize; ++i) {
+		fftReal[fftBitReverse[i]] = 0.0f;
+	}
+	for (i = 0; i < SampleAnalyzer::fftSize; ++i) {
+		fftImag[i] = 0.0f;
+	}
+	executeFft ();
+
+	halfsize = SampleAnalyzer::fftSize / 2;
+	scale = 2.0f / fftWindowSum;
+	minratio = (double) SampleAnalyzer::spectrumMinFrequencyRatio * 2.0f;
+	for (i = 0; i < binCount; ++i) {
+		// Bin edges are spaced logarithmically from minratio to the Nyquist frequency
+		ratio = minratio * pow (1.0f / minratio, (double) i / (double) binCount);
+		start = (int) floor (ratio * (double) halfsize);
+		ratio = minratio * pow (1.0f / minratio, (double) (i + 1) / (double) binCount);
+		end = (int) floor (ratio * (double) halfsize);
+		if (start < 1) {
+			start = 1;
+		}
+		if (end <= start) {
+			end = start + 1;
+		}
+		if (end > halfsize) {
+			end = halfsize;
+		}
+		maxmag = 0.0f;
+		for (k = start; k < end; ++k) {
+			mag = ((fftReal[k] * fftReal[k]) + (fftImag[k] * fftImag[k]));
+			if (mag > maxmag) {
+				maxmag = mag;
+			}
+		}
+		maxmag = sqrtf (maxmag) * scale;
+		if (maxmag <= 0.0f) {
+			destBins[i] = 0.0f;
+			continue;
+		}
+		db = 20.0f * log10f (maxmag);
+		db = (db - SampleAnalyzer::spectrumMinDecibels) / -(SampleAnalyzer::spectrumMinDecibels);
+		if (db < 0.0f) {
+			db = 0.0f;
+		}
+		if (db > 1.0f) {
+			db = 1.0f;
+		}
+		destBins[i] = db;
+	}
+}
+
+void SampleAnalyzer::executeFft () {
+	float tr, ti, wr, wi;
+	int size, halfsize, step, i, j, k;
+
+	size = 2;
+	while (size <= SampleAnalyzer::fftSize) {
+		halfsize = size / 2;
+		step = SampleAnalyzer::fftSize / size;
+		for (i = 0; i < SampleAnalyzer::fftSize; i += size) {
+			for (j = 0; j < halfsize; ++j) {
+				k = i + j;
+				wr = fftCos[j * step];
+				wi = fftSin[j * step];
+				tr = (fftReal[k + halfsize] * wr) - (fftImag[k + halfsize] * wi);
+				ti = (fftReal[k + halfsize] * wi) + (fftImag[k + halfsize] * wr);
+				fftReal[k + halfsize] = fftReal[k] - tr;
+				fftImag[k + halfsize] = fftImag[k] - ti;
+				fftReal[k] += tr;
+				fftImag[k] += ti;
+			}
+		}
+		size *= 2;
+	}
+}
@@ -0,0 +1,74 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Object that reduces blocks of audio samples to values for visualizer display
+#ifndef SAMPLE_ANALYZER_H
+#define SAMPLE_ANALYZER_H
+
+class SampleAnalyzer {
+public:
+	SampleAnalyzer ();
+	~SampleAnalyzer ();
+
+	static constexpr const int fftSize = 1024;
+	static constexpr const float spectrumMinDecibels = -72.0f;
+	static constexpr const float spectrumMinFrequencyRatio = 0.005f; // Fraction of the sample rate below which spectrum bins are not shown
+
+	// Read-only data members
+	SDL_AudioFormat sampleFormat;
+	int channelCount;
+
+	// Set the format of sample data to be provided for conversion
+	void setFormat (SDL_AudioFormat sampleFormatValue, int channelCountValue);
+
+	// Convert frameCount sample frames from data to mono float values ranging from -1.0 to 1.0, and store them in destValues
+	void convertSamples (const uint8_t *data, int frameCount, float *destValues);
+
+	// Assign the minimum, maximum, and root mean square values of the provided samples
+	static void reduceBlock (const float *values, int valueCount, float *minValue, float *maxValue, float *rmsValue);
+
+	// Compute a magnitude spectrum from up to fftSize of the provided samples, and store binCount values ranging from 0.0 to 1.0 in destBins, spaced logarithmically by frequency
+	void computeSpectrum (const float *values, int valueCount, float *destBins, int binCount);
+
+private:
+	// Transform the contents of fftReal and fftImag in place
+	void executeFft ();
+
+	std::vector<float> fftWindow;
+	std::vector<float> fftReal;
+	std::vector<float> fftImag;
+	std::vector<float> fftCos;
+	std::vector<float> fftSin;
+	std::vector<int> fftBitReverse;
+	float fftWindowSum;
+};
+#endif
@@ -69,6 +69,7 @@ SettingsWindow::SettingsWindow ()
 
 	setFixedSize (true, App::instance->rootPanel->width * windowWidthScale, App::instance->rootPanel->height);
 	setFillBg (true, UiConfiguration::instance->mediumBackgroundColor);
+	setLayerCache (true);
 
 	headerImage = add (new ImageWindow ());
 	headerImage->widgetName.assign ("settingsWindowHeaderImage");
@@ -41,6 +41,7 @@
 Shader::Shader ()
 : Widget ()
 , isAnimationComplete (false)
+, isRenderTextureEnabled (true)
 , isRendering (false)
 , shouldRender (false)
 , renderMsElapsed (0)
@@ -100,9 +101,11 @@ void Shader::doUpdate (int msElapsed) {
 
 		if (shouldRender) {
 			shouldRender = false;
-			isRendering = true;
-			retain ();
-			App::instance->addPredrawTask (Shader::resetRenderTexture, this);
+			if (isRenderTextureEnabled) {
+				isRendering = true;
+				retain ();
+				App::instance->addPredrawTask (Shader::resetRenderTexture, this);
+			}
 		}
 		if (!(FLOAT_EQUALS (w, width) && FLOAT_EQUALS (h, height))) {
 			eventCallback (resizeCallback);
@@ -111,6 +114,7 @@ void Shader::doUpdate (int msElapsed) {
 			eventCallback (animationCompleteCallback);
 		}
 	}
+	invalidateLayer ();
 }
 
 void Shader::resetRenderTexture (void *itPtr) {
@@ -140,7 +144,7 @@ void Shader::executeResetRenderTexture () {
 			textureWidth = w;
 			textureHeight = h;
 			renderTexturePath.sprintf ("*_Shader_%llx_%llx", (long long int) id, (long long int) App::instance->getUniqueId ());
-			renderTexture = Resource::instance->createTexture (renderTexturePath, textureWidth, textureHeight, true);
+			renderTexture = Resource::instance->createPoolTexture (renderTexturePath, textureWidth, textureHeight, true, Resource::ShaderTextureCategory);
 			if (! renderTexture) {
 				renderTexturePath.assign ("");
 			}
@@ -163,7 +167,13 @@ void Shader::executeResetRenderTexture () {
 }
 
 bool Shader::lockRenderTexture () {
-	if (SDL_LockTexture (renderTexture, NULL, &renderPixels, &renderPitch) != 0) {
+	SDL_Rect rect;
+
+	rect.x = 0;
+	rect.y = 0;
+	rect.w = textureWidth;
+	rect.h = textureHeight;
+	if (SDL_LockTexture (renderTexture, &rect, &renderPixels, &renderPitch) != 0) {
 		Log::err ("Failed to update render texture, SDL_LockTexture: %s", SDL_GetError ());
 		return (false);
 	}
@@ -302,7 +312,7 @@ void Shader::drawLine (const Color &drawColor, int lineX1, int lineY1, int lineX
 }
 
 void Shader::doDraw (double originX, double originY) {
-	SDL_Rect rect;
+	SDL_Rect rect, srcrect;
 
 	if (! renderTexture) {
 		return;
@@ -311,7 +321,11 @@ void Shader::doDraw (double originX, double originY) {
 	rect.y = (int) (originY + position.y);
 	rect.w = (int) width;
 	rect.h = (int) height;
-	SDL_RenderCopy (App::instance->render, renderTexture, NULL, &rect);
+	srcrect.x = 0;
+	srcrect.y = 0;
+	srcrect.w = textureWidth;
+	srcrect.h = textureHeight;
+	SDL_RenderCopy (App::instance->render, renderTexture, &srcrect, &rect);
 }
 
 bool Shader::updateRenderState (int msElapsed) {
@@ -78,6 +78,7 @@ protected:
 	// Draw a line to renderPixels
 	void drawLine (const Color &drawColor, int lineX1, int lineY1, int lineX2, int lineY2);
 
+	bool isRenderTextureEnabled; // If false, subclasses draw directly in doDraw and renderTexture is not created
 	bool isRendering;
 	bool shouldRender;
 	int64_t renderMsElapsed;
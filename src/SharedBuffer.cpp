@@ -31,39 +31,42 @@
 * If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
 */
 #include "Config.h"
-#include "SdlUtil.h"
+#include <new>
+#include "BufferPool.h"
 #include "SharedBuffer.h"
 
 SharedBuffer::SharedBuffer ()
 : Buffer ()
-, refcount (0)
 {
-	SdlUtil::createMutex (&refcountMutex);
+	isPooled = true;
 }
 SharedBuffer::~SharedBuffer () {
-	SdlUtil::destroyMutex (&refcountMutex);
 }
 
-void SharedBuffer::retain () {
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
+
+void *SharedBuffer::operator new (size_t objectSize) {
+	void *ptr;
+
+	ptr = NULL;
+	if (BufferPool::instance) {
+		ptr = BufferPool::instance->allocate ((int) objectSize);
+	}
+	else {
+		ptr = malloc (objectSize);
 	}
-	SDL_UnlockMutex (refcountMutex);
+	if (! ptr) {
+		throw std::bad_alloc ();
+	}
+	return (ptr);
 }
-void SharedBuffer::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
+void SharedBuffer::operator delete (void *objectPtr, size_t objectSize) {
+	if (! objectPtr) {
+		return;
+	}
+	if (BufferPool::instance) {
+		BufferPool::instance->recycle ((uint8_t *) objectPtr, BufferPool::instance->getBlockSize ((int) objectSize));
 	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
-		delete (this);
+	else {
+		free (objectPtr);
 	}
 }
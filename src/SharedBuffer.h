@@ -30,25 +30,21 @@
 * QUESTIONS OR ADDITIONAL INFORMATION
 * If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
 */
-// Buffer subclass that provides refcount functionality for use in shared contexts
+// Buffer subclass that provides refcount functionality for use in shared contexts, with object and data memory recycled through BufferPool
 #ifndef SHARED_BUFFER_H
 #define SHARED_BUFFER_H
 
+#include <stddef.h>
 #include "Buffer.h"
+#include "Refcounted.h"
 
-class SharedBuffer : public Buffer {
+class SharedBuffer : public Buffer, public Refcounted {
 public:
 	SharedBuffer ();
 	~SharedBuffer ();
 
-	// Increase the object's refcount
-	void retain ();
-
-	// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
-	void release ();
-
-private:
-	int refcount;
-	SDL_mutex *refcountMutex;
+	// Allocate and free SharedBuffer objects using BufferPool blocks
+	static void *operator new (size_t objectSize);
+	static void operator delete (void *objectPtr, size_t objectSize);
 };
 #endif
@@ -56,6 +56,9 @@ Slider::Slider (double minValue, double maxValue)
 , trackWidth (0.0f)
 , trackHeight (0.0f)
 , hoverSize (0.0f)
+, layerValue (minValue)
+, layerHoverValue (0.0f)
+, isLayerHovering (false)
 {
 	if (maxValue < minValue) {
 		maxValue = minValue;
@@ -175,11 +178,20 @@ void Slider::doUpdate (int msElapsed) {
 	thumbColor.update (msElapsed);
 	trackColor.update (msElapsed);
 	hoverColor.update (msElapsed);
+	if ((! thumbColor.equals (layerThumbColor)) || (! trackColor.equals (layerTrackColor)) || (! hoverColor.equals (layerHoverColor)) || (! FLOAT_EQUALS (value, layerValue)) || (! FLOAT_EQUALS (hoverValue, layerHoverValue)) || (isHovering != isLayerHovering)) {
+		layerThumbColor.assign (thumbColor);
+		layerTrackColor.assign (trackColor);
+		layerHoverColor.assign (hoverColor);
+		layerValue = value;
+		layerHoverValue = hoverValue;
+		isLayerHovering = isHovering;
+		invalidateLayer ();
+	}
 }
 
 void Slider::doDraw (double originX, double originY) {
 	SDL_Renderer *render;
-	SDL_Rect rect;
+	SDL_Rect rect, srcrect;
 	SDL_Texture *texture;
 	int x0, y0, texturew, textureh;
 	double w, h;
@@ -230,7 +242,7 @@ void Slider::doDraw (double originX, double originY) {
 
 	rect.x = x0;
 	rect.y = y0;
-	texture = RenderResource::instance->sliderThumbSprite->getScaleTexture (thumbSize, &texturew, &textureh);
+	texture = RenderResource::instance->sliderThumbSprite->getScaleTexture (thumbSize, &texturew, &textureh, NULL, &srcrect);
 	if (texture) {
 		w = trackWidth - texturew;
 		if (isVerticalTrack) {
@@ -249,7 +261,7 @@ void Slider::doDraw (double originX, double originY) {
 		}
 		SDL_SetTextureColorMod (texture, thumbColor.rByte, thumbColor.gByte, thumbColor.bByte);
 		SDL_SetTextureBlendMode (texture, SDL_BLENDMODE_BLEND);
-		SDL_RenderCopy (render, texture, NULL, &rect);
+		SDL_RenderCopy (render, texture, &srcrect, &rect);
 	}
 	else {
 		w = trackWidth - thumbWidth;
@@ -104,5 +104,11 @@ private:
 	double hoverSize;
 	Color hoverColor;
 	std::list<double> snapValueList;
+	Color layerThumbColor;
+	Color layerTrackColor;
+	Color layerHoverColor;
+	double layerValue;
+	double layerHoverValue;
+	bool isLayerHovering;
 };
 #endif
@@ -37,6 +37,7 @@
 #include "Log.h"
 #include "SharedBuffer.h"
 #include "HashMap.h"
+#include "Profiler.h"
 #include "SoundMixer.h"
 
 SoundMixer *SoundMixer::instance = NULL;
@@ -286,6 +287,9 @@ void SoundMixer::executeRunPlayers () {
 	std::map<int64_t, SoundMixer::PlayerQueue>::iterator qpos;
 	int64_t tnext, t;
 
+	if (Profiler::isEnabled.load (std::memory_order_relaxed)) {
+		Profiler::instance->setThreadName ("SoundMixer::runPlayers");
+	}
 	SDL_PauseAudioDevice (audioDeviceId, 0);
 	SDL_LockMutex (playerMutex);
 	while (true) {
@@ -484,6 +488,7 @@ void SoundMixer::audioCallback (void *userdata, Uint8 *stream, int len) {
 	SharedBuffer *buffer;
 	std::list<int64_t> endedids;
 	std::list<int64_t>::const_iterator j1, j2;
+	ProfilerZone zone ("SoundMixer::audioCallback");
 
 	memset (stream, 0, len);
 	i1 = it->queueMap.begin ();
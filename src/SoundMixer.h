@@ -127,6 +127,8 @@ public:
 	void setOutputCallback (int64_t playerId, SoundMixer::OutputCallbackContext callback);
 
 private:
+	friend class BenchHook;
+
 	struct Player {
 		int64_t id;
 		SoundSample *sample;
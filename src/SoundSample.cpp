@@ -86,11 +86,9 @@ SoundSample::SoundSample (const char *soundId, int outputSampleRate, SDL_AudioFo
 , reformatFn (NULL)
 , frameCallback (NULL)
 , frameCallbackData (NULL)
-, refcount (0)
 {
 	SdlUtil::createMutex (&framesMutex);
 	SdlUtil::createCond (&framesCond);
-	SdlUtil::createMutex (&refcountMutex);
 	outputFormat = getSampleFormat (outputSdlAudioFormat);
 }
 SoundSample::~SoundSample () {
@@ -98,7 +96,6 @@ SoundSample::~SoundSample () {
 	clearFrames ();
 	SdlUtil::destroyCond (&framesCond);
 	SdlUtil::destroyMutex (&framesMutex);
-	SdlUtil::destroyMutex (&refcountMutex);
 }
 
 void SoundSample::clearLoad () {
@@ -163,31 +160,6 @@ void SoundSample::clearFrames () {
 	SDL_UnlockMutex (framesMutex);
 }
 
-void SoundSample::retain () {
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
-}
-
-void SoundSample::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
-		delete (this);
-	}
-}
-
 StdString SoundSample::toString () const {
 	StdString s;
 
@@ -42,10 +42,11 @@ extern "C" {
 #include "libswresample/swresample.h"
 }
 #include "MediaUtil.h"
+#include "Refcounted.h"
 
 class SharedBuffer;
 
-class SoundSample {
+class SoundSample : public Refcounted {
 public:
 	SoundSample (const char *soundId, int outputSampleRate, SDL_AudioFormat outputSdlAudioFormat, int outputChannelCount);
 	~SoundSample ();
@@ -85,12 +86,6 @@ public:
 	int64_t livePlayerId;
 	int64_t lastFramePts;
 
-	// Increase the object's refcount
-	void retain ();
-
-	// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
-	void release ();
-
 	// Return a string description of the object
 	StdString toString () const;
 
@@ -165,7 +160,5 @@ private:
 	SDL_cond *framesCond;
 	SoundSample::FrameCallback frameCallback;
 	void *frameCallbackData;
-	SDL_mutex *refcountMutex;
-	int refcount;
 };
 #endif
@@ -35,6 +35,7 @@
 #include "App.h"
 #include "Resource.h"
 #include "RenderResource.h"
+#include "SpriteAtlas.h"
 #include "Sprite.h"
 
 Sprite::Sprite ()
@@ -67,7 +68,7 @@ Sprite *Sprite::copy () {
 			sprite = NULL;
 			break;
 		}
-		result = sprite->addTexture (texture, i1->loadPath);
+		result = sprite->addTexture (texture, i1->loadPath, i1->sourceRect);
 		if (result != OpResult::Success) {
 			Resource::instance->unloadTexture (i1->loadPath);
 			delete (sprite);
@@ -83,10 +84,25 @@ Sprite *Sprite::copy () {
 }
 
 OpResult Sprite::load (const StdString &path, const StdString &imagePrefix) {
+	SpriteAtlas atlas;
+	OpResult result;
+
+	result = addAtlasSurfaces (path, imagePrefix, &atlas);
+	if (result == OpResult::Success) {
+		result = atlas.build ();
+	}
+	if (result == OpResult::Success) {
+		result = loadAtlasFrames (&atlas);
+	}
+	atlasFrameIds.clear ();
+	return (result);
+}
+
+OpResult Sprite::addAtlasSurfaces (const StdString &path, const StdString &imagePrefix, SpriteAtlas *atlas) {
 	StdString loadpath;
-	SDL_Texture *texture;
+	SDL_Surface *surface;
 	OpResult result;
-	int i;
+	int i, id;
 	bool found;
 
 	result = OpResult::Success;
@@ -119,30 +135,76 @@ OpResult Sprite::load (const StdString &path, const StdString &imagePrefix) {
 			}
 			break;
 		}
-		texture = Resource::instance->loadTexture (loadpath);
+		surface = Resource::instance->loadSurface (loadpath);
+		if (! surface) {
+			result = OpResult::SdlOperationFailedError;
+			break;
+		}
+		id = atlas->addSurface (surface);
+		if (id < 0) {
+			result = OpResult::SdlOperationFailedError;
+			break;
+		}
+		atlasFrameIds.push_back (id);
+		++i;
+	}
+	return (result);
+}
+
+OpResult Sprite::loadAtlasFrames (SpriteAtlas *atlas) {
+	std::vector<int>::const_iterator i1, i2;
+	SDL_Texture *texture;
+	SDL_Rect rect;
+	StdString path;
+	OpResult result;
+
+	result = OpResult::Success;
+	i1 = atlasFrameIds.cbegin ();
+	i2 = atlasFrameIds.cend ();
+	while (i1 != i2) {
+		texture = atlas->getFrame (*i1, &rect, &path);
 		if (! texture) {
 			result = OpResult::SdlOperationFailedError;
 			break;
 		}
-		result = addTexture (texture, loadpath);
+		if (! Resource::instance->loadTexture (path, true)) {
+			result = OpResult::SdlOperationFailedError;
+			break;
+		}
+		result = addTexture (texture, path, rect);
 		if (result != OpResult::Success) {
-			Resource::instance->unloadTexture (loadpath);
+			Resource::instance->unloadTexture (path);
 			break;
 		}
-		++i;
+		++i1;
 	}
+	atlasFrameIds.clear ();
 	return (result);
 }
 
 OpResult Sprite::addTexture (SDL_Texture *texture, const StdString &loadPath) {
+	SDL_Rect rect;
+
+	rect.x = 0;
+	rect.y = 0;
+	if (SDL_QueryTexture (texture, NULL, NULL, &(rect.w), &(rect.h)) != 0) {
+		Log::err ("Failed to query sprite texture; path=\"%s\" err=\"%s\"", loadPath.c_str (), SDL_GetError ());
+		return (OpResult::SdlOperationFailedError);
+	}
+	return (addTexture (texture, loadPath, rect));
+}
+
+OpResult Sprite::addTexture (SDL_Texture *texture, const StdString &loadPath, const SDL_Rect &sourceRect) {
 	Sprite::TextureData item;
 
+	if ((! texture) || (sourceRect.w <= 0) || (sourceRect.h <= 0)) {
+		return (OpResult::InvalidParamError);
+	}
 	item.texture = texture;
 	item.loadPath.assign (loadPath);
-	if (SDL_QueryTexture (item.texture, NULL, NULL, &(item.width), &(item.height)) != 0) {
-		Log::err ("Failed to query sprite texture; path=\"%s\" err=\"%s\"", item.loadPath.c_str (), SDL_GetError ());
-		return (OpResult::SdlOperationFailedError);
-	}
+	item.sourceRect = sourceRect;
+	item.width = sourceRect.w;
+	item.height = sourceRect.h;
 	textureList.push_back (item);
 	frameCount = (int) textureList.size ();
 	if (item.width > maxWidth) {
@@ -175,7 +237,7 @@ void Sprite::unload () {
 	renderScaleIncrement = 0.0f;
 }
 
-SDL_Texture *Sprite::getTexture (int index, int *width, int *height, StdString *loadPath) const {
+SDL_Texture *Sprite::getTexture (int index, int *width, int *height, StdString *loadPath, SDL_Rect *sourceRect) const {
 	Sprite::TextureData item;
 
 	if ((index < 0) || (index >= (int) textureList.size ())) {
@@ -191,6 +253,9 @@ SDL_Texture *Sprite::getTexture (int index, int *width, int *height, StdString *
 	if (loadPath) {
 		loadPath->assign (item.loadPath);
 	}
+	if (sourceRect) {
+		*sourceRect = item.sourceRect;
+	}
 	return (item.texture);
 }
 
@@ -205,13 +270,11 @@ StdString Sprite::getLoadPath (int index) const {
 }
 
 OpResult Sprite::load (double minScale, double maxScale, double scaleIncrement) {
+	SpriteAtlas atlas;
 	OpResult result;
-	Uint32 *pixels;
 	SDL_Surface *surface;
-	SDL_Texture *texture;
-	StdString path;
 	double scale, lastscale, framew, frameh;
-	int surfacew, surfaceh;
+	int surfacew, surfaceh, id;
 
 	if ((minScale <= 0.0f) || (minScale >= maxScale) || (scaleIncrement <= 0.0f)) {
 		return (OpResult::InvalidParamError);
@@ -236,32 +299,29 @@ OpResult Sprite::load (double minScale, double maxScale, double scaleIncrement)
 		}
 		surfacew = (int) ceil (framew);
 		surfaceh = (int) ceil (frameh);
-		pixels = (Uint32 *) malloc (surfacew * surfaceh * sizeof (Uint32));
-		if (! pixels) {
-			Log::err ("Failed to create texture; err=\"Out of memory, dimensions %ix%i\"", surfacew, surfaceh);
-			result = OpResult::OutOfMemoryError;
-			break;
-		}
-		writeRenderPixels (scale, pixels, framew, frameh);
-		surface = SDL_CreateRGBSurfaceFrom (pixels, surfacew, surfaceh, 32, surfacew * sizeof (Uint32), RenderResource::instance->pixelRMask, RenderResource::instance->pixelGMask, RenderResource::instance->pixelBMask, RenderResource::instance->pixelAMask);
+		surface = SDL_CreateRGBSurface (0, surfacew, surfaceh, 32, RenderResource::instance->pixelRMask, RenderResource::instance->pixelGMask, RenderResource::instance->pixelBMask, RenderResource::instance->pixelAMask);
 		if (! surface) {
-			free (pixels);
-			Log::err ("Failed to create texture; err=\"SDL_CreateRGBSurfaceFrom, %s\"", SDL_GetError ());
+			Log::err ("Failed to create texture; err=\"SDL_CreateRGBSurface, %s\"", SDL_GetError ());
 			result = OpResult::SdlOperationFailedError;
 			break;
 		}
-		path.sprintf ("*_Sprite::load_%llx", (long long int) App::instance->getUniqueId ());
-		texture = Resource::instance->createTexture (path, surface);
-		SDL_FreeSurface (surface);
-		free (pixels);
-		if (! texture) {
+		writeRenderPixels (scale, (Uint32 *) surface->pixels, framew, frameh);
+		id = atlas.addSurface (surface);
+		if (id < 0) {
 			result = OpResult::SdlOperationFailedError;
 			break;
 		}
-		addTexture (texture, path);
+		atlasFrameIds.push_back (id);
 		lastscale = scale;
 		scale += scaleIncrement;
 	}
+	if (result == OpResult::Success) {
+		result = atlas.build ();
+	}
+	if (result == OpResult::Success) {
+		result = loadAtlasFrames (&atlas);
+	}
+	atlasFrameIds.clear ();
 
 	if (result == OpResult::Success) {
 		minRenderScale = minScale;
@@ -271,7 +331,7 @@ OpResult Sprite::load (double minScale, double maxScale, double scaleIncrement)
 	return (result);
 }
 
-SDL_Texture *Sprite::getScaleTexture (double scale, int *width, int *height, int *frameIndex) const {
+SDL_Texture *Sprite::getScaleTexture (double scale, int *width, int *height, int *frameIndex, SDL_Rect *sourceRect) const {
 	SDL_Texture *texture;
 	int frame;
 
@@ -285,7 +345,7 @@ SDL_Texture *Sprite::getScaleTexture (double scale, int *width, int *height, int
 	if (frame > (((int) textureList.size ()) - 1)) {
 		frame = ((int) textureList.size ()) - 1;
 	}
-	texture = getTexture (frame, width, height);
+	texture = getTexture (frame, width, height, NULL, sourceRect);
 	if (texture) {
 		if (frameIndex) {
 			*frameIndex = frame;
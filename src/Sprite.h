@@ -34,6 +34,8 @@
 #ifndef SPRITE_H
 #define SPRITE_H
 
+class SpriteAtlas;
+
 class Sprite {
 public:
 	Sprite ();
@@ -53,20 +55,29 @@ public:
 	// Load sprite data from numbered png files at the specified path and return a Result value. If imagePrefix is not provided, use the App imagePrefix value.
 	OpResult load (const StdString &path, const StdString &imagePrefix = StdString ());
 
-	// Load sprite data as a series of scaled images generated by pixel render functions and return a Result value
+	// Load sprite data as a series of scaled images generated by pixel render functions and return a Result value. Generated images are packed into shared atlas textures.
 	OpResult load (double minScale, double maxScale, double scaleIncrement);
 
+	// Add surfaces from numbered png files at the specified path to atlas, to be assigned as sprite frames by a later call to loadAtlasFrames. Returns a Result value.
+	OpResult addAtlasSurfaces (const StdString &path, const StdString &imagePrefix, SpriteAtlas *atlas);
+
+	// Assign frames for all surfaces previously passed to addAtlasSurfaces, after atlas has been built, and return a Result value
+	OpResult loadAtlasFrames (SpriteAtlas *atlas);
+
 	// Add the provided texture to the sprite's frame set. When the sprite is unloaded, release it from resources using the specified loadPath. Returns a Result value.
 	OpResult addTexture (SDL_Texture *texture, const StdString &loadPath);
 
+	// Add a frame to the sprite's frame set, drawn from the sourceRect region of the provided texture. When the sprite is unloaded, release it from resources using the specified loadPath. Returns a Result value.
+	OpResult addTexture (SDL_Texture *texture, const StdString &loadPath, const SDL_Rect &sourceRect);
+
 	// Unload previously loaded sprite data
 	void unload ();
 
-	// Return the SDL_Texture object at the specified index, or NULL if no such texture was found. If a texture is found, write texture attributes to any provided pointer values.
-	SDL_Texture *getTexture (int index, int *width = NULL, int *height = NULL, StdString *loadPath = NULL) const;
+	// Return the SDL_Texture object at the specified index, or NULL if no such texture was found. If a texture is found, write texture attributes to any provided pointer values. The returned texture may be a shared atlas page, and callers should draw from the region written to sourceRect.
+	SDL_Texture *getTexture (int index, int *width = NULL, int *height = NULL, StdString *loadPath = NULL, SDL_Rect *sourceRect = NULL) const;
 
-	// Return the SDL_Texture object at the specified render scale, or NULL if no such texture was found. If a texture is found and int pointers are provided, those values are filled in with texture attributes.
-	SDL_Texture *getScaleTexture (double scale, int *width = NULL, int *height = NULL, int *frameIndex = NULL) const;
+	// Return the SDL_Texture object at the specified render scale, or NULL if no such texture was found. If a texture is found and pointers are provided, those values are filled in with texture attributes.
+	SDL_Texture *getScaleTexture (double scale, int *width = NULL, int *height = NULL, int *frameIndex = NULL, SDL_Rect *sourceRect = NULL) const;
 
 	// Return the load path for the texture at the specified index, or an empty string if no such texture was found
 	StdString getLoadPath (int index) const;
@@ -82,12 +93,21 @@ protected:
 		SDL_Texture *texture;
 		StdString loadPath;
 		int width, height;
+		SDL_Rect sourceRect;
 		TextureData ():
 			texture (NULL),
 			loadPath (""),
 			width (0),
-			height (0) { }
+			height (0) {
+			sourceRect.x = 0;
+			sourceRect.y = 0;
+			sourceRect.w = 0;
+			sourceRect.h = 0;
+		}
 	};
 	std::vector<Sprite::TextureData> textureList;
+
+	// Atlas frame IDs added by addAtlasSurfaces and awaiting loadAtlasFrames
+	std::vector<int> atlasFrameIds;
 };
 #endif
@@ -0,0 +1,311 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+#include "Config.h"
+#include "App.h"
+#include "Log.h"
+#include "Resource.h"
+#include "RenderResource.h"
+#include "SpriteAtlas.h"
+
+SpriteAtlas::SpriteAtlas ()
+: pageSize (SpriteAtlas::defaultPageSize)
+, isBuilt (false)
+, frameCount (0)
+, pageCount (0)
+, framePixelCount (0)
+, pagePixelCount (0)
+{
+}
+SpriteAtlas::~SpriteAtlas () {
+	clear ();
+}
+
+int SpriteAtlas::addSurface (SDL_Surface *surface) {
+	SpriteAtlas::Frame frame;
+
+	if (! surface) {
+		return (-1);
+	}
+	if (isBuilt || (surface->w <= 0) || (surface->h <= 0)) {
+		SDL_FreeSurface (surface);
+		return (-1);
+	}
+	frame.surface = surface;
+	frame.rect.w = surface->w;
+	frame.rect.h = surface->h;
+	frameList.push_back (frame);
+	frameCount = (int) frameList.size ();
+	framePixelCount += (surface->w * surface->h);
+	return (frameCount - 1);
+}
+
+OpResult SpriteAtlas::build () {
+	SDL_RendererInfo renderinfo;
+	std::multimap<int, int> packorder;
+	std::multimap<int, int>::const_iterator i1, i2;
+	std::vector<SpriteAtlas::Frame>::iterator j1, j2;
+	OpResult result;
+	int i, maxpagesize;
+
+	if (isBuilt) {
+		return (OpResult::AlreadyLoadedError);
+	}
+	maxpagesize = pageSize;
+	if (SDL_GetRendererInfo (App::instance->render, &renderinfo) == 0) {
+		if ((renderinfo.max_texture_width > 0) && (renderinfo.max_texture_width < maxpagesize)) {
+			maxpagesize = renderinfo.max_texture_width;
+		}
+		if ((renderinfo.max_texture_height > 0) && (renderinfo.max_texture_height < maxpagesize)) {
+			maxpagesize = renderinfo.max_texture_height;
+		}
+	}
+
+	// Pack frames in order of decreasing height to keep shelves tight
+	for (i = 0; i < (int) frameList.size (); ++i) {
+		packorder.insert (std::pair<int, int> (-(frameList.at (i).rect.h), i));
+	}
+	i1 = packorder.cbegin ();
+	i2 = packorder.cend ();
+	while (i1 != i2) {
+		packFrame (&(frameList.at (i1->second)), maxpagesize);
+		++i1;
+	}
+
+	result = OpResult::Success;
+	for (i = 0; i < (int) pageList.size (); ++i) {
+		result = createPageTexture (i);
+		if (result != OpResult::Success) {
+			break;
+		}
+	}
+
+	j1 = frameList.begin ();
+	j2 = frameList.end ();
+	while (j1 != j2) {
+		if (j1->surface) {
+			SDL_FreeSurface (j1->surface);
+			j1->surface = NULL;
+		}
+		++j1;
+	}
+	isBuilt = true;
+	pageCount = (int) pageList.size ();
+	return (result);
+}
+
+void SpriteAtlas::packFrame (SpriteAtlas::Frame *frame, int maxPageSize) {
+	SpriteAtlas::Page page, *target;
+	std::vector<SpriteAtlas::Page>::iterator i1, i2;
+	int i, w, h;
+
+	w = frame->rect.w + (SpriteAtlas::framePadding * 2);
+	h = frame->rect.h + (SpriteAtlas::framePadding * 2);
+	if ((w > maxPageSize) || (h > maxPageSize)) {
+		// Frame exceeds the shared page size and receives an unpadded page of its own
+		page.width = frame->rect.w;
+		page.height = frame->rect.h;
+		page.shelfX = page.width;
+		page.shelfY = 0;
+		page.shelfHeight = page.height;
+		pageList.push_back (page);
+		frame->page = ((int) pageList.size ()) - 1;
+		frame->rect.x = 0;
+		frame->rect.y = 0;
+		return;
+	}
+
+	i = 0;
+	i1 = pageList.begin ();
+	i2 = pageList.end ();
+	while (i1 != i2) {
+		if ((i1->width == maxPageSize) && (i1->height == maxPageSize)) {
+			if (((i1->shelfX + w) <= i1->width) && ((i1->shelfY + h) <= i1->height)) {
+				break;
+			}
+			if ((i1->shelfY + i1->shelfHeight + h) <= i1->height) {
+				i1->shelfY += i1->shelfHeight;
+				i1->shelfX = 0;
+				i1->shelfHeight = 0;
+				break;
+			}
+		}
+		++i;
+		++i1;
+	}
+	if (i1 == i2) {
+		page.width = maxPageSize;
+		page.height = maxPageSize;
+		pageList.push_back (page);
+		i = ((int) pageList.size ()) - 1;
+	}
+
+	target = &(pageList.at (i));
+	frame->page = i;
+	frame->rect.x = target->shelfX + SpriteAtlas::framePadding;
+	frame->rect.y = target->shelfY + SpriteAtlas::framePadding;
+	target->shelfX += w;
+	if (h > target->shelfHeight) {
+		target->shelfHeight = h;
+	}
+}
+
+OpResult SpriteAtlas::createPageTexture (int pageIndex) {
+	SpriteAtlas::Page *page;
+	std::vector<SpriteAtlas::Frame>::const_iterator i1, i2;
+	SDL_Surface *surface, *src;
+	SDL_Rect srcrect, destrect;
+	int w, h, x, y, j;
+
+	page = &(pageList.at (pageIndex));
+
+	// Trim the page to the extent actually covered by its frames
+	w = 0;
+	h = page->shelfY + page->shelfHeight;
+	i1 = frameList.cbegin ();
+	i2 = frameList.cend ();
+	while (i1 != i2) {
+		if ((i1->page == pageIndex) && ((i1->rect.x + i1->rect.w + SpriteAtlas::framePadding) > w)) {
+			w = i1->rect.x + i1->rect.w + SpriteAtlas::framePadding;
+		}
+		++i1;
+	}
+	if (w > page->width) {
+		w = page->width;
+	}
+	if (h > page->height) {
+		h = page->height;
+	}
+	if ((w <= 0) || (h <= 0)) {
+		return (OpResult::InvalidParamError);
+	}
+	surface = SDL_CreateRGBSurface (0, w, h, 32, RenderResource::instance->pixelRMask, RenderResource::instance->pixelGMask, RenderResource::instance->pixelBMask, RenderResource::instance->pixelAMask);
+	if (! surface) {
+		Log::err ("Failed to create sprite atlas page; err=\"SDL_CreateRGBSurface, %s\"", SDL_GetError ());
+		return (OpResult::SdlOperationFailedError);
+	}
+	SDL_SetSurfaceBlendMode (surface, SDL_BLENDMODE_NONE);
+
+	i1 = frameList.cbegin ();
+	i2 = frameList.cend ();
+	while (i1 != i2) {
+		if ((i1->page == pageIndex) && i1->surface) {
+			src = i1->surface;
+			SDL_SetSurfaceBlendMode (src, SDL_BLENDMODE_NONE);
+
+			// Blit the frame at its offset from each of the nine padding positions, extruding edge pixels into the padding area so that filtered draws don't sample neighboring frames
+			for (j = 0; j < 9; ++j) {
+				x = (j % 3) - 1;
+				y = (j / 3) - 1;
+				srcrect.x = (x > 0) ? (i1->rect.w - 1) : 0;
+				srcrect.y = (y > 0) ? (i1->rect.h - 1) : 0;
+				srcrect.w = (x == 0) ? i1->rect.w : 1;
+				srcrect.h = (y == 0) ? i1->rect.h : 1;
+				destrect.x = i1->rect.x + ((x < 0) ? -SpriteAtlas::framePadding : ((x > 0) ? i1->rect.w : 0));
+				destrect.y = i1->rect.y + ((y < 0) ? -SpriteAtlas::framePadding : ((y > 0) ? i1->rect.h : 0));
+				destrect.w = srcrect.w;
+				destrect.h = srcrect.h;
+				SDL_BlitSurface (src, &srcrect, surface, &destrect);
+			}
+		}
+		++i1;
+	}
+
+	page->loadPath.sprintf ("*_SpriteAtlas_%llx", (long long int) App::instance->getUniqueId ());
+	page->texture = Resource::instance->createTexture (page->loadPath, surface);
+	SDL_FreeSurface (surface);
+	if (! page->texture) {
+		page->loadPath.assign ("");
+		return (OpResult::SdlOperationFailedError);
+	}
+	page->width = w;
+	page->height = h;
+	pagePixelCount += (w * h);
+	return (OpResult::Success);
+}
+
+SDL_Texture *SpriteAtlas::getFrame (int frameId, SDL_Rect *sourceRect, StdString *loadPath) const {
+	const SpriteAtlas::Frame *frame;
+	const SpriteAtlas::Page *page;
+
+	if ((! isBuilt) || (frameId < 0) || (frameId >= (int) frameList.size ())) {
+		return (NULL);
+	}
+	frame = &(frameList.at (frameId));
+	if ((frame->page < 0) || (frame->page >= (int) pageList.size ())) {
+		return (NULL);
+	}
+	page = &(pageList.at (frame->page));
+	if (! page->texture) {
+		return (NULL);
+	}
+	if (sourceRect) {
+		*sourceRect = frame->rect;
+	}
+	if (loadPath) {
+		loadPath->assign (page->loadPath);
+	}
+	return (page->texture);
+}
+
+void SpriteAtlas::clear () {
+	std::vector<SpriteAtlas::Frame>::iterator i1, i2;
+	std::vector<SpriteAtlas::Page>::iterator j1, j2;
+
+	i1 = frameList.begin ();
+	i2 = frameList.end ();
+	while (i1 != i2) {
+		if (i1->surface) {
+			SDL_FreeSurface (i1->surface);
+			i1->surface = NULL;
+		}
+		++i1;
+	}
+	frameList.clear ();
+
+	j1 = pageList.begin ();
+	j2 = pageList.end ();
+	while (j1 != j2) {
+		if (j1->texture) {
+			j1->texture = NULL;
+			Resource::instance->unloadTexture (j1->loadPath);
+		}
+		++j1;
+	}
+	pageList.clear ();
+
+	isBuilt = false;
+	frameCount = 0;
+	pageCount = 0;
+	framePixelCount = 0;
+	pagePixelCount = 0;
+}
@@ -0,0 +1,105 @@
+/*
+* Membrane Software Reference Source License
+* Version 2024 Sep 18
+* This license is a legal agreement between you and Membrane Software
+*
+* This license agreement governs use of the accompanying source code. If you use the source code, you accept this license. If you do not accept the license, do not use the source code.
+*
+* DEFINITIONS
+* "compilation" means to compile the code from source code to machine code.
+* “non-commercial distribution” means distribution of the code or any compilation of the code, or of any other application or program containing the code or any compilation of the code, where such distribution is not intended for or directed towards commercial advantage or monetary compensation.
+* "review" means to access, analyse, test and otherwise review the code as a reference
+* "you" means the licensee of rights set out in this license.
+*
+* GRANT OF RIGHTS
+* Subject to the terms of this license, we grant you a non-transferable, non-exclusive, worldwide, royalty-free license to access and use the source code solely for the purposes of review, compilation and non-commercial distribution.
+*
+* LIMITATIONS
+* This license does not grant you any rights to use Membrane Software's name, logo, or trademarks.
+*
+* If you issue proceedings in any jurisdiction against Membrane Software because you consider Membrane Software has infringed copyright or any patent right in respect of the code (including any joinder or counterclaim), your license to the code is automatically terminated.
+*
+* This source code is provided by the copyright holders and contributors "as is" and any express or implied warranties, including, but not limited to, the implied warranties of merchantability and fitness for a particular purpose are disclaimed. In no event shall the copyright holder or contributors be liable for any direct, indirect, incidental, special, exemplary, or consequential damages (including, but not limited to, procurement of substitute goods or services; loss of use, data, or profits; or business interruption) however caused and on any theory of liability, whether in contract, strict liability, or tort (including negligence or otherwise) arising in any way out of the use of this source code, even if advised of the possibility of such damage.
+*
+* NO IMPLIED RIGHTS
+* All rights not expressly granted by Membrane Software to you in this License Agreement are hereby reserved by Membrane Software and its suppliers. There are no implied rights in this License Agreement.
+*
+* GOVERNING LAW
+* This EULA agreement, and any dispute arising out of or in connection with this EULA agreement, shall be governed by and construed in accordance with the laws of Washington State, United States of America.
+*
+* QUESTIONS OR ADDITIONAL INFORMATION
+* If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
+*/
+// Class that packs sprite frame surfaces into a small set of large textures
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+class SpriteAtlas {
+public:
+	SpriteAtlas ();
+	~SpriteAtlas ();
+
+	static constexpr const int defaultPageSize = 2048;
+	static constexpr const int framePadding = 1;
+
+	// Read-write data members
+	int pageSize;
+
+	// Read-only data members
+	bool isBuilt;
+	int frameCount;
+	int pageCount;
+	int64_t framePixelCount;
+	int64_t pagePixelCount;
+
+	// Add a frame surface to the atlas and return its frame ID, or -1 if the surface could not be added. The atlas takes ownership of the surface and frees it on build or clear.
+	int addSurface (SDL_Surface *surface);
+
+	// Pack all added surfaces into page textures and return a Result value. This method must be invoked only from the application's main thread.
+	OpResult build ();
+
+	// Return the page texture holding the specified frame, or NULL if no such frame was found. If a texture is found, write frame attributes to any provided pointer values.
+	SDL_Texture *getFrame (int frameId, SDL_Rect *sourceRect = NULL, StdString *loadPath = NULL) const;
+
+	// Release all surfaces and the atlas's own references to page textures. Page textures remain loaded while any frame references acquired from Resource are held.
+	void clear ();
+
+private:
+	struct Frame {
+		SDL_Surface *surface;
+		int page;
+		SDL_Rect rect;
+		Frame ():
+			surface (NULL),
+			page (-1) {
+			rect.x = 0;
+			rect.y = 0;
+			rect.w = 0;
+			rect.h = 0;
+		}
+	};
+	struct Page {
+		SDL_Texture *texture;
+		StdString loadPath;
+		int width, height;
+		int shelfX, shelfY, shelfHeight;
+		Page ():
+			texture (NULL),
+			loadPath (""),
+			width (0),
+			height (0),
+			shelfX (0),
+			shelfY (0),
+			shelfHeight (0) { }
+	};
+
+	// Assign a page position to the specified frame using shelf packing
+	void packFrame (Frame *frame, int maxPageSize);
+
+	// Create the texture for the specified page from its assigned frames and return a Result value
+	OpResult createPageTexture (int pageIndex);
+
+	std::vector<SpriteAtlas::Frame> frameList;
+	std::vector<SpriteAtlas::Page> pageList;
+};
+#endif
@@ -36,6 +36,7 @@
 #include "StringList.h"
 #include "Resource.h"
 #include "SpriteId.h"
+#include "SpriteAtlas.h"
 #include "SpriteGroup.h"
 
 SpriteGroup *SpriteGroup::instance = NULL;
@@ -76,10 +77,12 @@ void SpriteGroup::clearSprites () {
 }
 
 OpResult SpriteGroup::load (const StdString &spriteIdPrefix, const StdString &imagePrefix) {
+	SpriteAtlas atlas;
 	Sprite *sprite;
 	StdString prefix;
 	StringList ids;
 	StringList::const_iterator i1, i2;
+	std::list<Sprite *> loadlist;
 	OpResult result;
 
 	if (isLoaded) {
@@ -102,14 +105,18 @@ OpResult SpriteGroup::load (const StdString &spriteIdPrefix, const StdString &im
 	i2 = ids.cend ();
 	while (i1 != i2) {
 		sprite = new Sprite ();
-		result = sprite->load (*i1, prefix);
+		result = sprite->addAtlasSurfaces (*i1, prefix, &atlas);
 		if (result != OpResult::Success) {
 			delete (sprite);
 			break;
 		}
 		spriteMap.insert (std::pair<StdString, Sprite *> (*i1, sprite));
+		loadlist.push_back (sprite);
 		++i1;
 	}
+	if (result == OpResult::Success) {
+		result = loadAtlasFrames (&atlas, loadlist);
+	}
 
 	if (result == OpResult::Success) {
 		loadSpriteIdPrefix.assign (spriteIdPrefix);
@@ -130,7 +137,9 @@ void SpriteGroup::unload () {
 }
 
 void SpriteGroup::resize (const StdString &imagePrefix) {
+	SpriteAtlas atlas;
 	std::map<StdString, Sprite *>::const_iterator i1, i2;
+	std::list<Sprite *> loadlist;
 	StdString prefix;
 	Sprite *sprite;
 	int result;
@@ -145,13 +154,41 @@ void SpriteGroup::resize (const StdString &imagePrefix) {
 		sprite = i1->second;
 		if (Resource::instance->fileExists (StdString::createSprintf ("%s/%s/000.png", i1->first.c_str (), prefix.c_str ()))) {
 			sprite->unload ();
-			result = sprite->load (i1->first, prefix);
+			result = sprite->addAtlasSurfaces (i1->first, prefix, &atlas);
 			if (result != OpResult::Success) {
 				Log::err ("Failed to reload textures; path=\"%s\" err=%i", i1->first.c_str (), result);
 			}
+			loadlist.push_back (sprite);
 		}
 		++i1;
 	}
+	if (! loadlist.empty ()) {
+		result = loadAtlasFrames (&atlas, loadlist);
+		if (result != OpResult::Success) {
+			Log::err ("Failed to reload sprite atlas; err=%i", result);
+		}
+	}
+}
+
+OpResult SpriteGroup::loadAtlasFrames (SpriteAtlas *atlas, const std::list<Sprite *> &loadList) {
+	std::list<Sprite *>::const_iterator i1, i2;
+	OpResult result;
+
+	result = atlas->build ();
+	if (result != OpResult::Success) {
+		return (result);
+	}
+	i1 = loadList.cbegin ();
+	i2 = loadList.cend ();
+	while (i1 != i2) {
+		result = (*i1)->loadAtlasFrames (atlas);
+		if (result != OpResult::Success) {
+			break;
+		}
+		++i1;
+	}
+	Log::debug ("Sprite atlas loaded; frameCount=%i pageCount=%i framePixels=%lli pagePixels=%lli", atlas->frameCount, atlas->pageCount, (long long int) atlas->framePixelCount, (long long int) atlas->pagePixelCount);
+	return (result);
 }
 
 Sprite *SpriteGroup::getSprite (const char *spriteId) {
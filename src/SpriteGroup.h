@@ -36,6 +36,8 @@
 
 #include "Sprite.h"
 
+class SpriteAtlas;
+
 class SpriteGroup {
 public:
 	SpriteGroup ();
@@ -68,6 +70,9 @@ private:
 	// Remove all items from the sprite map
 	void clearSprites ();
 
+	// Build atlas and assign its frames to each sprite in loadList, and return a Result value
+	OpResult loadAtlasFrames (SpriteAtlas *atlas, const std::list<Sprite *> &loadList);
+
 	std::map<StdString, Sprite *> spriteMap;
 };
 #endif
@@ -33,6 +33,7 @@
 #include "Config.h"
 #include "Buffer.h"
 #include "OsUtil.h"
+#include "SdlUtil.h"
 #include "SubtitleReader.h"
 
 // stage values
@@ -51,12 +52,15 @@ constexpr const int TextLine = 11;
 
 SubtitleReader::SubtitleReader ()
 : endTime (0)
+, findCursor (-1)
 , stage (IndexLine)
 , parseStartTime (-1)
 , parseEndTime (-1)
 {
+	SdlUtil::createMutex (&entryMutex);
 }
 SubtitleReader::~SubtitleReader () {
+	SdlUtil::destroyMutex (&entryMutex);
 }
 
 void SubtitleReader::setFilePath (const StdString &filePathValue) {
@@ -64,8 +68,75 @@ void SubtitleReader::setFilePath (const StdString &filePathValue) {
 		return;
 	}
 	filePath.assign (filePathValue);
+	clear ();
+}
+
+void SubtitleReader::clear () {
+	SDL_LockMutex (entryMutex);
 	entryList.clear ();
+	maxEndTimes.clear ();
 	endTime = 0;
+	findCursor = -1;
+	SDL_UnlockMutex (entryMutex);
+}
+
+void SubtitleReader::addEntry (int64_t entryStartTime, int64_t entryEndTime, const StdString &entryText) {
+	int64_t maxend;
+	int pos, lo, hi, mid, count, i;
+
+	SDL_LockMutex (entryMutex);
+	count = (int) entryList.size ();
+	if ((count <= 0) || (entryStartTime >= entryList.at (count - 1).startTime)) {
+		pos = count;
+	}
+	else {
+		lo = 0;
+		hi = count;
+		while (lo < hi) {
+			mid = (lo + hi) / 2;
+			if (entryList.at (mid).startTime <= entryStartTime) {
+				lo = mid + 1;
+			}
+			else {
+				hi = mid;
+			}
+		}
+		pos = lo;
+	}
+
+	// Stream packets are decoded again after a backward seek, so skip entries that were already added
+	i = pos - 1;
+	while ((i >= 0) && (entryList.at (i).startTime == entryStartTime)) {
+		if (entryList.at (i).text.equals (entryText)) {
+			SDL_UnlockMutex (entryMutex);
+			return;
+		}
+		--i;
+	}
+
+	if (pos >= count) {
+		entryList.push_back (SubtitleReader::Entry (entryStartTime, entryEndTime, entryText));
+		maxEndTimes.push_back (entryEndTime);
+	}
+	else {
+		entryList.insert (entryList.begin () + pos, SubtitleReader::Entry (entryStartTime, entryEndTime, entryText));
+		maxEndTimes.insert (maxEndTimes.begin () + pos, entryEndTime);
+		findCursor = -1;
+	}
+
+	count = (int) entryList.size ();
+	maxend = (pos > 0) ? maxEndTimes.at (pos - 1) : -1;
+	while (pos < count) {
+		if (entryList.at (pos).endTime > maxend) {
+			maxend = entryList.at (pos).endTime;
+		}
+		maxEndTimes.at (pos) = maxend;
+		++pos;
+	}
+	if (entryEndTime > endTime) {
+		endTime = entryEndTime;
+	}
+	SDL_UnlockMutex (entryMutex);
 }
 
 OpResult SubtitleReader::readSubtitles () {
@@ -77,8 +148,7 @@ OpResult SubtitleReader::readSubtitles () {
 	if (OsUtil::getFileType (filePath) != OsUtil::RegularFile) {
 		return (OpResult::FileOpenFailedError);
 	}
-	entryList.clear ();
-	endTime = 0;
+	clear ();
 	stage = IndexLine;
 	parseStartTime = -1;
 	parseEndTime = -1;
@@ -87,10 +157,7 @@ OpResult SubtitleReader::readSubtitles () {
 	if (result == OpResult::Success) {
 		if (stage == TextLine) {
 			if ((parseStartTime >= 0) && (parseEndTime >= 0) && (! parseText.empty ())) {
-				entryList.push_back (SubtitleReader::Entry (parseStartTime, parseEndTime, parseText));
-				if (parseEndTime > endTime) {
-					endTime = parseEndTime;
-				}
+				addEntry (parseStartTime, parseEndTime, parseText);
 			}
 		}
 	}
@@ -350,10 +417,7 @@ OpResult SubtitleReader::executeParseLine (const StdString &line) {
 		}
 		else {
 			if (! parseText.empty ()) {
-				entryList.push_back (SubtitleReader::Entry (parseStartTime, parseEndTime, parseText));
-				if (parseEndTime > endTime) {
-					endTime = parseEndTime;
-				}
+				addEntry (parseStartTime, parseEndTime, parseText);
 			}
 			parseStartTime = -1;
 			parseEndTime = -1;
@@ -365,21 +429,72 @@ OpResult SubtitleReader::executeParseLine (const StdString &line) {
 }
 
 int SubtitleReader::findEntry (int64_t seekTime) {
-	std::vector<SubtitleReader::Entry>::const_iterator i1, i2;
-	int count;
+	int result;
+
+	SDL_LockMutex (entryMutex);
+	result = executeFindEntry (seekTime);
+	SDL_UnlockMutex (entryMutex);
+	return (result);
+}
+
+StdString SubtitleReader::getEntryText (int64_t seekTime) {
+	StdString text;
+	int n;
+
+	SDL_LockMutex (entryMutex);
+	n = executeFindEntry (seekTime);
+	if (n >= 0) {
+		text.assign (entryList.at (n).text);
+	}
+	SDL_UnlockMutex (entryMutex);
+	return (text);
+}
+
+int SubtitleReader::executeFindEntry (int64_t seekTime) {
+	int count, advance, lo, hi, mid, i;
 
 	if (entryList.empty () || (seekTime < 0) || (seekTime > endTime)) {
 		return (-1);
 	}
-	count = 0;
-	i1 = entryList.cbegin ();
-	i2 = entryList.cend ();
-	while (i1 != i2) {
-		if ((seekTime >= i1->startTime) && (seekTime <= i1->endTime)) {
-			return (count);
+	count = (int) entryList.size ();
+
+	// Advance the cursor to the last entry starting at or before seekTime, falling back to a binary search for backward or distant seeks
+	advance = -1;
+	if ((findCursor >= 0) && (findCursor < count) && (seekTime >= entryList.at (findCursor).startTime)) {
+		advance = 0;
+		while ((findCursor < (count - 1)) && (entryList.at (findCursor + 1).startTime <= seekTime)) {
+			++findCursor;
+			++advance;
+			if (advance > SubtitleReader::maxCursorAdvanceCount) {
+				advance = -1;
+				break;
+			}
 		}
-		++count;
-		++i1;
+	}
+	if (advance < 0) {
+		lo = 0;
+		hi = count;
+		while (lo < hi) {
+			mid = (lo + hi) / 2;
+			if (entryList.at (mid).startTime <= seekTime) {
+				lo = mid + 1;
+			}
+			else {
+				hi = mid;
+			}
+		}
+		findCursor = lo - 1;
+	}
+	if (findCursor < 0) {
+		return (-1);
+	}
+
+	i = findCursor;
+	while ((i >= 0) && (maxEndTimes.at (i) >= seekTime)) {
+		if (entryList.at (i).endTime >= seekTime) {
+			return (i);
+		}
+		--i;
 	}
 	return (-1);
 }
@@ -396,3 +511,52 @@ int64_t SubtitleReader::getEntryTime (int h, int m, int s, int ms) {
 	t += ms;
 	return (t);
 }
+
+StdString SubtitleReader::getAssDialogueText (const char *assLine) {
+	StdString line, text, result;
+	std::list<StdString> lines;
+	std::list<StdString>::iterator i1, i2;
+	size_t pos;
+	int fieldcount;
+
+	if (! assLine) {
+		return (StdString ());
+	}
+	line.assign (assLine);
+
+	// Decoders produce "ReadOrder,Layer,Style,Name,MarginL,MarginR,MarginV,Effect,Text"; older versions produce a full "Dialogue:" event line with nine fields before Text
+	fieldcount = 8;
+	if (line.startsWith ("Dialogue:")) {
+		fieldcount = 9;
+	}
+	pos = 0;
+	while (fieldcount > 0) {
+		pos = line.find (',', pos);
+		if (pos == StdString::npos) {
+			return (StdString ());
+		}
+		++pos;
+		--fieldcount;
+	}
+	text.assign (line.substr (pos));
+	text.markupStrip ("{", "}");
+	text.replace (StdString ("\\N"), StdString ("\n"));
+	text.replace (StdString ("\\n"), StdString ("\n"));
+	text.replace (StdString ("\\h"), StdString (" "));
+	text.replace (StdString ("\r"), StdString (""));
+
+	text.split ("\n", &lines);
+	i1 = lines.begin ();
+	i2 = lines.end ();
+	while (i1 != i2) {
+		line = i1->trimmed ();
+		if (! line.empty ()) {
+			if (! result.empty ()) {
+				result.append ("\n");
+			}
+			result.append (line);
+		}
+		++i1;
+	}
+	return (result);
+}
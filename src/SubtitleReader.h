@@ -30,7 +30,7 @@
 * QUESTIONS OR ADDITIONAL INFORMATION
 * If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
 */
-// Class that reads subtitle entries from srt files
+// Class that reads subtitle entries from srt files or decoded subtitle streams
 #ifndef SUBTITLE_READER_H
 #define SUBTITLE_READER_H
 
@@ -40,6 +40,7 @@ public:
 	~SubtitleReader ();
 
 	static constexpr const char *srtExtension = "srt";
+	static constexpr const int maxCursorAdvanceCount = 8;
 
 	struct Entry {
 		int64_t startTime;
@@ -56,7 +57,7 @@ public:
 
 	// Read-only data members
 	StdString filePath;
-	std::vector<SubtitleReader::Entry> entryList;
+	std::vector<SubtitleReader::Entry> entryList; // Ordered by startTime
 	int64_t endTime;
 
 	// Set the path of the srt file to read
@@ -65,17 +66,36 @@ public:
 	// Read entries from the configured file path and return a result value
 	OpResult readSubtitles ();
 
-	// Return the entryList index number matching seekTime, or -1 if no matching entry was found
+	// Remove all entries
+	void clear ();
+
+	// Add an entry to entryList, keeping the list ordered by startTime, unless an entry with the same start time and text is already present. This method may be invoked from a thread other than the one performing lookups.
+	void addEntry (int64_t entryStartTime, int64_t entryEndTime, const StdString &entryText);
+
+	// Return the entryList index number matching seekTime, or -1 if no matching entry was found. If more than one entry matches, return the one with the latest start time. Lookups with non-decreasing seekTime values advance a cached cursor and complete in constant amortized time.
 	int findEntry (int64_t seekTime);
 
+	// Return the text of the entry matching seekTime, or an empty string if no matching entry was found
+	StdString getEntryText (int64_t seekTime);
+
 	// Return the timestamp value computed from parsed fields, or -1 if the fields are not valid
 	static int64_t getEntryTime (int h, int m, int s, int ms);
 
+	// Return display text from an ASS dialogue event line, as produced by text subtitle decoders, with style fields and override tags removed
+	static StdString getAssDialogueText (const char *assLine);
+
 private:
 	// Callback functions
 	static OpResult parseLine (void *itPtr, const StdString &line);
 	OpResult executeParseLine (const StdString &line);
 
+	// Execute findEntry operations. Must be invoked while holding entryMutex.
+	int executeFindEntry (int64_t seekTime);
+
+	// For each entryList index, the largest endTime value among entries at or before that index
+	std::vector<int64_t> maxEndTimes;
+	int findCursor;
+	SDL_mutex *entryMutex;
 	int stage;
 	int64_t parseStartTime;
 	int64_t parseEndTime;
@@ -32,6 +32,7 @@
 */
 #include "Config.h"
 #include "SdlUtil.h"
+#include "Profiler.h"
 #include "TaskGroup.h"
 
 TaskGroup *TaskGroup::instance = NULL;
@@ -40,6 +41,7 @@ TaskGroup::TaskGroup ()
 : maxThreadCount (0)
 , isStopped (false)
 , runCount (0)
+, maxRunCount (0)
 , threadCount (0)
 , nextThreadIndex (1)
 {
@@ -73,6 +75,9 @@ bool TaskGroup::run (TaskGroup::RunContext fn, TaskGroup::EndCallbackContext end
 	SDL_LockMutex (contextListMutex);
 	contextList.push_back (ctx);
 	runCount = (int) contextList.size ();
+	if (runCount > maxRunCount) {
+		maxRunCount = runCount;
+	}
 	SDL_UnlockMutex (contextListMutex);
 	return (true);
 }
@@ -81,7 +86,13 @@ int TaskGroup::executeTask (void *taskContextPtr) {
 	TaskGroup::TaskContext *ctx;
 
 	ctx = (TaskGroup::TaskContext *) taskContextPtr;
-	ctx->fn.fn (ctx->fn.fnData);
+	if (Profiler::isEnabled.load (std::memory_order_relaxed)) {
+		Profiler::instance->setThreadName ("TaskGroup::executeTask");
+	}
+	{
+		ProfilerZone zone ("TaskGroup::executeTask");
+		ctx->fn.fn (ctx->fn.fnData);
+	}
 	ctx->isRunning = false;
 	return (0);
 }
@@ -91,6 +102,7 @@ void TaskGroup::update (int msElapsed) {
 	std::list<TaskGroup::TaskContext> endlist;
 	int result;
 	bool found, shouldrun;
+	ProfilerZone zone ("TaskGroup::update");
 
 	SDL_LockMutex (contextListMutex);
 	i1 = contextList.begin ();
@@ -189,3 +201,9 @@ void TaskGroup::waitThreads () {
 	runCount = 0;
 	SDL_UnlockMutex (contextListMutex);
 }
+
+void TaskGroup::resetMaxRunCount () {
+	SDL_LockMutex (contextListMutex);
+	maxRunCount = runCount;
+	SDL_UnlockMutex (contextListMutex);
+}
@@ -54,6 +54,7 @@ public:
 	// Read-only data members
 	bool isStopped;
 	int runCount;
+	int maxRunCount;
 	int threadCount;
 	int nextThreadIndex;
 
@@ -104,6 +105,9 @@ public:
 	// Join any running task threads, blocking until the operation completes
 	void waitThreads ();
 
+	// Set maxRunCount to the current runCount, restarting measurement of its highest value
+	void resetMaxRunCount ();
+
 private:
 	// Run a thread that executes a task
 	static int executeTask (void *taskContextPtr);
@@ -57,6 +57,7 @@ Toolbar::Toolbar (double toolbarWidth)
 	classId = ClassId::Toolbar;
 	setFillBg (true, UiConfiguration::instance->darkPrimaryColor);
 	setPaddingScale (1.0f, 0.5f);
+	setLayerCache (true);
 	reflow ();
 }
 Toolbar::~Toolbar () {
@@ -32,7 +32,6 @@
 */
 #include "Config.h"
 #include "App.h"
-#include "SdlUtil.h"
 #include "Log.h"
 #include "Input.h"
 #include "UiText.h"
@@ -50,6 +49,7 @@
 #include "Menu.h"
 #include "SpriteId.h"
 #include "UiStack.h"
+#include "Profiler.h"
 #include "Ui.h"
 
 Ui::Ui ()
@@ -65,10 +65,8 @@ Ui::Ui ()
 , toolPopupHandle (&toolPopup)
 , toolPopupSourceHandle (&toolPopupSource)
 , detailImageSize (-1)
-, refcount (0)
 , lastWindowCloseCount (0)
 {
-	SdlUtil::createMutex (&refcountMutex);
 
 	rootPanel = new Panel ();
 	rootPanel->keyEventCallback = Widget::KeyEventCallbackContext (Ui::keyEvent, this);
@@ -79,31 +77,6 @@ Ui::~Ui () {
 		rootPanel->release ();
 		rootPanel = NULL;
 	}
-	SdlUtil::destroyMutex (&refcountMutex);
-}
-
-void Ui::retain () {
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
-}
-void Ui::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
-		delete (this);
-	}
 }
 
 bool Ui::isUiClass (Ui *ui, int classIdValue) {
@@ -270,6 +243,7 @@ void Ui::doPause () {
 
 void Ui::update (int msElapsed) {
 	int count;
+	ProfilerZone zone ("Ui::update");
 
 	if (actionWidget) {
 		actionWidgetHandle.compact ();
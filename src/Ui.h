@@ -37,6 +37,7 @@
 #include "Widget.h"
 #include "WidgetHandle.h"
 #include "SpriteGroup.h"
+#include "Refcounted.h"
 
 class Panel;
 class Color;
@@ -47,7 +48,7 @@ class CardView;
 class IconLabelWindow;
 class HelpWindow;
 
-class Ui {
+class Ui : public Refcounted {
 public:
 	Ui ();
 	virtual ~Ui ();
@@ -70,12 +71,6 @@ public:
 	bool isLoaded;
 	bool isFirstResumeComplete;
 
-	// Increase the object's refcount
-	void retain ();
-
-	// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
-	void release ();
-
 	// Return a boolean value indicating if a Ui pointer matches the provided ClassId value
 	static bool isUiClass (Ui *ui, int classIdValue);
 
@@ -302,8 +297,6 @@ private:
 	static void executeLuaTargetTask (void *ctxPtr);
 	static void executeLuaUntargetTask (void *ctxPtr);
 
-	int refcount;
-	SDL_mutex *refcountMutex;
 	int lastWindowCloseCount;
 };
 #endif
@@ -60,6 +60,8 @@
 #include "LuaScript.h"
 #include "MediaUtil.h"
 #include "TextFieldWindow.h"
+#include "Profiler.h"
+#include "ProfilerWindow.h"
 #include "UiStack.h"
 
 UiStack *UiStack::instance = NULL;
@@ -70,6 +72,8 @@ constexpr const int PopUiCommand = 2;
 
 constexpr const double consoleWindowScale = 0.84f;
 constexpr const double sidebarWindowWidthScale = 0.33f;
+constexpr const double profilerGraphWidthScale = 0.25f;
+constexpr const double profilerGraphHeightScale = 0.08f;
 constexpr const int clearOverlayKeycode = SDLK_ESCAPE;
 
 UiStack::UiStack ()
@@ -94,6 +98,7 @@ UiStack::UiStack ()
 , logWindowHandle (&logWindow)
 , dialogWindowHandle (&dialogWindow)
 , consoleWindowHandle (&consoleWindow)
+, profilerWindowHandle (&profilerWindow)
 , snackbarWindowHandle (&snackbarWindow)
 , isUiInputSuspended (false)
 , mouseHoverClock (0)
@@ -188,6 +193,7 @@ void UiStack::clear () {
 	logWindowHandle.destroyAndClear ();
 	dialogWindowHandle.destroyAndClear ();
 	consoleWindowHandle.destroyAndClear ();
+	profilerWindowHandle.destroyAndClear ();
 	stopPlayers ();
 
 	if (mainToolbarWindow) {
@@ -354,7 +360,10 @@ void UiStack::drawForeground () {
 			rect.h = pointerTextureHeight;
 			SDL_SetTextureColorMod (pointerTexture, pointerColor.rByte, pointerColor.gByte, pointerColor.bByte);
 			SDL_SetTextureAlphaMod (pointerTexture, pointerColor.aByte);
-			SDL_RenderCopy (App::instance->render, pointerTexture, NULL, &rect);
+			SDL_SetTextureBlendMode (pointerTexture, SDL_BLENDMODE_BLEND);
+			SDL_RenderCopy (App::instance->render, pointerTexture, &pointerTextureRect, &rect);
+			SDL_SetTextureColorMod (pointerTexture, 255, 255, 255);
+			SDL_SetTextureAlphaMod (pointerTexture, 255);
 		}
 		SDL_UnlockMutex (pointerMutex);
 	}
@@ -364,6 +373,7 @@ void UiStack::update (int msElapsed) {
 	Ui *ui;
 	Widget *mousewidget;
 	bool fullscreen;
+	ProfilerZone zone ("UiStack::update");
 
 	SDL_LockMutex (uiMutex);
 	if (! uiList.empty ()) {
@@ -434,6 +444,7 @@ void UiStack::update (int msElapsed) {
 	logWindowHandle.compact ();
 	dialogWindowHandle.compact ();
 	consoleWindowHandle.compact ();
+	profilerWindowHandle.compact ();
 
 	fullscreen = playerControl.isFullscreenPlaying;
 	playerControl.update (msElapsed);
@@ -512,6 +523,7 @@ void UiStack::resetToolbars () {
 void UiStack::executeStackCommands () {
 	Ui *ui, *item;
 	int cmd, result;
+	ProfilerZone zone ("UiStack::executeStackCommands");
 
 	SDL_LockMutex (nextCommandMutex);
 	cmd = nextCommandType;
@@ -729,7 +741,7 @@ void UiStack::setPointerSprite (Sprite *sprite, double offsetScaleX, double offs
 			Resource::instance->unloadTexture (pointerTexturePath);
 			pointerTexturePath.assign ("");
 		}
-		pointerTexture = sprite->getTexture (0, &pointerTextureWidth, &pointerTextureHeight, &pointerTexturePath);
+		pointerTexture = sprite->getTexture (0, &pointerTextureWidth, &pointerTextureHeight, &pointerTexturePath, &pointerTextureRect);
 		if (! Resource::instance->loadTexture (pointerTexturePath, true)) {
 			isPointerDrawEnabled = false;
 			pointerTexturePath.assign ("");
@@ -1044,6 +1056,10 @@ void UiStack::assignOverlayZLevels () {
 	if (fullscreen) {
 		z += playerControl.assignPlayerZLevels (z);
 	}
+	if (profilerWindow) {
+		profilerWindow->zLevel = z;
+		++z;
+	}
 }
 
 void UiStack::toggleSettingsWindow () {
@@ -1134,6 +1150,25 @@ void UiStack::toggleLogWindow () {
 	suspendUiInput ();
 }
 
+bool UiStack::isProfilerWindowOpen () {
+	return (profilerWindow != NULL);
+}
+
+void UiStack::toggleProfilerWindow () {
+	if (profilerWindow) {
+		profilerWindowHandle.destroyAndClear ();
+		if ((! Profiler::instance->isTracing) && (! Profiler::instance->isMeasuring)) {
+			Profiler::instance->setEnabled (false);
+		}
+		return;
+	}
+	Profiler::instance->setEnabled (true);
+	profilerWindowHandle.assign (new ProfilerWindow (App::instance->drawableWidth * profilerGraphWidthScale, App::instance->drawableHeight * profilerGraphHeightScale));
+	App::instance->rootPanel->addWidget (profilerWindow);
+	profilerWindow->position.assign (UiConfiguration::instance->marginSize, mainToolbar ? (mainToolbar->position.y + mainToolbar->height + UiConfiguration::instance->marginSize) : UiConfiguration::instance->marginSize);
+	assignOverlayZLevels ();
+}
+
 void UiStack::toggleConsoleWindow () {
 	StringList lines;
 
@@ -53,6 +53,7 @@ class SettingsWindow;
 class HelpWindow;
 class UiLogWindow;
 class ConsoleWindow;
+class ProfilerWindow;
 class MediaPlaylistWindow;
 
 class UiStack {
@@ -145,6 +146,12 @@ public:
 	// Toggle the visible state of the console window
 	void toggleConsoleWindow ();
 
+	// Toggle the visible state of the profiler window, enabling Profiler timing while the window is shown
+	void toggleProfilerWindow ();
+
+	// Return a boolean value indicating if the profiler window is showing
+	bool isProfilerWindowOpen ();
+
 	// Show the provided panel as a dialog
 	void showDialog (Panel *dialog);
 
@@ -255,6 +262,8 @@ private:
 	Panel *dialogWindow;
 	WidgetHandle<ConsoleWindow> consoleWindowHandle;
 	ConsoleWindow *consoleWindow;
+	WidgetHandle<ProfilerWindow> profilerWindowHandle;
+	ProfilerWindow *profilerWindow;
 	WidgetHandle<SnackbarWindow> snackbarWindowHandle;
 	SnackbarWindow *snackbarWindow;
 	PlayerControl playerControl;
@@ -275,6 +284,7 @@ private:
 	StdString pointerTexturePath;
 	int pointerTextureWidth;
 	int pointerTextureHeight;
+	SDL_Rect pointerTextureRect;
 	double pointerOffsetScaleX;
 	double pointerOffsetScaleY;
 	Color pointerColor;
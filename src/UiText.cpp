@@ -33,6 +33,7 @@
 #include "Config.h"
 #include "OsUtil.h"
 #include "Resource.h"
+#include "BufferView.h"
 #include "UiText.h"
 
 UiText *UiText::instance = NULL;
@@ -57,8 +58,9 @@ void UiText::freeInstance () {
 
 OpResult UiText::load (const StdString &language) {
 	Buffer *buffer;
-	StdString path, text, s;
-	size_t curpos, pos1, pos2;
+	BufferView text;
+	StdString path, s;
+	int curpos, pos1, pos2;
 
 	path.sprintf ("text/%s.txt", language.c_str ());
 	buffer = Resource::instance->loadFile (path);
@@ -69,17 +71,17 @@ OpResult UiText::load (const StdString &language) {
 	if (! buffer) {
 		return (OpResult::FileOpenFailedError);
 	}
-	text.assignBuffer (buffer);
+	text = BufferView (*buffer);
 	textStrings.clear ();
 	curpos = 0;
 	while (true) {
 		pos1 = text.find (' ', curpos);
 		pos2 = text.find ('\n', curpos);
-		if ((pos1 == StdString::npos) || (pos2 == StdString::npos) || (pos1 >= pos2)) {
+		if ((pos1 < 0) || (pos2 < 0) || (pos1 >= pos2)) {
 			break;
 		}
 
-		s = text.substr (pos1 + 1, pos2 - pos1 - 1);
+		s.assign ((const char *) text.data + pos1 + 1, pos2 - pos1 - 1);
 		s.replace (StdString ("\\n"), StdString ("\n"));
 		textStrings.push_back (s);
 		curpos = pos2 + 1;
@@ -434,5 +434,27 @@ public:
 	static constexpr const int PlayerWindowSubtitleDisableTooltip = 390;
 	static constexpr const int Mute = 391;
 	static constexpr const int Unmute = 392;
+	static constexpr const int LuaScriptVideostatsHelpText = 393;
+	static constexpr const int LuaScriptShowvideostatsHelpText = 394;
+	static constexpr const int LuaScriptStartmeasureHelpText = 395;
+	static constexpr const int LuaScriptStopmeasureHelpText = 396;
+	static constexpr const int MediaWatchLimitReached = 397;
+	static constexpr const int ProfilerTraceStarted = 398;
+	static constexpr const int ProfilerTraceWritten = 399;
+	static constexpr const int ProfilerTraceWriteFailed = 400;
+	static constexpr const int Frame = 401;
+	static constexpr const int Trace = 402;
+	static constexpr const int Recording = 403;
+	static constexpr const int Off = 404;
+	static constexpr const int Decode = 405;
+	static constexpr const int Scale = 406;
+	static constexpr const int Upload = 407;
+	static constexpr const int AvDrift = 408;
+	static constexpr const int Queue = 409;
+	static constexpr const int Rendered = 410;
+	static constexpr const int DroppedLate = 411;
+	static constexpr const int Skipped = 412;
+	static constexpr const int Max = 413;
+	static constexpr const int Audio = 414;
 };
 #endif
@@ -52,12 +52,17 @@ extern "C" {
 #include "MediaReader.h"
 #include "SubtitleReader.h"
 #include "SoundSample.h"
+#include "Json.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Video.h"
 
 constexpr const int defaultReadaheadTime = 5000; // ms
 constexpr const int minDtsDelay = 10;
 constexpr const int maxDtsDelay = 2000;
+constexpr const int defaultSubtitleDuration = 3000; // ms
+
+std::atomic<int64_t> Video::totalFrameDropCount (0);
 
 Video::Video (double videoWidth, double videoHeight, int soundMixVolume, bool isSoundMuted)
 : Widget ()
@@ -133,6 +138,10 @@ Video::Video (double videoWidth, double videoHeight, int soundMixVolume, bool is
 , audioDisplayTextureDrawWidth (0)
 , audioDisplayTextureDrawHeight (0)
 , isAudioDisplayEnabled (false)
+, subtitleStream (-1)
+, subtitleStreamTimeBaseNum (0)
+, subtitleStreamTimeBaseDen (1)
+, subtitleCodecContext (NULL)
 , playPositionStream (-1)
 , playReferenceTime (0)
 , pauseTime (0)
@@ -158,6 +167,7 @@ Video::Video (double videoWidth, double videoHeight, int soundMixVolume, bool is
 	SdlUtil::createCond (&framesCond);
 	SdlUtil::createMutex (&audioDisplayTextureMutex);
 	SdlUtil::createMutex (&playEndMutex);
+	SdlUtil::createMutex (&playbackStatsMutex);
 }
 Video::~Video () {
 	if (soundPlayerId >= 0) {
@@ -192,6 +202,7 @@ Video::~Video () {
 	SdlUtil::destroyMutex (&framesMutex);
 	SdlUtil::destroyMutex (&audioDisplayTextureMutex);
 	SdlUtil::destroyMutex (&playEndMutex);
+	SdlUtil::destroyMutex (&playbackStatsMutex);
 }
 
 Video *Video::castWidget (Widget *widget) {
@@ -226,6 +237,11 @@ void Video::clearPlay () {
 		avcodec_free_context (&videoCodecContext);
 		videoCodecContext = NULL;
 	}
+	if (subtitleCodecContext) {
+		avcodec_free_context (&subtitleCodecContext);
+		subtitleCodecContext = NULL;
+	}
+	subtitleStream = -1;
 	if (avFormatContext) {
 		avformat_close_input (&avFormatContext);
 		avFormatContext = NULL;
@@ -737,6 +753,7 @@ void Video::executeReadPackets () {
 	audioPacketDecodeCount = 0;
 	videoPacketDecodeCount = 0;
 	videoFrameRenderCount = 0;
+	resetPlaybackStats ();
 	soundPlayerId = SoundMixer::instance->playLiveSample (soundSample, soundMixVolume, isSoundMuted);
 	shouldClearRenderTexture = true;
 	while (true) {
@@ -761,6 +778,9 @@ void Video::executeReadPackets () {
 		else if (avPacket->stream_index == audioStream) {
 			decodeAudioPacket ();
 		}
+		else if ((subtitleStream >= 0) && (avPacket->stream_index == subtitleStream)) {
+			decodeSubtitlePacket ();
+		}
 		av_packet_unref (avPacket);
 	}
 	isReadEnded = true;
@@ -769,9 +789,11 @@ void Video::executeReadPackets () {
 
 void Video::decodeVideoPacket () {
 	int64_t dts, pts, playts, now, delta;
-	int result;
+	uint64_t t1, t2;
+	int result, depth;
 	Video::VideoFrame frame;
 	Buffer *buffer;
+	ProfilerZone zone ("Video::decodeVideoPacket");
 
 	++videoPacketDecodeCount;
 	pts = -1;
@@ -783,6 +805,10 @@ void Video::decodeVideoPacket () {
 	playts = now - playReferenceTime;
 	if (isDroppingVideoFrames) {
 		if (!((avPacket->flags & AV_PKT_FLAG_KEY) && (pts >= playts))) {
+			SDL_LockMutex (playbackStatsMutex);
+			++(playbackStats.videoPacketDropCount);
+			SDL_UnlockMutex (playbackStatsMutex);
+			Video::totalFrameDropCount.fetch_add (1, std::memory_order_relaxed);
 			return;
 		}
 		isDroppingVideoFrames = false;
@@ -790,6 +816,10 @@ void Video::decodeVideoPacket () {
 	else {
 		if (isFirstVideoFrameRendered && (pts >= 0) && (pts < playts)) {
 			isDroppingVideoFrames = true;
+			SDL_LockMutex (playbackStatsMutex);
+			++(playbackStats.videoPacketDropCount);
+			SDL_UnlockMutex (playbackStatsMutex);
+			Video::totalFrameDropCount.fetch_add (1, std::memory_order_relaxed);
 			return;
 		}
 	}
@@ -811,6 +841,7 @@ void Video::decodeVideoPacket () {
 		return;
 	}
 
+	t1 = SDL_GetPerformanceCounter ();
 	result = avcodec_send_packet (videoCodecContext, avPacket);
 	if (result < 0) {
 		failPlay (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("avcodec_send_packet error %i", result).c_str ());
@@ -825,6 +856,10 @@ void Video::decodeVideoPacket () {
 			failPlay (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("avcodec_receive_frame error %i", result).c_str ());
 			break;
 		}
+		t2 = SDL_GetPerformanceCounter ();
+		SDL_LockMutex (playbackStatsMutex);
+		playbackStats.decodeTime.add (Profiler::getCounterDuration (t1, t2));
+		SDL_UnlockMutex (playbackStatsMutex);
 		pts = 0;
 		if (videoFrame->pts != AV_NOPTS_VALUE) {
 			pts = (videoFrame->pts * 1000 * videoStreamTimeBaseNum) / videoStreamTimeBaseDen;
@@ -847,7 +882,12 @@ void Video::decodeVideoPacket () {
 			if (! resetSwsContext ()) {
 				break;
 			}
+			t1 = SDL_GetPerformanceCounter ();
 			result = sws_scale (swsContext, videoFrame->data, videoFrame->linesize, 0, videoFrame->height, imageData, imageLineSizes);
+			t2 = SDL_GetPerformanceCounter ();
+			SDL_LockMutex (playbackStatsMutex);
+			playbackStats.scaleTime.add (Profiler::getCounterDuration (t1, t2));
+			SDL_UnlockMutex (playbackStatsMutex);
 			if (result != scaledFrameHeight) {
 				failPlay (UiText::instance->getText (UiTextId::InternalApplicationError).capitalized (), StdString::createSprintf ("sws_scale unexpected result %i", result).c_str ());
 			}
@@ -870,18 +910,28 @@ void Video::decodeVideoPacket () {
 					frame.imageOffsetY = renderOffsetY;
 					SDL_LockMutex (framesMutex);
 					frames.push_back (frame);
+					depth = (int) frames.size ();
 					SDL_CondBroadcast (framesCond);
 					SDL_UnlockMutex (framesMutex);
+
+					SDL_LockMutex (playbackStatsMutex);
+					playbackStats.framesQueueDepthSize.add (depth);
+					if (depth > playbackStats.maxFramesQueueDepth) {
+						playbackStats.maxFramesQueueDepth = depth;
+					}
+					SDL_UnlockMutex (playbackStatsMutex);
 				}
 			}
 		}
 
 		av_frame_unref (videoFrame);
+		t1 = SDL_GetPerformanceCounter ();
 	}
 }
 
 void Video::decodeAudioPacket () {
 	int64_t dts, pts, playts, now, delta;
+	ProfilerZone zone ("Video::decodeAudioPacket");
 
 	++audioPacketDecodeCount;
 	dts = -1;
@@ -926,6 +976,15 @@ void Video::decodeAudioPacket () {
 	if (avPacket->pts != AV_NOPTS_VALUE) {
 		audioStreamDecodedDuration = ((avPacket->pts + avPacket->duration) * 1000 * audioStreamTimeBaseNum) / audioStreamTimeBaseDen;
 	}
+	if (isFirstSeekFrameFound && (soundSample->lastFramePts >= readaheadTime)) {
+		playts = OsUtil::getTime () - playReferenceTime;
+		delta = soundSample->lastFramePts - readaheadTime - playts;
+		SDL_LockMutex (playbackStatsMutex);
+		playbackStats.avDrift = delta;
+		playbackStats.avDriftSize.add ((delta < 0) ? -delta : delta);
+		playbackStats.audioBufferedTime = audioStreamDecodedDuration - playts;
+		SDL_UnlockMutex (playbackStatsMutex);
+	}
 	if (playPositionStream == audioStream) {
 		isPlayPresented = true;
 	}
@@ -940,6 +999,64 @@ void Video::decodeAudioPacket () {
 	}
 }
 
+void Video::decodeSubtitlePacket () {
+	AVSubtitle sub;
+	AVSubtitleRect *rect;
+	StdString text, line;
+	int64_t pts, starttime, endtime;
+	int result, gotsub;
+	unsigned int i;
+
+	if (! subtitleCodecContext) {
+		return;
+	}
+	gotsub = 0;
+	result = avcodec_decode_subtitle2 (subtitleCodecContext, &sub, &gotsub, avPacket);
+	if ((result < 0) || (! gotsub)) {
+		return;
+	}
+	pts = -1;
+	if (avPacket->pts != AV_NOPTS_VALUE) {
+		pts = (avPacket->pts * 1000 * subtitleStreamTimeBaseNum) / subtitleStreamTimeBaseDen;
+	}
+	else if (sub.pts != AV_NOPTS_VALUE) {
+		pts = sub.pts * 1000 / AV_TIME_BASE;
+	}
+	if (pts >= 0) {
+		for (i = 0; i < sub.num_rects; ++i) {
+			rect = sub.rects[i];
+			line.assign ("");
+			if ((rect->type == SUBTITLE_ASS) && rect->ass) {
+				line.assign (SubtitleReader::getAssDialogueText (rect->ass));
+			}
+			else if ((rect->type == SUBTITLE_TEXT) && rect->text) {
+				line.assign (StdString (rect->text).trimmed ());
+				line.markupStrip ("<", ">");
+			}
+			if (! line.empty ()) {
+				if (! text.empty ()) {
+					text.append ("\n");
+				}
+				text.append (line);
+			}
+		}
+		if (! text.empty ()) {
+			starttime = pts + sub.start_display_time - formatStartTime;
+			if ((sub.end_display_time > sub.start_display_time) && (sub.end_display_time != UINT32_MAX)) {
+				endtime = pts + sub.end_display_time - formatStartTime;
+			}
+			else if (avPacket->duration > 0) {
+				endtime = starttime + ((avPacket->duration * 1000 * subtitleStreamTimeBaseNum) / subtitleStreamTimeBaseDen);
+			}
+			else {
+				endtime = starttime + defaultSubtitleDuration;
+			}
+			subtitle.addEntry (starttime, endtime, text);
+		}
+	}
+	avsubtitle_free (&sub);
+}
+
 void Video::endAudioStream () {
 	int64_t now, playts, delta;
 
@@ -1084,6 +1201,10 @@ void Video::executePresentFrames () {
 			}
 			frames.erase (i1);
 			--skipcount;
+			SDL_LockMutex (playbackStatsMutex);
+			++(playbackStats.videoFrameSkipCount);
+			SDL_UnlockMutex (playbackStatsMutex);
+			Video::totalFrameDropCount.fetch_add (1, std::memory_order_relaxed);
 		}
 
 		i1 = frames.begin ();
@@ -1121,10 +1242,13 @@ void Video::executeRenderFrame () {
 	std::list<Video::VideoFrame>::iterator i;
 	Video::VideoFrame frame;
 	Buffer *buffer;
+	SDL_Rect rect;
 	uint8_t *src, *dst, *dstpixels;
 	int srcpitch, dstpitch, cpsize, x, y, y2;
 	Uint32 pixel;
 	int64_t playts;
+	uint64_t t1;
+	ProfilerZone zone ("Video::executeRenderFrame");
 
 	buffer = NULL;
 	SDL_LockMutex (framesMutex);
@@ -1151,15 +1275,24 @@ void Video::executeRenderFrame () {
 		renderTextureWidth = frame.renderWidth;
 		renderTextureHeight = frame.renderHeight;
 		renderTexturePath.sprintf ("*_Video_%llx_%llx", (long long int) id, (long long int) App::instance->getUniqueId ());
-		renderTexture = Resource::instance->createTexture (renderTexturePath, renderTextureWidth, renderTextureHeight, true);
+		renderTexture = Resource::instance->createPoolTexture (renderTexturePath, renderTextureWidth, renderTextureHeight, true, Resource::VideoTextureCategory);
 		if (! renderTexture) {
 			renderTexturePath.assign ("");
 		}
+		else {
+			// Pooled textures may hold content from a previous user
+			shouldClearRenderTexture = true;
+		}
 	}
 
+	t1 = SDL_GetPerformanceCounter ();
 	srcpitch = frame.imageLineSize;
 	if (renderTexture && (srcpitch > 0)) {
-		if (SDL_LockTexture (renderTexture, NULL, (void **) &dstpixels, &dstpitch) != 0) {
+		rect.x = 0;
+		rect.y = 0;
+		rect.w = renderTextureWidth;
+		rect.h = renderTextureHeight;
+		if (SDL_LockTexture (renderTexture, &rect, (void **) &dstpixels, &dstpitch) != 0) {
 			Log::err ("Failed to update video texture, SDL_LockTexture: %s", SDL_GetError ());
 		}
 		else {
@@ -1234,6 +1367,9 @@ void Video::executeRenderFrame () {
 		}
 	}
 	delete (buffer);
+	SDL_LockMutex (playbackStatsMutex);
+	playbackStats.textureUploadTime.add (Profiler::getCounterDuration (t1, SDL_GetPerformanceCounter ()));
+	SDL_UnlockMutex (playbackStatsMutex);
 
 	isFirstVideoFrameRendered = true;
 	++videoFrameRenderCount;
@@ -1325,25 +1461,121 @@ void Video::readSubtitles () {
 		subtitle.setFilePath (path);
 		result = subtitle.readSubtitles ();
 	}
-	if (result != OpResult::Success) {
-		isSubtitleLoaded = false;
-	}
-	else {
+	if (result == OpResult::Success) {
 		isSubtitleLoaded = true;
+		return;
 	}
+	subtitle.setFilePath (playPath);
+	subtitle.clear ();
+	isSubtitleLoaded = openSubtitleStream ();
 }
 
-StdString Video::getSubtitleText () {
-	int n;
+bool Video::openSubtitleStream () {
+	const AVCodec *codec;
+	AVCodecParameters *params;
+	int stream, result, i;
 
-	if ((! isSubtitleLoaded) || (! isPlaying)) {
-		return (StdString ());
+	// av_find_best_stream may select a bitmap subtitle stream such as PGS or DVB, so choose the first text stream, preferring one marked as default
+	stream = -1;
+	for (i = 0; i < (int) avFormatContext->nb_streams; ++i) {
+		params = avFormatContext->streams[i]->codecpar;
+		if ((params->codec_type != AVMEDIA_TYPE_SUBTITLE) || (! Video::isTextSubtitleCodec (params->codec_id))) {
+			continue;
+		}
+		if ((stream < 0) || ((avFormatContext->streams[i]->disposition & AV_DISPOSITION_DEFAULT) && (! (avFormatContext->streams[stream]->disposition & AV_DISPOSITION_DEFAULT)))) {
+			stream = i;
+		}
+	}
+	if (stream < 0) {
+		return (false);
 	}
-	n = subtitle.findEntry (playTimestamp);
-	if (n < 0) {
+	params = avFormatContext->streams[stream]->codecpar;
+	subtitleStreamTimeBaseNum = avFormatContext->streams[stream]->time_base.num;
+	subtitleStreamTimeBaseDen = avFormatContext->streams[stream]->time_base.den;
+	if ((subtitleStreamTimeBaseNum <= 0) || (subtitleStreamTimeBaseDen <= 0)) {
+		return (false);
+	}
+	codec = avcodec_find_decoder (params->codec_id);
+	if (! codec) {
+		return (false);
+	}
+	subtitleCodecContext = avcodec_alloc_context3 (codec);
+	if (! subtitleCodecContext) {
+		return (false);
+	}
+	result = avcodec_parameters_to_context (subtitleCodecContext, params);
+	if (result >= 0) {
+		subtitleCodecContext->pkt_timebase = avFormatContext->streams[stream]->time_base;
+		result = avcodec_open2 (subtitleCodecContext, codec, NULL);
+	}
+	if (result < 0) {
+		Log::debug ("Video playback: Failed to open subtitle codec; path=\"%s\" codec_id=%lli", playPath.c_str (), (long long int) params->codec_id);
+		avcodec_free_context (&subtitleCodecContext);
+		subtitleCodecContext = NULL;
+		return (false);
+	}
+	subtitleStream = stream;
+	return (true);
+}
+
+bool Video::isTextSubtitleCodec (int codecId) {
+	return ((codecId == AV_CODEC_ID_SUBRIP) || (codecId == AV_CODEC_ID_SRT) || (codecId == AV_CODEC_ID_ASS) || (codecId == AV_CODEC_ID_SSA) || (codecId == AV_CODEC_ID_MOV_TEXT) || (codecId == AV_CODEC_ID_TEXT));
+}
+
+StdString Video::getSubtitleText () {
+	if ((! isSubtitleLoaded) || (! isPlaying)) {
 		return (StdString ());
 	}
-	return (subtitle.entryList.at (n).text);
+	return (subtitle.getEntryText (playTimestamp));
+}
+
+void Video::resetPlaybackStats () {
+	SDL_LockMutex (playbackStatsMutex);
+	playbackStats = Video::PlaybackStats ();
+	SDL_UnlockMutex (playbackStatsMutex);
+}
+
+void Video::getPlaybackStats (Video::PlaybackStats *destStats) {
+	SDL_LockMutex (playbackStatsMutex);
+	*destStats = playbackStats;
+	SDL_UnlockMutex (playbackStatsMutex);
+	destStats->packetReadCount = packetReadCount;
+	destStats->videoPacketDecodeCount = videoPacketDecodeCount;
+	destStats->videoFrameRenderCount = videoFrameRenderCount;
+	destStats->audioPacketDecodeCount = audioPacketDecodeCount;
+	SDL_LockMutex (framesMutex);
+	destStats->framesQueueDepth = (int) frames.size ();
+	SDL_UnlockMutex (framesMutex);
+}
+
+Json *Video::createPlaybackStatsJson () {
+	Video::PlaybackStats stats;
+	Json *json;
+
+	getPlaybackStats (&stats);
+	json = new Json ();
+	json->set ("playPath", playPath);
+	json->set ("isPlaying", isPlaying);
+	json->set ("playTimestamp", playTimestamp);
+	json->set ("playDuration", playDuration);
+	json->set ("renderTargetWidth", renderTargetWidth);
+	json->set ("renderTargetHeight", renderTargetHeight);
+	json->set ("packetReadCount", stats.packetReadCount);
+	json->set ("videoPacketDecodeCount", stats.videoPacketDecodeCount);
+	json->set ("videoFrameRenderCount", stats.videoFrameRenderCount);
+	json->set ("videoPacketDropCount", stats.videoPacketDropCount);
+	json->set ("videoFrameSkipCount", stats.videoFrameSkipCount);
+	json->set ("audioPacketDecodeCount", stats.audioPacketDecodeCount);
+	json->set ("framesQueueDepth", stats.framesQueueDepth);
+	json->set ("maxFramesQueueDepth", stats.maxFramesQueueDepth);
+	json->set ("audioBufferedTime", stats.audioBufferedTime);
+	json->set ("avDrift", stats.avDrift);
+	json->set ("decodeTime", stats.decodeTime.createJson ());
+	json->set ("scaleTime", stats.scaleTime.createJson ());
+	json->set ("textureUploadTime", stats.textureUploadTime.createJson ());
+	json->set ("avDriftSize", stats.avDriftSize.createJson ());
+	json->set ("framesQueueDepthSize", stats.framesQueueDepthSize.createJson ());
+	return (json);
 }
 
 void Video::doUpdate (int msElapsed) {
@@ -1351,10 +1583,11 @@ void Video::doUpdate (int msElapsed) {
 		translateAlphaValue.update (msElapsed);
 		drawAlpha = translateAlphaValue.x;
 	}
+	invalidateLayer ();
 }
 
 void Video::doDraw (double originX, double originY) {
-	SDL_Rect rect;
+	SDL_Rect rect, srcrect;
 	SDL_Texture *texture;
 	int texturew, textureh;
 	bool found;
@@ -1371,7 +1604,11 @@ void Video::doDraw (double originX, double originY) {
 		else {
 			SDL_SetTextureBlendMode (renderTexture, SDL_BLENDMODE_NONE);
 		}
-		SDL_RenderCopy (App::instance->render, renderTexture, NULL, &rect);
+		srcrect.x = 0;
+		srcrect.y = 0;
+		srcrect.w = renderTextureWidth;
+		srcrect.h = renderTextureHeight;
+		SDL_RenderCopy (App::instance->render, renderTexture, &srcrect, &rect);
 	}
 	else {
 		if (fillBgColor.aByte < 255) {
@@ -1400,7 +1637,7 @@ void Video::doDraw (double originX, double originY) {
 			SDL_UnlockMutex (audioDisplayTextureMutex);
 
 			if ((! found) && audioIconSprite) {
-				texture = audioIconSprite->getTexture (0, &texturew, &textureh);
+				texture = audioIconSprite->getTexture (0, &texturew, &textureh, NULL, &srcrect);
 				if (texture) {
 					rect.x = (int) (originX + position.x + ((int) (width / 2.0f)) - (texturew / 2));
 					rect.y = (int) (originY + position.y + ((int) (height / 2.0f)) - (textureh / 2));
@@ -1410,12 +1647,13 @@ void Video::doDraw (double originX, double originY) {
 					if (audioIconDrawColor.aByte > 0) {
 						SDL_SetTextureColorMod (texture, audioIconDrawColor.rByte, audioIconDrawColor.gByte, audioIconDrawColor.bByte);
 						SDL_SetTextureAlphaMod (texture, audioIconDrawColor.aByte);
-						SDL_SetTextureBlendMode (texture, SDL_BLENDMODE_BLEND);
 					}
-					SDL_RenderCopy (App::instance->render, texture, NULL, &rect);
+					SDL_SetTextureBlendMode (texture, SDL_BLENDMODE_BLEND);
+					SDL_RenderCopy (App::instance->render, texture, &srcrect, &rect);
 					if (audioIconDrawColor.aByte > 0) {
+						// The icon texture may be an atlas page shared with other sprites
 						SDL_SetTextureColorMod (texture, 255, 255, 255);
-						SDL_SetTextureBlendMode (texture, SDL_BLENDMODE_NONE);
+						SDL_SetTextureAlphaMod (texture, 255);
 					}
 				}
 			}
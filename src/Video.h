@@ -39,13 +39,16 @@ extern "C" {
 #include "libavformat/avformat.h"
 #include "libswscale/swscale.h"
 }
+#include <atomic>
 #include "MediaUtil.h"
 #include "SubtitleReader.h"
 #include "SoundMixer.h"
 #include "Color.h"
+#include "Histogram.h"
 #include "Widget.h"
 
 class Buffer;
+class Json;
 class MediaReader;
 class SoundSample;
 class Sprite;
@@ -58,6 +61,39 @@ public:
 	// Return a typecasted pointer to the provided widget, or NULL if the widget does not appear to be of the correct type
 	static Video *castWidget (Widget *widget);
 
+	// The number of video packets dropped and frames skipped by all Video objects since application start
+	static std::atomic<int64_t> totalFrameDropCount;
+
+	struct PlaybackStats {
+		int packetReadCount;
+		int videoPacketDecodeCount;
+		int videoFrameRenderCount;
+		int videoPacketDropCount;
+		int videoFrameSkipCount;
+		int audioPacketDecodeCount;
+		int framesQueueDepth;
+		int maxFramesQueueDepth;
+		int64_t audioBufferedTime;
+		int64_t avDrift;
+		Histogram decodeTime;
+		Histogram scaleTime;
+		Histogram textureUploadTime;
+		Histogram avDriftSize;
+		Histogram framesQueueDepthSize;
+
+		PlaybackStats ():
+			packetReadCount (0),
+			videoPacketDecodeCount (0),
+			videoFrameRenderCount (0),
+			videoPacketDropCount (0),
+			videoFrameSkipCount (0),
+			audioPacketDecodeCount (0),
+			framesQueueDepth (0),
+			maxFramesQueueDepth (0),
+			audioBufferedTime (0),
+			avDrift (0) { }
+	};
+
 	// Read-write data members
 	Color fillBgColor;
 	double drawAlpha;
@@ -128,6 +164,12 @@ public:
 	// Return a string containing subtitle text for the current play timestamp, or an empty string if no subtitle was found
 	StdString getSubtitleText ();
 
+	// Store telemetry values from the current or most recent play operation into destStats. Time histograms are measured in microseconds, and avDrift values in milliseconds.
+	void getPlaybackStats (Video::PlaybackStats *destStats);
+
+	// Return a newly created Json object containing telemetry values from the current or most recent play operation
+	Json *createPlaybackStatsJson ();
+
 protected:
 	// Superclass override methods
 	void doUpdate (int msElapsed);
@@ -183,6 +225,9 @@ private:
 	// Process avPacket as an audio packet
 	void decodeAudioPacket ();
 
+	// Process avPacket as a subtitle packet, adding decoded text to subtitle entries
+	void decodeSubtitlePacket ();
+
 	// Reset swsContext and related values as needed for the targeted render size and return true if the operation succeeded
 	bool resetSwsContext ();
 
@@ -192,6 +237,9 @@ private:
 	// Reset draw size values for audioDisplayTexture. This method must only be invoked while holding a lock on audioDisplayTextureMutex.
 	void resetAudioDisplayTextureDrawSize ();
 
+	// Clear stored telemetry values in preparation for a play operation
+	void resetPlaybackStats ();
+
 	// Render stored frames as their presentation times arrive
 	static void presentFrames (void *itPtr);
 	void executePresentFrames ();
@@ -200,9 +248,15 @@ private:
 	static void renderFrame (void *itPtr);
 	void executeRenderFrame ();
 
-	// Find subtitle files associated with the current play path and read subtitle entries if found
+	// Find subtitle files associated with the current play path and read subtitle entries if found. If no subtitle file is found, prepare to decode entries from an embedded text subtitle stream.
 	void readSubtitles ();
 
+	// Open a decoder for the best embedded text subtitle stream and return a boolean value indicating if the operation succeeded
+	bool openSubtitleStream ();
+
+	// Return a boolean value indicating if the specified AVCodecID value identifies a text subtitle codec
+	static bool isTextSubtitleCodec (int codecId);
+
 	static constexpr const int imageDataPlaneCount = 4;
 
 	Position translateAlphaValue;
@@ -259,6 +313,10 @@ private:
 	SDL_mutex *audioDisplayTextureMutex;
 	bool isAudioDisplayEnabled;
 	SubtitleReader subtitle;
+	int subtitleStream;
+	int64_t subtitleStreamTimeBaseNum;
+	int64_t subtitleStreamTimeBaseDen;
+	AVCodecContext *subtitleCodecContext;
 	int playPositionStream;
 	int64_t playReferenceTime;
 	int64_t pauseTime;
@@ -268,5 +326,7 @@ private:
 	int playEndTarget;
 	SDL_mutex *playEndMutex;
 	Widget::EventCallbackContext playEndCallback;
+	Video::PlaybackStats playbackStats;
+	SDL_mutex *playbackStatsMutex;
 };
 #endif
@@ -35,22 +35,26 @@
 #include "ClassId.h"
 #include "OsUtil.h"
 #include "SharedBuffer.h"
-#include "Particle.h"
+#include "App.h"
 #include "Video.h"
 #include "SoundMixer.h"
 #include "WaveformShader.h"
 
-constexpr const double particleColorR = 0.3f;
-constexpr const double particleColorG = 1.0f;
-constexpr const double particleColorB = 0.3f;
+constexpr const uint8_t drawColorR = 77;
+constexpr const uint8_t drawColorG = 255;
+constexpr const uint8_t drawColorB = 77;
+constexpr const uint8_t fillAlpha = 96;
 constexpr const int decayPeriod = 200;
-constexpr const double decayScale = 0.65f;
+constexpr const float decayScale = 0.65f;
+constexpr const float spectrumFallScale = 0.8f;
+constexpr const float spectrumBarWidthScale = 0.75f;
 
-WaveformShader::WaveformShader (double shaderWidth, double shaderHeight, double particleDensity)
+WaveformShader::WaveformShader (double shaderWidth, double shaderHeight, double columnDensity)
 : Shader ()
+, displayMode (WaveformShader::WaveformMode)
 , shaderWidth (shaderWidth)
 , shaderHeight (shaderHeight)
-, particleDensity (particleDensity)
+, columnDensity (columnDensity)
 , frameDuration (25)
 , soundPlayerId (-1)
 , audioSampleFormat (AUDIO_F32)
@@ -58,7 +62,6 @@ WaveformShader::WaveformShader (double shaderWidth, double shaderHeight, double
 , audioSampleChannelCount (1)
 , audioSampleSize (1)
 , sourceSampleSize (0)
-, readSampleFn (WaveformShader::readFloat32Sample)
 , isDecayActive (false)
 , decayClock (0)
 , sourceVideoHandle (&sourceVideo)
@@ -79,11 +82,12 @@ WaveformShader::WaveformShader (double shaderWidth, double shaderHeight, double
 	if (this->shaderHeight < 0.0f) {
 		this->shaderHeight = 0.0f;
 	}
-	if (this->particleDensity > 1.0f) {
-		this->particleDensity = 1.0f;
+	if (this->columnDensity > 1.0f) {
+		this->columnDensity = 1.0f;
 	}
-	SdlUtil::createMutex (&particleMutex);
+	SdlUtil::createMutex (&columnMutex);
 	SdlUtil::createMutex (&sourceSampleMutex);
+	isRenderTextureEnabled = false;
 	width = this->shaderWidth;
 	height = this->shaderHeight;
 }
@@ -96,7 +100,7 @@ WaveformShader::~WaveformShader () {
 		soundPlayerId = -1;
 	}
 	clearSourceSamples ();
-	SdlUtil::destroyMutex (&particleMutex);
+	SdlUtil::destroyMutex (&columnMutex);
 	SdlUtil::destroyMutex (&sourceSampleMutex);
 }
 
@@ -124,8 +128,7 @@ void WaveformShader::clearSourceSamples () {
 }
 
 bool WaveformShader::updateRenderState (int msElapsed) {
-	int i, particlecount, samplecount, advance;
-	double x, y, dx, xmax;
+	int columncount, samplecount, advance;
 	bool paused, shouldupdate, firstbuffer, result;
 	std::list<SharedBuffer *>::iterator i1, i2;
 	SharedBuffer *buffer;
@@ -152,29 +155,19 @@ bool WaveformShader::updateRenderState (int msElapsed) {
 	}
 
 	result = false;
-	SDL_LockMutex (particleMutex);
-	if (particles.empty () && (shaderWidth >= 1.0f) && (shaderHeight >= 1.0f)) {
+	SDL_LockMutex (columnMutex);
+	if (columns.empty () && (shaderWidth >= 1.0f) && (shaderHeight >= 1.0f)) {
 		result = true;
-		particlecount = (int) floor (shaderWidth * particleDensity);
-		if (particlecount < 4) {
-			particlecount = 4;
-		}
-		xmax = shaderWidth - 1.0f;
-		dx = xmax / (double) (particlecount - 1);
-		x = 0.0f;
-		y = shaderHeight / 2.0f;
-		for (i = 0; i < particlecount; ++i) {
-			particles.push_back (Particle (particleColorR, particleColorG, particleColorB, x, y));
-			x += dx;
-			if (x > xmax) {
-				x = xmax;
-			}
+		columncount = (int) floor (shaderWidth * columnDensity);
+		if (columncount < 4) {
+			columncount = 4;
 		}
+		columns.resize (columncount);
 	}
-	particlecount = (int) particles.size ();
-	SDL_UnlockMutex (particleMutex);
+	columncount = (int) columns.size ();
+	SDL_UnlockMutex (columnMutex);
 
-	if ((particlecount > 0) && (! paused) && (audioSampleRate > 0) && (audioSampleSize > 0)) {
+	if ((columncount > 0) && (! paused) && (audioSampleRate > 0) && (audioSampleSize > 0)) {
 		shouldupdate = false;
 		frameSamples.clear ();
 		SDL_LockMutex (sourceSampleMutex);
@@ -235,7 +228,7 @@ bool WaveformShader::updateRenderState (int msElapsed) {
 		}
 		SDL_UnlockMutex (sourceSampleMutex);
 		if (shouldupdate && (! frameSamples.empty ())) {
-			assignParticlePositions ();
+			assignColumnValues ();
 			result = true;
 		}
 		if (result) {
@@ -247,7 +240,7 @@ bool WaveformShader::updateRenderState (int msElapsed) {
 				decayClock += msElapsed;
 				while (decayClock >= decayPeriod) {
 					decayClock -= decayPeriod;
-					if (! decayParticlePositions ()) {
+					if (! decayColumnValues ()) {
 						isDecayActive = false;
 						break;
 					}
@@ -258,28 +251,20 @@ bool WaveformShader::updateRenderState (int msElapsed) {
 	}
 	return (result);
 }
-void WaveformShader::assignParticlePositions () {
-	std::vector<Particle>::iterator i1, i2;
+void WaveformShader::assignColumnValues () {
 	std::list<SharedBuffer *>::const_iterator j1, j2;
+	std::vector<WaveformShader::Column>::iterator i1, i2;
 	SharedBuffer *buffer;
-	WaveformShader::ReadSampleFunction fn;
 	uint8_t *buf;
-	double y0, y, sum;
-	int pos, buflen, particlecount, samplecount, sumcount, delta;
+	float *values, *bins;
+	int pos, buflen, count, framecount, columncount, i, start, end;
 
-	fn = readSampleFn;
-	y0 = shaderHeight / 2.0f;
-	y = y0;
+	if (((int) frameSampleValues.size ()) < frameSampleCount) {
+		frameSampleValues.resize (frameSampleCount);
+	}
+	values = frameSampleValues.data ();
 	pos = bufferPosition;
-	samplecount = 0;
-	delta = 0;
-	sumcount = 0;
-	sum = 0.0f;
-
-	SDL_LockMutex (particleMutex);
-	particlecount = (int) particles.size ();
-	i1 = particles.begin ();
-	i2 = particles.end ();
+	count = 0;
 	j1 = frameSamples.cbegin ();
 	j2 = frameSamples.cend ();
 	while (j1 != j2) {
@@ -291,108 +276,219 @@ void WaveformShader::assignParticlePositions () {
 			buflen -= pos;
 			pos = 0;
 		}
-		while (buflen >= audioSampleSize) {
-			if ((i1 == i2) || (samplecount >= frameSampleCount)) {
-				break;
-			}
-			sum += fn (buf, audioSampleChannelCount);
-			++sumcount;
-			++samplecount;
-			delta += particlecount;
-			y = y0 - ((sum / (double) sumcount) * y0);
-			if (delta >= frameSampleCount) {
-				i1->position.assignY (y);
-				++i1;
-				delta -= frameSampleCount;
-				while (delta >= frameSampleCount) {
-					if (i1 == i2) {
-						break;
-					}
-					i1->position.assignY (y);
-					++i1;
-					delta -= frameSampleCount;
-				}
-				sum = 0.0f;
-				sumcount = 0;
-			}
-			buf += audioSampleSize;
-			buflen -= audioSampleSize;
+		framecount = buflen / audioSampleSize;
+		if (framecount > (frameSampleCount - count)) {
+			framecount = frameSampleCount - count;
 		}
-
+		if (framecount > 0) {
+			sampleAnalyzer.convertSamples (buf, framecount, values + count);
+			count += framecount;
+		}
+		buffer->release ();
 		++j1;
 	}
-	while (i1 != i2) {
-		i1->position.assignY (y);
-		++i1;
+	frameSamples.clear ();
+	if (count <= 0) {
+		return;
 	}
-	SDL_UnlockMutex (particleMutex);
 
-	j1 = frameSamples.cbegin ();
-	j2 = frameSamples.cend ();
-	while (j1 != j2) {
-		buffer = *j1;
-		buffer->release ();
-		++j1;
+	SDL_LockMutex (columnMutex);
+	columncount = (int) columns.size ();
+	if (columncount > 0) {
+		if (displayMode == WaveformShader::SpectrumMode) {
+			if (((int) spectrumValues.size ()) < columncount) {
+				spectrumValues.resize (columncount);
+			}
+			bins = spectrumValues.data ();
+			sampleAnalyzer.computeSpectrum (values, count, bins, columncount);
+			i1 = columns.begin ();
+			i2 = columns.end ();
+			while (i1 != i2) {
+				i1->maxValue *= spectrumFallScale;
+				if (*bins > i1->maxValue) {
+					i1->maxValue = *bins;
+				}
+				i1->minValue = 0.0f;
+				i1->rmsValue = 0.0f;
+				++bins;
+				++i1;
+			}
+		}
+		else {
+			for (i = 0; i < columncount; ++i) {
+				start = (int) ((int64_t) i * count / columncount);
+				end = (int) ((int64_t) (i + 1) * count / columncount);
+				if (start >= count) {
+					start = count - 1;
+				}
+				if (end <= start) {
+					end = start + 1;
+				}
+				SampleAnalyzer::reduceBlock (values + start, end - start, &(columns[i].minValue), &(columns[i].maxValue), &(columns[i].rmsValue));
+			}
+		}
 	}
-	frameSamples.clear ();
+	SDL_UnlockMutex (columnMutex);
 }
-bool WaveformShader::decayParticlePositions () {
-	std::vector<Particle>::iterator i1, i2;
-	double y, dy;
+
+bool WaveformShader::decayColumnValues () {
+	std::vector<WaveformShader::Column>::iterator i1, i2;
+	float minvalue;
 	bool found;
 
-	y = shaderHeight / 2.0f;
-	SDL_LockMutex (particleMutex);
+	// Values smaller than one pixel of displacement are snapped to zero
+	minvalue = (shaderHeight >= 2.0f) ? (float) (2.0f / shaderHeight) : 1.0f;
+	SDL_LockMutex (columnMutex);
 	found = false;
-	i1 = particles.begin ();
-	i2 = particles.end ();
+	i1 = columns.begin ();
+	i2 = columns.end ();
 	while (i1 != i2) {
-		dy = i1->position.y - y;
-		if (FLOAT_EQUALS (dy, 0.0f)) {
-			i1->position.assignY (y);
+		i1->minValue *= decayScale;
+		i1->maxValue *= decayScale;
+		i1->rmsValue *= decayScale;
+		if ((fabsf (i1->minValue) < minvalue) && (fabsf (i1->maxValue) < minvalue)) {
+			i1->minValue = 0.0f;
+			i1->maxValue = 0.0f;
+			i1->rmsValue = 0.0f;
 		}
 		else {
 			found = true;
-			dy *= decayScale;
-			if (dy < 1.0f) {
-				i1->position.assignY (y);
-			}
-			else {
-				i1->position.assignY (y + dy);
-			}
 		}
 		++i1;
 	}
-	SDL_UnlockMutex (particleMutex);
+	SDL_UnlockMutex (columnMutex);
 	return (found);
 }
 
-void WaveformShader::updateRenderTexture () {
-	std::vector<Particle>::const_iterator i1, i2;
-	int x1, y1, x2, y2;
-	bool first;
+void WaveformShader::doDraw (double originX, double originY) {
+	float x0, y0;
 
-	memset (renderPixels, 0, textureHeight * renderPitch);
-	SDL_LockMutex (particleMutex);
-	first = true;
-	i1 = particles.cbegin ();
-	i2 = particles.cend ();
-	while (i1 != i2) {
-		if (first) {
-			first = false;
-			x1 = (int) i1->position.x;
-			y1 = (int) i1->position.y;
+	x0 = (float) (originX + position.x);
+	y0 = (float) (originY + position.y);
+	vertices.clear ();
+	vertexIndices.clear ();
+	linePoints.clear ();
+	lowerLinePoints.clear ();
+	SDL_LockMutex (columnMutex);
+	if (columns.size () >= 2) {
+		if (displayMode == WaveformShader::SpectrumMode) {
+			assignSpectrumGeometry (x0, y0);
 		}
 		else {
-			x2 = (int) i1->position.x;
-			y2 = (int) i1->position.y;
-			drawLine (i1->color, x1, y1, x2, y2);
-			x1 = x2;
-			y1 = y2;
+			assignWaveformGeometry (x0, y0);
+		}
+	}
+	SDL_UnlockMutex (columnMutex);
+
+	SDL_SetRenderDrawBlendMode (App::instance->render, SDL_BLENDMODE_BLEND);
+	if (! vertices.empty ()) {
+		SDL_RenderGeometry (App::instance->render, NULL, vertices.data (), (int) vertices.size (), vertexIndices.data (), (int) vertexIndices.size ());
+	}
+	SDL_SetRenderDrawColor (App::instance->render, drawColorR, drawColorG, drawColorB, 255);
+	if (! linePoints.empty ()) {
+		SDL_RenderDrawLinesF (App::instance->render, linePoints.data (), (int) linePoints.size ());
+	}
+	if (! lowerLinePoints.empty ()) {
+		SDL_RenderDrawLinesF (App::instance->render, lowerLinePoints.data (), (int) lowerLinePoints.size ());
+	}
+	SDL_SetRenderDrawBlendMode (App::instance->render, SDL_BLENDMODE_NONE);
+}
+
+void WaveformShader::assignWaveformGeometry (float x0, float y0) {
+	std::vector<WaveformShader::Column>::const_iterator i1, i2;
+	SDL_Vertex vertex;
+	SDL_FPoint point;
+	float x, dx, ymid, yscale;
+	int index;
+
+	// Each column contributes a top and bottom vertex to a filled min/max band, joined to the previous column by two triangles
+	dx = (float) (shaderWidth - 1.0f) / (float) (columns.size () - 1);
+	ymid = y0 + (float) (shaderHeight / 2.0f);
+	yscale = (float) (shaderHeight / 2.0f);
+	vertex.color.r = drawColorR;
+	vertex.color.g = drawColorG;
+	vertex.color.b = drawColorB;
+	vertex.color.a = fillAlpha;
+	vertex.tex_coord.x = 0.0f;
+	vertex.tex_coord.y = 0.0f;
+	x = x0;
+	index = 0;
+	i1 = columns.cbegin ();
+	i2 = columns.cend ();
+	while (i1 != i2) {
+		vertex.position.x = x;
+		vertex.position.y = ymid - (i1->maxValue * yscale);
+		vertices.push_back (vertex);
+		vertex.position.y = ymid - (i1->minValue * yscale);
+		vertices.push_back (vertex);
+		if (index > 0) {
+			vertexIndices.push_back (index - 2);
+			vertexIndices.push_back (index - 1);
+			vertexIndices.push_back (index);
+			vertexIndices.push_back (index - 1);
+			vertexIndices.push_back (index + 1);
+			vertexIndices.push_back (index);
 		}
+		index += 2;
+
+		point.x = x;
+		point.y = ymid - (i1->rmsValue * yscale);
+		linePoints.push_back (point);
+		point.y = ymid + (i1->rmsValue * yscale);
+		lowerLinePoints.push_back (point);
+		x += dx;
+		++i1;
+	}
+}
+
+void WaveformShader::assignSpectrumGeometry (float x0, float y0) {
+	std::vector<WaveformShader::Column>::const_iterator i1, i2;
+	SDL_Vertex vertex;
+	SDL_FPoint point;
+	float x, dx, barwidth, ybase, ytop;
+	int index;
+
+	dx = (float) shaderWidth / (float) columns.size ();
+	barwidth = dx * spectrumBarWidthScale;
+	if (barwidth < 1.0f) {
+		barwidth = 1.0f;
+	}
+	ybase = y0 + (float) shaderHeight;
+	vertex.color.r = drawColorR;
+	vertex.color.g = drawColorG;
+	vertex.color.b = drawColorB;
+	vertex.color.a = fillAlpha;
+	vertex.tex_coord.x = 0.0f;
+	vertex.tex_coord.y = 0.0f;
+	x = x0;
+	index = 0;
+	i1 = columns.cbegin ();
+	i2 = columns.cend ();
+	while (i1 != i2) {
+		ytop = ybase - (i1->maxValue * (float) shaderHeight);
+		vertex.position.x = x;
+		vertex.position.y = ytop;
+		vertices.push_back (vertex);
+		vertex.position.x = x + barwidth;
+		vertices.push_back (vertex);
+		vertex.position.y = ybase;
+		vertices.push_back (vertex);
+		vertex.position.x = x;
+		vertices.push_back (vertex);
+		vertexIndices.push_back (index);
+		vertexIndices.push_back (index + 1);
+		vertexIndices.push_back (index + 2);
+		vertexIndices.push_back (index);
+		vertexIndices.push_back (index + 2);
+		vertexIndices.push_back (index + 3);
+		index += 4;
+
+		point.x = x + (barwidth / 2.0f);
+		point.y = ytop;
+		linePoints.push_back (point);
+		x += dx;
 		++i1;
 	}
-	SDL_UnlockMutex (particleMutex);
 }
 
 void WaveformShader::soundMixerOutput (void *itPtr, SharedBuffer *sampleData, int playerWriteDelta) {
@@ -414,127 +510,8 @@ void WaveformShader::soundMixerOutput (void *itPtr, SharedBuffer *sampleData, in
 	SDL_UnlockMutex (it->sourceSampleMutex);
 }
 
-void WaveformShader::assignReadSampleFn () {
-	switch (audioSampleFormat) {
-		case AUDIO_S8: {
-			readSampleFn = WaveformShader::readSint8Sample;
-			break;
-		}
-		case AUDIO_U8: {
-			readSampleFn = WaveformShader::readUint8Sample;
-			break;
-		}
-		case AUDIO_S16LSB:
-		case AUDIO_S16MSB: {
-			readSampleFn = WaveformShader::readSint16Sample;
-			break;
-		}
-		case AUDIO_U16LSB:
-		case AUDIO_U16MSB: {
-			readSampleFn = WaveformShader::readUint16Sample;
-			break;
-		}
-		case AUDIO_S32LSB:
-		case AUDIO_S32MSB: {
-			readSampleFn = WaveformShader::readSint32Sample;
-			break;
-		}
-		default: {
-			readSampleFn = WaveformShader::readFloat32Sample;
-			break;
-		}
-	}
-}
-double WaveformShader::readSint8Sample (uint8_t *sampleBuffer, int channelCount) {
-	uint8_t *b;
-	int32_t sum;
-	int count;
-
-	b = sampleBuffer;
-	sum = 0;
-	count = channelCount;
-	while (count > 0) {
-		sum += (*((int8_t *) b)) + 128;
-		b += 1;
-		--count;
-	}
-	return (-1.0f + (2.0f * (double) sum / (double) channelCount / 255.0f));
-}
-double WaveformShader::readUint8Sample (uint8_t *sampleBuffer, int channelCount) {
-	uint8_t *b;
-	int32_t sum;
-	int count;
-
-	b = sampleBuffer;
-	sum = 0;
-	count = channelCount;
-	while (count > 0) {
-		sum += *((uint8_t *) b);
-		b += 1;
-		--count;
-	}
-	return (-1.0f + (2.0f * (double) sum / (double) channelCount / 255.0f));
-}
-double WaveformShader::readSint16Sample (uint8_t *sampleBuffer, int channelCount) {
-	uint8_t *b;
-	int32_t sum;
-	int count;
-
-	b = sampleBuffer;
-	sum = 0;
-	count = channelCount;
-	while (count > 0) {
-		sum += (*((int16_t *) b)) + 32768;
-		b += 2;
-		--count;
-	}
-	return (-1.0f + (2.0f * (double) sum / (double) channelCount / 65535.0f));
-}
-double WaveformShader::readUint16Sample (uint8_t *sampleBuffer, int channelCount) {
-	uint8_t *b;
-	int32_t sum;
-	int count;
-
-	b = sampleBuffer;
-	sum = 0;
-	count = channelCount;
-	while (count > 0) {
-		sum += *((uint16_t *) b);
-		b += 2;
-		--count;
-	}
-	return (-1.0f + (2.0f * (double) sum / (double) channelCount / 65535.0f));
-}
-double WaveformShader::readSint32Sample (uint8_t *sampleBuffer, int channelCount) {
-	uint8_t *b;
-	int64_t sum;
-	int count;
-
-	b = sampleBuffer;
-	sum = 0;
-	count = channelCount;
-	while (count > 0) {
-		sum += *((int32_t *) b);
-		sum += 2147483648;
-		b += 4;
-		--count;
-	}
-	return (-1.0f + (2.0f * (double) sum / (double) channelCount / 4294967296.0f));
-}
-double WaveformShader::readFloat32Sample (uint8_t *sampleBuffer, int channelCount) {
-	uint8_t *b;
-	float sum;
-	int count;
-
-	b = sampleBuffer;
-	sum = 0.0f;
-	count = channelCount;
-	while (count > 0) {
-		sum += *((float *) b);
-		b += 4;
-		--count;
-	}
-	return ((double) sum / (double) channelCount);
+void WaveformShader::resetSampleAnalyzer () {
+	sampleAnalyzer.setFormat (audioSampleFormat, audioSampleChannelCount);
 }
 
 bool WaveformShader::playResourceSample (const char *soundId, int mixVolume, bool muted) {
@@ -547,7 +524,7 @@ bool WaveformShader::playResourceSample (const char *soundId, int mixVolume, boo
 	}
 	audioSampleSize *= audioSampleChannelCount;
 	frameSampleCount = frameDuration * audioSampleRate / 1000;
-	assignReadSampleFn ();
+	resetSampleAnalyzer ();
 	if (soundPlayerId >= 0) {
 		if (shouldStopSoundPlayer) {
 			SoundMixer::instance->stopPlayer (soundPlayerId);
@@ -585,7 +562,7 @@ void WaveformShader::setSourceVideo (Video *video) {
 		}
 		audioSampleSize *= audioSampleChannelCount;
 		frameSampleCount = frameDuration * audioSampleRate / 1000;
-		assignReadSampleFn ();
+		resetSampleAnalyzer ();
 		shouldStopSoundPlayer = false;
 	}
 }
@@ -606,9 +583,19 @@ void WaveformShader::setShaderSize (double targetWidth, double targetHeight) {
 	}
 	width = w;
 	height = h;
-	SDL_LockMutex (particleMutex);
-	particles.clear ();
+	SDL_LockMutex (columnMutex);
+	columns.clear ();
 	shaderWidth = w;
 	shaderHeight = h;
-	SDL_UnlockMutex (particleMutex);
+	SDL_UnlockMutex (columnMutex);
+}
+
+void WaveformShader::setDisplayMode (int mode) {
+	if (displayMode == mode) {
+		return;
+	}
+	SDL_LockMutex (columnMutex);
+	displayMode = mode;
+	columns.clear ();
+	SDL_UnlockMutex (columnMutex);
 }
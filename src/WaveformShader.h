@@ -30,12 +30,12 @@
 * QUESTIONS OR ADDITIONAL INFORMATION
 * If you have questions regarding this License Agreement, please contact Membrane Software by sending an email to support@membranesoftware.com.
 */
-// Shader that renders a waveform animation from audio sample data
+// Shader that renders a waveform or spectrum animation from audio sample data
 #ifndef WAVEFORM_SHADER_H
 #define WAVEFORM_SHADER_H
 
-#include "Particle.h"
 #include "SoundMixer.h"
+#include "SampleAnalyzer.h"
 #include "WidgetHandle.h"
 #include "Shader.h"
 
@@ -44,16 +44,20 @@ class SharedBuffer;
 
 class WaveformShader : public Shader {
 public:
-	WaveformShader (double shaderWidth, double shaderHeight, double particleDensity = 0.25f);
+	WaveformShader (double shaderWidth, double shaderHeight, double columnDensity = 0.25f);
 	~WaveformShader ();
 
 	// Return a typecasted pointer to the provided widget, or NULL if the widget does not appear to be of the correct type
 	static WaveformShader *castWidget (Widget *widget);
 
+	static constexpr const int WaveformMode = 0;
+	static constexpr const int SpectrumMode = 1;
+
 	// Read-only data members
+	int displayMode;
 	double shaderWidth;
 	double shaderHeight;
-	double particleDensity;
+	double columnDensity;
 	int frameDuration;
 	int64_t soundPlayerId;
 	SDL_AudioFormat audioSampleFormat;
@@ -68,47 +72,61 @@ public:
 	// Set a Video widget that should provide audio data for waveform render, or clear any existing source video if NULL
 	void setSourceVideo (Video *video);
 
-	// Set the size of the shader texture
+	// Set the size of the shader's draw area
 	void setShaderSize (double targetWidth, double targetHeight);
 
+	// Set the shader's display mode, specified by a DisplayMode constant
+	void setDisplayMode (int mode);
+
 protected:
+	// Add subclass-specific draw commands for execution by the App
+	void doDraw (double originX, double originY);
+
 	// Update render state as appropriate for an elapsed millisecond time period and return true if render surface updates are needed
 	bool updateRenderState (int msElapsed);
 
-	// Update the content of renderTexture as appropriate for render state
-	void updateRenderTexture ();
-
 private:
+	struct Column {
+		float minValue;
+		float maxValue;
+		float rmsValue;
+		Column ():
+			minValue (0.0f),
+			maxValue (0.0f),
+			rmsValue (0.0f) { }
+	};
+
 	// Remove all items from sourceSamples
 	void clearSourceSamples ();
 
-	// Reset readSampleFn for use with audioSampleFormat
-	void assignReadSampleFn ();
+	// Reset sampleAnalyzer for use with audioSampleFormat
+	void resetSampleAnalyzer ();
 
-	// Reposition particles as appropriate for data in frameSamples
-	void assignParticlePositions ();
+	// Assign column values as appropriate for data in frameSamples
+	void assignColumnValues ();
 
-	// Reposition particles as appropriate for a period of time without sample data and return true if any positions were changed
-	bool decayParticlePositions ();
+	// Reduce column values as appropriate for a period of time without sample data and return true if any values were changed
+	bool decayColumnValues ();
 
-	// Return a sample value from sampleBuffer, scaled to a range from -1.0 to 1.0.
-	typedef double (*ReadSampleFunction) (uint8_t *sampleBuffer, int channelCount);
-	static double readSint8Sample (uint8_t *sampleBuffer, int channelCount);
-	static double readUint8Sample (uint8_t *sampleBuffer, int channelCount);
-	static double readSint16Sample (uint8_t *sampleBuffer, int channelCount);
-	static double readUint16Sample (uint8_t *sampleBuffer, int channelCount);
-	static double readSint32Sample (uint8_t *sampleBuffer, int channelCount);
-	static double readFloat32Sample (uint8_t *sampleBuffer, int channelCount);
+	// Populate vertices and linePoints with draw data for the current column values
+	void assignWaveformGeometry (float x0, float y0);
+	void assignSpectrumGeometry (float x0, float y0);
 
 	// Callback functions
 	static void soundMixerOutput (void *itPtr, SharedBuffer *sampleData, int playerWriteDelta);
 
-	std::vector<Particle> particles;
-	SDL_mutex *particleMutex;
+	std::vector<WaveformShader::Column> columns;
+	SDL_mutex *columnMutex;
 	std::list<SharedBuffer *> sourceSamples;
 	SDL_mutex *sourceSampleMutex;
 	int sourceSampleSize;
-	WaveformShader::ReadSampleFunction readSampleFn;
+	SampleAnalyzer sampleAnalyzer;
+	std::vector<float> frameSampleValues;
+	std::vector<float> spectrumValues;
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> vertexIndices;
+	std::vector<SDL_FPoint> linePoints;
+	std::vector<SDL_FPoint> lowerLinePoints;
 	bool isDecayActive;
 	int decayClock;
 	WidgetHandle<Video> sourceVideoHandle;
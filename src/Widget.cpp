@@ -32,7 +32,6 @@
 */
 #include "Config.h"
 #include "App.h"
-#include "SdlUtil.h"
 #include "ClassId.h"
 #include "StringList.h"
 #include "MathUtil.h"
@@ -55,7 +54,6 @@ Widget::Widget ()
 , mouseClickExecuteCount (0)
 , shouldComposeRender (false)
 , classId (-1)
-, refcount (0)
 , hasScreenPosition (false)
 , screenX (0.0f)
 , screenY (0.0f)
@@ -66,6 +64,7 @@ Widget::Widget ()
 , isComposeDrawEnabled (false)
 , isComposeRendering (false)
 , isComposeAnimating (false)
+, isLayerInvalid (true)
 , composeWidth (0.0f)
 , composeHeight (0.0f)
 , composeScale (1.0f)
@@ -80,8 +79,12 @@ Widget::Widget ()
 , composeTargetWidth (0.0f)
 , composeTargetHeight (0.0f)
 , composeAnimationType (0)
+, layerPositionX (0.0f)
+, layerPositionY (0.0f)
+, layerWidth (0.0f)
+, layerHeight (0.0f)
+, isLayerVisible (true)
 {
-	SdlUtil::createMutex (&refcountMutex);
 }
 Widget::~Widget () {
 	if (! composeTexturePath.empty ()) {
@@ -89,31 +92,6 @@ Widget::~Widget () {
 		composeTexturePath.assign ("");
 	}
 	composeTexture = NULL;
-	SdlUtil::destroyMutex (&refcountMutex);
-}
-
-void Widget::retain () {
-	SDL_LockMutex (refcountMutex);
-	++refcount;
-	if (refcount < 1) {
-		refcount = 1;
-	}
-	SDL_UnlockMutex (refcountMutex);
-}
-void Widget::release () {
-	bool isdestroyed;
-
-	isdestroyed = false;
-	SDL_LockMutex (refcountMutex);
-	--refcount;
-	if (refcount <= 0) {
-		refcount = 0;
-		isdestroyed = true;
-	}
-	SDL_UnlockMutex (refcountMutex);
-	if (isdestroyed) {
-		delete (this);
-	}
 }
 
 bool Widget::isWidgetClass (Widget *widget, int classIdValue) {
@@ -189,6 +167,22 @@ void Widget::update (int msElapsed, double originX, double originY) {
 
 	doUpdate (msElapsed);
 
+	if ((! FLOAT_EQUALS (layerPositionX, position.x)) || (! FLOAT_EQUALS (layerPositionY, position.y)) || (! FLOAT_EQUALS (layerWidth, width)) || (! FLOAT_EQUALS (layerHeight, height)) || (isLayerVisible != isVisible)) {
+		layerPositionX = position.x;
+		layerPositionY = position.y;
+		layerWidth = width;
+		layerHeight = height;
+		isLayerVisible = isVisible;
+		invalidateLayer ();
+	}
+	else if (! isVisible) {
+		// Content changes in a hidden widget don't affect any cached layer that holds it
+		isLayerInvalid = false;
+	}
+	if (isComposeAnimating) {
+		invalidateLayer ();
+	}
+
 	if (isComposeDrawEnabled) {
 		if (! isComposeRendering) {
 			if (! shouldComposeRender) {
@@ -203,6 +197,7 @@ void Widget::update (int msElapsed, double originX, double originY) {
 				composeWidth = width * composeScale;
 				composeHeight = height * composeScale;
 				isComposeRendering = true;
+				invalidateLayer ();
 				retain ();
 				App::instance->addPredrawTask (Widget::renderComposeTexture, this);
 			}
@@ -225,7 +220,7 @@ void Widget::doUpdate (int msElapsed) {
 }
 
 void Widget::draw (double originX, double originY) {
-	SDL_Rect rect;
+	SDL_Rect rect, srcrect;
 	double w, h;
 
 	if (isDestroyed) {
@@ -238,7 +233,11 @@ void Widget::draw (double originX, double originY) {
 		rect.y = (int) (originY + position.y + (composeTargetHeight / 2.0f) - (h / 2.0f));
 		rect.w = (int) w;
 		rect.h = (int) h;
-		SDL_RenderCopyEx (App::instance->render, composeTexture, NULL, &rect, composeRotation, NULL, SDL_FLIP_NONE);
+		srcrect.x = 0;
+		srcrect.y = 0;
+		srcrect.w = composeTextureWidth;
+		srcrect.h = composeTextureHeight;
+		SDL_RenderCopyEx (App::instance->render, composeTexture, &srcrect, &rect, composeRotation, NULL, SDL_FLIP_NONE);
 	}
 	else {
 		doDraw (originX, originY);
@@ -530,6 +529,10 @@ void Widget::animateScaleBump () {
 	isComposeAnimating = true;
 }
 
+void Widget::invalidateLayer () {
+	isLayerInvalid = true;
+}
+
 void Widget::renderComposeTexture (void *itPtr) {
 	Widget *it = (Widget *) itPtr;
 
@@ -539,6 +542,7 @@ void Widget::renderComposeTexture (void *itPtr) {
 }
 
 void Widget::executeRenderComposeTexture () {
+	SDL_Texture *target;
 	int w, h;
 
 	if (isDestroyed) {
@@ -559,18 +563,25 @@ void Widget::executeRenderComposeTexture () {
 		composeTextureWidth = w;
 		composeTextureHeight = h;
 		composeTexturePath.sprintf ("*_Widget_%llx_%llx", (long long int) id, (long long int) App::instance->getUniqueId ());
-		composeTexture = Resource::instance->createTexture (composeTexturePath, composeTextureWidth, composeTextureHeight);
+		composeTexture = Resource::instance->createPoolTexture (composeTexturePath, composeTextureWidth, composeTextureHeight, false, Resource::ComposeTextureCategory);
 		if (! composeTexture) {
 			composeTexturePath.assign ("");
 		}
+		else {
+			// Content drawn with alpha blending over the cleared texture holds premultiplied color values
+			if (SDL_SetTextureBlendMode (composeTexture, SDL_ComposeCustomBlendMode (SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD)) != 0) {
+				SDL_SetTextureBlendMode (composeTexture, SDL_BLENDMODE_BLEND);
+			}
+		}
 	}
 	if (! composeTexture) {
 		return;
 	}
+	target = SDL_GetRenderTarget (App::instance->render);
 	SDL_SetRenderTarget (App::instance->render, composeTexture);
 	SDL_SetRenderDrawBlendMode (App::instance->render, SDL_BLENDMODE_NONE);
 	SDL_SetRenderDrawColor (App::instance->render, 0, 0, 0, 0);
 	SDL_RenderClear (App::instance->render);
 	doDraw (-(position.x), -(position.y));
-	SDL_SetRenderTarget (App::instance->render, NULL);
+	SDL_SetRenderTarget (App::instance->render, target);
 }
@@ -36,11 +36,12 @@
 
 #include <stdint.h>
 #include "Position.h"
+#include "Refcounted.h"
 
 class StringList;
 class PanelLayoutFlow;
 
-class Widget {
+class Widget : public Refcounted {
 public:
 	Widget ();
 	virtual ~Widget ();
@@ -128,7 +129,6 @@ public:
 
 	// Read-only data members
 	int classId;
-	int refcount;
 	bool hasScreenPosition;
 	double screenX;
 	double screenY;
@@ -140,6 +140,7 @@ public:
 	bool isComposeDrawEnabled;
 	bool isComposeRendering;
 	bool isComposeAnimating;
+	bool isLayerInvalid;
 	double composeWidth;
 	double composeHeight;
 	double composeScale;
@@ -149,12 +150,6 @@ public:
 	double width;
 	double height;
 
-	// Increase the object's refcount
-	void retain ();
-
-	// Decrease the object's refcount. If this reduces the refcount to zero or less, delete the object.
-	void release ();
-
 	// Return a boolean value indicating if a widget pointer matches the provided ClassId value
 	static bool isWidgetClass (Widget *widget, int classIdValue);
 
@@ -283,6 +278,9 @@ public:
 	// Execute a scale bump animation
 	void animateScaleBump ();
 
+	// Mark the widget's drawn content as changed, causing any cached layer that holds the widget to render again
+	void invalidateLayer ();
+
 	// Callback functions
 	static bool compareZLevel (Widget *first, Widget *second);
 
@@ -317,7 +315,6 @@ private:
 	static void renderComposeTexture (void *itPtr);
 	void executeRenderComposeTexture ();
 
-	SDL_mutex *refcountMutex;
 	SDL_Texture *composeTexture;
 	StdString composeTexturePath;
 	int composeTextureWidth;
@@ -326,5 +323,10 @@ private:
 	double composeTargetHeight;
 	int composeAnimationType;
 	Position composeAnimationScale;
+	double layerPositionX;
+	double layerPositionY;
+	double layerWidth;
+	double layerHeight;
+	bool isLayerVisible;
 };
 #endif